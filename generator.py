@@ -284,6 +284,8 @@ class DocGeneratorOptions(GeneratorOptions):
 #     parameter on a separate line
 #   alignFuncParam - if nonzero and parameters are being put on a
 #     separate line, align parameter names at the specified column
+#   sampledTypes - list of object types whose uses are only tracked for
+#     google_threading.sample_percent of their objects, or None for all
 class ThreadGeneratorOptions(GeneratorOptions):
     """Represents options during C interface generation for headers"""
     def __init__(self,
@@ -307,7 +309,8 @@ class ThreadGeneratorOptions(GeneratorOptions):
                  apientryp = '',
                  indentFuncProto = True,
                  indentFuncPointer = False,
-                 alignFuncParam = 0):
+                 alignFuncParam = 0,
+                 sampledTypes = None):
         GeneratorOptions.__init__(self, filename, apiname, profile,
                                   versions, emitversions, defaultExtensions,
                                   addExtensions, removeExtensions, sortProcedure)
@@ -323,6 +326,7 @@ class ThreadGeneratorOptions(GeneratorOptions):
         self.indentFuncProto = indentFuncProto
         self.indentFuncPointer = indentFuncPointer
         self.alignFuncParam  = alignFuncParam
+        self.sampledTypes    = sampledTypes
 
 
 # ParamCheckerGeneratorOptions - subclass of GeneratorOptions.
@@ -2352,6 +2356,34 @@ class ThreadOutputGenerator(OutputGenerator):
     TYPE_SECTIONS = ['include', 'define', 'basetype', 'handle', 'enum',
                      'group', 'bitmask', 'funcpointer', 'struct']
     ALL_SECTIONS = TYPE_SECTIONS + ['command']
+    # Object types with a counter in threading.h
+    THREAD_CHECK_DISPATCHABLE_OBJECTS = [
+        "VkCommandBuffer",
+        "VkDevice",
+        "VkInstance",
+        "VkQueue",
+    ]
+    THREAD_CHECK_NONDISPATCHABLE_OBJECTS = [
+        "VkBuffer",
+        "VkBufferView",
+        "VkCommandPool",
+        "VkDescriptorPool",
+        "VkDescriptorSetLayout",
+        "VkDeviceMemory",
+        "VkEvent",
+        "VkFence",
+        "VkFramebuffer",
+        "VkImage",
+        "VkImageView",
+        "VkPipeline",
+        "VkPipelineCache",
+        "VkPipelineLayout",
+        "VkQueryPool",
+        "VkRenderPass",
+        "VkSampler",
+        "VkSemaphore",
+        "VkShaderModule",
+    ]
     def __init__(self,
                  errFile = sys.stderr,
                  warnFile = sys.stderr,
@@ -2382,33 +2414,8 @@ class ThreadOutputGenerator(OutputGenerator):
     def makeThreadUseBlock(self, cmd, functionprefix):
         """Generate C function pointer typedef for <command> Element"""
         paramdecl = ''
-        thread_check_dispatchable_objects = [
-            "VkCommandBuffer",
-            "VkDevice",
-            "VkInstance",
-            "VkQueue",
-        ]
-        thread_check_nondispatchable_objects = [
-            "VkBuffer",
-            "VkBufferView",
-            "VkCommandPool",
-            "VkDescriptorPool",
-            "VkDescriptorSetLayout",
-            "VkDeviceMemory",
-            "VkEvent",
-            "VkFence",
-            "VkFramebuffer",
-            "VkImage",
-            "VkImageView",
-            "VkPipeline",
-            "VkPipelineCache",
-            "VkPipelineLayout",
-            "VkQueryPool",
-            "VkRenderPass",
-            "VkSampler",
-            "VkSemaphore",
-            "VkShaderModule",
-        ]
+        thread_check_dispatchable_objects = self.THREAD_CHECK_DISPATCHABLE_OBJECTS
+        thread_check_nondispatchable_objects = self.THREAD_CHECK_NONDISPATCHABLE_OBJECTS
 
         # Find and add any parameters that are thread unsafe
         params = cmd.findall('param')
@@ -2493,6 +2500,29 @@ class ThreadOutputGenerator(OutputGenerator):
             return None
         else:
             return paramdecl
+    def makeSamplePercentSetter(self):
+        """Generate the function applying google_threading.sample_percent to the sampled types"""
+        sampled = self.genOpts.sampledTypes
+        if sampled is None:
+            sampled = self.THREAD_CHECK_DISPATCHABLE_OBJECTS + self.THREAD_CHECK_NONDISPATCHABLE_OBJECTS
+        dispatchable = [t for t in self.THREAD_CHECK_DISPATCHABLE_OBJECTS if t in sampled]
+        nondispatchable = [t for t in self.THREAD_CHECK_NONDISPATCHABLE_OBJECTS if t in sampled]
+        body = '// Only track uses of percent of the objects of the sampled types\n'
+        body += '// (' + ', '.join(dispatchable + nondispatchable) + ')\n'
+        body += 'static void setThreadingSamplePercent(layer_data *my_data, uint32_t percent)\n'
+        body += '{\n'
+        for t in dispatchable:
+            body += '    my_data->c_' + t + '.samplePercent = percent;\n'
+        if nondispatchable:
+            body += '#ifdef DISTINCT_NONDISPATCHABLE_HANDLES\n'
+            for t in nondispatchable:
+                body += '    my_data->c_' + t + '.samplePercent = percent;\n'
+            body += '#else // DISTINCT_NONDISPATCHABLE_HANDLES\n'
+            body += '    // All non-dispatchable handles share one counter\n'
+            body += '    my_data->c_uint64_t.samplePercent = percent;\n'
+            body += '#endif // DISTINCT_NONDISPATCHABLE_HANDLES\n'
+        body += '}\n'
+        return body
     def beginFile(self, genOpts):
         OutputGenerator.beginFile(self, genOpts)
         # C-specific
@@ -2516,6 +2546,7 @@ class ThreadOutputGenerator(OutputGenerator):
         # C-specific
         # Finish C++ wrapper and multiple inclusion protection
         self.newline()
+        write(self.makeSamplePercentSetter(), file=self.outFile)
         # record intercepted procedures
         write('// intercepts', file=self.outFile)
         write('struct { const char* name; PFN_vkVoidFunction pFunc;} procmap[] = {', file=self.outFile)
@@ -269,7 +269,10 @@ buildList = [
         apicall           = '',
         apientry          = 'VKAPI_CALL ',
         apientryp         = 'VKAPI_PTR *',
-        alignFuncParam    = 48)
+        alignFuncParam    = 48,
+        sampledTypes      = [ 'VkCommandBuffer', 'VkBuffer', 'VkBufferView', 'VkDeviceMemory',
+                              'VkEvent', 'VkFence', 'VkFramebuffer', 'VkImage', 'VkImageView',
+                              'VkPipeline', 'VkQueryPool', 'VkSampler', 'VkSemaphore' ])
     ],
     [ ParamCheckerOutputGenerator,
       ParamCheckerGeneratorOptions(
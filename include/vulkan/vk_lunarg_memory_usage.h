@@ -0,0 +1,81 @@
+//
+// File: vk_lunarg_memory_usage.h
+//
+/*
+ * Copyright (c) 2015-2016 The Khronos Group Inc.
+ * Copyright (c) 2015-2016 Valve Corporation
+ * Copyright (c) 2015-2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and/or associated documentation files (the "Materials"), to
+ * deal in the Materials without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Materials, and to permit persons to whom the Materials are
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice(s) and this permission notice shall be included in
+ * all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+ * USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+#ifndef __VK_LUNARG_MEMORY_USAGE_H__
+#define __VK_LUNARG_MEMORY_USAGE_H__
+
+#include "vulkan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/*
+***************************************************************************************************
+*   Memory usage query exposed by VK_LAYER_LUNARG_mem_tracker
+***************************************************************************************************
+*/
+
+// Device extension advertised by mem_tracker. Enable it at vkCreateDevice(), then retrieve
+//  the query with vkGetDeviceProcAddr(), which returns NULL when the extension is not enabled
+#define VK_LUNARG_MEMORY_USAGE_EXTENSION_NAME "VK_LUNARG_memory_usage"
+#define VK_LUNARG_MEMORY_USAGE_SPEC_VERSION 1
+#define VK_LUNARG_MEMORY_USAGE_QUERY_NAME "vkGetMemoryUsageLUNARG"
+
+// ------------------------------------------------------------------------------------------------
+// Structures
+
+typedef struct VkMemoryUsageLUNARG {
+    uint32_t       allocationCount;                            // Live vkAllocateMemory() allocations
+    uint32_t       maxMemoryAllocationCount;                   // VkPhysicalDeviceLimits::maxMemoryAllocationCount
+    uint32_t       memoryTypeCount;                            // From vkGetPhysicalDeviceMemoryProperties()
+    uint32_t       memoryHeapCount;
+    VkDeviceSize   typeBytes[VK_MAX_MEMORY_TYPES];             // Bytes allocated from each memory type
+    uint32_t       typeAllocationCount[VK_MAX_MEMORY_TYPES];
+    VkDeviceSize   heapBytes[VK_MAX_MEMORY_HEAPS];             // Bytes allocated from each heap
+    VkDeviceSize   heapSize[VK_MAX_MEMORY_HEAPS];
+    uint32_t       bufferCount;                                // Live buffers bound to memory
+    VkDeviceSize   bufferBytes;                                // Their VkMemoryRequirements::size total
+    uint32_t       imageCount;                                 // Live images bound to memory
+    VkDeviceSize   imageBytes;
+    VkDeviceSize   unboundBytes;                               // Allocated bytes no buffer or image is bound to
+    VkDeviceMemory mostUnboundMemory;                          // Allocation with the most unbound bytes
+    VkDeviceSize   mostUnboundBytes;
+} VkMemoryUsageLUNARG;
+
+// ------------------------------------------------------------------------------------------------
+// API functions
+
+typedef void(VKAPI_PTR *PFN_vkGetMemoryUsageLUNARG)(VkDevice device,
+                                                    VkMemoryUsageLUNARG *pUsage);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // __VK_LUNARG_MEMORY_USAGE_H__
@@ -105,7 +105,6 @@ static void init_device_limits(layer_data *my_data, const VkAllocationCallbacks
     uint32_t report_flags = 0;
     uint32_t debug_action = 0;
     FILE *log_output = NULL;
-    const char *option_str;
     VkDebugReportCallbackEXT callback;
     // initialize device_limits options
     report_flags = getLayerOptionFlags("lunarg_device_limits.report_flags", 0);
@@ -113,14 +112,14 @@ static void init_device_limits(layer_data *my_data, const VkAllocationCallbacks
 
     if (debug_action & VK_DBG_LAYER_ACTION_LOG_MSG)
     {
-        option_str = getLayerOption("lunarg_device_limits.log_filename");
-        log_output = getLayerLogOutput(option_str, "lunarg_device_limits");
+        layer_log_ring *log_ring;
+        getLayerLogSink("lunarg_device_limits", &log_output, &log_ring);
         VkDebugReportCallbackCreateInfoEXT dbgCreateInfo;
         memset(&dbgCreateInfo, 0, sizeof(dbgCreateInfo));
         dbgCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
         dbgCreateInfo.flags = report_flags;
-        dbgCreateInfo.pfnCallback = log_callback;
-        dbgCreateInfo.pUserData = (void *) log_output;
+        dbgCreateInfo.pfnCallback = log_ring ? log_ring_callback : log_callback;
+        dbgCreateInfo.pUserData = log_ring ? (void *) log_ring : (void *) log_output;
         layer_create_msg_callback(my_data->report_data, &dbgCreateInfo, pAllocator, &callback);
         my_data->logging_callback.push_back(callback);
     }
@@ -45,10 +45,16 @@
 #include <iostream>
 #include <algorithm>
 #include <list>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <deque>
 #include <spirv.hpp>
 #include <set>
 
 #include "vk_loader_platform.h"
+#include "vk_layer_rwlock.h"
 #include "vk_dispatch_table_helper.h"
 #include "vk_struct_string_helper_cpp.h"
 #if defined(__GNUC__)
@@ -75,7 +81,8 @@ using std::unordered_set;
 struct CMD_POOL_INFO {
     VkCommandPoolCreateFlags    createFlags;
     uint32_t queueFamilyIndex;
-    list<VkCommandBuffer>       commandBuffers; // list container of cmd buffers allocated from this pool
+    vector<GLOBAL_CB_NODE*>     commandBuffers; // nodes of cmd buffers allocated from this pool, see GLOBAL_CB_NODE::poolIndex
+    vector<GLOBAL_CB_NODE*>     freeNodes; // nodes of freed cmd buffers, reused with their container capacity intact
 };
 
 struct devExts {
@@ -118,10 +125,19 @@ struct layer_data {
     unordered_map<VkSemaphore, SEMAPHORE_NODE> semaphoreMap;
     unordered_map<void*,                 GLOBAL_CB_NODE*>                    commandBufferMap;
     unordered_map<VkFramebuffer,         VkFramebufferCreateInfo*>           frameBufferMap;
-    unordered_map<VkImage, vector<ImageSubresourcePair>> imageSubresourceMap;
-    unordered_map<ImageSubresourcePair, IMAGE_NODE> imageLayoutMap;
+    unordered_map<VkImage, subresource_range_map<VkImageLayout> > imageLayoutMap;
     unordered_map<VkRenderPass,          RENDER_PASS_NODE*>                  renderPassMap;
-    unordered_map<VkShaderModule,        shader_module*>                     shaderModuleMap;
+    unordered_map<VkShaderModule,        shared_ptr<shader_module>>          shaderModuleMap;
+    // Submitted command buffers whose checks are left to runDeferredSubmits(), see
+    //  lunarg_draw_state.deferred_submit_validation. Only touched under globalLock.
+    std::deque<VkCommandBuffer>          deferredSubmits;
+    // Wakes deferredSubmitThread; deferredSubmitPending and deferredSubmitStop are
+    //  guarded by deferredSubmitMutex
+    std::mutex                           deferredSubmitMutex;
+    std::condition_variable              deferredSubmitCond;
+    bool                                 deferredSubmitPending;
+    bool                                 deferredSubmitStop;
+    std::thread                          deferredSubmitThread;
     // Current render pass
     VkRenderPassBeginInfo                renderPassBeginInfo;
     uint32_t                             currentSubpass;
@@ -133,7 +149,9 @@ struct layer_data {
         report_data(nullptr),
         device_dispatch_table(nullptr),
         instance_dispatch_table(nullptr),
-        device_extensions()
+        device_extensions(),
+        deferredSubmitPending(false),
+        deferredSubmitStop(false)
     {};
 };
 
@@ -181,13 +199,70 @@ struct spirv_inst_iter {
     spirv_inst_iter const & operator* () const { return *this; }
 };
 
+typedef std::pair<unsigned, unsigned> location_t;
+typedef std::pair<unsigned, unsigned> descriptor_slot_t;
+
+
+struct interface_var {
+    uint32_t id;
+    uint32_t type_id;
+    uint32_t offset;
+    /* TODO: collect the name, too? Isn't required to be present. */
+};
+
+/* a variable whose descriptor slot is already claimed by another variable in the same image */
+struct descriptor_conflict {
+    descriptor_slot_t slot;
+    uint32_t id;
+    uint32_t type_id;
+};
+
+/* Analysis of one entrypoint of a module. The module is immutable, so each part is
+ * filled in the first time a pipeline asks for it and reused after that.
+ */
+struct entrypoint_info {
+    bool descriptors_collected;
+    /* ids referenced by the static call tree of the entrypoint */
+    std::unordered_set<uint32_t> accessible_ids;
+    std::map<descriptor_slot_t, interface_var> descriptor_uses;
+    std::vector<descriptor_conflict> descriptor_conflicts;
+    /* interface by location, indexed by storage class and arrayed-ness, see get_interface_by_location() */
+    bool interface_collected[4];
+    std::map<location_t, interface_var> interfaces[4];
+
+    entrypoint_info() : descriptors_collected(false), interface_collected() {}
+};
+
+/* the decorations of one id that the interface collectors care about */
+struct id_decorations {
+    int location;           /* -1 if not decorated */
+    int builtin;            /* -1 if not decorated */
+    unsigned component;     /* unspecified is OK, is 0 */
+    unsigned set;
+    unsigned binding;
+    bool block;
+
+    id_decorations() : location(-1), builtin(-1), component(0), set(0), binding(0), block(false) {}
+};
+
 struct shader_module {
     /* the spirv image itself */
     vector<uint32_t> words;
     /* a mapping of <id> to the first word of its def. this is useful because walking type
      * trees, constant expressions, etc requires jumping all over the instruction stream.
+     * ids are dense and below the header's bound, so this is indexed directly by id; 0 means
+     * no def was collected (no instruction starts inside the header).
      */
-    unordered_map<unsigned, unsigned> def_index;
+    vector<unsigned> def_index;
+    /* OpDecorate results indexed by id, built on first use by get_decorations() */
+    mutable vector<id_decorations> decorations;
+    /* offsets of the OpEntryPoint instructions */
+    vector<unsigned> entrypoint_offsets;
+    /* per-entrypoint analysis, keyed by the OpEntryPoint offset */
+    mutable unordered_map<unsigned, entrypoint_info> entrypoint_cache;
+    /* guards the lazily built decorations and entrypoint_cache, which pipelines validated
+     * on different threads may fill at the same time */
+    mutable std::mutex analysis_lock;
 
     shader_module(VkShaderModuleCreateInfo const *pCreateInfo) :
         words((uint32_t *)pCreateInfo->pCode, (uint32_t *)pCreateInfo->pCode + pCreateInfo->codeSize / sizeof(uint32_t)),
@@ -204,20 +279,48 @@ struct shader_module {
 
     /* gets an iterator to the definition of an id */
     spirv_inst_iter get_def(unsigned id) const {
-        auto it = def_index.find(id);
-        if (it == def_index.end()) {
+        if (id >= def_index.size() || !def_index[id]) {
             return end();
         }
-        return at(it->second);
+        return at(def_index[id]);
     }
 };
 
 // TODO : Do we need to guard access to layer_data_map w/ lock?
 static unordered_map<void*, layer_data*> layer_data_map;
 
-// TODO : This can be much smarter, using separate locks for separate global data
+// globalLock guards all layer state. Calls that create, destroy or submit objects take it
+//  exclusively. Command recording calls only change their own GLOBAL_CB_NODE, so they take
+//  it shared and serialize on that node's recordLock instead, letting separate command
+//  buffers record in parallel. Lock order is globalLock, then recordLock, then any
+//  boundCmdBufferLocks shard.
 static int globalLockInitialized = 0;
-static loader_platform_thread_mutex globalLock;
+static loader_platform_thread_rwlock globalLock;
+// Sharded by set handle, guards SET_NODE::boundCmdBuffers against concurrent binds
+#define BOUND_CMD_BUFFER_LOCK_BITS 4
+static std::mutex boundCmdBufferLocks[1 << BOUND_CMD_BUFFER_LOCK_BITS];
+// Check families turned off with lunarg_draw_state.disabled_checks. A disabled
+//  family skips its validation work entirely, not just the message.
+//  SHADER_CHECKER_ERROR values follow the DRAW_STATE_ERROR values.
+#define DRAWSTATE_CHECK_COUNT (DRAWSTATE_INVALID_STORAGE_BUFFER_OFFSET + 1)
+static bool disabledChecks[DRAWSTATE_CHECK_COUNT + SHADER_CHECKER_MISSING_ENTRYPOINT + 1];
+static inline bool checkDisabled(DRAW_STATE_ERROR code) { return disabledChecks[code]; }
+static inline bool checkDisabled(SHADER_CHECKER_ERROR code) { return disabledChecks[DRAWSTATE_CHECK_COUNT + code]; }
+// Threads used to validate a batch of pipelines, from lunarg_draw_state.pipeline_validation_threads.
+//  1 validates serially on the calling thread. 0 (the default) means one per core, but no
+//  more than DEFAULT_MAX_PIPELINE_VALIDATION_THREADS.
+static uint32_t pipelineValidationThreads = 0;
+static const uint32_t DEFAULT_MAX_PIPELINE_VALIDATION_THREADS = 4;
+// Starting a thread costs about as much as validating a few pipelines, so each extra
+//  thread only joins in for this many pipelines of the batch
+static const uint32_t PIPELINES_PER_VALIDATION_THREAD = 16;
+// From lunarg_draw_state.deferred_submit_validation. When set, vkQueueSubmit only does
+//  the bookkeeping later calls depend on and forwards the submit; the command buffer
+//  checks run afterwards on a per-device thread and can no longer block the submit.
+static bool deferredSubmitValidation = false;
+// Bytes of SPIR-V whose analysis the shader module cache keeps, from
+//  lunarg_draw_state.shader_module_cache_size. 0 turns the cache off.
+static size_t shaderModuleCacheLimit = 16 * 1024 * 1024;
 #define MAX_TID 513
 static loader_platform_thread_id g_tidMapping[MAX_TID] = {0};
 static uint32_t g_maxTID = 0;
@@ -242,7 +345,7 @@ static uint32_t getTIDIndex() {
 }
 
 // Return a string representation of CMD_TYPE enum
-static string cmdTypeToString(CMD_TYPE cmd)
+static const char* cmdTypeToString(CMD_TYPE cmd)
 {
     switch (cmd)
     {
@@ -346,9 +449,26 @@ static string cmdTypeToString(CMD_TYPE cmd)
 }
 
 // SPIRV utility functions
+static void
+set_def(shader_module *module, unsigned id, unsigned offset)
+{
+    /* ids at or past the bound are invalid SPIR-V; leave them undefined */
+    if (id >= module->words[3]) {
+        return;
+    }
+    if (id >= module->def_index.size()) {
+        module->def_index.resize(id + 1);
+    }
+    module->def_index[id] = offset;
+}
+
 static void
 build_def_index(shader_module *module)
 {
+    /* words[3] is the id bound. Don't trust it further than the module size for the initial
+     * allocation, since every def takes at least two words. */
+    module->def_index.resize(std::min<size_t>(module->words[3], module->words.size()));
+
     for (auto insn : *module) {
         switch (insn.opcode()) {
         /* Types */
@@ -372,7 +492,7 @@ build_def_index(shader_module *module)
         case spv::OpTypeReserveId:
         case spv::OpTypeQueue:
         case spv::OpTypePipe:
-            module->def_index[insn.word(1)] = insn.offset();
+            set_def(module, insn.word(1), insn.offset());
             break;
 
         /* Fixed constants */
@@ -382,7 +502,7 @@ build_def_index(shader_module *module)
         case spv::OpConstantComposite:
         case spv::OpConstantSampler:
         case spv::OpConstantNull:
-            module->def_index[insn.word(2)] = insn.offset();
+            set_def(module, insn.word(2), insn.offset());
             break;
 
         /* Specialization constants */
@@ -391,17 +511,22 @@ build_def_index(shader_module *module)
         case spv::OpSpecConstant:
         case spv::OpSpecConstantComposite:
         case spv::OpSpecConstantOp:
-            module->def_index[insn.word(2)] = insn.offset();
+            set_def(module, insn.word(2), insn.offset());
             break;
 
         /* Variables */
         case spv::OpVariable:
-            module->def_index[insn.word(2)] = insn.offset();
+            set_def(module, insn.word(2), insn.offset());
             break;
 
         /* Functions */
         case spv::OpFunction:
-            module->def_index[insn.word(2)] = insn.offset();
+            set_def(module, insn.word(2), insn.offset());
+            break;
+
+        /* Entrypoints aren't defs, but find_entrypoint wants them without another walk */
+        case spv::OpEntryPoint:
+            module->entrypoint_offsets.push_back(insn.offset());
             break;
 
         default:
@@ -413,16 +538,15 @@ build_def_index(shader_module *module)
 
 
 static spirv_inst_iter
-find_entrypoint(shader_module *src, char const *name, VkShaderStageFlagBits stageBits)
+find_entrypoint(shader_module const *src, char const *name, VkShaderStageFlagBits stageBits)
 {
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpEntryPoint) {
-            auto entrypointName = (char const *) &insn.word(3);
-            auto entrypointStageBits = 1u << insn.word(1);
+    for (auto offset : src->entrypoint_offsets) {
+        auto insn = src->at(offset);
+        auto entrypointName = (char const *) &insn.word(3);
+        auto entrypointStageBits = 1u << insn.word(1);
 
-            if (!strcmp(entrypointName, name) && (entrypointStageBits & stageBits)) {
-                return insn;
-            }
+        if (!strcmp(entrypointName, name) && (entrypointStageBits & stageBits)) {
+            return insn;
         }
     }
 
@@ -593,14 +717,50 @@ types_match(shader_module const *a, shader_module const *b, unsigned a_type, uns
     }
 }
 
-static int
-value_or_default(std::unordered_map<unsigned, unsigned> const &map, unsigned id, int def)
+/* Gather the OpDecorate decorations of every id in one walk, the first time a module is
+ * used by a pipeline. The collectors below then look decorations up by id.
+ * Called with the module's analysis_lock held.
+ */
+static vector<id_decorations> const &
+get_decorations(shader_module const *src)
 {
-    auto it = map.find(id);
-    if (it == map.end())
-        return def;
-    else
-        return it->second;
+    auto &decorations = src->decorations;
+    if (!decorations.empty() || src->def_index.empty()) {
+        return decorations;
+    }
+
+    decorations.resize(src->def_index.size());
+    for (auto insn : *src) {
+        if (insn.opcode() == spv::OpDecorate) {
+            unsigned id = insn.word(1);
+            if (id >= src->words[3]) {
+                continue;
+            }
+            if (id >= decorations.size()) {
+                decorations.resize(id + 1);
+            }
+            auto &d = decorations[id];
+
+            /* TODO: handle grouped decorations */
+            switch (insn.word(2)) {
+            case spv::DecorationLocation: d.location = insn.word(3); break;
+            case spv::DecorationBuiltIn: d.builtin = insn.word(3); break;
+            case spv::DecorationComponent: d.component = insn.word(3); break;
+            case spv::DecorationDescriptorSet: d.set = insn.word(3); break;
+            case spv::DecorationBinding: d.binding = insn.word(3); break;
+            case spv::DecorationBlock: d.block = true; break;
+            default: break;
+            }
+        }
+    }
+    return decorations;
+}
+
+static id_decorations const &
+decorations_of(vector<id_decorations> const &decorations, unsigned id)
+{
+    static const id_decorations none;
+    return id < decorations.size() ? decorations[id] : none;
 }
 
 
@@ -635,23 +795,10 @@ get_locations_consumed_by_type(shader_module const *src, unsigned type, bool str
 }
 
 
-typedef std::pair<unsigned, unsigned> location_t;
-typedef std::pair<unsigned, unsigned> descriptor_slot_t;
-
-
-struct interface_var {
-    uint32_t id;
-    uint32_t type_id;
-    uint32_t offset;
-    /* TODO: collect the name, too? Isn't required to be present. */
-};
-
-
 static void
-collect_interface_block_members(layer_data *my_data, VkDevice dev,
-                                shader_module const *src,
+collect_interface_block_members(shader_module const *src,
                                 std::map<location_t, interface_var> &out,
-                                std::unordered_map<unsigned, unsigned> const &blocks,
+                                vector<id_decorations> const &decorations,
                                 bool is_array_of_verts,
                                 uint32_t id,
                                 uint32_t type_id)
@@ -669,7 +816,7 @@ collect_interface_block_members(layer_data *my_data, VkDevice dev,
             is_array_of_verts = false;
         }
         else if (type.opcode() == spv::OpTypeStruct) {
-            if (blocks.find(type.word(1)) == blocks.end()) {
+            if (!decorations_of(decorations, type.word(1)).block) {
                 /* This isn't an interface block. */
                 return;
             }
@@ -684,16 +831,16 @@ collect_interface_block_members(layer_data *my_data, VkDevice dev,
         }
     }
 
-    std::unordered_map<unsigned, unsigned> member_components;
+    /* one entry per member of the struct, 0 if the member has no Component decoration */
+    std::vector<unsigned> member_components(type.len() - 2);
 
     /* Walk all the OpMemberDecorate for type's result id -- first pass, collect components. */
     for (auto insn : *src) {
         if (insn.opcode() == spv::OpMemberDecorate && insn.word(1) == type.word(1)) {
             unsigned member_index = insn.word(2);
 
-            if (insn.word(3) == spv::DecorationComponent) {
-                unsigned component = insn.word(4);
-                member_components[member_index] = component;
+            if (insn.word(3) == spv::DecorationComponent && member_index < member_components.size()) {
+                member_components[member_index] = insn.word(4);
             }
         }
     }
@@ -707,8 +854,7 @@ collect_interface_block_members(layer_data *my_data, VkDevice dev,
             if (insn.word(3) == spv::DecorationLocation) {
                 unsigned location = insn.word(4);
                 unsigned num_locations = get_locations_consumed_by_type(src, member_type_id, false);
-                auto component_it = member_components.find(member_index);
-                unsigned component = component_it == member_components.end() ? 0 : component_it->second;
+                unsigned component = member_index < member_components.size() ? member_components[member_index] : 0;
 
                 for (unsigned int offset = 0; offset < num_locations; offset++) {
                     interface_var v;
@@ -724,43 +870,17 @@ collect_interface_block_members(layer_data *my_data, VkDevice dev,
 }
 
 static void
-collect_interface_by_location(layer_data *my_data, VkDevice dev,
-                              shader_module const *src,
+collect_interface_by_location(shader_module const *src,
                               spirv_inst_iter entrypoint,
                               spv::StorageClass sinterface,
                               std::map<location_t, interface_var> &out,
                               bool is_array_of_verts)
 {
-    std::unordered_map<unsigned, unsigned> var_locations;
-    std::unordered_map<unsigned, unsigned> var_builtins;
-    std::unordered_map<unsigned, unsigned> var_components;
-    std::unordered_map<unsigned, unsigned> blocks;
-
-    for (auto insn : *src) {
-
-        /* We consider two interface models: SSO rendezvous-by-location, and
-         * builtins. Complain about anything that fits neither model.
-         */
-        if (insn.opcode() == spv::OpDecorate) {
-            if (insn.word(2) == spv::DecorationLocation) {
-                var_locations[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationBuiltIn) {
-                var_builtins[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationComponent) {
-                var_components[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationBlock) {
-                blocks[insn.word(1)] = 1;
-            }
-        }
-    }
+    /* We consider two interface models: SSO rendezvous-by-location, and
+     * builtins. Complain about anything that fits neither model.
+     */
+    auto const &decorations = get_decorations(src);
 
-        /* TODO: handle grouped decorations */
         /* TODO: handle index=1 dual source outputs from FS -- two vars will
          * have the same location, and we DONT want to clobber. */
 
@@ -782,9 +902,10 @@ collect_interface_by_location(layer_data *my_data, VkDevice dev,
             unsigned id = insn.word(2);
             unsigned type = insn.word(1);
 
-            int location = value_or_default(var_locations, id, -1);
-            int builtin = value_or_default(var_builtins, id, -1);
-            unsigned component = value_or_default(var_components, id, 0);    /* unspecified is OK, is 0 */
+            auto const &d = decorations_of(decorations, id);
+            int location = d.location;
+            int builtin = d.builtin;
+            unsigned component = d.component;    /* unspecified is OK, is 0 */
 
             /* All variables and interface block members in the Input or Output storage classes
              * must be decorated with either a builtin or an explicit location.
@@ -809,37 +930,40 @@ collect_interface_by_location(layer_data *my_data, VkDevice dev,
             }
             else if (builtin == -1) {
                 /* An interface block instance */
-                collect_interface_block_members(my_data, dev, src, out,
-                                                blocks, is_array_of_verts, id, type);
+                collect_interface_block_members(src, out, decorations, is_array_of_verts, id, type);
             }
         }
     }
 }
 
-static void
-collect_interface_by_descriptor_slot(layer_data *my_data, VkDevice dev,
-                              shader_module const *src, spv::StorageClass sinterface,
-                              std::unordered_set<uint32_t> const &accessible_ids,
-                              std::map<descriptor_slot_t, interface_var> &out)
+/* Interfaces by location are cached on the module, so only the first pipeline to use an
+ * entrypoint pays for the walk.
+ */
+static std::map<location_t, interface_var> const &
+get_interface_by_location(shader_module const *src, spirv_inst_iter entrypoint,
+                          spv::StorageClass sinterface, bool is_array_of_verts)
 {
+    std::lock_guard<std::mutex> lock(src->analysis_lock);
+    auto &info = src->entrypoint_cache[entrypoint.offset()];
+    unsigned index = (sinterface == spv::StorageClassOutput ? 1 : 0) | (is_array_of_verts ? 2 : 0);
 
-    std::unordered_map<unsigned, unsigned> var_sets;
-    std::unordered_map<unsigned, unsigned> var_bindings;
-
-    for (auto insn : *src) {
-        /* All variables in the Uniform or UniformConstant storage classes are required to be decorated with both
-         * DecorationDescriptorSet and DecorationBinding.
-         */
-        if (insn.opcode() == spv::OpDecorate) {
-            if (insn.word(2) == spv::DecorationDescriptorSet) {
-                var_sets[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationBinding) {
-                var_bindings[insn.word(1)] = insn.word(3);
-            }
-        }
+    if (!info.interface_collected[index]) {
+        collect_interface_by_location(src, entrypoint, sinterface, info.interfaces[index], is_array_of_verts);
+        info.interface_collected[index] = true;
     }
+    return info.interfaces[index];
+}
+
+static void
+collect_interface_by_descriptor_slot(shader_module const *src,
+                              std::unordered_set<uint32_t> const &accessible_ids,
+                              std::map<descriptor_slot_t, interface_var> &out,
+                              std::vector<descriptor_conflict> &conflicts)
+{
+    /* All variables in the Uniform or UniformConstant storage classes are required to be decorated with both
+     * DecorationDescriptorSet and DecorationBinding.
+     */
+    auto const &decorations = get_decorations(src);
 
     for (auto id : accessible_ids) {
         auto insn = src->get_def(id);
@@ -848,17 +972,19 @@ collect_interface_by_descriptor_slot(layer_data *my_data, VkDevice dev,
         if (insn.opcode() == spv::OpVariable &&
                 (insn.word(3) == spv::StorageClassUniform ||
                  insn.word(3) == spv::StorageClassUniformConstant)) {
-            unsigned set = value_or_default(var_sets, insn.word(2), 0);
-            unsigned binding = value_or_default(var_bindings, insn.word(2), 0);
+            auto const &d = decorations_of(decorations, insn.word(2));
+            unsigned set = d.set;
+            unsigned binding = d.binding;
 
             auto existing_it = out.find(std::make_pair(set, binding));
             if (existing_it != out.end()) {
-                /* conflict within spv image */
-                log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT, /*dev*/0, __LINE__,
-                        SHADER_CHECKER_INCONSISTENT_SPIRV, "SC",
-                        "var %d (type %d) in %s interface in descriptor slot (%u,%u) conflicts with existing definition",
-                        insn.word(2), insn.word(1), storage_class_name(sinterface),
-                        existing_it->first.first, existing_it->first.second);
+                /* conflict within spv image. Recorded rather than reported, since the result
+                 * is shared by every device that creates this module. */
+                descriptor_conflict conflict;
+                conflict.slot = existing_it->first;
+                conflict.id = insn.word(2);
+                conflict.type_id = insn.word(1);
+                conflicts.push_back(conflict);
             }
 
             interface_var v;
@@ -875,14 +1001,11 @@ validate_interface_between_stages(layer_data *my_data, VkDevice dev,
                                   shader_module const *consumer, spirv_inst_iter consumer_entrypoint, char const *consumer_name,
                                   bool consumer_arrayed_input)
 {
-    std::map<location_t, interface_var> outputs;
-    std::map<location_t, interface_var> inputs;
+    auto const &outputs = get_interface_by_location(producer, producer_entrypoint, spv::StorageClassOutput, false);
+    auto const &inputs = get_interface_by_location(consumer, consumer_entrypoint, spv::StorageClassInput, consumer_arrayed_input);
 
     bool pass = true;
 
-    collect_interface_by_location(my_data, dev, producer, producer_entrypoint, spv::StorageClassOutput, outputs, false);
-    collect_interface_by_location(my_data, dev, consumer, consumer_entrypoint, spv::StorageClassInput, inputs, consumer_arrayed_input);
-
     auto a_it = outputs.begin();
     auto b_it = inputs.begin();
 
@@ -1036,11 +1159,9 @@ validate_vi_consistency(layer_data *my_data, VkDevice dev, VkPipelineVertexInput
 static bool
 validate_vi_against_vs_inputs(layer_data *my_data, VkDevice dev, VkPipelineVertexInputStateCreateInfo const *vi, shader_module const *vs, spirv_inst_iter entrypoint)
 {
-    std::map<location_t, interface_var> inputs;
+    auto const &inputs = get_interface_by_location(vs, entrypoint, spv::StorageClassInput, false);
     bool pass = true;
 
-    collect_interface_by_location(my_data, dev, vs, entrypoint, spv::StorageClassInput, inputs, false);
-
     /* Build index by location */
     std::map<uint32_t, VkVertexInputAttributeDescription const *> attribs;
     if (vi) {
@@ -1098,12 +1219,11 @@ static bool
 validate_fs_outputs_against_render_pass(layer_data *my_data, VkDevice dev, shader_module const *fs, spirv_inst_iter entrypoint, RENDER_PASS_NODE const *rp, uint32_t subpass)
 {
     const std::vector<VkFormat> &color_formats = rp->subpassColorFormats[subpass];
-    std::map<location_t, interface_var> outputs;
     bool pass = true;
 
     /* TODO: dual source blend index (spv::DecIndex, zero if not provided) */
 
-    collect_interface_by_location(my_data, dev, fs, entrypoint, spv::StorageClassOutput, outputs, false);
+    auto const &outputs = get_interface_by_location(fs, entrypoint, spv::StorageClassOutput, false);
 
     auto it = outputs.begin();
     uint32_t attachment = 0;
@@ -1164,13 +1284,13 @@ validate_fs_outputs_against_render_pass(layer_data *my_data, VkDevice dev, shade
 static void
 mark_accessible_ids(shader_module const *src, spirv_inst_iter entrypoint, std::unordered_set<uint32_t> &ids)
 {
-    std::unordered_set<uint32_t> worklist;
-    worklist.insert(entrypoint.word(2));
+    /* a plain stack; ids seen twice are dropped by the ids set below */
+    std::vector<uint32_t> worklist;
+    worklist.push_back(entrypoint.word(2));
 
     while (!worklist.empty()) {
-        auto id_iter = worklist.begin();
-        auto id = *id_iter;
-        worklist.erase(id_iter);
+        auto id = worklist.back();
+        worklist.pop_back();
 
         auto insn = src->get_def(id);
         if (insn == src->end()) {
@@ -1205,15 +1325,15 @@ mark_accessible_ids(shader_module const *src, spirv_inst_iter entrypoint, std::u
                 case spv::OpAtomicAnd:
                 case spv::OpAtomicOr:
                 case spv::OpAtomicXor:
-                    worklist.insert(insn.word(3));  /* ptr */
+                    worklist.push_back(insn.word(3));  /* ptr */
                     break;
                 case spv::OpStore:
                 case spv::OpAtomicStore:
-                    worklist.insert(insn.word(1));  /* ptr */
+                    worklist.push_back(insn.word(1));  /* ptr */
                     break;
                 case spv::OpAccessChain:
                 case spv::OpInBoundsAccessChain:
-                    worklist.insert(insn.word(3));  /* base ptr */
+                    worklist.push_back(insn.word(3));  /* base ptr */
                     break;
                 case spv::OpSampledImage:
                 case spv::OpImageSampleImplicitLod:
@@ -1248,20 +1368,20 @@ mark_accessible_ids(shader_module const *src, spirv_inst_iter entrypoint, std::u
                 case spv::OpImageSparseGather:
                 case spv::OpImageSparseDrefGather:
                 case spv::OpImageTexelPointer:
-                    worklist.insert(insn.word(3));  /* image or sampled image */
+                    worklist.push_back(insn.word(3));  /* image or sampled image */
                     break;
                 case spv::OpImageWrite:
-                    worklist.insert(insn.word(1));  /* image -- different operand order to above */
+                    worklist.push_back(insn.word(1));  /* image -- different operand order to above */
                     break;
                 case spv::OpFunctionCall:
                     for (auto i = 3; i < insn.len(); i++) {
-                        worklist.insert(insn.word(i));  /* fn itself, and all args */
+                        worklist.push_back(insn.word(i));  /* fn itself, and all args */
                     }
                     break;
 
                 case spv::OpExtInst:
                     for (auto i = 5; i < insn.len(); i++) {
-                        worklist.insert(insn.word(i));  /* operands to ext inst */
+                        worklist.push_back(insn.word(i));  /* operands to ext inst */
                     }
                     break;
                 }
@@ -1271,6 +1391,21 @@ mark_accessible_ids(shader_module const *src, spirv_inst_iter entrypoint, std::u
     }
 }
 
+/* Accessible ids and descriptor uses of an entrypoint, computed on first use and cached on the module */
+static entrypoint_info const &
+get_entrypoint_descriptor_uses(shader_module const *src, spirv_inst_iter entrypoint)
+{
+    std::lock_guard<std::mutex> lock(src->analysis_lock);
+    auto &info = src->entrypoint_cache[entrypoint.offset()];
+
+    if (!info.descriptors_collected) {
+        mark_accessible_ids(src, entrypoint, info.accessible_ids);
+        collect_interface_by_descriptor_slot(src, info.accessible_ids, info.descriptor_uses, info.descriptor_conflicts);
+        info.descriptors_collected = true;
+    }
+    return info;
+}
+
 
 struct shader_stage_attributes {
     char const * const name;
@@ -1300,8 +1435,11 @@ has_descriptor_binding(layer_data* my_data,
     if (slot.first >= pipelineLayout->size())
         return false;
 
-    const auto &bindingMap = my_data->descriptorSetLayoutMap[(*pipelineLayout)[slot.first]]
-                   ->bindingToIndexMap;
+    auto layout_it = my_data->descriptorSetLayoutMap.find((*pipelineLayout)[slot.first]);
+    if (layout_it == my_data->descriptorSetLayoutMap.end())
+        return false;
+
+    const auto &bindingMap = layout_it->second->bindingToIndexMap;
 
     return (bindingMap.find(slot.second) != bindingMap.end());
 }
@@ -1314,7 +1452,8 @@ static uint32_t get_shader_stage_id(VkShaderStageFlagBits stage)
 
 // Block of code at start here for managing/tracking Pipeline state that this layer cares about
 
-static uint64_t g_drawCount[NUM_DRAW_TYPES] = {0, 0, 0, 0};
+// Atomic as draws on different command buffers are recorded concurrently
+static std::atomic<uint64_t> g_drawCount[NUM_DRAW_TYPES];
 
 // TODO : Should be tracking lastBound per commandBuffer and when draws occur, report based on that cmd buffer lastBound
 //   Then need to synchronize the accesses based on cmd buffer so that if I'm reading state on one cmd buffer, updates
@@ -1351,10 +1490,11 @@ static VkBool32 validate_status(layer_data* my_data, GLOBAL_CB_NODE* pNode, CBSt
 // Retrieve pipeline node ptr for given pipeline object
 static PIPELINE_NODE* getPipeline(layer_data* my_data, const VkPipeline pipeline)
 {
-    if (my_data->pipelineMap.find(pipeline) == my_data->pipelineMap.end()) {
+    auto pipe_data = my_data->pipelineMap.find(pipeline);
+    if (pipe_data == my_data->pipelineMap.end()) {
         return NULL;
     }
-    return my_data->pipelineMap[pipeline];
+    return pipe_data->second;
 }
 
 // Return VK_TRUE if for a given PSO, the given state enum is dynamic, else return VK_FALSE
@@ -1476,19 +1616,31 @@ static bool verify_renderpass_compatibility(layer_data* my_data, const VkRenderP
 static bool verify_set_layout_compatibility(layer_data* my_data, const SET_NODE* pSet, const VkPipelineLayout layout, const uint32_t layoutIndex, string& errorMsg)
 {
     stringstream errorStr;
-    if (my_data->pipelineLayoutMap.find(layout) == my_data->pipelineLayoutMap.end()) {
+    if (!pSet) {
+        errorStr << "descriptor set no longer exists";
+        errorMsg = errorStr.str();
+        return false;
+    }
+    auto pipeline_layout = my_data->pipelineLayoutMap.find(layout);
+    if (pipeline_layout == my_data->pipelineLayoutMap.end()) {
         errorStr << "invalid VkPipelineLayout (" << layout << ")";
         errorMsg = errorStr.str();
         return false;
     }
-    PIPELINE_LAYOUT_NODE pl = my_data->pipelineLayoutMap[layout];
+    const PIPELINE_LAYOUT_NODE& pl = pipeline_layout->second;
     if (layoutIndex >= pl.descriptorSetLayouts.size()) {
         errorStr << "VkPipelineLayout (" << layout << ") only contains " << pl.descriptorSetLayouts.size() << " setLayouts corresponding to sets 0-" << pl.descriptorSetLayouts.size()-1 << ", but you're attempting to bind set to index " << layoutIndex;
         errorMsg = errorStr.str();
         return false;
     }
     // Get the specific setLayout from PipelineLayout that overlaps this set
-    LAYOUT_NODE* pLayoutNode = my_data->descriptorSetLayoutMap[pl.descriptorSetLayouts[layoutIndex]];
+    auto set_layout = my_data->descriptorSetLayoutMap.find(pl.descriptorSetLayouts[layoutIndex]);
+    if (set_layout == my_data->descriptorSetLayoutMap.end()) {
+        errorStr << "invalid VkDescriptorSetLayout (" << pl.descriptorSetLayouts[layoutIndex] << ") at index " << layoutIndex << " of VkPipelineLayout (" << layout << ")";
+        errorMsg = errorStr.str();
+        return false;
+    }
+    LAYOUT_NODE* pLayoutNode = set_layout->second;
     if (pLayoutNode->layout == pSet->pLayout->layout) { // trivial pass case
         return true;
     }
@@ -1580,11 +1732,16 @@ validate_pipeline_shaders(layer_data *my_data, VkDevice dev, PIPELINE_NODE* pPip
                 }
             }
             else {
-                pass = validate_specialization_offsets(my_data, pStage) && pass;
+                if (!checkDisabled(SHADER_CHECKER_BAD_SPECIALIZATION))
+                    pass = validate_specialization_offsets(my_data, pStage) && pass;
 
                 auto stage_id = get_shader_stage_id(pStage->stage);
-                shader_module *module = my_data->shaderModuleMap[pStage->module];
-                shaders[stage_id] = module;
+                // Pipelines of a batch are validated in parallel, so only use find() on shared maps here
+                auto module_it = my_data->shaderModuleMap.find(pStage->module);
+                if (module_it == my_data->shaderModuleMap.end()) {
+                    continue;
+                }
+                shader_module *module = module_it->second.get();
 
                 /* find the entrypoint */
                 entrypoints[stage_id] = find_entrypoint(module, pStage->pName, pStage->stage);
@@ -1593,20 +1750,25 @@ validate_pipeline_shaders(layer_data *my_data, VkDevice dev, PIPELINE_NODE* pPip
                         "No entrypoint found named `%s` for stages %u", pStage->pName, pStage->stage)) {
                         pass = VK_FALSE;
                     }
+                    continue;
                 }
-
-                /* mark accessible ids */
-                std::unordered_set<uint32_t> accessible_ids;
-                mark_accessible_ids(module, entrypoints[stage_id], accessible_ids);
+                shaders[stage_id] = module;
 
                 /* validate descriptor set layout against what the entrypoint actually uses */
-                std::map<descriptor_slot_t, interface_var> descriptor_uses;
-                collect_interface_by_descriptor_slot(my_data, dev, module, spv::StorageClassUniform,
-                        accessible_ids,
-                        descriptor_uses);
+                auto const &info = get_entrypoint_descriptor_uses(module, entrypoints[stage_id]);
+                auto const &descriptor_uses = info.descriptor_uses;
+
+                for (auto const &conflict : info.descriptor_conflicts) {
+                    log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT, /*dev*/0, __LINE__,
+                            SHADER_CHECKER_INCONSISTENT_SPIRV, "SC",
+                            "var %d (type %d) in %s interface in descriptor slot (%u,%u) conflicts with existing definition",
+                            conflict.id, conflict.type_id, storage_class_name(spv::StorageClassUniform),
+                            conflict.slot.first, conflict.slot.second);
+                }
 
-                auto layouts = pCreateInfo->layout != VK_NULL_HANDLE ?
-                    &(my_data->pipelineLayoutMap[pCreateInfo->layout].descriptorSetLayouts) : nullptr;
+                auto layout_it = my_data->pipelineLayoutMap.find(pCreateInfo->layout);
+                auto layouts = layout_it != my_data->pipelineLayoutMap.end() ?
+                    &(layout_it->second.descriptorSetLayouts) : nullptr;
 
                 for (auto it = descriptor_uses.begin(); it != descriptor_uses.end(); it++) {
                     // As a side-effect of this function, capture which sets are used by the pipeline
@@ -1630,15 +1792,22 @@ validate_pipeline_shaders(layer_data *my_data, VkDevice dev, PIPELINE_NODE* pPip
         }
     }
 
-    if (pCreateInfo->renderPass != VK_NULL_HANDLE)
-        rp = my_data->renderPassMap[pCreateInfo->renderPass];
+    auto rp_it = my_data->renderPassMap.find(pCreateInfo->renderPass);
+    if (rp_it != my_data->renderPassMap.end())
+        rp = rp_it->second;
 
     vi = pCreateInfo->pVertexInputState;
 
-    if (vi) {
+    if (vi && !checkDisabled(SHADER_CHECKER_INCONSISTENT_VI)) {
         pass = validate_vi_consistency(my_data, dev, vi) && pass;
     }
 
+    // Interface matching reports all three of these, so only skip it when they are all disabled
+    if (checkDisabled(SHADER_CHECKER_INTERFACE_TYPE_MISMATCH) && checkDisabled(SHADER_CHECKER_OUTPUT_NOT_CONSUMED) &&
+        checkDisabled(SHADER_CHECKER_INPUT_NOT_PRODUCED)) {
+        return pass;
+    }
+
     if (shaders[vertex_stage]) {
         pass = validate_vi_against_vs_inputs(my_data, dev, vi, shaders[vertex_stage], entrypoints[vertex_stage]) && pass;
     }
@@ -1677,10 +1846,11 @@ validate_pipeline_shaders(layer_data *my_data, VkDevice dev, PIPELINE_NODE* pPip
 // Return Set node ptr for specified set or else NULL
 static SET_NODE* getSetNode(layer_data* my_data, const VkDescriptorSet set)
 {
-    if (my_data->setMap.find(set) == my_data->setMap.end()) {
+    auto set_data = my_data->setMap.find(set);
+    if (set_data == my_data->setMap.end()) {
         return NULL;
     }
-    return my_data->setMap[set];
+    return set_data->second;
 }
 // For the given command buffer, verify that for each set set in activeSetNodes
 //  that any dynamic descriptor in that set has a valid dynamic offset bound.
@@ -1690,117 +1860,103 @@ static VkBool32 validate_dynamic_offsets(layer_data* my_data, const GLOBAL_CB_NO
 {
     VkBool32 result = VK_FALSE;
 
-    VkWriteDescriptorSet* pWDS = NULL;
     uint32_t dynOffsetIndex = 0;
     VkDeviceSize bufferSize = 0;
     for (auto set_node : activeSetNodes) {
         for (uint32_t i = 0; i < set_node->descriptorCount; ++i) {
             // TODO: Add validation for descriptors dynamically skipped in shader
-            if (set_node->ppDescriptors[i] != NULL) {
-                switch (set_node->ppDescriptors[i]->sType) {
-                case VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET:
-                    pWDS = (VkWriteDescriptorSet *)set_node->ppDescriptors[i];
-                    if ((pWDS->descriptorType ==
-                         VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) ||
-                        (pWDS->descriptorType ==
-                         VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)) {
-                        for (uint32_t j = 0; j < pWDS->descriptorCount; ++j) {
-                            bufferSize =
-                                my_data->bufferMap[pWDS->pBufferInfo[j].buffer]
-                                    .create_info->size;
-                            if (pWDS->pBufferInfo[j].range == VK_WHOLE_SIZE) {
-                                if ((pCB->dynamicOffsets[dynOffsetIndex] +
-                                     pWDS->pBufferInfo[j].offset) > bufferSize) {
-                                    result |= log_msg(
-                                        my_data->report_data,
-                                        VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                        VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
-                                        (uint64_t)set_node->set, __LINE__,
-                                        DRAWSTATE_DYNAMIC_OFFSET_OVERFLOW, "DS",
-                                        "VkDescriptorSet (%#" PRIxLEAST64
-                                        ") bound as set #%u has range of "
-                                        "VK_WHOLE_SIZE but dynamic offset %u "
-                                        "combined with offet %#" PRIxLEAST64
-                                        " oversteps its buffer (%#" PRIxLEAST64
-                                        ") which has a size of %#" PRIxLEAST64 ".",
-                                        (uint64_t)set_node->set, i,
-                                        pCB->dynamicOffsets[dynOffsetIndex],
-                                        pWDS->pBufferInfo[j].offset,
-                                        (uint64_t)pWDS->pBufferInfo[j].buffer,
-                                        bufferSize);
-                                }
-                            } else if ((pCB->dynamicOffsets[dynOffsetIndex] +
-                                        pWDS->pBufferInfo[j].offset +
-                                        pWDS->pBufferInfo[j].range) > bufferSize) {
-                                result |= log_msg(
-                                    my_data->report_data,
-                                    VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                    VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
-                                    (uint64_t)set_node->set, __LINE__,
-                                    DRAWSTATE_DYNAMIC_OFFSET_OVERFLOW, "DS",
-                                    "VkDescriptorSet (%#" PRIxLEAST64
-                                    ") bound as set #%u has dynamic offset %u. "
-                                    "Combined with offet %#" PRIxLEAST64
-                                    " and range %#" PRIxLEAST64
-                                    " from its update, this oversteps its buffer "
-                                    "(%#" PRIxLEAST64
-                                    ") which has a size of %#" PRIxLEAST64 ".",
-                                    (uint64_t)set_node->set, i,
-                                    pCB->dynamicOffsets[dynOffsetIndex],
-                                    pWDS->pBufferInfo[j].offset,
-                                    pWDS->pBufferInfo[j].range,
-                                    (uint64_t)pWDS->pBufferInfo[j].buffer,
-                                    bufferSize);
-                            } else if ((pCB->dynamicOffsets[dynOffsetIndex] +
-                                        pWDS->pBufferInfo[j].offset +
-                                        pWDS->pBufferInfo[j].range) >
-                                       bufferSize) {
-                              result |= log_msg(
-                                  my_data->report_data,
-                                  VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                  VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
-                                  (uint64_t)set_node->set, __LINE__,
-                                  DRAWSTATE_DYNAMIC_OFFSET_OVERFLOW, "DS",
-                                  "VkDescriptorSet (%#" PRIxLEAST64
-                                  ") bound as set #%u has dynamic offset %u. "
-                                  "Combined with offet %#" PRIxLEAST64
-                                  " and range %#" PRIxLEAST64
-                                  " from its update, this oversteps its buffer "
-                                  "(%#" PRIxLEAST64
-                                  ") which has a size of %#" PRIxLEAST64 ".",
-                                  (uint64_t)set_node->set, i,
-                                  pCB->dynamicOffsets[dynOffsetIndex],
-                                  pWDS->pBufferInfo[j].offset,
-                                  pWDS->pBufferInfo[j].range,
-                                  (uint64_t)pWDS->pBufferInfo[j].buffer,
-                                  bufferSize);
-                            }
-                            dynOffsetIndex++;
-                            i += j; // Advance i to end of this set of descriptors (++i at end of for loop will move 1 index past last of these descriptors)
-                        }
+            const DESCRIPTOR_NODE& descriptor = set_node->pDescriptors[i];
+            if (!descriptor.updated ||
+                ((descriptor.type != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) &&
+                 (descriptor.type != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)))
+                continue;
+            if (dynOffsetIndex >= pCB->dynamicOffsets.size())
+                return result;
+            auto buffer_data = my_data->bufferMap.find(descriptor.bufferInfo.buffer);
+            if (buffer_data != my_data->bufferMap.end()) {
+                bufferSize = buffer_data->second.create_info->size;
+                if (descriptor.bufferInfo.range == VK_WHOLE_SIZE) {
+                    if ((pCB->dynamicOffsets[dynOffsetIndex] +
+                         descriptor.bufferInfo.offset) > bufferSize) {
+                        result |= log_msg(
+                            my_data->report_data,
+                            VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                            VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
+                            (uint64_t)set_node->set, __LINE__,
+                            DRAWSTATE_DYNAMIC_OFFSET_OVERFLOW, "DS",
+                            "VkDescriptorSet (%#" PRIxLEAST64
+                            ") bound as set #%u has range of "
+                            "VK_WHOLE_SIZE but dynamic offset %u "
+                            "combined with offet %#" PRIxLEAST64
+                            " oversteps its buffer (%#" PRIxLEAST64
+                            ") which has a size of %#" PRIxLEAST64 ".",
+                            (uint64_t)set_node->set, i,
+                            pCB->dynamicOffsets[dynOffsetIndex],
+                            descriptor.bufferInfo.offset,
+                            (uint64_t)descriptor.bufferInfo.buffer,
+                            bufferSize);
                     }
-                    break;
-                default: // Currently only shadowing Write update nodes so shouldn't get here
-                    assert(0);
-                    continue;
+                } else if ((pCB->dynamicOffsets[dynOffsetIndex] +
+                            descriptor.bufferInfo.offset +
+                            descriptor.bufferInfo.range) > bufferSize) {
+                    result |= log_msg(
+                        my_data->report_data,
+                        VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                        VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
+                        (uint64_t)set_node->set, __LINE__,
+                        DRAWSTATE_DYNAMIC_OFFSET_OVERFLOW, "DS",
+                        "VkDescriptorSet (%#" PRIxLEAST64
+                        ") bound as set #%u has dynamic offset %u. "
+                        "Combined with offet %#" PRIxLEAST64
+                        " and range %#" PRIxLEAST64
+                        " from its update, this oversteps its buffer "
+                        "(%#" PRIxLEAST64
+                        ") which has a size of %#" PRIxLEAST64 ".",
+                        (uint64_t)set_node->set, i,
+                        pCB->dynamicOffsets[dynOffsetIndex],
+                        descriptor.bufferInfo.offset,
+                        descriptor.bufferInfo.range,
+                        (uint64_t)descriptor.bufferInfo.buffer,
+                        bufferSize);
                 }
             }
+            dynOffsetIndex++;
         }
     }
     return result;
 }
 
 // Validate overall state at the time of a draw call
+//  Only state rebound since the last draw that passed is re-checked, see CBDirtyFlagBits.
+//  A dirty bit stays set while its checks log anything, whether or not the callback asked
+//  to skip the draw, so every later draw keeps reporting the problem until it is fixed.
 static VkBool32 validate_draw_state(layer_data* my_data, GLOBAL_CB_NODE* pCB, VkBool32 indexedDraw) {
+    VkBool32 result = VK_FALSE;
+    CBDirtyFlags dirty = pCB->drawStateDirty;
+    CBDirtyFlags failed = CBDIRTY_NONE;
+    uint32_t msgCount;
+    // A new pipeline changes what every other check compares against
+    if (dirty & CBDIRTY_PIPELINE)
+        dirty = CBDIRTY_ALL;
     // First check flag states
-    VkBool32 result = validate_draw_state_flags(my_data, pCB, indexedDraw);
-    PIPELINE_NODE* pPipe = getPipeline(my_data, pCB->lastBoundPipeline);
+    if ((dirty & CBDIRTY_DYNAMIC_STATE) || (indexedDraw && !pCB->indexedDrawValidated)) {
+        msgCount = log_msg_count;
+        result |= validate_draw_state_flags(my_data, pCB, indexedDraw);
+        if (log_msg_count != msgCount) {
+            failed |= CBDIRTY_DYNAMIC_STATE;
+            pCB->indexedDrawValidated = VK_FALSE;
+        } else {
+            pCB->indexedDrawValidated = indexedDraw || (!(dirty & CBDIRTY_DYNAMIC_STATE) && pCB->indexedDrawValidated);
+        }
+    }
+    PIPELINE_NODE* pPipe = (dirty != CBDIRTY_NONE) ? getPipeline(my_data, pCB->lastBoundPipeline) : NULL;
     // Now complete other state checks
     // TODO : Currently only performing next check if *something* was bound (non-zero last bound)
     //  There is probably a better way to gate when this check happens, and to know if something *should* have been bound
     //  We should have that check separately and then gate this check based on that check
     if (pPipe) {
-        if (pCB->lastBoundPipelineLayout) {
+        if ((dirty & CBDIRTY_DESCRIPTOR_SETS) && pCB->lastBoundPipelineLayout) {
+            msgCount = log_msg_count;
             string errorString;
             // Need a vector (vs. std::set) of active Sets for dynamicOffset validation in case same set bound w/ different offsets
             vector<SET_NODE*> activeSetNodes;
@@ -1809,49 +1965,58 @@ static VkBool32 validate_draw_state(layer_data* my_data, GLOBAL_CB_NODE* pCB, Vk
                 if ((pCB->boundDescriptorSets.size() <= setIndex) || (!pCB->boundDescriptorSets[setIndex])) {
                     result |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_DESCRIPTOR_SET_NOT_BOUND, "DS",
                             "VkPipeline %#" PRIxLEAST64 " uses set #%u but that set is not bound.", (uint64_t)pPipe->pipeline, setIndex);
-                } else if (!verify_set_layout_compatibility(my_data, my_data->setMap[pCB->boundDescriptorSets[setIndex]], pPipe->graphicsPipelineCI.layout, setIndex, errorString)) {
+                } else if (!checkDisabled(DRAWSTATE_PIPELINE_LAYOUTS_INCOMPATIBLE) &&
+                           !verify_set_layout_compatibility(my_data, getSetNode(my_data, pCB->boundDescriptorSets[setIndex]), pPipe->graphicsPipelineCI.layout, setIndex, errorString)) {
                     // Set is bound but not compatible w/ overlapping pipelineLayout from PSO
-                    VkDescriptorSet setHandle = my_data->setMap[pCB->boundDescriptorSets[setIndex]]->set;
+                    VkDescriptorSet setHandle = pCB->boundDescriptorSets[setIndex];
                     result |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)setHandle, __LINE__, DRAWSTATE_PIPELINE_LAYOUTS_INCOMPATIBLE, "DS",
                         "VkDescriptorSet (%#" PRIxLEAST64 ") bound as set #%u is not compatible with overlapping VkPipelineLayout %#" PRIxLEAST64 " due to: %s",
                             (uint64_t)setHandle, setIndex, (uint64_t)pPipe->graphicsPipelineCI.layout, errorString.c_str());
                 } else { // Valid set is bound and layout compatible, validate that it's updated and verify any dynamic offsets
                     // Pull the set node
-                    SET_NODE* pSet = my_data->setMap[pCB->boundDescriptorSets[setIndex]];
+                    SET_NODE* pSet = getSetNode(my_data, pCB->boundDescriptorSets[setIndex]);
                     // Save vector of all active sets to verify dynamicOffsets below
                     activeSetNodes.push_back(pSet);
                     // Make sure set has been updated
-                    if (!pSet->pUpdateStructs) {
+                    if (!pSet->updated) {
                         result |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t) pSet->set, __LINE__, DRAWSTATE_DESCRIPTOR_SET_NOT_UPDATED, "DS",
                             "DS %#" PRIxLEAST64 " bound but it was never updated. It is now being used to draw so this will result in undefined behavior.", (uint64_t) pSet->set);
                     }
                 }
             }
             // For each dynamic descriptor, make sure dynamic offset doesn't overstep buffer
-            if (!pCB->dynamicOffsets.empty())
+            if (!pCB->dynamicOffsets.empty() && !checkDisabled(DRAWSTATE_DYNAMIC_OFFSET_OVERFLOW))
                 result |= validate_dynamic_offsets(my_data, pCB, activeSetNodes);
+            if (log_msg_count != msgCount)
+                failed |= CBDIRTY_DESCRIPTOR_SETS;
         }
         // Verify Vtx binding
-        if (pPipe->vtxBindingCount > 0) {
-            VkPipelineVertexInputStateCreateInfo *vtxInCI = &pPipe->vertexInputCI;
-            for (uint32_t i = 0; i < vtxInCI->vertexBindingDescriptionCount; i++) {
-                if ((pCB->currentDrawData.buffers.size() < (i+1)) || (pCB->currentDrawData.buffers[i] == VK_NULL_HANDLE)) {
-                    result |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_VTX_INDEX_OUT_OF_BOUNDS, "DS",
-                        "The Pipeline State Object (%#" PRIxLEAST64 ") expects that this Command Buffer's vertex binding Index %d should be set via vkCmdBindVertexBuffers.",
-                        (uint64_t)pCB->lastBoundPipeline, i);
+        if (dirty & CBDIRTY_VERTEX_BUFFERS) {
+            msgCount = log_msg_count;
+            if (pPipe->vtxBindingCount > 0) {
+                VkPipelineVertexInputStateCreateInfo *vtxInCI = &pPipe->vertexInputCI;
+                for (uint32_t i = 0; i < vtxInCI->vertexBindingDescriptionCount; i++) {
+                    if ((pCB->currentDrawData.buffers.size() < (i+1)) || (pCB->currentDrawData.buffers[i] == VK_NULL_HANDLE)) {
+                        result |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_VTX_INDEX_OUT_OF_BOUNDS, "DS",
+                            "The Pipeline State Object (%#" PRIxLEAST64 ") expects that this Command Buffer's vertex binding Index %d should be set via vkCmdBindVertexBuffers.",
+                            (uint64_t)pCB->lastBoundPipeline, i);
 
+                    }
+                }
+            } else {
+                if (!pCB->currentDrawData.buffers.empty()) {
+                    result |= log_msg(my_data->report_data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_VTX_INDEX_OUT_OF_BOUNDS,
+                        "DS", "Vertex buffers are bound to command buffer (%#" PRIxLEAST64 ") but no vertex buffers are attached to this Pipeline State Object (%#" PRIxLEAST64 ").",
+                        (uint64_t)pCB->commandBuffer, (uint64_t)pCB->lastBoundPipeline);
                 }
             }
-        } else {
-            if (!pCB->currentDrawData.buffers.empty()) {
-                result |= log_msg(my_data->report_data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_VTX_INDEX_OUT_OF_BOUNDS,
-                    "DS", "Vertex buffers are bound to command buffer (%#" PRIxLEAST64 ") but no vertex buffers are attached to this Pipeline State Object (%#" PRIxLEAST64 ").",
-                    (uint64_t)pCB->commandBuffer, (uint64_t)pCB->lastBoundPipeline);
-            }
+            if (log_msg_count != msgCount)
+                failed |= CBDIRTY_VERTEX_BUFFERS;
         }
         // If Viewport or scissors are dynamic, verify that dynamic count matches PSO count
-        VkBool32 dynViewport = isDynamic(pPipe, VK_DYNAMIC_STATE_VIEWPORT);
-        VkBool32 dynScissor = isDynamic(pPipe, VK_DYNAMIC_STATE_SCISSOR);
+        msgCount = log_msg_count;
+        VkBool32 dynViewport = (dirty & CBDIRTY_DYNAMIC_STATE) && isDynamic(pPipe, VK_DYNAMIC_STATE_VIEWPORT);
+        VkBool32 dynScissor = (dirty & CBDIRTY_DYNAMIC_STATE) && isDynamic(pPipe, VK_DYNAMIC_STATE_SCISSOR);
         if (dynViewport) {
             if (pCB->viewports.size() != pPipe->graphicsPipelineCI.pViewportState->viewportCount) {
                 result |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_VIEWPORT_SCISSOR_MISMATCH, "DS",
@@ -1864,7 +2029,13 @@ static VkBool32 validate_draw_state(layer_data* my_data, GLOBAL_CB_NODE* pCB, Vk
                     "Dynamic scissorCount from vkCmdSetScissor() is " PRINTF_SIZE_T_SPECIFIER ", but PSO scissorCount is %u. These counts must match.", pCB->scissors.size(), pPipe->graphicsPipelineCI.pViewportState->scissorCount);
             }
         }
+        if (log_msg_count != msgCount)
+            failed |= CBDIRTY_DYNAMIC_STATE;
     }
+    // Only the checks that came back clean are done with; everything stays dirty until
+    //  a pipeline is bound since the checks above need one
+    if (pPipe)
+        pCB->drawStateDirty = failed;
     return result;
 }
 
@@ -1941,6 +2112,50 @@ static VkBool32 verifyPipelineCreateState(layer_data* my_data, const VkDevice de
     return skipCall;
 }
 
+// Call validate(i) for each pipeline i of a batch and store whether pipeline i must be skipped
+//  in skip[i]. Large batches are spread over up to pipelineValidationThreads threads including
+//  the caller; validate must then only read shared layer state. Messages logged by the workers
+//  are captured and delivered afterwards, pipeline by pipeline, so a callback asking to skip
+//  still skips that pipeline, although it can no longer cut that pipeline's checks short.
+template <typename Validate>
+static void validatePipelineBatch(debug_report_data *report_data, uint32_t count, vector<VkBool32>& skip, Validate validate)
+{
+    uint32_t threadCount = pipelineValidationThreads;
+    if (!threadCount)
+        threadCount = std::min(std::thread::hardware_concurrency(), DEFAULT_MAX_PIPELINE_VALIDATION_THREADS);
+    threadCount = std::max(1u, std::min(threadCount, count / PIPELINES_PER_VALIDATION_THREAD));
+
+    if (threadCount == 1) {
+        // Report directly so each check sees the callbacks' answer, as without threading
+        for (uint32_t i = 0; i < count; i++) {
+            skip[i] = validate(i);
+        }
+        return;
+    }
+
+    vector<vector<debug_report_msg>> msgs(count);
+    std::atomic<uint32_t> next(0);
+    auto worker = [&]() {
+        for (uint32_t i = next++; i < count; i = next++) {
+            debug_report_capture = &msgs[i];
+            skip[i] = validate(i);
+            debug_report_capture = NULL;
+        }
+    };
+
+    vector<std::thread> threads;
+    for (uint32_t t = 1; t < threadCount; t++) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        skip[i] |= debug_report_replay_msgs(report_data, msgs[i]);
+    }
+}
+
 // Init the pipeline mapping info based on pipeline create info LL tree
 //  Threading note : Calls to this function should wrapped in mutex
 // TODO : this should really just be in the constructor for PIPELINE_NODE
@@ -2088,8 +2303,8 @@ static void deletePipelines(layer_data* my_data)
 // For given pipeline, return number of MSAA samples, or one if MSAA disabled
 static VkSampleCountFlagBits getNumSamples(layer_data* my_data, const VkPipeline pipeline)
 {
-    PIPELINE_NODE* pPipe = my_data->pipelineMap[pipeline];
-    if (VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO == pPipe->msStateCI.sType) {
+    PIPELINE_NODE* pPipe = getPipeline(my_data, pipeline);
+    if (pPipe && VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO == pPipe->msStateCI.sType) {
         return pPipe->msStateCI.rasterizationSamples;
     }
     return VK_SAMPLE_COUNT_1_BIT;
@@ -2102,7 +2317,12 @@ static VkBool32 validatePipelineState(layer_data* my_data, const GLOBAL_CB_NODE*
         // Verify that any MSAA request in PSO matches sample# in bound FB
         VkSampleCountFlagBits psoNumSamples = getNumSamples(my_data, pipeline);
         if (pCB->activeRenderPass) {
-            const VkRenderPassCreateInfo* pRPCI = my_data->renderPassMap[pCB->activeRenderPass]->pCreateInfo;
+            auto render_pass = my_data->renderPassMap.find(pCB->activeRenderPass);
+            if (render_pass == my_data->renderPassMap.end()) {
+                return log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_RENDER_PASS_EXT, (uint64_t) pCB->activeRenderPass, __LINE__, DRAWSTATE_INVALID_RENDERPASS, "DS",
+                        "Binding PSO (%#" PRIxLEAST64 ") within invalid RenderPass (%#" PRIxLEAST64 ").", (uint64_t) pipeline, (uint64_t) pCB->activeRenderPass);
+            }
+            const VkRenderPassCreateInfo* pRPCI = render_pass->second->pCreateInfo;
             const VkSubpassDescription* pSD = &pRPCI->pSubpasses[pCB->activeSubpass];
             VkSampleCountFlagBits subpassNumSamples = (VkSampleCountFlagBits) 0;
             uint32_t i;
@@ -2150,17 +2370,19 @@ static VkBool32 validatePipelineState(layer_data* my_data, const GLOBAL_CB_NODE*
 // Return Pool node ptr for specified pool or else NULL
 static DESCRIPTOR_POOL_NODE* getPoolNode(layer_data* my_data, const VkDescriptorPool pool)
 {
-    if (my_data->descriptorPoolMap.find(pool) == my_data->descriptorPoolMap.end()) {
+    auto pool_data = my_data->descriptorPoolMap.find(pool);
+    if (pool_data == my_data->descriptorPoolMap.end()) {
         return NULL;
     }
-    return my_data->descriptorPoolMap[pool];
+    return pool_data->second;
 }
 
 static LAYOUT_NODE* getLayoutNode(layer_data* my_data, const VkDescriptorSetLayout layout) {
-    if (my_data->descriptorSetLayoutMap.find(layout) == my_data->descriptorSetLayoutMap.end()) {
+    auto layout_data = my_data->descriptorSetLayoutMap.find(layout);
+    if (layout_data == my_data->descriptorSetLayoutMap.end()) {
         return NULL;
     }
-    return my_data->descriptorSetLayoutMap[layout];
+    return layout_data->second;
 }
 
 // Return VK_FALSE if update struct is of valid type, otherwise flag error and return code from callback
@@ -2270,68 +2492,39 @@ static VkBool32 validateUpdateConsistency(layer_data* my_data, const VkDevice de
     return skipCall;
 }
 
-// Determine the update type, allocate a new struct of that type, shadow the given pUpdate
-//   struct into the pNewNode param. Return VK_TRUE if error condition encountered and callback signals early exit.
+// Store the contents of a validated write update into the set's descriptors
+//  [startIndex, startIndex + pWDS->descriptorCount)
 // NOTE : Calls to this function should be wrapped in mutex
-static VkBool32 shadowUpdateNode(layer_data* my_data, const VkDevice device, GENERIC_HEADER* pUpdate, GENERIC_HEADER** pNewNode)
-{
-    VkBool32 skipCall = VK_FALSE;
-    VkWriteDescriptorSet* pWDS = NULL;
-    VkCopyDescriptorSet* pCDS = NULL;
-    switch (pUpdate->sType)
-    {
-        case VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET:
-            pWDS = new VkWriteDescriptorSet;
-            *pNewNode = (GENERIC_HEADER*)pWDS;
-            memcpy(pWDS, pUpdate, sizeof(VkWriteDescriptorSet));
-
-            switch (pWDS->descriptorType) {
-            case VK_DESCRIPTOR_TYPE_SAMPLER:
-            case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-                {
-                    VkDescriptorImageInfo *info = new VkDescriptorImageInfo[pWDS->descriptorCount];
-                    memcpy(info, pWDS->pImageInfo, pWDS->descriptorCount * sizeof(VkDescriptorImageInfo));
-                    pWDS->pImageInfo = info;
-                }
-                break;
-            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
-            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-                {
-                    VkBufferView *info = new VkBufferView[pWDS->descriptorCount];
-                    memcpy(info, pWDS->pTexelBufferView, pWDS->descriptorCount * sizeof(VkBufferView));
-                    pWDS->pTexelBufferView = info;
-                }
-                break;
-            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
-            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
-                {
-                    VkDescriptorBufferInfo *info = new VkDescriptorBufferInfo[pWDS->descriptorCount];
-                    memcpy(info, pWDS->pBufferInfo, pWDS->descriptorCount * sizeof(VkDescriptorBufferInfo));
-                    pWDS->pBufferInfo = info;
-                }
-                break;
-            default:
-                return VK_ERROR_VALIDATION_FAILED_EXT;
-                break;
-            }
+static void writeDescriptors(SET_NODE* pSet, uint32_t startIndex, const VkWriteDescriptorSet* pWDS)
+{
+    for (uint32_t j = 0; j < pWDS->descriptorCount; j++) {
+        assert(startIndex + j < pSet->descriptorCount);
+        DESCRIPTOR_NODE& descriptor = pSet->pDescriptors[startIndex + j];
+        descriptor.updated = VK_TRUE;
+        descriptor.type = pWDS->descriptorType;
+        switch (pWDS->descriptorType) {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+            descriptor.imageInfo = pWDS->pImageInfo[j];
             break;
-        case VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET:
-            pCDS = new VkCopyDescriptorSet;
-            *pNewNode = (GENERIC_HEADER*)pCDS;
-            memcpy(pCDS, pUpdate, sizeof(VkCopyDescriptorSet));
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+            descriptor.texelBufferView = pWDS->pTexelBufferView[j];
+            break;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+            descriptor.bufferInfo = pWDS->pBufferInfo[j];
             break;
         default:
-            if (log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_INVALID_UPDATE_STRUCT, "DS",
-                    "Unexpected UPDATE struct of type %s (value %u) in vkUpdateDescriptors() struct tree", string_VkStructureType(pUpdate->sType), pUpdate->sType))
-                return VK_TRUE;
+            break;
+        }
     }
-    // Make sure that pNext for the end of shadow copy is NULL
-    (*pNewNode)->pNext = NULL;
-    return skipCall;
+    pSet->updated = true;
 }
 
 // Verify that given sampler is valid
@@ -2353,152 +2546,86 @@ static VkBool32 validateSampler(const layer_data* my_data, const VkSampler* pSam
     return skipCall;
 }
 
-// Set the layout on the global level
-void SetLayout(layer_data *my_data, ImageSubresourcePair imgpair,
-               const VkImageLayout &layout) {
-    VkImage &image = imgpair.image;
-    // TODO (mlentine): Maybe set format if new? Not used atm.
-    my_data->imageLayoutMap[imgpair].layout = layout;
-    // TODO (mlentine): Maybe make vector a set?
-    auto subresource =
-        std::find(my_data->imageSubresourceMap[image].begin(),
-                  my_data->imageSubresourceMap[image].end(), imgpair);
-    if (subresource == my_data->imageSubresourceMap[image].end()) {
-        my_data->imageSubresourceMap[image].push_back(imgpair);
-    }
-}
-
+// Set the layout of a whole image on the global level
 void SetLayout(layer_data *my_data, VkImage image,
                const VkImageLayout &layout) {
-    ImageSubresourcePair imgpair = {image, false, VkImageSubresource()};
-    SetLayout(my_data, imgpair, layout);
+    my_data->imageLayoutMap[image].set_whole(layout);
 }
 
-void SetLayout(layer_data *my_data, VkImage image, VkImageSubresource range,
-               const VkImageLayout &layout) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    SetLayout(my_data, imgpair, layout);
-}
-
-// Set the layout on the cmdbuf level
-void SetLayout(GLOBAL_CB_NODE *pCB, VkImage image, ImageSubresourcePair imgpair,
-               const IMAGE_CMD_BUF_NODE &node) {
-    pCB->imageLayoutMap[imgpair] = node;
-    // TODO (mlentine): Maybe make vector a set?
-    auto subresource =
-        std::find(pCB->imageSubresourceMap[image].begin(),
-                  pCB->imageSubresourceMap[image].end(), imgpair);
-    if (subresource == pCB->imageSubresourceMap[image].end()) {
-        pCB->imageSubresourceMap[image].push_back(imgpair);
+// Number of mip levels and end of the array layers a subresource range covers,
+// with VK_REMAINING_* counts resolved against the image where it is known
+static void GetSubresourceRangeExtent(const layer_data *my_data, VkImage image,
+                                      const VkImageSubresourceRange &range,
+                                      uint32_t &levelCount, uint32_t &layerEnd) {
+    levelCount = range.levelCount;
+    uint32_t layerCount = range.layerCount;
+    auto imgIt = my_data->imageMap.find(image);
+    if (imgIt != my_data->imageMap.end()) {
+        const VkImageCreateInfo *pInfo = imgIt->second.get();
+        if (levelCount == VK_REMAINING_MIP_LEVELS)
+            levelCount = (pInfo->mipLevels > range.baseMipLevel) ? pInfo->mipLevels - range.baseMipLevel : 0;
+        if (layerCount == VK_REMAINING_ARRAY_LAYERS)
+            layerCount = (pInfo->arrayLayers > range.baseArrayLayer) ? pInfo->arrayLayers - range.baseArrayLayer : 0;
+    } else if (levelCount == VK_REMAINING_MIP_LEVELS) {
+        // Only swapchain images are untracked here, and they have a single level
+        levelCount = 1;
+    }
+    // An unresolved VK_REMAINING_ARRAY_LAYERS saturates to every layer
+    layerEnd = range.baseArrayLayer + std::min(layerCount, UINT32_MAX - range.baseArrayLayer);
+}
+
+// Apply fn(found, node) to each piece of the cmdbuf level layouts of image that
+// range covers; see subresource_range_map::update
+template <typename Fn>
+void UpdateLayouts(const layer_data *my_data, GLOBAL_CB_NODE *pCB, VkImage image,
+                   const VkImageSubresourceRange &range, Fn fn) {
+    uint32_t levelCount, layerEnd;
+    GetSubresourceRangeExtent(my_data, image, range, levelCount, layerEnd);
+    auto &layouts = pCB->imageLayoutMap[image];
+    for (uint32_t j = 0; j < levelCount; j++) {
+        layouts.update(range.aspectMask, range.baseMipLevel + j,
+                       range.baseArrayLayer, layerEnd, fn);
     }
 }
 
-void SetLayout(GLOBAL_CB_NODE *pCB, VkImage image, ImageSubresourcePair imgpair,
-               const VkImageLayout &layout) {
-    pCB->imageLayoutMap[imgpair].layout = layout;
-    // TODO (mlentine): Maybe make vector a set?
-    assert(std::find(pCB->imageSubresourceMap[image].begin(),
-                     pCB->imageSubresourceMap[image].end(),
-                     imgpair) != pCB->imageSubresourceMap[image].end());
-}
-
-void SetLayout(GLOBAL_CB_NODE *pCB, VkImage image,
-               const IMAGE_CMD_BUF_NODE &node) {
-    ImageSubresourcePair imgpair = {image, false, VkImageSubresource()};
-    SetLayout(pCB, image, imgpair, node);
-}
-
-void SetLayout(GLOBAL_CB_NODE *pCB, VkImage image, VkImageSubresource range,
-               const IMAGE_CMD_BUF_NODE &node) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    SetLayout(pCB, image, imgpair, node);
-}
-
-void SetLayout(GLOBAL_CB_NODE *pCB, VkImage image,
-               const VkImageLayout &layout) {
-    ImageSubresourcePair imgpair = {image, false, VkImageSubresource()};
-    SetLayout(pCB, image, imgpair, layout);
-}
-
-void SetLayout(GLOBAL_CB_NODE *pCB, VkImage image, VkImageSubresource range,
-               const VkImageLayout &layout) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    SetLayout(pCB, image, imgpair, layout);
-}
-
+// Set the layout on the cmdbuf level
 void SetLayout(const layer_data *dev_data, GLOBAL_CB_NODE *pCB,
                VkImageView imageView, const VkImageLayout &layout) {
     auto image_view_data = dev_data->imageViewMap.find(imageView);
     assert(image_view_data != dev_data->imageViewMap.end());
-    const VkImage &image = image_view_data->second->image;
-    const VkImageSubresourceRange &subRange =
-        image_view_data->second->subresourceRange;
-    // TODO: Do not iterate over every possibility - consolidate where possible
-    for (uint32_t j = 0; j < subRange.levelCount; j++) {
-        uint32_t level = subRange.baseMipLevel + j;
-        for (uint32_t k = 0; k < subRange.layerCount; k++) {
-            uint32_t layer = subRange.baseArrayLayer + k;
-            VkImageSubresource sub = {subRange.aspectMask, level, layer};
-            SetLayout(pCB, image, sub, layout);
-        }
-    }
-}
-
-// find layout(s) on the cmd buf level
-bool FindLayout(const GLOBAL_CB_NODE *pCB, VkImage image,
-                VkImageSubresource range, IMAGE_CMD_BUF_NODE &node) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    auto imgsubIt = pCB->imageLayoutMap.find(imgpair);
-    if (imgsubIt == pCB->imageLayoutMap.end()) {
-        imgpair = {image, false, VkImageSubresource()};
-        imgsubIt = pCB->imageLayoutMap.find(imgpair);
-        if (imgsubIt == pCB->imageLayoutMap.end())
-            return false;
-    }
-    node = imgsubIt->second;
-    return true;
+    UpdateLayouts(dev_data, pCB, image_view_data->second->image,
+                  image_view_data->second->subresourceRange,
+                  [&](bool, IMAGE_CMD_BUF_NODE &node) {
+                      node.layout = layout;
+                      return true;
+                  });
 }
 
 // find layout(s) on the global level
-bool FindLayout(const layer_data *my_data, ImageSubresourcePair imgpair,
-                VkImageLayout &layout) {
-    auto imgsubIt = my_data->imageLayoutMap.find(imgpair);
-    if (imgsubIt == my_data->imageLayoutMap.end()) {
-        imgpair = {imgpair.image, false, VkImageSubresource()};
-        imgsubIt = my_data->imageLayoutMap.find(imgpair);
-        if(imgsubIt == my_data->imageLayoutMap.end()) return false;
-    }
-    layout = imgsubIt->second.layout;
-    return true;
-}
-
-bool FindLayout(const layer_data *my_data, VkImage image,
-                VkImageSubresource range, VkImageLayout &layout) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    return FindLayout(my_data, imgpair, layout);
-}
-
 bool FindLayouts(const layer_data *my_data, VkImage image,
                  std::vector<VkImageLayout> &layouts) {
-    auto sub_data = my_data->imageSubresourceMap.find(image);
-    if (sub_data == my_data->imageSubresourceMap.end())
+    auto layout_data = my_data->imageLayoutMap.find(image);
+    if (layout_data == my_data->imageLayoutMap.end())
         return false;
     auto imgIt = my_data->imageMap.find(image);
     if (imgIt == my_data->imageMap.end())
         return false;
-    bool ignoreGlobal = false;
+    const subresource_range_map<VkImageLayout> &image_layouts = layout_data->second;
+    uint64_t covered = 0;
+    for (auto &level : image_layouts.levels) {
+        for (auto &run : level.runs) {
+            covered += run.end - run.begin;
+        }
+    }
     // TODO: Make this robust for >1 aspect mask. Now it will just say ignore
     // potential errors in this case.
-    if (sub_data->second.size() >=
-        (imgIt->second->arrayLayers * imgIt->second->mipLevels + 1)) {
-        ignoreGlobal = true;
+    bool ignoreGlobal = covered >= static_cast<uint64_t>(imgIt->second->arrayLayers) * imgIt->second->mipLevels;
+    if (image_layouts.hasWhole && !ignoreGlobal) {
+        layouts.push_back(image_layouts.whole);
     }
-    for (auto imgsubpair : sub_data->second) {
-        if (ignoreGlobal && !imgsubpair.hasSubresource)
-            continue;
-        auto img_data = my_data->imageLayoutMap.find(imgsubpair);
-        if (img_data != my_data->imageLayoutMap.end()) {
-            layouts.push_back(img_data->second.layout);
+    for (auto &level : image_layouts.levels) {
+        for (auto &run : level.runs) {
+            layouts.push_back(run.value);
         }
     }
     return true;
@@ -2609,6 +2736,8 @@ static VkBool32 validateUpdateContents(const layer_data* my_data, const VkWriteD
     // For given update type, verify that update contents are correct
     switch (pWDS->descriptorType) {
         case VK_DESCRIPTOR_TYPE_SAMPLER:
+            if (checkDisabled(DRAWSTATE_SAMPLER_DESCRIPTOR_ERROR))
+                break;
             for (i=0; i<pWDS->descriptorCount; ++i) {
                 skipCall |= validateSampler(my_data, &(pWDS->pImageInfo[i].sampler), immutable);
             }
@@ -2633,18 +2762,23 @@ static VkBool32 validateUpdateContents(const layer_data* my_data, const VkWriteD
                     immutable = VK_TRUE;
                     pSampler = &(pLayoutBinding->pImmutableSamplers[i]);
                 }
-                skipCall |= validateSampler(my_data, pSampler, immutable);
+                if (!checkDisabled(DRAWSTATE_SAMPLER_DESCRIPTOR_ERROR))
+                    skipCall |= validateSampler(my_data, pSampler, immutable);
             }
             // Intentionally fall through here to also validate image stuff
         case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
         case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
         case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+            if (checkDisabled(DRAWSTATE_IMAGEVIEW_DESCRIPTOR_ERROR))
+                break;
             for (i=0; i<pWDS->descriptorCount; ++i) {
                 skipCall |= validateImageView(my_data, &(pWDS->pImageInfo[i].imageView), pWDS->pImageInfo[i].imageLayout);
             }
             break;
         case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
         case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+            if (checkDisabled(DRAWSTATE_BUFFERVIEW_DESCRIPTOR_ERROR))
+                break;
             for (i=0; i<pWDS->descriptorCount; ++i) {
                 skipCall |= validateBufferView(my_data, &(pWDS->pTexelBufferView[i]));
             }
@@ -2653,6 +2787,8 @@ static VkBool32 validateUpdateContents(const layer_data* my_data, const VkWriteD
         case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
         case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
         case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+            if (checkDisabled(DRAWSTATE_BUFFERINFO_DESCRIPTOR_ERROR))
+                break;
             for (i=0; i<pWDS->descriptorCount; ++i) {
                 skipCall |= validateBufferInfo(my_data, &(pWDS->pBufferInfo[i]));
             }
@@ -2687,6 +2823,7 @@ static void invalidateBoundCmdBuffers(layer_data* dev_data, const SET_NODE* pSet
         auto cb_node = dev_data->commandBufferMap.find(cb);
         if (cb_node != dev_data->commandBufferMap.end()) {
             cb_node->second->state = CB_INVALID;
+            cb_node->second->drawStateDirty |= CBDIRTY_DESCRIPTOR_SETS;
         }
     }
 }
@@ -2701,10 +2838,13 @@ static VkBool32 dsUpdate(layer_data* my_data, VkDevice device, uint32_t descript
     uint32_t i = 0;
     for (i=0; i < descriptorWriteCount; i++) {
         VkDescriptorSet ds = pWDS[i].dstSet;
-        SET_NODE* pSet = my_data->setMap[ds];
         // Set being updated cannot be in-flight
         if ((skipCall = validateIdleDescriptorSet(my_data, ds, "VkUpdateDescriptorSets")) == VK_TRUE)
             return skipCall;
+        auto set_node = my_data->setMap.find(ds);
+        if (set_node == my_data->setMap.end())
+            continue;
+        SET_NODE* pSet = set_node->second;
         // If set is bound to any cmdBuffers, mark them invalid
         invalidateBoundCmdBuffers(my_data, pSet);
         GENERIC_HEADER* pUpdate = (GENERIC_HEADER*) &pWDS[i];
@@ -2752,22 +2892,7 @@ static VkBool32 dsUpdate(layer_data* my_data, VkDevice device, uint32_t descript
                              &pLayout->createInfo.pBindings[bindingToIndex->second])) ==
                         VK_FALSE) {
                         // Update is good. Save the update info
-                        // Create new update struct for this set's shadow copy
-                        GENERIC_HEADER* pNewNode = NULL;
-                        skipCall |= shadowUpdateNode(my_data, device, pUpdate, &pNewNode);
-                        if (NULL == pNewNode) {
-                            skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)(ds), __LINE__, DRAWSTATE_OUT_OF_MEMORY, "DS",
-                                    "Out of memory while attempting to allocate UPDATE struct in vkUpdateDescriptors()");
-                        } else {
-                            // Insert shadow node into LL of updates for this set
-                            pNewNode->pNext = pSet->pUpdateStructs;
-                            pSet->pUpdateStructs = pNewNode;
-                            // Now update appropriate descriptor(s) to point to new Update node
-                            for (uint32_t j = startIndex; j <= endIndex; j++) {
-                                assert(j<pSet->descriptorCount);
-                                pSet->ppDescriptors[j] = pNewNode;
-                            }
-                        }
+                        writeDescriptors(pSet, startIndex, &pWDS[i]);
                     }
                 }
             }
@@ -2779,11 +2904,19 @@ static VkBool32 dsUpdate(layer_data* my_data, VkDevice device, uint32_t descript
         LAYOUT_NODE *pSrcLayout = NULL, *pDstLayout = NULL;
         uint32_t srcStartIndex = 0, srcEndIndex = 0, dstStartIndex = 0, dstEndIndex = 0;
         // For each copy make sure that update falls within given layout and that types match
-        pSrcSet = my_data->setMap[pCDS[i].srcSet];
-        pDstSet = my_data->setMap[pCDS[i].dstSet];
         // Set being updated cannot be in-flight
-        if ((skipCall = validateIdleDescriptorSet(my_data, pDstSet->set, "VkUpdateDescriptorSets")) == VK_TRUE)
+        if ((skipCall = validateIdleDescriptorSet(my_data, pCDS[i].dstSet, "VkUpdateDescriptorSets")) == VK_TRUE)
             return skipCall;
+        auto src_node = my_data->setMap.find(pCDS[i].srcSet);
+        auto dst_node = my_data->setMap.find(pCDS[i].dstSet);
+        if (src_node == my_data->setMap.end()) {
+            skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)(pCDS[i].srcSet), __LINE__, DRAWSTATE_INVALID_SET, "DS",
+                                "Cannot copy from descriptor set %" PRIxLEAST64 " that has not been allocated.", (uint64_t)(pCDS[i].srcSet));
+        }
+        if (src_node == my_data->setMap.end() || dst_node == my_data->setMap.end())
+            continue;
+        pSrcSet = src_node->second;
+        pDstSet = dst_node->second;
         invalidateBoundCmdBuffers(my_data, pDstSet);
         pSrcLayout = pSrcSet->pLayout;
         pDstLayout = pDstSet->pLayout;
@@ -2836,10 +2969,9 @@ static VkBool32 dsUpdate(layer_data* my_data, VkDevice device, uint32_t descript
                             "Copy descriptor update index %u, update count #%u, has src update descriptor type %s that does not match overlapping dest descriptor type of %s!",
                             i, j+1, string_VkDescriptorType(pSrcLayout->descriptorTypes[srcStartIndex+j]), string_VkDescriptorType(pDstLayout->descriptorTypes[dstStartIndex+j]));
                     } else {
-                        // point dst descriptor at corresponding src descriptor
-                        // TODO : This may be a hole. I believe copy should be its own copy,
-                        //  otherwise a subsequent write update to src will incorrectly affect the copy
-                        pDstSet->ppDescriptors[j+dstStartIndex] = pSrcSet->ppDescriptors[j+srcStartIndex];
+                        // Copy by value so later writes to src don't show through the copy
+                        pDstSet->pDescriptors[j+dstStartIndex] = pSrcSet->pDescriptors[j+srcStartIndex];
+                        pDstSet->updated = true;
                     }
                 }
             }
@@ -2876,60 +3008,6 @@ static VkBool32 validate_descriptor_availability_in_pool(layer_data* dev_data, D
     return skipCall;
 }
 
-// Free the shadowed update node for this Set
-// NOTE : Calls to this function should be wrapped in mutex
-static void freeShadowUpdateTree(SET_NODE* pSet)
-{
-    GENERIC_HEADER* pShadowUpdate = pSet->pUpdateStructs;
-    pSet->pUpdateStructs = NULL;
-    GENERIC_HEADER* pFreeUpdate = pShadowUpdate;
-    // Clear the descriptor mappings as they will now be invalid
-    memset(pSet->ppDescriptors, 0, pSet->descriptorCount*sizeof(GENERIC_HEADER*));
-    while(pShadowUpdate) {
-        pFreeUpdate = pShadowUpdate;
-        pShadowUpdate = (GENERIC_HEADER*)pShadowUpdate->pNext;
-        VkWriteDescriptorSet * pWDS = NULL;
-        switch (pFreeUpdate->sType)
-        {
-            case VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET:
-                pWDS = (VkWriteDescriptorSet*)pFreeUpdate;
-                switch (pWDS->descriptorType) {
-                case VK_DESCRIPTOR_TYPE_SAMPLER:
-                case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-                case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-                case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-                    {
-                        delete[] pWDS->pImageInfo;
-                    }
-                    break;
-                case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
-                case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-                    {
-                        delete[] pWDS->pTexelBufferView;
-                    }
-                    break;
-                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
-                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
-                    {
-                        delete[] pWDS->pBufferInfo;
-                    }
-                    break;
-                default:
-                    break;
-                }
-                break;
-            case VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET:
-                break;
-            default:
-                assert(0);
-                break;
-        }
-        delete pFreeUpdate;
-    }
-}
-
 // Free all DS Pools including their Sets & related sub-structs
 // NOTE : Calls to this function should be wrapped in mutex
 static void deletePools(layer_data* my_data)
@@ -2943,9 +3021,7 @@ static void deletePools(layer_data* my_data)
             pFreeSet = pSet;
             pSet = pSet->pNext;
             // Freeing layouts handled in deleteLayouts() function
-            // Free Update shadow struct tree
-            freeShadowUpdateTree(pFreeSet);
-            delete[] pFreeSet->ppDescriptors;
+            // Descriptors go away with the pool's descriptorStorage
             delete pFreeSet;
         }
         delete (*ii).second;
@@ -2972,16 +3048,24 @@ static void deleteLayouts(layer_data* my_data)
     my_data->descriptorSetLayoutMap.clear();
 }
 
-// Currently clearing a set is removing all previous updates to that set
-//  TODO : Validate if this is correct clearing behavior
-static void clearDescriptorSet(layer_data* my_data, VkDescriptorSet set)
+// Remove a freed set from its pool and the setMap, giving its descriptors back to the pool
+// NOTE : Calls to this function should be wrapped in mutex
+static void freeDescriptorSet(layer_data* my_data, DESCRIPTOR_POOL_NODE* pPool, SET_NODE* pSet)
 {
-    SET_NODE* pSet = getSetNode(my_data, set);
-    if (!pSet) {
-        // TODO : Return error
+    invalidateBoundCmdBuffers(my_data, pSet);
+    if (pSet->pPrev) {
+        pSet->pPrev->pNext = pSet->pNext;
     } else {
-        freeShadowUpdateTree(pSet);
+        pPool->pSets = pSet->pNext;
+    }
+    if (pSet->pNext) {
+        pSet->pNext->pPrev = pSet->pPrev;
+    }
+    if (pSet->pDescriptors) {
+        pPool->descriptorStorage.release(pSet->pDescriptors, pSet->descriptorCount);
     }
+    my_data->setMap.erase(pSet->set);
+    delete pSet;
 }
 
 static void clearDescriptorPool(layer_data* my_data, const VkDevice device, const VkDescriptorPool pool, VkDescriptorPoolResetFlags flags)
@@ -2992,12 +3076,17 @@ static void clearDescriptorPool(layer_data* my_data, const VkDevice device, cons
                 "Unable to find pool node for pool %#" PRIxLEAST64 " specified in vkResetDescriptorPool() call", (uint64_t) pool);
     } else {
         // TODO: validate flags
-        // For every set off of this pool, clear it
+        // Resetting the pool frees all of its sets, so drop their nodes and rewind the arena
         SET_NODE* pSet = pPool->pSets;
         while (pSet) {
-            clearDescriptorSet(my_data, pSet->set);
+            SET_NODE* pFreeSet = pSet;
             pSet = pSet->pNext;
+            invalidateBoundCmdBuffers(my_data, pFreeSet);
+            my_data->setMap.erase(pFreeSet->set);
+            delete pFreeSet;
         }
+        pPool->pSets = NULL;
+        pPool->descriptorStorage.reset();
         // Reset available count to max count for this pool
         for (uint32_t i=0; i<pPool->availableDescriptorTypeCount.size(); ++i) {
             pPool->availableDescriptorTypeCount[i] = pPool->maxDescriptorTypeCount[i];
@@ -3008,26 +3097,50 @@ static void clearDescriptorPool(layer_data* my_data, const VkDevice device, cons
 // For given CB object, fetch associated CB Node from map
 static GLOBAL_CB_NODE* getCBNode(layer_data* my_data, const VkCommandBuffer cb)
 {
-    if (my_data->commandBufferMap.count(cb) == 0) {
+    auto cb_data = my_data->commandBufferMap.find(cb);
+    if (cb_data == my_data->commandBufferMap.end()) {
         // TODO : How to pass cb as srcObj here?
         log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0, __LINE__, DRAWSTATE_INVALID_COMMAND_BUFFER, "DS",
                 "Attempt to use CommandBuffer %#" PRIxLEAST64 " that doesn't exist!", (uint64_t)(cb));
         return NULL;
     }
-    return my_data->commandBufferMap[cb];
+    return cb_data->second;
+}
+
+// Lock for a vkCmd* recording call: globalLock shared, then the CB node's recordLock.
+//  Recording calls may only read device-level maps, write their own CB node, and
+//  touch shared nodes under that node's finer-grained lock.
+static GLOBAL_CB_NODE* lockCBForRecording(layer_data* my_data, const VkCommandBuffer cb)
+{
+    loader_platform_thread_read_lock_rwlock(&globalLock);
+    GLOBAL_CB_NODE* pCB = getCBNode(my_data, cb);
+    if (pCB)
+        pCB->recordLock.lock();
+    return pCB;
+}
+
+static void unlockCBForRecording(GLOBAL_CB_NODE* pCB)
+{
+    if (pCB)
+        pCB->recordLock.unlock();
+    loader_platform_thread_read_unlock_rwlock(&globalLock);
 }
 
 // Free all CB Nodes
 // NOTE : Calls to this function should be wrapped in mutex
 static void deleteCommandBuffers(layer_data* my_data)
 {
-    if (my_data->commandBufferMap.size() <= 0) {
-        return;
-    }
     for (auto ii=my_data->commandBufferMap.begin(); ii!=my_data->commandBufferMap.end(); ++ii) {
         delete (*ii).second;
     }
     my_data->commandBufferMap.clear();
+    for (auto ii=my_data->commandPoolMap.begin(); ii!=my_data->commandPoolMap.end(); ++ii) {
+        for (auto pCB : (*ii).second.freeNodes) {
+            delete pCB;
+        }
+        (*ii).second.freeNodes.clear();
+        (*ii).second.commandBuffers.clear();
+    }
 }
 
 static VkBool32 report_error_no_cb_begin(const layer_data* dev_data, const VkCommandBuffer cb, const char* caller_name)
@@ -3050,24 +3163,24 @@ VkBool32 validateCmdsInCmdBuffer(const layer_data* dev_data, const GLOBAL_CB_NOD
     return skip_call;
 }
 
-static bool checkGraphicsBit(const layer_data* my_data, VkQueueFlags flags, const char* name) {
+static bool checkGraphicsBit(const layer_data* my_data, VkQueueFlags flags, CMD_TYPE cmd) {
     if (!(flags & VK_QUEUE_GRAPHICS_BIT))
         return log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
-            DRAWSTATE_INVALID_COMMAND_BUFFER, "DS", "Cannot call %s on a command buffer allocated from a pool without graphics capabilities.", name);
+            DRAWSTATE_INVALID_COMMAND_BUFFER, "DS", "Cannot call %s on a command buffer allocated from a pool without graphics capabilities.", cmdTypeToString(cmd));
     return false;
 }
 
-static bool checkComputeBit(const layer_data* my_data, VkQueueFlags flags, const char* name) {
+static bool checkComputeBit(const layer_data* my_data, VkQueueFlags flags, CMD_TYPE cmd) {
     if (!(flags & VK_QUEUE_COMPUTE_BIT))
         return log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
-            DRAWSTATE_INVALID_COMMAND_BUFFER, "DS", "Cannot call %s on a command buffer allocated from a pool without compute capabilities.", name);
+            DRAWSTATE_INVALID_COMMAND_BUFFER, "DS", "Cannot call %s on a command buffer allocated from a pool without compute capabilities.", cmdTypeToString(cmd));
     return false;
 }
 
-static bool checkGraphicsOrComputeBit(const layer_data* my_data, VkQueueFlags flags, const char* name) {
+static bool checkGraphicsOrComputeBit(const layer_data* my_data, VkQueueFlags flags, CMD_TYPE cmd) {
     if (!((flags & VK_QUEUE_GRAPHICS_BIT) || (flags & VK_QUEUE_COMPUTE_BIT)))
         return log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
-            DRAWSTATE_INVALID_COMMAND_BUFFER, "DS", "Cannot call %s on a command buffer allocated from a pool without graphics capabilities.", name);
+            DRAWSTATE_INVALID_COMMAND_BUFFER, "DS", "Cannot call %s on a command buffer allocated from a pool without graphics capabilities.", cmdTypeToString(cmd));
     return false;
 }
 
@@ -3076,87 +3189,81 @@ static bool checkGraphicsOrComputeBit(const layer_data* my_data, VkQueueFlags fl
 static VkBool32 addCmd(const layer_data* my_data, GLOBAL_CB_NODE* pCB, const CMD_TYPE cmd, const char* caller_name)
 {
     VkBool32 skipCall = VK_FALSE;
-    auto pool_data = my_data->commandPoolMap.find(pCB->createInfo.commandPool);
-    if (pool_data != my_data->commandPoolMap.end()) {
-        VkQueueFlags flags = my_data->physDevProperties.queue_family_properties[pool_data->second.queueFamilyIndex].queueFlags;
-        switch (cmd)
-        {
-            case CMD_BINDPIPELINE:
-            case CMD_BINDPIPELINEDELTA:
-            case CMD_BINDDESCRIPTORSETS:
-            case CMD_FILLBUFFER:
-            case CMD_CLEARCOLORIMAGE:
-            case CMD_SETEVENT:
-            case CMD_RESETEVENT:
-            case CMD_WAITEVENTS:
-            case CMD_BEGINQUERY:
-            case CMD_ENDQUERY:
-            case CMD_RESETQUERYPOOL:
-            case CMD_COPYQUERYPOOLRESULTS:
-            case CMD_WRITETIMESTAMP:
-                skipCall |= checkGraphicsOrComputeBit(my_data, flags, cmdTypeToString(cmd).c_str());
-                break;
-            case CMD_SETVIEWPORTSTATE:
-            case CMD_SETSCISSORSTATE:
-            case CMD_SETLINEWIDTHSTATE:
-            case CMD_SETDEPTHBIASSTATE:
-            case CMD_SETBLENDSTATE:
-            case CMD_SETDEPTHBOUNDSSTATE:
-            case CMD_SETSTENCILREADMASKSTATE:
-            case CMD_SETSTENCILWRITEMASKSTATE:
-            case CMD_SETSTENCILREFERENCESTATE:
-            case CMD_BINDINDEXBUFFER:
-            case CMD_BINDVERTEXBUFFER:
-            case CMD_DRAW:
-            case CMD_DRAWINDEXED:
-            case CMD_DRAWINDIRECT:
-            case CMD_DRAWINDEXEDINDIRECT:
-            case CMD_BLITIMAGE:
-            case CMD_CLEARATTACHMENTS:
-            case CMD_CLEARDEPTHSTENCILIMAGE:
-            case CMD_RESOLVEIMAGE:
-            case CMD_BEGINRENDERPASS:
-            case CMD_NEXTSUBPASS:
-            case CMD_ENDRENDERPASS:
-                skipCall |= checkGraphicsBit(my_data, flags, cmdTypeToString(cmd).c_str());
-                break;
-            case CMD_DISPATCH:
-            case CMD_DISPATCHINDIRECT:
-                skipCall |= checkComputeBit(my_data, flags, cmdTypeToString(cmd).c_str());
-                break;
-            case CMD_COPYBUFFER:
-            case CMD_COPYIMAGE:
-            case CMD_COPYBUFFERTOIMAGE:
-            case CMD_COPYIMAGETOBUFFER:
-            case CMD_CLONEIMAGEDATA:
-            case CMD_UPDATEBUFFER:
-            case CMD_PIPELINEBARRIER:
-            case CMD_EXECUTECOMMANDS:
-                break;
-            default:
-                break;
-        }
+    VkQueueFlags flags = pCB->queueFlags;
+    switch (cmd)
+    {
+        case CMD_BINDPIPELINE:
+        case CMD_BINDPIPELINEDELTA:
+        case CMD_BINDDESCRIPTORSETS:
+        case CMD_FILLBUFFER:
+        case CMD_CLEARCOLORIMAGE:
+        case CMD_SETEVENT:
+        case CMD_RESETEVENT:
+        case CMD_WAITEVENTS:
+        case CMD_BEGINQUERY:
+        case CMD_ENDQUERY:
+        case CMD_RESETQUERYPOOL:
+        case CMD_COPYQUERYPOOLRESULTS:
+        case CMD_WRITETIMESTAMP:
+            skipCall |= checkGraphicsOrComputeBit(my_data, flags, cmd);
+            break;
+        case CMD_SETVIEWPORTSTATE:
+        case CMD_SETSCISSORSTATE:
+        case CMD_SETLINEWIDTHSTATE:
+        case CMD_SETDEPTHBIASSTATE:
+        case CMD_SETBLENDSTATE:
+        case CMD_SETDEPTHBOUNDSSTATE:
+        case CMD_SETSTENCILREADMASKSTATE:
+        case CMD_SETSTENCILWRITEMASKSTATE:
+        case CMD_SETSTENCILREFERENCESTATE:
+        case CMD_BINDINDEXBUFFER:
+        case CMD_BINDVERTEXBUFFER:
+        case CMD_DRAW:
+        case CMD_DRAWINDEXED:
+        case CMD_DRAWINDIRECT:
+        case CMD_DRAWINDEXEDINDIRECT:
+        case CMD_BLITIMAGE:
+        case CMD_CLEARATTACHMENTS:
+        case CMD_CLEARDEPTHSTENCILIMAGE:
+        case CMD_RESOLVEIMAGE:
+        case CMD_BEGINRENDERPASS:
+        case CMD_NEXTSUBPASS:
+        case CMD_ENDRENDERPASS:
+            skipCall |= checkGraphicsBit(my_data, flags, cmd);
+            break;
+        case CMD_DISPATCH:
+        case CMD_DISPATCHINDIRECT:
+            skipCall |= checkComputeBit(my_data, flags, cmd);
+            break;
+        case CMD_COPYBUFFER:
+        case CMD_COPYIMAGE:
+        case CMD_COPYBUFFERTOIMAGE:
+        case CMD_COPYIMAGETOBUFFER:
+        case CMD_CLONEIMAGEDATA:
+        case CMD_UPDATEBUFFER:
+        case CMD_PIPELINEBARRIER:
+        case CMD_EXECUTECOMMANDS:
+            break;
+        default:
+            break;
     }
     if (pCB->state != CB_RECORDING) {
         skipCall |= report_error_no_cb_begin(my_data, pCB->commandBuffer, caller_name);
         skipCall |= validateCmdsInCmdBuffer(my_data, pCB, cmd);
-        CMD_NODE cmdNode = {};
-        // init cmd node and append to end of cmd LL
-        cmdNode.cmdNumber = ++pCB->numCmds;
-        cmdNode.type = cmd;
-        pCB->cmds.push_back(cmdNode);
+        // append to end of cmd log
+        ++pCB->numCmds;
+        pCB->cmds.push_back(static_cast<uint8_t>(cmd));
     }
     return skipCall;
 }
 // Reset the command buffer state
-//  Maintain the createInfo and set state to CB_NEW, but clear all other state
-static void resetCB(layer_data* my_data, const VkCommandBuffer cb)
+//  Maintain the createInfo and set state to CB_NEW, but clear all other state.
+//  Containers are cleared rather than reallocated so a re-recorded CB reuses their storage.
+static void resetCB(layer_data* my_data, GLOBAL_CB_NODE* pCB)
 {
-    GLOBAL_CB_NODE* pCB = my_data->commandBufferMap[cb];
     if (pCB) {
         pCB->cmds.clear();
-        // Reset CB state (note that createInfo is not cleared)
-        pCB->commandBuffer = cb;
+        // Reset CB state (note that createInfo and commandBuffer are not cleared)
         memset(&pCB->beginInfo, 0, sizeof(VkCommandBufferBeginInfo));
         memset(&pCB->inheritanceInfo, 0, sizeof(VkCommandBufferInheritanceInfo));
         pCB->fence = 0;
@@ -3165,6 +3272,8 @@ static void resetCB(layer_data* my_data, const VkCommandBuffer cb)
         pCB->state = CB_NEW;
         pCB->submitCount = 0;
         pCB->status = 0;
+        pCB->drawStateDirty = CBDIRTY_ALL;
+        pCB->indexedDrawValidated = VK_FALSE;
         pCB->lastBoundPipeline = 0;
         pCB->lastVtxBinding = 0;
         pCB->boundVtxBuffers.clear();
@@ -3214,6 +3323,38 @@ static void resetCB(layer_data* my_data, const VkCommandBuffer cb)
     }
 }
 
+static void resetCB(layer_data* my_data, const VkCommandBuffer cb)
+{
+    auto cb_data = my_data->commandBufferMap.find(cb);
+    if (cb_data != my_data->commandBufferMap.end())
+        resetCB(my_data, cb_data->second);
+}
+
+// Take a CB node from the pool's free list, or create one, and link it into the pool
+static GLOBAL_CB_NODE* allocateCBNode(CMD_POOL_INFO& pool)
+{
+    GLOBAL_CB_NODE* pCB;
+    if (pool.freeNodes.empty()) {
+        pCB = new GLOBAL_CB_NODE;
+    } else {
+        pCB = pool.freeNodes.back();
+        pool.freeNodes.pop_back();
+    }
+    pCB->poolIndex = static_cast<uint32_t>(pool.commandBuffers.size());
+    pool.commandBuffers.push_back(pCB);
+    return pCB;
+}
+
+// Unlink an already reset CB node from its pool and keep it for the pool's next allocation
+static void recycleCBNode(CMD_POOL_INFO& pool, GLOBAL_CB_NODE* pCB)
+{
+    GLOBAL_CB_NODE* pLast = pool.commandBuffers.back();
+    pool.commandBuffers[pCB->poolIndex] = pLast;
+    pLast->poolIndex = pCB->poolIndex;
+    pool.commandBuffers.pop_back();
+    pool.freeNodes.push_back(pCB);
+}
+
 // Set PSO-related status bits for CB, including dynamic state set via PSO
 static void set_cb_pso_status(GLOBAL_CB_NODE* pCB, const PIPELINE_NODE* pPipe)
 {
@@ -3319,18 +3460,41 @@ static VkBool32 printDSConfig(layer_data* my_data, const VkCommandBuffer cb)
         skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_NONE, "DS",
                 "%s", DSLstr.c_str());
         index++;
-        GENERIC_HEADER* pUpdate = pSet->pUpdateStructs;
-        if (pUpdate) {
+        if (pSet->updated) {
             skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_NONE, "DS",
-                    "Update Chain [UC] for descriptor set %#" PRIxLEAST64 ":", (uint64_t) pSet->set);
-            sprintf(prefix, "  [UC] ");
+                    "Descriptors [D] for descriptor set %#" PRIxLEAST64 ":", (uint64_t) pSet->set);
+            std::stringstream descriptorStr;
+            for (uint32_t i = 0; i < pSet->descriptorCount; ++i) {
+                const DESCRIPTOR_NODE& descriptor = pSet->pDescriptors[i];
+                if (!descriptor.updated)
+                    continue;
+                descriptorStr << "  [D] #" << i << " " << string_VkDescriptorType(descriptor.type) << ": ";
+                switch (descriptor.type) {
+                case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+                case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                    descriptorStr << "bufferView " << descriptor.texelBufferView;
+                    break;
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                    descriptorStr << "buffer " << descriptor.bufferInfo.buffer << " offset " << descriptor.bufferInfo.offset
+                                  << " range " << descriptor.bufferInfo.range;
+                    break;
+                default:
+                    descriptorStr << "sampler " << descriptor.imageInfo.sampler << " imageView " << descriptor.imageInfo.imageView
+                                  << " layout " << string_VkImageLayout(descriptor.imageInfo.imageLayout);
+                    break;
+                }
+                descriptorStr << "\n";
+            }
             skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_NONE, "DS",
-                    "%s", dynamic_display(pUpdate, prefix).c_str());
-            // TODO : If there is a "view" associated with this update, print CI for that view
+                    "%s", descriptorStr.str().c_str());
+            // TODO : If there is a "view" associated with this descriptor, print CI for that view
         } else {
             if (0 != pSet->descriptorCount) {
                 skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_NONE, "DS",
-                        "No Update Chain for descriptor set %#" PRIxLEAST64 " which has %u descriptors (vkUpdateDescriptors has not been called)", (uint64_t) pSet->set, pSet->descriptorCount);
+                        "No updated descriptors in descriptor set %#" PRIxLEAST64 " which has %u descriptors (vkUpdateDescriptors has not been called)", (uint64_t) pSet->set, pSet->descriptorCount);
             } else {
                 skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_NONE, "DS",
                         "FYI: No descriptors in descriptor set %#" PRIxLEAST64 ".", (uint64_t) pSet->set);
@@ -3346,11 +3510,10 @@ static void printCB(layer_data* my_data, const VkCommandBuffer cb)
     if (pCB && pCB->cmds.size() > 0) {
         log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, 0, __LINE__, DRAWSTATE_NONE, "DS",
                 "Cmds in CB %p", (void*)cb);
-        vector<CMD_NODE> cmds = pCB->cmds;
-        for (auto ii=cmds.begin(); ii!=cmds.end(); ++ii) {
+        for (size_t i = 0; i < pCB->cmds.size(); ++i) {
             // TODO : Need to pass cb as srcObj here
             log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0, __LINE__, DRAWSTATE_NONE, "DS",
-                "  CMD#%" PRIu64 ": %s", (*ii).cmdNumber, cmdTypeToString((*ii).type).c_str());
+                "  CMD#%" PRIu64 ": %s", (uint64_t)(i + 1), cmdTypeToString(static_cast<CMD_TYPE>(pCB->cmds[i])));
         }
     } else {
         // Nothing to print
@@ -3399,6 +3562,23 @@ static VkBool32 outsideRenderPass(const layer_data* my_data, GLOBAL_CB_NODE *pCB
     return outside;
 }
 
+// Names accepted by lunarg_draw_state.disabled_checks
+static const layer_option_enum drawStateCheckNames[] = {
+    {"DRAWSTATE_INVALID_IMAGE_LAYOUT", DRAWSTATE_INVALID_IMAGE_LAYOUT},
+    {"DRAWSTATE_INVALID_BARRIER", DRAWSTATE_INVALID_BARRIER},
+    {"DRAWSTATE_PIPELINE_LAYOUTS_INCOMPATIBLE", DRAWSTATE_PIPELINE_LAYOUTS_INCOMPATIBLE},
+    {"DRAWSTATE_DYNAMIC_OFFSET_OVERFLOW", DRAWSTATE_DYNAMIC_OFFSET_OVERFLOW},
+    {"DRAWSTATE_SAMPLER_DESCRIPTOR_ERROR", DRAWSTATE_SAMPLER_DESCRIPTOR_ERROR},
+    {"DRAWSTATE_IMAGEVIEW_DESCRIPTOR_ERROR", DRAWSTATE_IMAGEVIEW_DESCRIPTOR_ERROR},
+    {"DRAWSTATE_BUFFERVIEW_DESCRIPTOR_ERROR", DRAWSTATE_BUFFERVIEW_DESCRIPTOR_ERROR},
+    {"DRAWSTATE_BUFFERINFO_DESCRIPTOR_ERROR", DRAWSTATE_BUFFERINFO_DESCRIPTOR_ERROR},
+    {"SHADER_CHECKER_INTERFACE_TYPE_MISMATCH", DRAWSTATE_CHECK_COUNT + SHADER_CHECKER_INTERFACE_TYPE_MISMATCH},
+    {"SHADER_CHECKER_OUTPUT_NOT_CONSUMED", DRAWSTATE_CHECK_COUNT + SHADER_CHECKER_OUTPUT_NOT_CONSUMED},
+    {"SHADER_CHECKER_INPUT_NOT_PRODUCED", DRAWSTATE_CHECK_COUNT + SHADER_CHECKER_INPUT_NOT_PRODUCED},
+    {"SHADER_CHECKER_INCONSISTENT_VI", DRAWSTATE_CHECK_COUNT + SHADER_CHECKER_INCONSISTENT_VI},
+    {"SHADER_CHECKER_BAD_SPECIALIZATION", DRAWSTATE_CHECK_COUNT + SHADER_CHECKER_BAD_SPECIALIZATION},
+};
+
 static void init_draw_state(layer_data *my_data, const VkAllocationCallbacks *pAllocator)
 {
     uint32_t report_flags = 0;
@@ -3409,16 +3589,30 @@ static void init_draw_state(layer_data *my_data, const VkAllocationCallbacks *pA
     // initialize draw_state options
     report_flags = getLayerOptionFlags("lunarg_draw_state.report_flags", 0);
     getLayerOptionEnum("lunarg_draw_state.debug_action", (uint32_t *) &debug_action);
+    getLayerOptionEnumList("lunarg_draw_state.disabled_checks", drawStateCheckNames,
+                           sizeof(drawStateCheckNames) / sizeof(drawStateCheckNames[0]), disabledChecks);
+    option_str = getLayerOption("lunarg_draw_state.pipeline_validation_threads");
+    if (option_str) {
+        pipelineValidationThreads = (uint32_t) strtoul(option_str, NULL, 0);
+    }
+    option_str = getLayerOption("lunarg_draw_state.deferred_submit_validation");
+    if (option_str) {
+        deferredSubmitValidation = strtoul(option_str, NULL, 0) != 0;
+    }
+    option_str = getLayerOption("lunarg_draw_state.shader_module_cache_size");
+    if (option_str) {
+        shaderModuleCacheLimit = (size_t) strtoull(option_str, NULL, 0);
+    }
 
     if (debug_action & VK_DBG_LAYER_ACTION_LOG_MSG)
     {
-        option_str = getLayerOption("lunarg_draw_state.log_filename");
-        log_output = getLayerLogOutput(option_str, "lunarg_draw_state");
+        layer_log_ring *log_ring;
+        getLayerLogSink("lunarg_draw_state", &log_output, &log_ring);
         VkDebugReportCallbackCreateInfoEXT dbgInfo;
         memset(&dbgInfo, 0, sizeof(dbgInfo));
         dbgInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
-        dbgInfo.pfnCallback = log_callback;
-        dbgInfo.pUserData = log_output;
+        dbgInfo.pfnCallback = log_ring ? log_ring_callback : log_callback;
+        dbgInfo.pUserData = log_ring ? (void *) log_ring : (void *) log_output;
         dbgInfo.flags = report_flags;
         layer_create_msg_callback(my_data->report_data, &dbgInfo, pAllocator, &callback);
         my_data->logging_callback.push_back(callback);
@@ -3437,7 +3631,7 @@ static void init_draw_state(layer_data *my_data, const VkAllocationCallbacks *pA
 
     if (!globalLockInitialized)
     {
-        loader_platform_thread_create_mutex(&globalLock);
+        loader_platform_thread_create_rwlock(&globalLock);
         globalLockInitialized = 1;
     }
 }
@@ -3488,7 +3682,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(VkInstance instance
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     pTable->DestroyInstance(instance, pAllocator);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
 
     // Clean up logging callback, if any
     while (my_data->logging_callback.size() > 0) {
@@ -3502,12 +3696,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(VkInstance instance
     layer_data_map.erase(key);
     // TODO : Potential race here with separate threads creating/destroying instance
     if (layer_data_map.empty()) {
-        // Release mutex when destroying last instance.
-        loader_platform_thread_unlock_mutex(&globalLock);
-        loader_platform_thread_delete_mutex(&globalLock);
+        // Release lock when destroying last instance.
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
+        loader_platform_thread_delete_rwlock(&globalLock);
         globalLockInitialized = 0;
     } else {
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
 }
 
@@ -3543,6 +3737,9 @@ static void createDeviceRegisterExtensions(const VkDeviceCreateInfo* pCreateInfo
     }
 }
 
+// prototypes
+static void flushDeferredSubmits(layer_data*);
+static void runDeferredSubmits(layer_data*);
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice gpu, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
 {
     VkLayerDeviceCreateInfo *chain_info = get_chain_info(pCreateInfo, VK_LAYER_LINK_INFO);
@@ -3563,7 +3760,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice g
         return result;
     }
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     layer_data *my_instance_data = get_my_data_ptr(get_dispatch_key(gpu), layer_data_map);
     layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(*pDevice), layer_data_map);
 
@@ -3588,19 +3785,24 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice g
         my_instance_data->instance_dispatch_table->GetPhysicalDeviceFeatures(
             gpu, &my_device_data->physDevProperties.features);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    if (deferredSubmitValidation) {
+        my_device_data->deferredSubmitThread = std::thread(runDeferredSubmits, my_device_data);
+    }
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     return result;
 }
 
 // prototype
 static void deleteRenderPasses(layer_data*);
+
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
 {
     // TODOSC : Shouldn't need any customization here
     dispatch_key key = get_dispatch_key(device);
     layer_data* dev_data = get_my_data_ptr(key, layer_data_map);
     // Free all the memory
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    flushDeferredSubmits(dev_data);
     deletePipelines(dev_data);
     deleteRenderPasses(dev_data);
     deleteCommandBuffers(dev_data);
@@ -3610,7 +3812,16 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(VkDevice device, cons
     dev_data->imageMap.clear();
     dev_data->bufferViewMap.clear();
     dev_data->bufferMap.clear();
-    loader_platform_thread_unlock_mutex(&globalLock);
+    dev_data->shaderModuleMap.clear();
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
+    if (dev_data->deferredSubmitThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(dev_data->deferredSubmitMutex);
+            dev_data->deferredSubmitStop = true;
+        }
+        dev_data->deferredSubmitCond.notify_one();
+        dev_data->deferredSubmitThread.join();
+    }
 
     dev_data->device_dispatch_table->DestroyDevice(device, pAllocator);
     tableDebugMarkerMap.erase(key);
@@ -3702,23 +3913,31 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateDeviceLayerProperties(
 // the IMAGE is the same
 // as the global IMAGE layout
 VkBool32 ValidateCmdBufImageLayouts(VkCommandBuffer cmdBuffer) {
+    if (checkDisabled(DRAWSTATE_INVALID_IMAGE_LAYOUT))
+        return VK_FALSE;
     VkBool32 skip_call = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, cmdBuffer);
-    for (auto cb_image_data : pCB->imageLayoutMap) {
-        VkImageLayout imageLayout;
-        if (!FindLayout(dev_data, cb_image_data.first, imageLayout)) {
-            skip_call |= log_msg(
-                dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0, __LINE__,
-                DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
-                "Cannot submit cmd buffer using deleted image %" PRIu64 ".",
-                reinterpret_cast<const uint64_t &>(cb_image_data.first));
-        } else {
-            if (cb_image_data.second.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+    for (auto &cb_image_data : pCB->imageLayoutMap) {
+        const VkImage image = cb_image_data.first;
+        auto image_data = dev_data->imageLayoutMap.find(image);
+        auto apply = [&](const IMAGE_CMD_BUF_NODE &cb_node, bool found, VkImageLayout &imageLayout) {
+            if (!found) {
+                if (image_data == dev_data->imageLayoutMap.end() || !image_data->second.hasWhole) {
+                    skip_call |= log_msg(
+                        dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                        VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0, __LINE__,
+                        DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
+                        "Cannot submit cmd buffer using deleted image %" PRIu64 ".",
+                        reinterpret_cast<const uint64_t &>(image));
+                    return false;
+                }
+                imageLayout = image_data->second.whole;
+            }
+            if (cb_node.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
                 // TODO: Set memory invalid which is in mem_tracker currently
             }
-            else if (imageLayout != cb_image_data.second.initialLayout) {
+            else if (imageLayout != cb_node.initialLayout) {
                 skip_call |= log_msg(
                     dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
                     VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0, __LINE__,
@@ -3726,9 +3945,24 @@ VkBool32 ValidateCmdBufImageLayouts(VkCommandBuffer cmdBuffer) {
                     "Cannot submit cmd buffer using image with layout %s when "
                     "first use is %s.",
                     string_VkImageLayout(imageLayout),
-                    string_VkImageLayout(cb_image_data.second.initialLayout));
+                    string_VkImageLayout(cb_node.initialLayout));
+            }
+            imageLayout = cb_node.layout;
+            return true;
+        };
+        // Apply the command buffer's changes one run of array layers at a time
+        for (auto &level : cb_image_data.second.levels) {
+            for (auto &run : level.runs) {
+                if (image_data == dev_data->imageLayoutMap.end()) {
+                    VkImageLayout unused;
+                    apply(run.value, false, unused);
+                    continue;
+                }
+                image_data->second.update(level.aspectMask, level.mipLevel, run.begin, run.end,
+                                          [&](bool found, VkImageLayout &imageLayout) {
+                                              return apply(run.value, found, imageLayout);
+                                          });
             }
-            SetLayout(dev_data, cb_image_data.first, cb_image_data.second.layout);
         }
     }
     return skip_call;
@@ -3991,18 +4225,56 @@ static VkBool32 validatePrimaryCommandBufferState(layer_data *dev_data,
                     (uint64_t)(pCB->commandBuffer), pCB->submitCount);
     }
     skipCall |= validateCommandBufferState(dev_data, pCB);
-    // If USAGE_SIMULTANEOUS_USE_BIT not set then CB cannot already be executing
-    // on device
-    skipCall |= validateCommandBufferSimultaneousUse(dev_data, pCB);
     return skipCall;
 }
 
+// Run the checks vkQueueSubmit deferred, in submission order. Anything that retires
+//  fences, changes a command buffer or reads the device image layouts calls this first,
+//  so the deferred checks always see the state they would have seen at submit.
+// Note: This function assumes that the global lock is held by the calling
+// thread.
+static void flushDeferredSubmits(layer_data *dev_data) {
+    if (dev_data->deferredSubmits.empty())
+        return;
+    std::deque<VkCommandBuffer> submits;
+    submits.swap(dev_data->deferredSubmits);
+    {
+        std::lock_guard<std::mutex> lock(dev_data->deferredSubmitMutex);
+        dev_data->deferredSubmitPending = false;
+    }
+    // The submits were already forwarded, so any errors can only be reported
+    for (auto cmdBuffer : submits) {
+        GLOBAL_CB_NODE *pCB = getCBNode(dev_data, cmdBuffer);
+        if (!pCB)
+            continue;
+        ValidateCmdBufImageLayouts(cmdBuffer);
+        validatePrimaryCommandBufferState(dev_data, pCB);
+    }
+}
+
+static void runDeferredSubmits(layer_data *dev_data) {
+    std::unique_lock<std::mutex> lock(dev_data->deferredSubmitMutex);
+    while (true) {
+        dev_data->deferredSubmitCond.wait(lock, [dev_data] {
+            return dev_data->deferredSubmitPending || dev_data->deferredSubmitStop;
+        });
+        if (dev_data->deferredSubmitStop)
+            break;
+        // globalLock is taken before deferredSubmitMutex everywhere else
+        lock.unlock();
+        loader_platform_thread_write_lock_rwlock(&globalLock);
+        flushDeferredSubmits(dev_data);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
+        lock.lock();
+    }
+}
+
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
 {
     VkBool32 skipCall = VK_FALSE;
     GLOBAL_CB_NODE* pCB = NULL;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
         const VkSubmitInfo *submit = &pSubmits[submit_idx];
         vector<VkSemaphore> semaphoreList;
@@ -4021,11 +4293,18 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(VkQueue queue, uint
             dev_data->semaphoreMap[submit->pSignalSemaphores[i]].signaled = 1;
         }
         for (uint32_t i=0; i < submit->commandBufferCount; i++) {
-            skipCall |= ValidateCmdBufImageLayouts(submit->pCommandBuffers[i]);
             pCB = getCBNode(dev_data, submit->pCommandBuffers[i]);
             pCB->semaphores = semaphoreList;
             pCB->submitCount++; // increment submit count
-            skipCall |= validatePrimaryCommandBufferState(dev_data, pCB);
+            // If USAGE_SIMULTANEOUS_USE_BIT not set then CB cannot already be executing
+            // on device. Checked before trackCommandBuffers() marks it in flight.
+            skipCall |= validateCommandBufferSimultaneousUse(dev_data, pCB);
+            if (deferredSubmitValidation) {
+                dev_data->deferredSubmits.push_back(submit->pCommandBuffers[i]);
+            } else {
+                skipCall |= ValidateCmdBufImageLayouts(submit->pCommandBuffers[i]);
+                skipCall |= validatePrimaryCommandBufferState(dev_data, pCB);
+            }
         }
         if ((fence != VK_NULL_HANDLE) && dev_data->fenceMap[fence].in_use.load()) {
             skipCall |= log_msg(
@@ -4039,7 +4318,12 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(VkQueue queue, uint
         trackCommandBuffers(dev_data, queue, submit->commandBufferCount,
                             submit->pCommandBuffers, fence);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    if (!dev_data->deferredSubmits.empty()) {
+        std::lock_guard<std::mutex> lock(dev_data->deferredSubmitMutex);
+        dev_data->deferredSubmitPending = true;
+        dev_data->deferredSubmitCond.notify_one();
+    }
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall)
         return dev_data->device_dispatch_table->QueueSubmit(queue, submitCount, pSubmits, fence);
     return VK_ERROR_VALIDATION_FAILED_EXT;
@@ -4089,7 +4373,8 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkWaitForFences(VkDevice device,
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->WaitForFences(device, fenceCount, pFences, waitAll, timeout);
     VkBool32 skip_call = VK_FALSE;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    flushDeferredSubmits(dev_data);
     if (result == VK_SUCCESS) {
         // When we know that all fences are complete we can clean/remove their CBs
         if (waitAll || fenceCount == 1) {
@@ -4106,7 +4391,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkWaitForFences(VkDevice device,
         //  this case for app to guarantee which fences completed it will have to call
         //  vkGetFenceStatus() at which point we'll clean/remove their CBs if complete.
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE != skip_call)
         return VK_ERROR_VALIDATION_FAILED_EXT;
     return result;
@@ -4118,7 +4403,8 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice device,
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->GetFenceStatus(device, fence);
     VkBool32 skip_call = VK_FALSE;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    flushDeferredSubmits(dev_data);
     if (result == VK_SUCCESS) {
         auto fence_queue = dev_data->fenceMap[fence].queue;
         for (auto cmdBuffer : dev_data->fenceMap[fence].cmdBuffers) {
@@ -4127,7 +4413,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice device,
         }
         decrementResources(dev_data, 1, &fence);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE != skip_call)
         return VK_ERROR_VALIDATION_FAILED_EXT;
     return result;
@@ -4136,19 +4422,20 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice device,
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkGetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex, VkQueue* pQueue)
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     dev_data->device_dispatch_table->GetDeviceQueue(device, queueFamilyIndex, queueIndex, pQueue);
     dev_data->queues.push_back(*pQueue);
     dev_data->queueMap[*pQueue].device = device;
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueWaitIdle(VkQueue queue)
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
-    decrementResources(dev_data, queue);
     VkBool32 skip_call = VK_FALSE;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    flushDeferredSubmits(dev_data);
+    decrementResources(dev_data, queue);
     // Iterate over local set since we erase set members as we go in for loop
     auto local_cb_set = dev_data->queueMap[queue].inFlightCmdBuffers;
     for (auto cmdBuffer : local_cb_set) {
@@ -4156,7 +4443,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueWaitIdle(VkQueue queue)
         removeInFlightCmdBuffer(dev_data, cmdBuffer, queue);
     }
     dev_data->queueMap[queue].inFlightCmdBuffers.clear();
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE != skip_call)
         return VK_ERROR_VALIDATION_FAILED_EXT;
     return dev_data->device_dispatch_table->QueueWaitIdle(queue);
@@ -4166,7 +4453,8 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkDeviceWaitIdle(VkDevice device)
 {
     VkBool32 skip_call = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    flushDeferredSubmits(dev_data);
     for (auto queue : dev_data->queues) {
         decrementResources(dev_data, queue);
         if (dev_data->queueMap.find(queue) != dev_data->queueMap.end()) {
@@ -4178,7 +4466,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkDeviceWaitIdle(VkDevice device)
         skip_call |= cleanInFlightCmdBuffer(dev_data, cmdBuffer);
     }
     dev_data->globalInFlightCmdBuffers.clear();
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE != skip_call)
         return VK_ERROR_VALIDATION_FAILED_EXT;
     return dev_data->device_dispatch_table->DeviceWaitIdle(device);
@@ -4189,7 +4477,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyFence(VkDevice device, VkFen
     layer_data *dev_data =
         get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     if (dev_data->fenceMap[fence].in_use.load()) {
         skipCall |=
             log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
@@ -4198,7 +4486,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyFence(VkDevice device, VkFen
                     "Fence %#" PRIx64 " is in use by a command buffer.",
                     (uint64_t)(fence));
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (!skipCall)
         dev_data->device_dispatch_table->DestroyFence(device, fence,
                                                       pAllocator);
@@ -4209,7 +4497,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroySemaphore(VkDevice device, V
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     dev_data->device_dispatch_table->DestroySemaphore(device, semaphore, pAllocator);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     if (dev_data->semaphoreMap[semaphore].in_use.load()) {
         log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
                 VK_DEBUG_REPORT_OBJECT_TYPE_SEMAPHORE_EXT,
@@ -4219,7 +4507,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroySemaphore(VkDevice device, V
                 reinterpret_cast<uint64_t &>(semaphore));
     }
     dev_data->semaphoreMap.erase(semaphore);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     // TODO : Clean up any internal data structures using this obj.
 }
 
@@ -4228,7 +4516,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyEvent(VkDevice device, VkEve
     layer_data *dev_data =
         get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     auto event_data = dev_data->eventMap.find(event);
     if (event_data != dev_data->eventMap.end() &&
         event_data->second.in_use.load()) {
@@ -4241,7 +4529,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyEvent(VkDevice device, VkEve
                     " which is in use by a command buffer.",
                     reinterpret_cast<uint64_t &>(event));
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (!skip_call)
         dev_data->device_dispatch_table->DestroyEvent(device, event,
                                                       pAllocator);
@@ -4259,7 +4547,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkGetQueryPoolResults(VkDevice device, VkQueryPoo
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     unordered_map<QueryObject, vector<VkCommandBuffer>> queriesInFlight;
     GLOBAL_CB_NODE* pCB = nullptr;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (auto cmdBuffer : dev_data->globalInFlightCmdBuffers) {
         pCB = getCBNode(dev_data, cmdBuffer);
         for (auto queryStatePair : pCB->queryToStateMap) {
@@ -4313,7 +4601,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkGetQueryPoolResults(VkDevice device, VkQueryPoo
                                  (uint64_t)(queryPool), firstQuery + i);
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (skip_call)
         return VK_ERROR_VALIDATION_FAILED_EXT;
     return dev_data->device_dispatch_table->GetQueryPoolResults(device, queryPool, firstQuery, queryCount, dataSize, pData, stride, flags);
@@ -4337,32 +4625,32 @@ VkBool32 validateIdleBuffer(const layer_data* my_data, VkBuffer buffer) {
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks* pAllocator)
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     if (!validateIdleBuffer(dev_data, buffer)) {
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
         dev_data->device_dispatch_table->DestroyBuffer(device, buffer, pAllocator);
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
     }
     dev_data->bufferMap.erase(buffer);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyBufferView(VkDevice device, VkBufferView bufferView, const VkAllocationCallbacks* pAllocator)
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     dev_data->device_dispatch_table->DestroyBufferView(device, bufferView, pAllocator);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     dev_data->bufferViewMap.erase(bufferView);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator)
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     dev_data->device_dispatch_table->DestroyImage(device, image, pAllocator);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     dev_data->imageMap.erase(image);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyImageView(VkDevice device, VkImageView imageView, const VkAllocationCallbacks* pAllocator)
@@ -4373,8 +4661,14 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyImageView(VkDevice device, V
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyShaderModule(VkDevice device, VkShaderModule shaderModule, const VkAllocationCallbacks* pAllocator)
 {
-    get_my_data_ptr(get_dispatch_key(device), layer_data_map)->device_dispatch_table->DestroyShaderModule(device, shaderModule, pAllocator);
-    // TODO : Clean up any internal data structures using this obj.
+    layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    dev_data->device_dispatch_table->DestroyShaderModule(device, shaderModule, pAllocator);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    auto module = dev_data->shaderModuleMap.find(shaderModule);
+    if (module != dev_data->shaderModuleMap.end()) {
+        dev_data->shaderModuleMap.erase(module);
+    }
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks* pAllocator)
@@ -4403,8 +4697,17 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDescriptorSetLayout(VkDevice
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks* pAllocator)
 {
-    get_my_data_ptr(get_dispatch_key(device), layer_data_map)->device_dispatch_table->DestroyDescriptorPool(device, descriptorPool, pAllocator);
-    // TODO : Clean up any internal data structures using this obj.
+    layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    dev_data->device_dispatch_table->DestroyDescriptorPool(device, descriptorPool, pAllocator);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    auto pool_node = dev_data->descriptorPoolMap.find(descriptorPool);
+    if (pool_node != dev_data->descriptorPoolMap.end()) {
+        // Destroying the pool implicitly frees all of its sets
+        clearDescriptorPool(dev_data, device, descriptorPool, 0);
+        delete pool_node->second;
+        dev_data->descriptorPoolMap.erase(pool_node);
+    }
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t count, const VkCommandBuffer *pCommandBuffers)
@@ -4412,26 +4715,29 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkFreeCommandBuffers(VkDevice device,
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     bool skip_call = false;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    flushDeferredSubmits(dev_data);
     for (uint32_t i = 0; i < count; i++) {
         if (dev_data->globalInFlightCmdBuffers.count(pCommandBuffers[i])) {
             skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
                 reinterpret_cast<uint64_t>(pCommandBuffers[i]), __LINE__, DRAWSTATE_INVALID_COMMAND_BUFFER_RESET, "DS",
                 "Attempt to free command buffer (%#" PRIxLEAST64 ") which is in use.", reinterpret_cast<uint64_t>(pCommandBuffers[i]));
         }
-        // Delete CB information structure, and remove from commandBufferMap
+        // Reset CB information structure, remove it from commandBufferMap and return it to its pool
         auto cb = dev_data->commandBufferMap.find(pCommandBuffers[i]);
         if (cb != dev_data->commandBufferMap.end()) {
-            // reset prior to delete for data clean-up
-            resetCB(dev_data, (*cb).second->commandBuffer);
-            delete (*cb).second;
+            GLOBAL_CB_NODE* pCB = (*cb).second;
+            resetCB(dev_data, pCB);
             dev_data->commandBufferMap.erase(cb);
+            auto pool_data = dev_data->commandPoolMap.find(pCB->createInfo.commandPool);
+            if (pool_data != dev_data->commandPoolMap.end()) {
+                recycleCBNode(pool_data->second, pCB);
+            } else {
+                delete pCB;
+            }
         }
-
-        // Remove commandBuffer reference from commandPoolMap
-        dev_data->commandPoolMap[commandPool].commandBuffers.remove(pCommandBuffers[i]);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     if (!skip_call)
         dev_data->device_dispatch_table->FreeCommandBuffers(device, commandPool, count, pCommandBuffers);
@@ -4444,10 +4750,10 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateCommandPool(VkDevice devi
     VkResult result = dev_data->device_dispatch_table->CreateCommandPool(device, pCreateInfo, pAllocator, pCommandPool);
 
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->commandPoolMap[*pCommandPool].createFlags = pCreateInfo->flags;
         dev_data->commandPoolMap[*pCommandPool].queueFamilyIndex = pCreateInfo->queueFamilyIndex;
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4461,9 +4767,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateQueryPool(
     VkResult result = dev_data->device_dispatch_table->CreateQueryPool(
         device, pCreateInfo, pAllocator, pQueryPool);
     if (result == VK_SUCCESS) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->queryPoolMap[*pQueryPool].createInfo = *pCreateInfo;
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4472,7 +4778,8 @@ VkBool32 validateCommandBuffersNotInUse(const layer_data* dev_data, VkCommandPoo
     VkBool32 skipCall = VK_FALSE;
     auto pool_data = dev_data->commandPoolMap.find(commandPool);
     if (pool_data != dev_data->commandPoolMap.end()) {
-        for (auto cmdBuffer : pool_data->second.commandBuffers) {
+        for (auto pCB : pool_data->second.commandBuffers) {
+            VkCommandBuffer cmdBuffer = pCB->commandBuffer;
             if (dev_data->globalInFlightCmdBuffers.count(cmdBuffer)) {
                 skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_POOL_EXT, (uint64_t)(commandPool),
                                      __LINE__, DRAWSTATE_OBJECT_INUSE, "DS", "Cannot reset command pool %" PRIx64 " when allocated command buffer %" PRIx64 " is in use.",
@@ -4487,20 +4794,23 @@ VkBool32 validateCommandBuffersNotInUse(const layer_data* dev_data, VkCommandPoo
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator)
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    flushDeferredSubmits(dev_data);
 
     // Must remove cmdpool from cmdpoolmap, after removing all cmdbuffers in its list from the commandPoolMap
-    if (dev_data->commandPoolMap.find(commandPool) != dev_data->commandPoolMap.end()) {
-        for (auto poolCb = dev_data->commandPoolMap[commandPool].commandBuffers.begin(); poolCb != dev_data->commandPoolMap[commandPool].commandBuffers.end();) {
-            auto del_cb = dev_data->commandBufferMap.find(*poolCb);
-            delete (*del_cb).second;                                        // delete CB info structure
-            dev_data->commandBufferMap.erase(del_cb);                       // Remove this command buffer from cbMap
-            poolCb = dev_data->commandPoolMap[commandPool].commandBuffers.erase(poolCb);   // Remove CB reference from commandPoolMap's list
+    auto pool_data = dev_data->commandPoolMap.find(commandPool);
+    if (pool_data != dev_data->commandPoolMap.end()) {
+        for (auto pCB : pool_data->second.commandBuffers) {
+            dev_data->commandBufferMap.erase(pCB->commandBuffer);   // Remove this command buffer from cbMap
+            delete pCB;                                             // delete CB info structure
+        }
+        for (auto pCB : pool_data->second.freeNodes) {
+            delete pCB;
         }
+        dev_data->commandPoolMap.erase(pool_data);
     }
-    dev_data->commandPoolMap.erase(commandPool);
 
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     if (VK_TRUE == validateCommandBuffersNotInUse(dev_data, commandPool))
         return;
@@ -4522,13 +4832,16 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandPool(
     result = dev_data->device_dispatch_table->ResetCommandPool(device, commandPool, flags);
     // Reset all of the CBs allocated from this pool
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
-        auto it = dev_data->commandPoolMap[commandPool].commandBuffers.begin();
-        while (it != dev_data->commandPoolMap[commandPool].commandBuffers.end()) {
-            resetCB(dev_data, (*it));
-            ++it;
+        loader_platform_thread_write_lock_rwlock(&globalLock);
+        flushDeferredSubmits(dev_data);
+        // The pool holds its nodes directly, so this is one pass with no commandBufferMap lookups
+        auto pool_data = dev_data->commandPoolMap.find(commandPool);
+        if (pool_data != dev_data->commandPoolMap.end()) {
+            for (auto pCB : pool_data->second.commandBuffers) {
+                resetCB(dev_data, pCB);
+            }
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4538,7 +4851,7 @@ vkResetFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences) {
     layer_data *dev_data =
         get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t i = 0; i < fenceCount; ++i) {
         if (dev_data->fenceMap[pFences[i]].in_use.load()) {
             skipCall |=
@@ -4550,7 +4863,7 @@ vkResetFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences) {
                         reinterpret_cast<const uint64_t &>(pFences[i]));
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     if (!skipCall)
         result = dev_data->device_dispatch_table->ResetFences(
@@ -4575,11 +4888,11 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer(VkDevice device, c
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateBuffer(device, pCreateInfo, pAllocator, pBuffer);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         // TODO : This doesn't create deep copy of pQueueFamilyIndices so need to fix that if/when we want that data to be valid
         dev_data->bufferMap[*pBuffer].create_info = unique_ptr<VkBufferCreateInfo>(new VkBufferCreateInfo(*pCreateInfo));
         dev_data->bufferMap[*pBuffer].in_use.store(0);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4589,9 +4902,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateBufferView(VkDevice devic
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateBufferView(device, pCreateInfo, pAllocator, pView);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->bufferViewMap[*pView] = unique_ptr<VkBufferViewCreateInfo>(new VkBufferViewCreateInfo(*pCreateInfo));
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4601,15 +4914,12 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(VkDevice device, co
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateImage(device, pCreateInfo, pAllocator, pImage);
     if (VK_SUCCESS == result) {
-        IMAGE_NODE image_node;
-        image_node.layout = pCreateInfo->initialLayout;
-        image_node.format = pCreateInfo->format;
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->imageMap[*pImage] = unique_ptr<VkImageCreateInfo>(new VkImageCreateInfo(*pCreateInfo));
-        ImageSubresourcePair subpair = {*pImage, false, VkImageSubresource()};
-        dev_data->imageSubresourceMap[*pImage].push_back(subpair); 
-        dev_data->imageLayoutMap[subpair] = image_node;
-        loader_platform_thread_unlock_mutex(&globalLock);
+        // Drop any ranges left behind by a destroyed image with the same handle
+        dev_data->imageLayoutMap[*pImage] = subresource_range_map<VkImageLayout>();
+        SetLayout(dev_data, *pImage, pCreateInfo->initialLayout);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4619,9 +4929,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateImageView(VkDevice device
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateImageView(device, pCreateInfo, pAllocator, pView);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->imageViewMap[*pView] = unique_ptr<VkImageViewCreateInfo>(new VkImageViewCreateInfo(*pCreateInfo));
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4634,9 +4944,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
     VkResult result = dev_data->device_dispatch_table->CreateFence(
         device, pCreateInfo, pAllocator, pFence);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->fenceMap[*pFence].in_use.store(0);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4705,23 +5015,30 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateGraphicsPipelines(
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     uint32_t i=0;
-    loader_platform_thread_lock_mutex(&globalLock);
-
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+
+    // Pipelines of a batch are independent, so large batches are validated in parallel.
+    //  Workers only read layer state, which holding globalLock keeps stable, and their
+    //  messages are delivered in pipeline order so the output doesn't depend on scheduling.
+    vector<VkBool32> pipeSkip(count, VK_FALSE);
+    validatePipelineBatch(dev_data->report_data, count, pipeSkip, [&](uint32_t index) {
+        pPipeNode[index] = initGraphicsPipeline(dev_data, &pCreateInfos[index], NULL);
+        return verifyPipelineCreateState(dev_data, device, pPipeNode[index]);
+    });
     for (i=0; i<count; i++) {
-        pPipeNode[i] = initGraphicsPipeline(dev_data, &pCreateInfos[i], NULL);
-        skipCall |= verifyPipelineCreateState(dev_data, device, pPipeNode[i]);
+        skipCall |= pipeSkip[i];
     }
 
     if (VK_FALSE == skipCall) {
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
         result = dev_data->device_dispatch_table->CreateGraphicsPipelines(device,
             pipelineCache, count, pCreateInfos, pAllocator, pPipelines);
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         for (i=0; i<count; i++) {
             pPipeNode[i]->pipeline = pPipelines[i];
             dev_data->pipelineMap[pPipeNode[i]->pipeline] = pPipeNode[i];
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     } else {
         for (i=0; i<count; i++) {
             if (pPipeNode[i]) {
@@ -4732,7 +5049,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateGraphicsPipelines(
                 delete pPipeNode[i];
             }
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
         return VK_ERROR_VALIDATION_FAILED_EXT;
     }
     return result;
@@ -4754,7 +5071,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateComputePipelines(
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     uint32_t i=0;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (i=0; i<count; i++) {
         // TODO: Verify compute stage bits
 
@@ -4767,20 +5084,20 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateComputePipelines(
     }
 
     if (VK_FALSE == skipCall) {
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
         result = dev_data->device_dispatch_table->CreateComputePipelines(device, pipelineCache, count, pCreateInfos, pAllocator, pPipelines);
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         for (i=0; i<count; i++) {
             pPipeNode[i]->pipeline = pPipelines[i];
             dev_data->pipelineMap[pPipeNode[i]->pipeline] = pPipeNode[i];
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     } else {
         for (i=0; i<count; i++) {
             // Clean up any locally allocated data structures
             delete pPipeNode[i];
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
         return VK_ERROR_VALIDATION_FAILED_EXT;
     }
     return result;
@@ -4791,9 +5108,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateSampler(VkDevice device,
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateSampler(device, pCreateInfo, pAllocator, pSampler);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->sampleMap[*pSampler] = unique_ptr<SAMPLER_NODE>(new SAMPLER_NODE(pSampler, pCreateInfo));
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4862,9 +5179,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDescriptorSetLayout(VkDev
             pNewNode->endIndex = 0;
         }
         // Put new node at Head of global Layer list
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->descriptorSetLayoutMap[*pSetLayout] = pNewNode;
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4874,7 +5191,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineLayout(VkDevice device, const VkP
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreatePipelineLayout(device, pCreateInfo, pAllocator, pPipelineLayout);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         // TODOSC : Merge capture of the setLayouts per pipeline
         PIPELINE_LAYOUT_NODE& plNode = dev_data->pipelineLayoutMap[*pPipelineLayout];
         plNode.descriptorSetLayouts.resize(pCreateInfo->setLayoutCount);
@@ -4886,7 +5203,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineLayout(VkDevice device, const VkP
         for (i=0; i<pCreateInfo->pushConstantRangeCount; ++i) {
             plNode.pushConstantRanges[i] = pCreateInfo->pPushConstantRanges[i];
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4906,9 +5223,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDescriptorPool(VkDevice d
                     "Out of memory while attempting to allocate DESCRIPTOR_POOL_NODE in vkCreateDescriptorPool()"))
                 return VK_ERROR_VALIDATION_FAILED_EXT;
         } else {
-            loader_platform_thread_lock_mutex(&globalLock);
+            loader_platform_thread_write_lock_rwlock(&globalLock);
             dev_data->descriptorPoolMap[*pDescriptorPool] = pNewNode;
-            loader_platform_thread_unlock_mutex(&globalLock);
+            loader_platform_thread_write_unlock_rwlock(&globalLock);
         }
     } else {
         // Need to do anything if pool create fails?
@@ -4921,9 +5238,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetDescriptorPool(VkDevice de
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->ResetDescriptorPool(device, descriptorPool, flags);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         clearDescriptorPool(dev_data, device, descriptorPool, flags);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -4933,7 +5250,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAllocateDescriptorSets(VkDevice
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     // Verify that requested descriptorSets are available in pool
     DESCRIPTOR_POOL_NODE *pPoolNode = getPoolNode(dev_data, pAllocateInfo->descriptorPool);
     if (!pPoolNode) {
@@ -4942,12 +5259,12 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAllocateDescriptorSets(VkDevice
     } else { // Make sure pool has all the available descriptors before calling down chain
         skipCall |= validate_descriptor_availability_in_pool(dev_data, pPoolNode, pAllocateInfo->descriptorSetCount, pAllocateInfo->pSetLayouts);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (skipCall)
         return VK_ERROR_VALIDATION_FAILED_EXT;
     VkResult result = dev_data->device_dispatch_table->AllocateDescriptorSets(device, pAllocateInfo, pDescriptorSets);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         DESCRIPTOR_POOL_NODE *pPoolNode = getPoolNode(dev_data, pAllocateInfo->descriptorPool);
         if (pPoolNode) {
             if (pAllocateInfo->descriptorSetCount == 0) {
@@ -4969,6 +5286,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAllocateDescriptorSets(VkDevice
                     //  that the count doesn't go below 0. One reset/free need to bump count back up.
                     // Insert set at head of Set LL for this pool
                     pNewNode->pNext = pPoolNode->pSets;
+                    if (pPoolNode->pSets) {
+                        pPoolNode->pSets->pPrev = pNewNode;
+                    }
                     pNewNode->in_use.store(0);
                     pPoolNode->pSets = pNewNode;
                     LAYOUT_NODE* pLayout = getLayoutNode(dev_data, pAllocateInfo->pSetLayouts[i]);
@@ -4982,15 +5302,13 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAllocateDescriptorSets(VkDevice
                     pNewNode->set = pDescriptorSets[i];
                     pNewNode->descriptorCount = (pLayout->createInfo.bindingCount != 0) ? pLayout->endIndex + 1 : 0;
                     if (pNewNode->descriptorCount) {
-                        size_t descriptorArraySize = sizeof(GENERIC_HEADER*)*pNewNode->descriptorCount;
-                        pNewNode->ppDescriptors = new GENERIC_HEADER*[descriptorArraySize];
-                        memset(pNewNode->ppDescriptors, 0, descriptorArraySize);
+                        pNewNode->pDescriptors = pPoolNode->descriptorStorage.allocate(pNewNode->descriptorCount);
                     }
                     dev_data->setMap[pDescriptorSets[i]] = pNewNode;
                 }
             }
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -5000,7 +5318,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkFreeDescriptorSets(VkDevice dev
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     // Make sure that no sets being destroyed are in-flight
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t i=0; i<count; ++i)
         skipCall |= validateIdleDescriptorSet(dev_data, pDescriptorSets[i], "vkFreeDesriptorSets");
     DESCRIPTOR_POOL_NODE *pPoolNode = getPoolNode(dev_data, descriptorPool);
@@ -5009,27 +5327,30 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkFreeDescriptorSets(VkDevice dev
         skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT, (uint64_t)device, __LINE__, DRAWSTATE_CANT_FREE_FROM_NON_FREE_POOL, "DS",
                     "It is invalid to call vkFreeDescriptorSets() with a pool created without setting VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT.");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE != skipCall)
         return VK_ERROR_VALIDATION_FAILED_EXT;
     VkResult result = dev_data->device_dispatch_table->FreeDescriptorSets(device, descriptorPool, count, pDescriptorSets);
     if (VK_SUCCESS == result) {
-        // For each freed descriptor add it back into the pool as available
-        loader_platform_thread_lock_mutex(&globalLock);
+        // For each freed set add its descriptors back into the pool as available, then drop it
+        loader_platform_thread_write_lock_rwlock(&globalLock);
+        pPoolNode = getPoolNode(dev_data, descriptorPool);
         for (uint32_t i=0; i<count; ++i) {
-            SET_NODE* pSet = dev_data->setMap[pDescriptorSets[i]]; // getSetNode() without locking
-            invalidateBoundCmdBuffers(dev_data, pSet);
+            auto set_node = dev_data->setMap.find(pDescriptorSets[i]); // getSetNode() without locking
+            if (!pPoolNode || set_node == dev_data->setMap.end())
+                continue;
+            SET_NODE* pSet = set_node->second;
             LAYOUT_NODE* pLayout = pSet->pLayout;
             uint32_t typeIndex = 0, poolSizeCount = 0;
-            for (uint32_t j=0; j<pLayout->createInfo.bindingCount; ++j) {
+            for (uint32_t j=0; pLayout && j<pLayout->createInfo.bindingCount; ++j) {
                 typeIndex = static_cast<uint32_t>(pLayout->createInfo.pBindings[j].descriptorType);
                 poolSizeCount = pLayout->createInfo.pBindings[j].descriptorCount;
                 pPoolNode->availableDescriptorTypeCount[typeIndex] += poolSizeCount;
             }
+            freeDescriptorSet(dev_data, pPoolNode, pSet);
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
-    // TODO : Any other clean-up or book-keeping to do here?
     return result;
 }
 
@@ -5037,14 +5358,14 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkUpdateDescriptorSets(VkDevice devic
 {
     // dsUpdate will return VK_TRUE only if a bailout error occurs, so we want to call down tree when update returns VK_FALSE
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     VkBool32 rtn = dsUpdate(dev_data,
                             device,
                             descriptorWriteCount,
                             pDescriptorWrites,
                             descriptorCopyCount,
                             pDescriptorCopies);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (!rtn) {
         dev_data->device_dispatch_table->UpdateDescriptorSets(device, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount, pDescriptorCopies);
     }
@@ -5055,21 +5376,23 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAllocateCommandBuffers(VkDevice
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->AllocateCommandBuffers(device, pCreateInfo, pCommandBuffer);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         for (uint32_t i = 0; i < pCreateInfo->commandBufferCount; i++) {
             // Validate command pool
-            if (dev_data->commandPoolMap.find(pCreateInfo->commandPool) != dev_data->commandPoolMap.end()) {
-                // Add command buffer to its commandPool map
-                dev_data->commandPoolMap[pCreateInfo->commandPool].commandBuffers.push_back(pCommandBuffer[i]);
-                GLOBAL_CB_NODE* pCB = new GLOBAL_CB_NODE;
+            auto pool_data = dev_data->commandPoolMap.find(pCreateInfo->commandPool);
+            if (pool_data != dev_data->commandPoolMap.end()) {
+                // Add command buffer to its commandPool, reusing a freed node when there is one
+                GLOBAL_CB_NODE* pCB = allocateCBNode(pool_data->second);
                 // Add command buffer to map
                 dev_data->commandBufferMap[pCommandBuffer[i]] = pCB;
-                resetCB(dev_data, pCommandBuffer[i]);
+                pCB->commandBuffer = pCommandBuffer[i];
+                resetCB(dev_data, pCB);
                 pCB->createInfo    = *pCreateInfo;
                 pCB->device        = device;
+                pCB->queueFlags    = dev_data->physDevProperties.queue_family_properties[pool_data->second.queueFamilyIndex].queueFlags;
             }
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -5078,7 +5401,8 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkBeginCommandBuffer(VkCommandBuf
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    flushDeferredSubmits(dev_data);
     // Validate command buffer level
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
@@ -5157,7 +5481,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkBeginCommandBuffer(VkCommandBuf
         skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, (uint64_t)commandBuffer, __LINE__, DRAWSTATE_INVALID_COMMAND_BUFFER, "DS",
                 "In vkBeginCommandBuffer() and unable to find CommandBuffer Node for CB %p!", (void*)commandBuffer);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE != skipCall) {
         return VK_ERROR_VALIDATION_FAILED_EXT;
     }
@@ -5170,7 +5494,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffe
     VkBool32 skipCall = VK_FALSE;
     VkResult result = VK_SUCCESS;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         if (pCB->state != CB_RECORDING) {
@@ -5182,9 +5506,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffe
         }
     }
     if (VK_FALSE == skipCall) {
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
         result = dev_data->device_dispatch_table->EndCommandBuffer(commandBuffer);
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         if (VK_SUCCESS == result) {
             pCB->state = CB_RECORDED;
             // Reset CB status flags
@@ -5194,7 +5518,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffe
     } else {
         result = VK_ERROR_VALIDATION_FAILED_EXT;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     return result;
 }
 
@@ -5202,7 +5526,8 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandBuffer(VkCommandBuf
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    flushDeferredSubmits(dev_data);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
     VkCommandPool cmdPool = pCB->createInfo.commandPool;
     if (!(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT & dev_data->commandPoolMap[cmdPool].createFlags)) {
@@ -5216,14 +5541,14 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandBuffer(VkCommandBuf
                         __LINE__, DRAWSTATE_INVALID_COMMAND_BUFFER_RESET, "DS",
                         "Attempt to reset command buffer (%#" PRIxLEAST64 ") which is in use.", reinterpret_cast<uint64_t>(commandBuffer));
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (skipCall != VK_FALSE)
         return VK_ERROR_VALIDATION_FAILED_EXT;
     VkResult result = dev_data->device_dispatch_table->ResetCommandBuffer(commandBuffer, flags);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         resetCB(dev_data, commandBuffer);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -5232,8 +5557,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindPipeline(VkCommandBuffer com
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_BINDPIPELINE, "vkCmdBindPipeline()");
         if ((VK_PIPELINE_BIND_POINT_COMPUTE == pipelineBindPoint) && (pCB->activeRenderPass)) {
@@ -5248,6 +5572,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindPipeline(VkCommandBuffer com
         PIPELINE_NODE* pPN = getPipeline(dev_data, pipeline);
         if (pPN) {
             pCB->lastBoundPipeline = pipeline;
+            pCB->drawStateDirty |= CBDIRTY_PIPELINE;
             set_cb_pso_status(pCB, pPN);
             skipCall |= validatePipelineState(dev_data, pCB, pipelineBindPoint, pipeline);
         } else {
@@ -5256,7 +5581,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindPipeline(VkCommandBuffer com
                                 "Attempt to bind Pipeline %#" PRIxLEAST64 " that doesn't exist!", (uint64_t)(pipeline));
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdBindPipeline(commandBuffer, pipelineBindPoint, pipeline);
 }
@@ -5269,15 +5594,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetViewport(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETVIEWPORTSTATE, "vkCmdSetViewport()");
         pCB->status |= CBSTATUS_VIEWPORT_SET;
+        pCB->drawStateDirty |= CBDIRTY_DYNAMIC_STATE;
         pCB->viewports.resize(viewportCount);
         memcpy(pCB->viewports.data(), pViewports, viewportCount * sizeof(VkViewport));
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdSetViewport(commandBuffer, firstViewport, viewportCount, pViewports);
 }
@@ -5290,15 +5615,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetScissor(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETSCISSORSTATE, "vkCmdSetScissor()");
         pCB->status |= CBSTATUS_SCISSOR_SET;
+        pCB->drawStateDirty |= CBDIRTY_DYNAMIC_STATE;
         pCB->scissors.resize(scissorCount);
         memcpy(pCB->scissors.data(), pScissors, scissorCount * sizeof(VkRect2D));
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdSetScissor(commandBuffer, firstScissor, scissorCount, pScissors);
 }
@@ -5307,14 +5632,14 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetLineWidth(VkCommandBuffer com
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETLINEWIDTHSTATE, "vkCmdSetLineWidth()");
         pCB->status |= CBSTATUS_LINE_WIDTH_SET;
+        pCB->drawStateDirty |= CBDIRTY_DYNAMIC_STATE;
         pCB->lineWidth = lineWidth;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdSetLineWidth(commandBuffer, lineWidth);
 }
@@ -5327,16 +5652,16 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetDepthBias(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETDEPTHBIASSTATE, "vkCmdSetDepthBias()");
         pCB->status |= CBSTATUS_DEPTH_BIAS_SET;
+        pCB->drawStateDirty |= CBDIRTY_DYNAMIC_STATE;
         pCB->depthBiasConstantFactor = depthBiasConstantFactor;
         pCB->depthBiasClamp = depthBiasClamp;
         pCB->depthBiasSlopeFactor = depthBiasSlopeFactor;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdSetDepthBias(commandBuffer, depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor);
 }
@@ -5345,14 +5670,14 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetBlendConstants(VkCommandBuffe
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETBLENDSTATE, "vkCmdSetBlendConstants()");
         pCB->status |= CBSTATUS_BLEND_SET;
+        pCB->drawStateDirty |= CBDIRTY_DYNAMIC_STATE;
         memcpy(pCB->blendConstants, blendConstants, 4 * sizeof(float));
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdSetBlendConstants(commandBuffer, blendConstants);
 }
@@ -5364,15 +5689,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetDepthBounds(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETDEPTHBOUNDSSTATE, "vkCmdSetDepthBounds()");
         pCB->status |= CBSTATUS_DEPTH_BOUNDS_SET;
+        pCB->drawStateDirty |= CBDIRTY_DYNAMIC_STATE;
         pCB->minDepthBounds = minDepthBounds;
         pCB->maxDepthBounds = maxDepthBounds;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdSetDepthBounds(commandBuffer, minDepthBounds, maxDepthBounds);
 }
@@ -5384,8 +5709,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetStencilCompareMask(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETSTENCILREADMASKSTATE, "vkCmdSetStencilCompareMask()");
         if (faceMask & VK_STENCIL_FACE_FRONT_BIT) {
@@ -5397,8 +5721,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetStencilCompareMask(
         /* TODO: Do we need to track front and back separately? */
         /* TODO: We aren't capturing the faceMask, do we need to? */
         pCB->status |= CBSTATUS_STENCIL_READ_MASK_SET;
+        pCB->drawStateDirty |= CBDIRTY_DYNAMIC_STATE;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdSetStencilCompareMask(commandBuffer, faceMask, compareMask);
 }
@@ -5410,8 +5735,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetStencilWriteMask(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETSTENCILWRITEMASKSTATE, "vkCmdSetStencilWriteMask()");
         if (faceMask & VK_STENCIL_FACE_FRONT_BIT) {
@@ -5421,8 +5745,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetStencilWriteMask(
             pCB->back.writeMask = writeMask;
         }
         pCB->status |= CBSTATUS_STENCIL_WRITE_MASK_SET;
+        pCB->drawStateDirty |= CBDIRTY_DYNAMIC_STATE;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdSetStencilWriteMask(commandBuffer, faceMask, writeMask);
 }
@@ -5434,8 +5759,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetStencilReference(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETSTENCILREFERENCESTATE, "vkCmdSetStencilReference()");
         if (faceMask & VK_STENCIL_FACE_FRONT_BIT) {
@@ -5445,8 +5769,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetStencilReference(
             pCB->back.reference = reference;
         }
         pCB->status |= CBSTATUS_STENCIL_REFERENCE_SET;
+        pCB->drawStateDirty |= CBDIRTY_DYNAMIC_STATE;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdSetStencilReference(commandBuffer, faceMask, reference);
 }
@@ -5455,8 +5780,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(VkCommandBuff
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         if (pCB->state == CB_RECORDING) {
             if ((VK_PIPELINE_BIND_POINT_COMPUTE == pipelineBindPoint) && (pCB->activeRenderPass)) {
@@ -5466,6 +5790,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(VkCommandBuff
                 skipCall |= outsideRenderPass(dev_data, pCB, "vkCmdBindDescriptorSets");
             }
             if (VK_FALSE == skipCall) {
+                pCB->drawStateDirty |= CBDIRTY_DESCRIPTOR_SETS;
                 // Track total count of dynamic descriptor types to make sure we have an offset for each one
                 uint32_t totalDynamicDescriptors = 0;
                 string errorString = "";
@@ -5477,13 +5802,16 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(VkCommandBuff
                     SET_NODE* pSet = getSetNode(dev_data, pDescriptorSets[i]);
                     if (pSet) {
                         pCB->uniqueBoundSets.insert(pDescriptorSets[i]);
-                        pSet->boundCmdBuffers.insert(commandBuffer);
+                        {
+                            std::lock_guard<std::mutex> lock(boundCmdBufferLocks[layer_lock_shard((uint64_t)pDescriptorSets[i], BOUND_CMD_BUFFER_LOCK_BITS)]);
+                            pSet->boundCmdBuffers.insert(commandBuffer);
+                        }
                         pCB->lastBoundDescriptorSet = pDescriptorSets[i];
                         pCB->lastBoundPipelineLayout = layout;
                         pCB->boundDescriptorSets[i+firstSet] = pDescriptorSets[i];
                         skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t) pDescriptorSets[i], __LINE__, DRAWSTATE_NONE, "DS",
                                 "DS %#" PRIxLEAST64 " bound on pipeline %s", (uint64_t) pDescriptorSets[i], string_VkPipelineBindPoint(pipelineBindPoint));
-                        if (!pSet->pUpdateStructs && (pSet->descriptorCount != 0)) {
+                        if (!pSet->updated && (pSet->descriptorCount != 0)) {
                             skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t) pDescriptorSets[i], __LINE__, DRAWSTATE_DESCRIPTOR_SET_NOT_UPDATED, "DS",
                                     "DS %#" PRIxLEAST64 " bound but it was never updated. You may want to either update it or not bind it.", (uint64_t) pDescriptorSets[i]);
                         }
@@ -5533,7 +5861,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(VkCommandBuff
                 // For any previously bound sets, need to set them to "invalid" if they were disturbed by this update
                 if (firstSet > 0) { // Check set #s below the first bound set
                     for (uint32_t i=0; i<firstSet; ++i) {
-                        if (pCB->boundDescriptorSets[i] && !verify_set_layout_compatibility(dev_data, dev_data->setMap[pCB->boundDescriptorSets[i]], layout, i, errorString)) {
+                        if (pCB->boundDescriptorSets[i] && !verify_set_layout_compatibility(dev_data, getSetNode(dev_data, pCB->boundDescriptorSets[i]), layout, i, errorString)) {
                             skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t) pCB->boundDescriptorSets[i], __LINE__, DRAWSTATE_NONE, "DS",
                                 "DescriptorSetDS %#" PRIxLEAST64 " previously bound as set #%u was disturbed by newly bound pipelineLayout (%#" PRIxLEAST64 ")", (uint64_t) pCB->boundDescriptorSets[i], i, (uint64_t) layout);
                             pCB->boundDescriptorSets[i] = VK_NULL_HANDLE;
@@ -5542,7 +5870,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(VkCommandBuff
                 }
                 // Check if newly last bound set invalidates any remaining bound sets
                 if ((pCB->boundDescriptorSets.size()-1) > (lastSetIndex)) {
-                    if (oldFinalBoundSet && !verify_set_layout_compatibility(dev_data, dev_data->setMap[oldFinalBoundSet], layout, lastSetIndex, errorString)) {
+                    if (oldFinalBoundSet && !verify_set_layout_compatibility(dev_data, getSetNode(dev_data, oldFinalBoundSet), layout, lastSetIndex, errorString)) {
                         skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t) oldFinalBoundSet, __LINE__, DRAWSTATE_NONE, "DS",
                             "DescriptorSetDS %#" PRIxLEAST64 " previously bound as set #%u is incompatible with set %#" PRIxLEAST64 " newly bound as set #%u so set #%u and any subsequent sets were disturbed by newly bound pipelineLayout (%#" PRIxLEAST64 ")", (uint64_t) oldFinalBoundSet, lastSetIndex, (uint64_t) pCB->boundDescriptorSets[lastSetIndex], lastSetIndex, lastSetIndex+1, (uint64_t) layout);
                         pCB->boundDescriptorSets.resize(lastSetIndex+1);
@@ -5562,7 +5890,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(VkCommandBuff
             skipCall |= report_error_no_cb_begin(dev_data, commandBuffer, "vkCmdBindDescriptorSets()");
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdBindDescriptorSets(commandBuffer, pipelineBindPoint, layout, firstSet, setCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
 }
@@ -5571,8 +5899,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindIndexBuffer(VkCommandBuffer
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_BINDINDEXBUFFER, "vkCmdBindIndexBuffer()");
         VkDeviceSize offset_align = 0;
@@ -5592,8 +5919,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindIndexBuffer(VkCommandBuffer
                 "vkCmdBindIndexBuffer() offset (%#" PRIxLEAST64 ") does not fall on alignment (%s) boundary.", offset, string_VkIndexType(indexType));
         }
         pCB->status |= CBSTATUS_INDEX_BUFFER_BOUND;
+        pCB->drawStateDirty |= CBDIRTY_DYNAMIC_STATE;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdBindIndexBuffer(commandBuffer, buffer, offset, indexType);
 }
@@ -5621,15 +5949,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindVertexBuffers(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         addCmd(dev_data, pCB, CMD_BINDVERTEXBUFFER, "vkCmdBindVertexBuffer()");
         updateResourceTracking(pCB, firstBinding, bindingCount, pBuffers);
+        pCB->drawStateDirty |= CBDIRTY_VERTEX_BUFFERS;
     } else {
         skipCall |= report_error_no_cb_begin(dev_data, commandBuffer, "vkCmdBindVertexBuffer()");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdBindVertexBuffers(commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets);
 }
@@ -5638,8 +5966,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDraw(VkCommandBuffer commandBuff
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_DRAW, "vkCmdDraw()");
         pCB->drawCount[DRAW]++;
@@ -5653,7 +5980,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDraw(VkCommandBuffer commandBuff
         }
         skipCall |= outsideRenderPass(dev_data, pCB, "vkCmdDraw");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
 }
@@ -5661,8 +5988,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDraw(VkCommandBuffer commandBuff
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     VkBool32 skipCall = VK_FALSE;
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_DRAWINDEXED, "vkCmdDrawIndexed()");
@@ -5677,7 +6003,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(VkCommandBuffer comm
         }
         skipCall |= outsideRenderPass(dev_data, pCB, "vkCmdDrawIndexed");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
@@ -5685,8 +6011,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(VkCommandBuffer comm
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t count, uint32_t stride)
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     VkBool32 skipCall = VK_FALSE;
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_DRAWINDIRECT, "vkCmdDrawIndirect()");
@@ -5701,7 +6026,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndirect(VkCommandBuffer com
         }
         skipCall |= outsideRenderPass(dev_data, pCB, "vkCmdDrawIndirect");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdDrawIndirect(commandBuffer, buffer, offset, count, stride);
 }
@@ -5710,14 +6035,11 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexedIndirect(VkCommandBuf
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_DRAWINDEXEDINDIRECT, "vkCmdDrawIndexedIndirect()");
         pCB->drawCount[DRAW_INDEXED_INDIRECT]++;
-        loader_platform_thread_unlock_mutex(&globalLock);
         skipCall |= validate_draw_state(dev_data, pCB, VK_TRUE);
-        loader_platform_thread_lock_mutex(&globalLock);
         // TODO : Need to pass commandBuffer as srcObj here
         skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0, __LINE__, DRAWSTATE_NONE, "DS",
                 "vkCmdDrawIndexedIndirect() call #%" PRIu64 ", reporting DS state:", g_drawCount[DRAW_INDEXED_INDIRECT]++);
@@ -5727,7 +6049,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexedIndirect(VkCommandBuf
         }
         skipCall |= outsideRenderPass(dev_data, pCB, "vkCmdDrawIndexedIndirect");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdDrawIndexedIndirect(commandBuffer, buffer, offset, count, stride);
 }
@@ -5736,13 +6058,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDispatch(VkCommandBuffer command
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_DISPATCH, "vkCmdDispatch()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdDispatch");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdDispatch(commandBuffer, x, y, z);
 }
@@ -5751,13 +6072,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDispatchIndirect(VkCommandBuffer
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_DISPATCHINDIRECT, "vkCmdDispatchIndirect()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdDispatchIndirect");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdDispatchIndirect(commandBuffer, buffer, offset);
 }
@@ -5766,29 +6086,29 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyBuffer(VkCommandBuffer comma
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_COPYBUFFER, "vkCmdCopyBuffer()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdCopyBuffer");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, regionCount, pRegions);
 }
 
 VkBool32 VerifySourceImageLayout(VkCommandBuffer cmdBuffer, VkImage srcImage, VkImageSubresourceLayers subLayers, VkImageLayout srcImageLayout) {
+    if (checkDisabled(DRAWSTATE_INVALID_IMAGE_LAYOUT))
+        return VK_FALSE;
     VkBool32 skip_call = VK_FALSE;
 
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, cmdBuffer);
-    for (uint32_t i = 0; i < subLayers.layerCount; ++i) {
-        uint32_t layer = i + subLayers.baseArrayLayer;
-        VkImageSubresource sub = {subLayers.aspectMask, subLayers.mipLevel, layer};
-        IMAGE_CMD_BUF_NODE node;
-        if (!FindLayout(pCB, srcImage, sub, node)) {
-            SetLayout(pCB, srcImage, sub, {srcImageLayout, srcImageLayout});
-            continue;
+    VkImageSubresourceRange range = {subLayers.aspectMask, subLayers.mipLevel, 1,
+                                     subLayers.baseArrayLayer, subLayers.layerCount};
+    UpdateLayouts(dev_data, pCB, srcImage, range, [&](bool found, IMAGE_CMD_BUF_NODE &node) {
+        if (!found) {
+            node = {srcImageLayout, srcImageLayout};
+            return true;
         }
         if (node.layout != srcImageLayout) {
             // TODO: Improve log message in the next pass
@@ -5801,7 +6121,8 @@ VkBool32 VerifySourceImageLayout(VkCommandBuffer cmdBuffer, VkImage srcImage, Vk
                         string_VkImageLayout(srcImageLayout),
                         string_VkImageLayout(node.layout));
         }
-    }
+        return false;
+    });
     if (srcImageLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
         if (srcImageLayout == VK_IMAGE_LAYOUT_GENERAL) {
             // LAYOUT_GENERAL is allowed, but may not be performance optimal, flag as perf warning.
@@ -5821,17 +6142,18 @@ VkBool32 VerifySourceImageLayout(VkCommandBuffer cmdBuffer, VkImage srcImage, Vk
 }
 
 VkBool32 VerifyDestImageLayout(VkCommandBuffer cmdBuffer, VkImage destImage, VkImageSubresourceLayers subLayers, VkImageLayout destImageLayout) {
+    if (checkDisabled(DRAWSTATE_INVALID_IMAGE_LAYOUT))
+        return VK_FALSE;
     VkBool32 skip_call = VK_FALSE;
 
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, cmdBuffer);
-    for (uint32_t i = 0; i < subLayers.layerCount; ++i) {
-        uint32_t layer = i + subLayers.baseArrayLayer;
-        VkImageSubresource sub = {subLayers.aspectMask, subLayers.mipLevel, layer};
-        IMAGE_CMD_BUF_NODE node;
-        if (!FindLayout(pCB, destImage, sub, node)) {
-            SetLayout(pCB, destImage, sub, {destImageLayout, destImageLayout});
-            continue;
+    VkImageSubresourceRange range = {subLayers.aspectMask, subLayers.mipLevel, 1,
+                                     subLayers.baseArrayLayer, subLayers.layerCount};
+    UpdateLayouts(dev_data, pCB, destImage, range, [&](bool found, IMAGE_CMD_BUF_NODE &node) {
+        if (!found) {
+            node = {destImageLayout, destImageLayout};
+            return true;
         }
         if (node.layout != destImageLayout) {
             skip_call |=
@@ -5843,7 +6165,8 @@ VkBool32 VerifyDestImageLayout(VkCommandBuffer cmdBuffer, VkImage destImage, VkI
                         string_VkImageLayout(destImageLayout),
                         string_VkImageLayout(node.layout));
         }
-    }
+        return false;
+    });
     if (destImageLayout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
         if (destImageLayout == VK_IMAGE_LAYOUT_GENERAL) {
             // LAYOUT_GENERAL is allowed, but may not be performance optimal, flag as perf warning.
@@ -5871,8 +6194,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyImage(VkCommandBuffer comman
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_COPYIMAGE, "vkCmdCopyImage()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdCopyImage");
@@ -5881,7 +6203,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyImage(VkCommandBuffer comman
             skipCall |= VerifyDestImageLayout(commandBuffer, dstImage, pRegions[i].dstSubresource, dstImageLayout);
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdCopyImage(commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions);
 }
@@ -5894,13 +6216,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBlitImage(VkCommandBuffer comman
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_BLITIMAGE, "vkCmdBlitImage()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdBlitImage");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdBlitImage(commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions, filter);
 }
@@ -5912,8 +6233,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyBufferToImage(VkCommandBuffe
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_COPYBUFFERTOIMAGE, "vkCmdCopyBufferToImage()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdCopyBufferToImage");
@@ -5923,7 +6243,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyBufferToImage(VkCommandBuffe
                                                 dstImageLayout);
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdCopyBufferToImage(commandBuffer, srcBuffer, dstImage, dstImageLayout, regionCount, pRegions);
 }
@@ -5935,8 +6255,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyImageToBuffer(VkCommandBuffe
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_COPYIMAGETOBUFFER, "vkCmdCopyImageToBuffer()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdCopyImageToBuffer");
@@ -5946,7 +6265,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyImageToBuffer(VkCommandBuffe
                                                 srcImageLayout);
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdCopyImageToBuffer(commandBuffer, srcImage, srcImageLayout, dstBuffer, regionCount, pRegions);
 }
@@ -5955,13 +6274,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdUpdateBuffer(VkCommandBuffer com
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_UPDATEBUFFER, "vkCmdUpdateBuffer()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdCopyUpdateBuffer");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdUpdateBuffer(commandBuffer, dstBuffer, dstOffset, dataSize, pData);
 }
@@ -5970,13 +6288,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdFillBuffer(VkCommandBuffer comma
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_FILLBUFFER, "vkCmdFillBuffer()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdCopyFillBuffer");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdFillBuffer(commandBuffer, dstBuffer, dstOffset, size, data);
 }
@@ -5990,8 +6307,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdClearAttachments(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_CLEARATTACHMENTS, "vkCmdClearAttachments()");
         // Warn if this is issued prior to Draw Cmd and clearing the entire attachment
@@ -6007,8 +6323,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdClearAttachments(
     }
 
     // Validate that attachment is in reference list of active subpass
-    if (pCB->activeRenderPass) {
-        const VkRenderPassCreateInfo *pRPCI = dev_data->renderPassMap[pCB->activeRenderPass]->pCreateInfo;
+    auto render_pass = (pCB && pCB->activeRenderPass) ? dev_data->renderPassMap.find(pCB->activeRenderPass) : dev_data->renderPassMap.end();
+    if (pCB && pCB->activeRenderPass && render_pass == dev_data->renderPassMap.end()) {
+        skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_RENDER_PASS_EXT, (uint64_t) pCB->activeRenderPass, __LINE__, DRAWSTATE_INVALID_RENDERPASS, "DS",
+                "vkCmdClearAttachments() issued on CB object 0x%" PRIxLEAST64 " within invalid RenderPass (%#" PRIxLEAST64 ").", (uint64_t)(commandBuffer), (uint64_t) pCB->activeRenderPass);
+    } else if (render_pass != dev_data->renderPassMap.end()) {
+        const VkRenderPassCreateInfo *pRPCI = render_pass->second->pCreateInfo;
         const VkSubpassDescription   *pSD   = &pRPCI->pSubpasses[pCB->activeSubpass];
 
         for (uint32_t attachment_idx = 0; attachment_idx < attachmentCount; attachment_idx++) {
@@ -6041,7 +6361,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdClearAttachments(
             }
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdClearAttachments(commandBuffer, attachmentCount, pAttachments, rectCount, pRects);
 }
@@ -6054,13 +6374,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdClearColorImage(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_CLEARCOLORIMAGE, "vkCmdClearColorImage()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdClearColorImage");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdClearColorImage(commandBuffer, image, imageLayout, pColor, rangeCount, pRanges);
 }
@@ -6074,13 +6393,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdClearDepthStencilImage(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_CLEARDEPTHSTENCILIMAGE, "vkCmdClearDepthStencilImage()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdClearDepthStencilImage");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdClearDepthStencilImage(commandBuffer, image, imageLayout, pDepthStencil, rangeCount, pRanges);
 }
@@ -6092,13 +6410,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdResolveImage(VkCommandBuffer com
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_RESOLVEIMAGE, "vkCmdResolveImage()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdResolveImage");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdResolveImage(commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions);
 }
@@ -6107,15 +6424,14 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetEvent(VkCommandBuffer command
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETEVENT, "vkCmdSetEvent()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdSetEvent");
         pCB->events.push_back(event);
         pCB->eventToStageMap[event] = stageMask;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdSetEvent(commandBuffer, event, stageMask);
 }
@@ -6124,19 +6440,20 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdResetEvent(VkCommandBuffer comma
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_RESETEVENT, "vkCmdResetEvent()");
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdResetEvent");
         pCB->events.push_back(event);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdResetEvent(commandBuffer, event, stageMask);
 }
 
 VkBool32 TransitionImageLayouts(VkCommandBuffer cmdBuffer, uint32_t memBarrierCount, const VkImageMemoryBarrier* pImgMemBarriers) {
+    if (checkDisabled(DRAWSTATE_INVALID_IMAGE_LAYOUT))
+        return VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, cmdBuffer);
     VkBool32 skip = VK_FALSE;
@@ -6145,39 +6462,28 @@ VkBool32 TransitionImageLayouts(VkCommandBuffer cmdBuffer, uint32_t memBarrierCo
         auto mem_barrier = &pImgMemBarriers[i];
         if (!mem_barrier)
             continue;
-        // TODO: Do not iterate over every possibility - consolidate where
-        // possible
-        for (uint32_t j = 0; j < mem_barrier->subresourceRange.levelCount;
-             j++) {
-            uint32_t level = mem_barrier->subresourceRange.baseMipLevel + j;
-            for (uint32_t k = 0; k < mem_barrier->subresourceRange.layerCount;
-                 k++) {
-                uint32_t layer =
-                    mem_barrier->subresourceRange.baseArrayLayer + k;
-                VkImageSubresource sub = {
-                    mem_barrier->subresourceRange.aspectMask, level, layer};
-                IMAGE_CMD_BUF_NODE node;
-                if (!FindLayout(pCB, mem_barrier->image, sub, node)) {
-                    SetLayout(pCB, mem_barrier->image, sub,
-                              {mem_barrier->oldLayout, mem_barrier->newLayout});
-                    continue;
-                }
-                if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
-                    // TODO: Set memory invalid which is in mem_tracker currently
-                }
-                else if (node.layout != mem_barrier->oldLayout) {
-                    skip |= log_msg(
-                        dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                        (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
-                        DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
-                        "You cannot transition the layout from %s "
-                        "when current layout is %s.",
-                        string_VkImageLayout(mem_barrier->oldLayout),
-                        string_VkImageLayout(node.layout));
-                }
-                SetLayout(pCB, mem_barrier->image, sub, mem_barrier->newLayout);
+        UpdateLayouts(dev_data, pCB, mem_barrier->image, mem_barrier->subresourceRange,
+                      [&](bool found, IMAGE_CMD_BUF_NODE &node) {
+            if (!found) {
+                node = {mem_barrier->oldLayout, mem_barrier->newLayout};
+                return true;
             }
-        }
+            if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+                // TODO: Set memory invalid which is in mem_tracker currently
+            }
+            else if (node.layout != mem_barrier->oldLayout) {
+                skip |= log_msg(
+                    dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                    (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
+                    DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
+                    "You cannot transition the layout from %s "
+                    "when current layout is %s.",
+                    string_VkImageLayout(mem_barrier->oldLayout),
+                    string_VkImageLayout(node.layout));
+            }
+            node.layout = mem_barrier->newLayout;
+            return true;
+        });
     }
     return skip;
 }
@@ -6298,7 +6604,11 @@ VkBool32 ValidateBarriers(VkCommandBuffer cmdBuffer, uint32_t memBarrierCount,
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, cmdBuffer);
     if (pCB->activeRenderPass && memBarrierCount) {
-        if (!dev_data->renderPassMap[pCB->activeRenderPass]->hasSelfDependency[pCB->activeSubpass]) {
+        auto render_pass = dev_data->renderPassMap.find(pCB->activeRenderPass);
+        if (render_pass == dev_data->renderPassMap.end()) {
+            skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_RENDER_PASS_EXT, (uint64_t) pCB->activeRenderPass, __LINE__, DRAWSTATE_INVALID_RENDERPASS, "DS",
+                                 "Barriers set within invalid RenderPass (%#" PRIxLEAST64 ").", (uint64_t) pCB->activeRenderPass);
+        } else if (!render_pass->second->hasSelfDependency[pCB->activeSubpass]) {
             skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__, DRAWSTATE_INVALID_BARRIER, "DS",
                                  "Barriers cannot be set during subpass %d with no self dependency specified.", pCB->activeSubpass);
         }
@@ -6372,8 +6682,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdWaitEvents(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         VkPipelineStageFlags stageMask = 0;
         for (uint32_t i = 0; i < eventCount; ++i) {
@@ -6413,12 +6722,13 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdWaitEvents(
             skipCall |= report_error_no_cb_begin(dev_data, commandBuffer, "vkCmdWaitEvents()");
         }
         skipCall |= TransitionImageLayouts(commandBuffer, imageMemoryBarrierCount, pImageMemoryBarriers);
-        skipCall |=
-            ValidateBarriers(commandBuffer, memoryBarrierCount, pMemoryBarriers,
-                             bufferMemoryBarrierCount, pBufferMemoryBarriers,
-                             imageMemoryBarrierCount, pImageMemoryBarriers);
+        if (!checkDisabled(DRAWSTATE_INVALID_BARRIER))
+            skipCall |=
+                ValidateBarriers(commandBuffer, memoryBarrierCount, pMemoryBarriers,
+                                 bufferMemoryBarrierCount, pBufferMemoryBarriers,
+                                 imageMemoryBarrierCount, pImageMemoryBarriers);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdWaitEvents(commandBuffer, eventCount, pEvents, sourceStageMask, dstStageMask,
                                                        memoryBarrierCount, pMemoryBarriers,
@@ -6435,17 +6745,17 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdPipelineBarrier(
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_PIPELINEBARRIER, "vkCmdPipelineBarrier()");
         skipCall |= TransitionImageLayouts(commandBuffer, imageMemoryBarrierCount, pImageMemoryBarriers);
-        skipCall |=
-            ValidateBarriers(commandBuffer, memoryBarrierCount, pMemoryBarriers,
-                             bufferMemoryBarrierCount, pBufferMemoryBarriers,
-                             imageMemoryBarrierCount, pImageMemoryBarriers);
+        if (!checkDisabled(DRAWSTATE_INVALID_BARRIER))
+            skipCall |=
+                ValidateBarriers(commandBuffer, memoryBarrierCount, pMemoryBarriers,
+                                 bufferMemoryBarrierCount, pBufferMemoryBarriers,
+                                 imageMemoryBarrierCount, pImageMemoryBarriers);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, dependencyFlags,
                                                             memoryBarrierCount, pMemoryBarriers,
@@ -6457,8 +6767,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBeginQuery(VkCommandBuffer comma
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         QueryObject query = {queryPool, slot};
         pCB->activeQueries.insert(query);
@@ -6467,7 +6776,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBeginQuery(VkCommandBuffer comma
         }
         skipCall |= addCmd(dev_data, pCB, CMD_BEGINQUERY, "vkCmdBeginQuery()");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdBeginQuery(commandBuffer, queryPool, slot, flags);
 }
@@ -6476,8 +6785,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdEndQuery(VkCommandBuffer command
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         QueryObject query = {queryPool, slot};
         if (!pCB->activeQueries.count(query)) {
@@ -6493,7 +6801,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdEndQuery(VkCommandBuffer command
             skipCall |= report_error_no_cb_begin(dev_data, commandBuffer, "vkCmdEndQuery()");
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdEndQuery(commandBuffer, queryPool, slot);
 }
@@ -6502,8 +6810,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdResetQueryPool(VkCommandBuffer c
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         for (uint32_t i = 0; i < queryCount; i++) {
             QueryObject query = {queryPool, firstQuery + i};
@@ -6517,7 +6824,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdResetQueryPool(VkCommandBuffer c
         }
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdQueryPool");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdResetQueryPool(commandBuffer, queryPool, firstQuery, queryCount);
 }
@@ -6528,8 +6835,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyQueryPoolResults(VkCommandBu
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         for (uint32_t i = 0; i < queryCount; i++) {
             QueryObject query = {queryPool, firstQuery + i};
@@ -6545,7 +6851,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyQueryPoolResults(VkCommandBu
         }
         skipCall |= insideRenderPass(dev_data, pCB, "vkCmdCopyQueryPoolResults");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdCopyQueryPoolResults(commandBuffer, queryPool,
                            firstQuery, queryCount, dstBuffer, dstOffset, stride, flags);
@@ -6555,8 +6861,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdWriteTimestamp(VkCommandBuffer c
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (pCB) {
         QueryObject query = {queryPool, slot};
         pCB->queryToStateMap[query] = 1;
@@ -6566,7 +6871,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdWriteTimestamp(VkCommandBuffer c
             skipCall |= report_error_no_cb_begin(dev_data, commandBuffer, "vkCmdWriteTimestamp()");
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdWriteTimestamp(commandBuffer, pipelineStage, queryPool, slot);
 }
@@ -6582,9 +6887,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateFramebuffer(VkDevice devi
             localFBCI->pAttachments = new VkImageView[localFBCI->attachmentCount];
             memcpy((void*)localFBCI->pAttachments, pCreateInfo->pAttachments, localFBCI->attachmentCount*sizeof(VkImageView));
         }
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->frameBufferMap[*pFramebuffer] = localFBCI;
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -6800,7 +7105,71 @@ VkBool32 CreatePassDAG(const layer_data* my_data, VkDevice device, const VkRende
     }
     return skip_call;
 }
-// TODOSC : Add intercept of vkCreateShaderModule
+// Process-wide cache of analyzed modules keyed by a hash of their SPIR-V. Apps tend to create
+//  the same shaders again, on the same or another device and often after destroying the first
+//  VkShaderModule, and the module analysis (def_index, entrypoints, interfaces, descriptor uses)
+//  only depends on the words. The cache holds its analyses strongly and evicts the least
+//  recently used once their SPIR-V exceeds shaderModuleCacheLimit bytes. Guarded by globalLock.
+struct shader_module_cache_entry {
+    uint64_t hash;
+    shared_ptr<shader_module> module;
+};
+static list<shader_module_cache_entry> shaderModuleLRU; // Most recently used first
+static unordered_multimap<uint64_t, list<shader_module_cache_entry>::iterator> shaderModuleCache;
+static size_t shaderModuleCacheBytes = 0;
+
+// 64-bit FNV-1a over the SPIR-V words
+static uint64_t hash_spirv(uint32_t const *words, size_t count)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < count; i++) {
+        hash ^= words[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void evict_shader_module(list<shader_module_cache_entry>::iterator entry)
+{
+    auto range = shaderModuleCache.equal_range(entry->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == entry) {
+            shaderModuleCache.erase(it);
+            break;
+        }
+    }
+    shaderModuleCacheBytes -= entry->module->words.size() * sizeof(uint32_t);
+    shaderModuleLRU.erase(entry);
+}
+
+// Return the cached analysis for this SPIR-V, creating it on first use
+static shared_ptr<shader_module> get_shader_module(VkShaderModuleCreateInfo const *pCreateInfo)
+{
+    uint32_t const *words = (uint32_t const *)pCreateInfo->pCode;
+    size_t count = pCreateInfo->codeSize / sizeof(uint32_t);
+    uint64_t hash = hash_spirv(words, count);
+
+    auto range = shaderModuleCache.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        shared_ptr<shader_module> const &cached = it->second->module;
+        if (cached->words.size() == count && std::equal(words, words + count, cached->words.begin())) {
+            shaderModuleLRU.splice(shaderModuleLRU.begin(), shaderModuleLRU, it->second);
+            return cached;
+        }
+    }
+
+    shared_ptr<shader_module> module = make_shared<shader_module>(pCreateInfo);
+    size_t bytes = count * sizeof(uint32_t);
+    if (bytes <= shaderModuleCacheLimit) {
+        shaderModuleLRU.push_front(shader_module_cache_entry{hash, module});
+        shaderModuleCache.insert(std::make_pair(hash, shaderModuleLRU.begin()));
+        shaderModuleCacheBytes += bytes;
+        while (shaderModuleCacheBytes > shaderModuleCacheLimit) {
+            evict_shader_module(std::prev(shaderModuleLRU.end()));
+        }
+    }
+    return module;
+}
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateShaderModule(
         VkDevice device,
@@ -6822,9 +7191,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateShaderModule(
     VkResult res = my_data->device_dispatch_table->CreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
 
     if (res == VK_SUCCESS) {
-        loader_platform_thread_lock_mutex(&globalLock);
-        my_data->shaderModuleMap[*pShaderModule] = new shader_module(pCreateInfo);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
+        my_data->shaderModuleMap[*pShaderModule] = get_shader_module(pCreateInfo);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return res;
 }
@@ -6833,7 +7202,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateRenderPass(VkDevice devic
 {
     VkBool32 skip_call = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     // Create DAG
     std::vector<bool> has_self_dependency(pCreateInfo->subpassCount);
     std::vector<DAGNode> subpass_to_node(pCreateInfo->subpassCount);
@@ -6844,10 +7213,10 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateRenderPass(VkDevice devic
     if (VK_FALSE != skip_call) {
         return VK_ERROR_VALIDATION_FAILED_EXT;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     VkResult result = dev_data->device_dispatch_table->CreateRenderPass(device, pCreateInfo, pAllocator, pRenderPass);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         // TODOSC : Merge in tracking of renderpass from shader_checker
         // Shadow create info and store in map
         VkRenderPassCreateInfo* localRPCI = new VkRenderPassCreateInfo(*pCreateInfo);
@@ -6901,7 +7270,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateRenderPass(VkDevice devic
         }
         dev_data->renderPassMap[*pRenderPass] = new RENDER_PASS_NODE(localRPCI);
         dev_data->renderPassMap[*pRenderPass]->hasSelfDependency = has_self_dependency;
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -6946,35 +7315,32 @@ VkBool32 VerifyFramebufferAndRenderPassLayouts(VkCommandBuffer cmdBuffer, const
         skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__, DRAWSTATE_INVALID_RENDERPASS, "DS",
                              "You cannot start a render pass using a framebuffer with a different number of attachments.");
     }
+    if (checkDisabled(DRAWSTATE_INVALID_IMAGE_LAYOUT))
+        return skip_call;
     for (uint32_t i = 0; i < pRenderPassInfo->attachmentCount; ++i) {
         const VkImageView& image_view = pFramebufferInfo->pAttachments[i];
         auto image_data = dev_data->imageViewMap.find(image_view);
         assert(image_data != dev_data->imageViewMap.end());
-        const VkImage& image = image_data->second->image;
-        const VkImageSubresourceRange& subRange = image_data->second->subresourceRange;
         IMAGE_CMD_BUF_NODE newNode = {pRenderPassInfo->pAttachments[i].initialLayout, pRenderPassInfo->pAttachments[i].initialLayout};
-        // TODO: Do not iterate over every possibility - consolidate where possible
-        for (uint32_t j = 0; j < subRange.levelCount; j++) {
-            uint32_t level = subRange.baseMipLevel + j;
-            for (uint32_t k = 0; k < subRange.layerCount; k++) {
-                uint32_t layer = subRange.baseArrayLayer + k;
-                VkImageSubresource sub = {subRange.aspectMask, level, layer};
-                IMAGE_CMD_BUF_NODE node;
-                if (!FindLayout(pCB, image, sub, node)) {
-                    SetLayout(pCB, image, sub, newNode);
-                    continue;
-                }
-                if (newNode.layout != node.layout) {
-                    skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__, DRAWSTATE_INVALID_RENDERPASS, "DS",
-                                 "You cannot start a render pass using attachment %i where the intial layout differs from the starting layout.", i);
-                }
+        UpdateLayouts(dev_data, pCB, image_data->second->image, image_data->second->subresourceRange,
+                      [&](bool found, IMAGE_CMD_BUF_NODE &node) {
+            if (!found) {
+                node = newNode;
+                return true;
             }
-        }
+            if (newNode.layout != node.layout) {
+                skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__, DRAWSTATE_INVALID_RENDERPASS, "DS",
+                             "You cannot start a render pass using attachment %i where the intial layout differs from the starting layout.", i);
+            }
+            return false;
+        });
     }
     return skip_call;
 }
 
 void TransitionSubpassLayouts(VkCommandBuffer cmdBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, const int subpass_index) {
+    if (checkDisabled(DRAWSTATE_INVALID_IMAGE_LAYOUT))
+        return;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, cmdBuffer);
     auto render_pass_data = dev_data->renderPassMap.find(pRenderPassBegin->renderPass);
@@ -7016,6 +7382,8 @@ VkBool32 validatePrimaryCommandBuffer(const layer_data* my_data, const GLOBAL_CB
 }
 
 void TransitionFinalSubpassLayouts(VkCommandBuffer cmdBuffer, const VkRenderPassBeginInfo* pRenderPassBegin) {
+    if (checkDisabled(DRAWSTATE_INVALID_IMAGE_LAYOUT))
+        return;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, cmdBuffer);
     auto render_pass_data = dev_data->renderPassMap.find(pRenderPassBegin->renderPass);
@@ -7039,7 +7407,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(VkCommandBuffer
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         if (pRenderPassBegin && pRenderPassBegin->renderPass) {
@@ -7058,14 +7426,14 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(VkCommandBuffer
                     "You cannot use a NULL RenderPass object in vkCmdBeginRenderPass()");
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         dev_data->device_dispatch_table->CmdBeginRenderPass(commandBuffer, pRenderPassBegin, contents);
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         // This is a shallow copy as that is all that is needed for now
         dev_data->renderPassBeginInfo = *pRenderPassBegin;
         dev_data->currentSubpass = 0;
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
 }
 
@@ -7073,7 +7441,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdNextSubpass(VkCommandBuffer comm
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
     TransitionSubpassLayouts(commandBuffer, &dev_data->renderPassBeginInfo, ++dev_data->currentSubpass);
     if (pCB) {
@@ -7087,7 +7455,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdNextSubpass(VkCommandBuffer comm
         }
         skipCall |= outsideRenderPass(dev_data, pCB, "vkCmdNextSubpass");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdNextSubpass(commandBuffer, contents);
 }
@@ -7096,7 +7464,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdEndRenderPass(VkCommandBuffer co
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
     TransitionFinalSubpassLayouts(commandBuffer, &dev_data->renderPassBeginInfo);
     if (pCB) {
@@ -7107,7 +7475,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdEndRenderPass(VkCommandBuffer co
         pCB->activeRenderPass = 0;
         pCB->activeSubpass = 0;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdEndRenderPass(commandBuffer);
 }
@@ -7313,7 +7681,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdExecuteCommands(VkCommandBuffer
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         GLOBAL_CB_NODE* pSubCB = NULL;
@@ -7399,12 +7767,14 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdExecuteCommands(VkCommandBuffer
         skipCall |= validatePrimaryCommandBuffer(dev_data, pCB, "vkCmdExecuteComands");
         skipCall |= addCmd(dev_data, pCB, CMD_EXECUTECOMMANDS, "vkCmdExecuteComands()");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall)
         dev_data->device_dispatch_table->CmdExecuteCommands(commandBuffer, commandBuffersCount, pCommandBuffers);
 }
 
 VkBool32 ValidateMapImageLayouts(VkDevice device, VkDeviceMemory mem) {
+    if (checkDisabled(DRAWSTATE_INVALID_IMAGE_LAYOUT))
+        return VK_FALSE;
     VkBool32 skip_call = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     auto mem_data = dev_data->memImageMap.find(mem);
@@ -7439,9 +7809,10 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory(
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     VkBool32 skip_call = VK_FALSE;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    flushDeferredSubmits(dev_data);
     skip_call = ValidateMapImageLayouts(device, mem);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     if (VK_FALSE == skip_call) {
         return dev_data->device_dispatch_table->MapMemory(device, mem, offset, size, flags, ppData);
@@ -7457,19 +7828,19 @@ VKAPI_ATTR VkResult VKAPI_CALL vkBindImageMemory(
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->BindImageMemory(device, image, mem, memOffset);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     dev_data->memImageMap[mem] = image;
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     return result;
 }
 
 
 VKAPI_ATTR VkResult VKAPI_CALL vkSetEvent(VkDevice device, VkEvent event) {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     dev_data->eventMap[event].needsSignaled = false;
     dev_data->eventMap[event].stageMask = VK_PIPELINE_STAGE_HOST_BIT;
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     VkResult result = dev_data->device_dispatch_table->SetEvent(device, event);
     return result;
 }
@@ -7483,7 +7854,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkQueueBindSparse(
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkBool32 skip_call = VK_FALSE;
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t bindIdx=0; bindIdx < bindInfoCount; ++bindIdx) {
         const VkBindSparseInfo& bindInfo = pBindInfo[bindIdx];
         for (uint32_t i=0; i < bindInfo.waitSemaphoreCount; ++i) {
@@ -7500,7 +7871,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkQueueBindSparse(
             dev_data->semaphoreMap[bindInfo.pSignalSemaphores[i]].signaled = 1;
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     if (VK_FALSE == skip_call)
         return dev_data->device_dispatch_table->QueueBindSparse(queue, bindInfoCount, pBindInfo, fence);
@@ -7517,10 +7888,10 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateSemaphore(
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateSemaphore(device, pCreateInfo, pAllocator, pSemaphore);
     if (result == VK_SUCCESS) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->semaphoreMap[*pSemaphore].signaled = 0;
         dev_data->semaphoreMap[*pSemaphore].in_use.store(0);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -7536,9 +7907,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateSwapchainKHR(
 
     if (VK_SUCCESS == result) {
         SWAPCHAIN_NODE *swapchain_data = new SWAPCHAIN_NODE(pCreateInfo);
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         dev_data->device_extensions.swapchainMap[*pSwapchain] = swapchain_data;
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
 
     return result;
@@ -7551,29 +7922,18 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroySwapchainKHR(
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     auto swapchain_data = dev_data->device_extensions.swapchainMap.find(swapchain);
     if (swapchain_data != dev_data->device_extensions.swapchainMap.end()) {
         if (swapchain_data->second->images.size() > 0) {
             for (auto swapchain_image : swapchain_data->second->images) {
-                auto image_sub =
-                    dev_data->imageSubresourceMap.find(swapchain_image);
-                if (image_sub != dev_data->imageSubresourceMap.end()) {
-                    for (auto imgsubpair : image_sub->second) {
-                        auto image_item =
-                            dev_data->imageLayoutMap.find(imgsubpair);
-                        if (image_item != dev_data->imageLayoutMap.end()) {
-                            dev_data->imageLayoutMap.erase(image_item);
-                        }
-                    }
-                    dev_data->imageSubresourceMap.erase(image_sub);
-                }
+                dev_data->imageLayoutMap.erase(swapchain_image);
             }
         }
         delete swapchain_data->second;
         dev_data->device_extensions.swapchainMap.erase(swapchain);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     dev_data->device_dispatch_table->DestroySwapchainKHR(device, swapchain, pAllocator);
 }
 
@@ -7589,20 +7949,13 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetSwapchainImagesKHR(
     if (result == VK_SUCCESS && pSwapchainImages != NULL) {
         // This should never happen and is checked by param checker.
         if (!pCount) return result;
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         for (uint32_t i = 0; i < *pCount; ++i) {
-            IMAGE_NODE image_node;
-            image_node.layout = VK_IMAGE_LAYOUT_UNDEFINED;
             auto swapchain_node = dev_data->device_extensions.swapchainMap[swapchain];
-            image_node.format = swapchain_node->createInfo.imageFormat;
             swapchain_node->images.push_back(pSwapchainImages[i]);
-            ImageSubresourcePair subpair = {pSwapchainImages[i], false,
-                                            VkImageSubresource()};
-            dev_data->imageSubresourceMap[pSwapchainImages[i]].push_back(
-                subpair);
-            dev_data->imageLayoutMap[subpair] = image_node;
+            SetLayout(dev_data, pSwapchainImages[i], VK_IMAGE_LAYOUT_UNDEFINED);
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -7613,7 +7966,8 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(VkQueue queue,
     VkBool32 skip_call = VK_FALSE;
 
     if (pPresentInfo) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
+        flushDeferredSubmits(dev_data);
         for (uint32_t i=0; i < pPresentInfo->waitSemaphoreCount; ++i) {
             if (dev_data->semaphoreMap[pPresentInfo->pWaitSemaphores[i]]
                     .signaled) {
@@ -7652,7 +8006,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(VkQueue queue,
                 }
             }
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
 
     if (VK_FALSE == skip_call)
@@ -7670,10 +8024,10 @@ VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(
 {
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->AcquireNextImageKHR(device, swapchain, timeout, semaphore, fence, pImageIndex);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     // FIXME/TODO: Need to add some thing code the "fence" parameter
     dev_data->semaphoreMap[semaphore].signaled = 1;
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     return result;
 }
 
@@ -7687,9 +8041,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDebugReportCallbackEXT(
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     VkResult res = pTable->CreateDebugReportCallbackEXT(instance, pCreateInfo, pAllocator, pMsgCallback);
     if (VK_SUCCESS == res) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         res = layer_create_msg_callback(my_data->report_data, pCreateInfo, pAllocator, pMsgCallback);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return res;
 }
@@ -7702,9 +8056,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDebugReportCallbackEXT(
     layer_data* my_data = get_my_data_ptr(get_dispatch_key(instance), layer_data_map);
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     pTable->DestroyDebugReportCallbackEXT(instance, msgCallback, pAllocator);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     layer_destroy_msg_callback(my_data->report_data, msgCallback, pAllocator);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDebugReportMessageEXT(
@@ -7725,16 +8079,16 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDbgMarkerBegin(VkCommandBuffer c
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (!dev_data->device_extensions.debug_marker_enabled) {
         skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, (uint64_t)commandBuffer, __LINE__, DRAWSTATE_INVALID_EXTENSION, "DS",
                 "Attempt to use CmdDbgMarkerBegin but extension disabled!");
+        unlockCBForRecording(pCB);
         return;
     } else if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_DBGMARKERBEGIN, "vkCmdDbgMarkerBegin()");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         debug_marker_dispatch_table(commandBuffer)->CmdDbgMarkerBegin(commandBuffer, pMarker);
 }
@@ -7743,16 +8097,16 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDbgMarkerEnd(VkCommandBuffer com
 {
     VkBool32 skipCall = VK_FALSE;
     layer_data* dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
-    GLOBAL_CB_NODE* pCB = getCBNode(dev_data, commandBuffer);
+    GLOBAL_CB_NODE* pCB = lockCBForRecording(dev_data, commandBuffer);
     if (!dev_data->device_extensions.debug_marker_enabled) {
         skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, (uint64_t)commandBuffer, __LINE__, DRAWSTATE_INVALID_EXTENSION, "DS",
                 "Attempt to use CmdDbgMarkerEnd but extension disabled!");
+        unlockCBForRecording(pCB);
         return;
     } else if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_DBGMARKEREND, "vkCmdDbgMarkerEnd()");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCB);
     if (VK_FALSE == skipCall)
         debug_marker_dispatch_table(commandBuffer)->CmdDbgMarkerEnd(commandBuffer);
 }
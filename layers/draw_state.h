@@ -32,6 +32,9 @@
 #include <atomic>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <algorithm>
+#include <functional>
 
 using std::vector;
 
@@ -301,16 +304,117 @@ typedef struct _SAMPLER_NODE {
     _SAMPLER_NODE(const VkSampler* ps, const VkSamplerCreateInfo* pci) : sampler(*ps), createInfo(*pci) {};
 } SAMPLER_NODE;
 
-typedef struct _IMAGE_NODE {
-    VkImageLayout layout;
-    VkFormat      format;
-} IMAGE_NODE;
-
 typedef struct _IMAGE_CMD_BUF_NODE {
     VkImageLayout initialLayout;
     VkImageLayout layout;
 } IMAGE_CMD_BUF_NODE;
 
+inline bool operator==(const IMAGE_CMD_BUF_NODE& node1, const IMAGE_CMD_BUF_NODE& node2) {
+    return node1.initialLayout == node2.initialLayout && node1.layout == node2.layout;
+}
+
+// Per-subresource state of one image, stored for each (aspectMask, mipLevel) in use as
+//  sorted runs of array layers, with adjacent runs of equal value merged. Barriers and
+//  copies over a range of layers then cost one step per run instead of one per layer.
+//  Subresources outside any run take 'whole' when hasWhole is set.
+template <typename T>
+class subresource_range_map {
+  public:
+    struct layer_run {
+        uint32_t begin; // first array layer
+        uint32_t end;   // one past the last array layer
+        T value;
+    };
+    struct level_runs {
+        VkImageAspectFlags aspectMask;
+        uint32_t mipLevel;
+        vector<layer_run> runs;
+    };
+
+    bool hasWhole;
+    T whole;
+    vector<level_runs> levels;
+
+    subresource_range_map() : hasWhole(false), whole() {}
+
+    void set_whole(const T& value) {
+        hasWhole = true;
+        whole = value;
+    }
+
+    // Split [begin, end) of one mip level into pieces that are each either inside a single
+    //  run or outside all runs, and call fn(found, value) on each. 'found' is false outside
+    //  the runs, where 'value' starts value-initialized. If fn returns true, the piece is
+    //  stored with the value fn left in it.
+    template <typename Fn>
+    void update(VkImageAspectFlags aspectMask, uint32_t mipLevel, uint32_t begin, uint32_t end, Fn fn) {
+        vector<layer_run>& runs = runs_of(aspectMask, mipLevel);
+        vector<std::pair<bool, layer_run> > pieces;
+        uint32_t pos = begin;
+        for (auto it = first_ending_after(runs, begin); it != runs.end() && it->begin < end; ++it) {
+            if (it->begin > pos) {
+                pieces.push_back(std::make_pair(false, layer_run{pos, it->begin, T()}));
+            }
+            pos = std::min(it->end, end);
+            pieces.push_back(std::make_pair(true, layer_run{std::max(it->begin, begin), pos, it->value}));
+        }
+        if (pos < end) {
+            pieces.push_back(std::make_pair(false, layer_run{pos, end, T()}));
+        }
+        for (auto& piece : pieces) {
+            if (fn(piece.first, piece.second.value)) {
+                set(aspectMask, mipLevel, piece.second.begin, piece.second.end, piece.second.value);
+            }
+        }
+    }
+
+    // Store value for array layers [begin, end) of one mip level
+    void set(VkImageAspectFlags aspectMask, uint32_t mipLevel, uint32_t begin, uint32_t end, const T& value) {
+        vector<layer_run>& runs = runs_of(aspectMask, mipLevel);
+        auto first = first_ending_after(runs, begin);
+        auto last = first;
+        while (last != runs.end() && last->begin < end)
+            ++last;
+        // Keep the parts of the overlapped runs that stick out on either side
+        layer_run replacement[3];
+        size_t count = 0;
+        if (first != last && first->begin < begin)
+            replacement[count++] = layer_run{first->begin, begin, first->value};
+        replacement[count++] = layer_run{begin, end, value};
+        if (first != last && (last - 1)->end > end)
+            replacement[count++] = layer_run{end, (last - 1)->end, (last - 1)->value};
+        size_t index = runs.erase(first, last) - runs.begin();
+        runs.insert(runs.begin() + index, replacement, replacement + count);
+        // Merge the new runs with each other and with their neighbours
+        size_t i = index ? index - 1 : 0;
+        size_t stop = std::min(index + count + 1, runs.size());
+        while (i + 1 < stop) {
+            if (runs[i].end == runs[i + 1].begin && runs[i].value == runs[i + 1].value) {
+                runs[i].end = runs[i + 1].end;
+                runs.erase(runs.begin() + i + 1);
+                --stop;
+            } else {
+                ++i;
+            }
+        }
+    }
+
+  private:
+    vector<layer_run>& runs_of(VkImageAspectFlags aspectMask, uint32_t mipLevel) {
+        for (auto& level : levels) {
+            if (level.aspectMask == aspectMask && level.mipLevel == mipLevel)
+                return level.runs;
+        }
+        levels.push_back(level_runs{aspectMask, mipLevel, vector<layer_run>()});
+        return levels.back().runs;
+    }
+
+    static typename vector<layer_run>::iterator first_ending_after(vector<layer_run>& runs, uint32_t layer) {
+        return std::lower_bound(runs.begin(), runs.end(), layer,
+                                [](const layer_run& run, uint32_t l) { return run.end <= l; });
+    }
+};
+
 class BUFFER_NODE : public BASE_NODE {
   public:
     using BASE_NODE::in_use;
@@ -418,20 +522,89 @@ struct PIPELINE_LAYOUT_NODE {
     vector<VkPushConstantRange>    pushConstantRanges;
 };
 
+// One descriptor of a set as last written by vkUpdateDescriptorSets, indexed like
+//  LAYOUT_NODE::descriptorTypes. Which member of the union is valid follows type.
+typedef struct _DESCRIPTOR_NODE {
+    VkBool32                   updated;
+    VkDescriptorType           type;
+    union {
+        VkDescriptorImageInfo  imageInfo;       // sampler, image and input attachment types
+        VkBufferView           texelBufferView; // texel buffer types
+        VkDescriptorBufferInfo bufferInfo;      // uniform and storage buffer types
+    };
+} DESCRIPTOR_NODE;
+
+// Backing store for the DESCRIPTOR_NODE arrays of one pool's sets. Sets are carved off
+//  in allocation order. Freed arrays are binned by size for the next set of the same
+//  size, and resetting the pool rewinds the arena, so memory stays at the pool's peak.
+class descriptor_arena {
+  public:
+    descriptor_arena() : current(0) {};
+
+    DESCRIPTOR_NODE* allocate(uint32_t count) {
+        DESCRIPTOR_NODE* pNodes = NULL;
+        auto bin = freeBins.find(count);
+        if (bin != freeBins.end() && !bin->second.empty()) {
+            pNodes = bin->second.back();
+            bin->second.pop_back();
+        } else {
+            while (current < chunks.size() && chunks[current].capacity - chunks[current].used < count) {
+                current++;
+            }
+            if (current == chunks.size()) {
+                chunk newChunk;
+                newChunk.capacity = std::max(count, static_cast<uint32_t>(DEFAULT_CHUNK_SIZE));
+                newChunk.used = 0;
+                newChunk.nodes.reset(new DESCRIPTOR_NODE[newChunk.capacity]);
+                chunks.push_back(std::move(newChunk));
+            }
+            chunk& c = chunks[current];
+            pNodes = &c.nodes[c.used];
+            c.used += count;
+        }
+        memset(pNodes, 0, count * sizeof(DESCRIPTOR_NODE));
+        return pNodes;
+    }
+    // Give back the nodes of one freed set
+    void release(DESCRIPTOR_NODE* pNodes, uint32_t count) {
+        freeBins[count].push_back(pNodes);
+    }
+    // Give back every set's nodes at once, keeping the chunks for reuse
+    void reset() {
+        for (auto& c : chunks) {
+            c.used = 0;
+        }
+        current = 0;
+        freeBins.clear();
+    }
+
+  private:
+    enum { DEFAULT_CHUNK_SIZE = 1024 };
+    struct chunk {
+        unique_ptr<DESCRIPTOR_NODE[]> nodes;
+        uint32_t capacity;
+        uint32_t used;
+    };
+    vector<chunk> chunks;
+    size_t current; // First chunk that may still have room
+    unordered_map<uint32_t, vector<DESCRIPTOR_NODE*>> freeBins;
+};
+
 class SET_NODE : public BASE_NODE {
   public:
     using BASE_NODE::in_use;
     VkDescriptorSet      set;
     VkDescriptorPool     pool;
-    // Head of LL of all Update structs for this set
-    GENERIC_HEADER*      pUpdateStructs;
+    // Set has had a write or copy since it was allocated or its pool was reset
+    bool                 updated;
     // Total num of descriptors in this set (count of its layout plus all prior layouts)
     uint32_t             descriptorCount;
-    GENERIC_HEADER**     ppDescriptors; // Array where each index points to update node for its slot
+    DESCRIPTOR_NODE*     pDescriptors; // descriptorCount slots from the pool's descriptorStorage
     LAYOUT_NODE*         pLayout; // Layout for this set
     SET_NODE*            pNext;
+    SET_NODE*            pPrev;
     unordered_set<VkCommandBuffer> boundCmdBuffers; // Cmd buffers that this set has been bound to
-    SET_NODE() : pUpdateStructs(NULL), ppDescriptors(NULL), pLayout(NULL), pNext(NULL) {};
+    SET_NODE() : updated(false), descriptorCount(0), pDescriptors(NULL), pLayout(NULL), pNext(NULL), pPrev(NULL) {};
 };
 
 typedef struct _DESCRIPTOR_POOL_NODE {
@@ -441,6 +614,7 @@ typedef struct _DESCRIPTOR_POOL_NODE {
     SET_NODE*                  pSets; // Head of LL of sets for this Pool
     vector<uint32_t>           maxDescriptorTypeCount; // max # of descriptors of each type in this pool
     vector<uint32_t>           availableDescriptorTypeCount; // available # of descriptors of each type in this pool
+    descriptor_arena           descriptorStorage; // DESCRIPTOR_NODEs of all sets allocated from this pool
 
     _DESCRIPTOR_POOL_NODE(const VkDescriptorPool pool,
                           const VkDescriptorPoolCreateInfo *pCreateInfo)
@@ -469,7 +643,7 @@ typedef struct _DESCRIPTOR_POOL_NODE {
     }
     ~_DESCRIPTOR_POOL_NODE() {
         delete[] createInfo.pPoolSizes;
-        // TODO : pSets are currently freed in deletePools function which uses freeShadowUpdateTree function
+        // TODO : pSets are currently freed in deletePools function
         //  need to migrate that struct to smart ptrs for auto-cleanup
     }
 } DESCRIPTOR_POOL_NODE;
@@ -528,11 +702,8 @@ typedef enum _CMD_TYPE
     CMD_DBGMARKERBEGIN,
     CMD_DBGMARKEREND,
 } CMD_TYPE;
-// Data structure for holding sequence of cmds in cmd buffer
-typedef struct _CMD_NODE {
-    CMD_TYPE          type;
-    uint64_t          cmdNumber;
-} CMD_NODE;
+// The cmd log stores each CMD_TYPE in one byte
+static_assert(CMD_DBGMARKEREND <= UINT8_MAX, "CMD_TYPE no longer fits in the cmd log");
 
 typedef enum _CB_STATE
 {
@@ -561,6 +732,17 @@ typedef enum _CBStatusFlagBits
     CBSTATUS_SCISSOR_SET                       = 0x00001000, // Scissor has been set
     CBSTATUS_ALL                               = 0x00001FFF, // All dynamic state set
 } CBStatusFlagBits;
+// CB Dirty -- draw-time state changed since validate_draw_state() last passed on this cmd buffer
+typedef VkFlags CBDirtyFlags;
+typedef enum _CBDirtyFlagBits
+{
+    CBDIRTY_NONE                               = 0x00000000, // Nothing rebound since the last validated draw
+    CBDIRTY_PIPELINE                           = 0x00000001, // Pipeline bound, re-check everything
+    CBDIRTY_DESCRIPTOR_SETS                    = 0x00000002, // Sets, layout or dynamic offsets bound, or a bound set changed
+    CBDIRTY_VERTEX_BUFFERS                     = 0x00000004, // Vertex buffers bound
+    CBDIRTY_DYNAMIC_STATE                      = 0x00000008, // Any CBSTATUS bit, viewport or scissor count changed
+    CBDIRTY_ALL                                = 0x0000000F, // Nothing validated yet
+} CBDirtyFlagBits;
 
 typedef struct stencil_data {
     uint32_t                     compareMask;
@@ -572,34 +754,6 @@ typedef struct _DRAW_DATA {
     vector<VkBuffer> buffers;
 } DRAW_DATA;
 
-struct ImageSubresourcePair {
-    VkImage image;
-    bool hasSubresource;
-    VkImageSubresource subresource;
-};
-
-bool operator==(const ImageSubresourcePair &img1, const ImageSubresourcePair &img2) {
-    if (img1.image != img2.image || img1.hasSubresource != img2.hasSubresource) return false;
-    return !img1.hasSubresource || (img1.subresource.aspectMask == img2.subresource.aspectMask &&
-            img1.subresource.mipLevel == img2.subresource.mipLevel &&
-            img1.subresource.arrayLayer == img2.subresource.arrayLayer);
-}
-
-namespace std {
-template <> struct hash<ImageSubresourcePair> {
-    size_t operator()(ImageSubresourcePair img) const throw() {
-        size_t hashVal =
-            hash<uint64_t>()(reinterpret_cast<uint64_t &>(img.image));
-        hashVal ^= hash<bool>()(img.hasSubresource);
-        if (img.hasSubresource) {
-            hashVal ^= hash<uint32_t>()(reinterpret_cast<uint32_t &>(img.subresource.aspectMask));
-            hashVal ^= hash<uint32_t>()(img.subresource.mipLevel);
-            hashVal ^= hash<uint32_t>()(img.subresource.arrayLayer);
-        }
-        return hashVal;
-    }
-};
-}
 
 struct QueryObject {
     VkQueryPool pool;
@@ -610,6 +764,10 @@ bool operator==(const QueryObject& query1, const QueryObject& query2) {
     return (query1.pool == query2.pool && query1.index == query2.index);
 }
 
+bool operator<(const QueryObject& query1, const QueryObject& query2) {
+    return (query1.pool < query2.pool) || (query1.pool == query2.pool && query1.index < query2.index);
+}
+
 namespace std {
 template <>
 struct hash<QueryObject> {
@@ -619,6 +777,35 @@ struct hash<QueryObject> {
 };
 }
 
+// Set kept as a sorted vector. Per-CB sets are small and are cleared on every reset,
+//  so unlike std::set this keeps its storage and needs no allocation per insert.
+template <typename T, typename Compare = std::less<T> >
+class flat_set {
+  public:
+    typedef typename vector<T>::const_iterator const_iterator;
+    const_iterator begin() const { return elements.begin(); }
+    const_iterator end() const { return elements.end(); }
+    size_t size() const { return elements.size(); }
+    bool empty() const { return elements.empty(); }
+    void clear() { elements.clear(); }
+    size_t count(const T& value) const {
+        auto it = std::lower_bound(elements.begin(), elements.end(), value, Compare());
+        return (it != elements.end() && !Compare()(value, *it)) ? 1 : 0;
+    }
+    void insert(const T& value) {
+        auto it = std::lower_bound(elements.begin(), elements.end(), value, Compare());
+        if (it == elements.end() || Compare()(value, *it))
+            elements.insert(it, value);
+    }
+    void erase(const T& value) {
+        auto it = std::lower_bound(elements.begin(), elements.end(), value, Compare());
+        if (it != elements.end() && !Compare()(value, *it))
+            elements.erase(it);
+    }
+  private:
+    vector<T> elements;
+};
+
 // Cmd Buffer Wrapper Struct
 typedef struct _GLOBAL_CB_NODE {
     VkCommandBuffer              commandBuffer;
@@ -627,12 +814,18 @@ typedef struct _GLOBAL_CB_NODE {
     VkCommandBufferInheritanceInfo inheritanceInfo;
     VkFence                      fence;    // fence tracking this cmd buffer
     VkDevice                     device;   // device this DB belongs to
+    VkQueueFlags                 queueFlags; // capabilities of the pool's queue family, cached at allocation
+    uint32_t                     poolIndex; // position in its CMD_POOL_INFO::commandBuffers
     uint64_t                     numCmds;  // number of cmds in this CB
     uint64_t                     drawCount[NUM_DRAW_TYPES]; // Count of each type of draw in this CB
     CB_STATE                     state;  // Track cmd buffer update state
     uint64_t                     submitCount; // Number of times CB has been submitted
     CBStatusFlags                status; // Track status of various bindings on cmd buffer
-    vector<CMD_NODE>             cmds; // vector of commands bound to this command buffer
+    CBDirtyFlags                 drawStateDirty; // State validate_draw_state() must re-check at the next draw
+    VkBool32                     indexedDrawValidated; // Index buffer status was checked for the current state
+    // CMD_TYPE of each cmd recorded into this command buffer; cmd number N is cmds[N-1].
+    //  Cleared but not freed on reset, so re-recording reuses the same storage.
+    vector<uint8_t>              cmds;
     // Currently storing "lastBound" objects on per-CB basis
     //  long-term may want to create caches of "lastBound" states and could have
     //  each individual CMD_NODE referencing its own "lastBound" state
@@ -658,29 +851,29 @@ typedef struct _GLOBAL_CB_NODE {
     uint32_t                     activeSubpass;
     VkFramebuffer                framebuffer;
     // Capture unique std::set of descriptorSets that are bound to this CB.
-    std::set<VkDescriptorSet>    uniqueBoundSets;
+    flat_set<VkDescriptorSet>    uniqueBoundSets;
     // Keep running track of which sets are bound to which set# at any given time
     // Track descriptor sets that are destroyed or updated while bound to CB
-    std::set<VkDescriptorSet>    destroyedSets;
-    std::set<VkDescriptorSet>    updatedSets;
+    flat_set<VkDescriptorSet>    destroyedSets;
+    flat_set<VkDescriptorSet>    updatedSets;
     vector<VkDescriptorSet>      boundDescriptorSets; // Index is set# that given set is bound to
     vector<VkEvent>              waitedEvents;
     vector<VkSemaphore> semaphores;
     vector<VkEvent> events;
     unordered_map<QueryObject, vector<VkEvent> > waitedEventsBeforeQueryReset;
     unordered_map<QueryObject, bool> queryToStateMap; // 0 is unavailable, 1 is available
-    unordered_set<QueryObject>   activeQueries;
-    unordered_set<QueryObject> startedQueries;
-    unordered_map<ImageSubresourcePair, IMAGE_CMD_BUF_NODE> imageLayoutMap;
-    unordered_map<VkImage, vector<ImageSubresourcePair>> imageSubresourceMap;
+    flat_set<QueryObject>        activeQueries;
+    flat_set<QueryObject>        startedQueries;
+    unordered_map<VkImage, subresource_range_map<IMAGE_CMD_BUF_NODE> > imageLayoutMap;
     unordered_map<VkEvent, VkPipelineStageFlags> eventToStageMap;
     vector<DRAW_DATA>            drawData;
     DRAW_DATA                    currentDrawData;
     VkCommandBuffer primaryCommandBuffer;
     // If cmd buffer is primary, track secondary command buffers pending
     // execution
-    std::unordered_set<VkCommandBuffer> secondaryCommandBuffers;
+    flat_set<VkCommandBuffer>    secondaryCommandBuffers;
     vector<uint32_t>             dynamicOffsets; // one dynamic offset per dynamic descriptor bound to this CB
+    std::mutex                   recordLock; // held with globalLock shared while a vkCmd* call records into this CB
 } GLOBAL_CB_NODE;
 
 typedef struct _SWAPCHAIN_NODE {
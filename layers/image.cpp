@@ -74,6 +74,16 @@ struct layer_data {
 
 static unordered_map<void*, layer_data*> layer_data_map;
 
+// Checks turned off with lunarg_image.disabled_checks, indexed by IMAGE_ERROR.
+//  Disabled checks skip their format property queries.
+static bool disabledChecks[IMAGE_INVALID_FORMAT_LIMITS_VIOLATION + 1];
+
+// Names accepted by lunarg_image.disabled_checks
+static const layer_option_enum imageCheckNames[] = {
+    {"IMAGE_FORMAT_UNSUPPORTED", IMAGE_FORMAT_UNSUPPORTED},
+    {"IMAGE_INVALID_FORMAT_LIMITS_VIOLATION", IMAGE_INVALID_FORMAT_LIMITS_VIOLATION},
+};
+
 static void InitImage(layer_data *data, const VkAllocationCallbacks *pAllocator)
 {
     VkDebugReportCallbackEXT callback;
@@ -81,16 +91,18 @@ static void InitImage(layer_data *data, const VkAllocationCallbacks *pAllocator)
 
     uint32_t debug_action = 0;
     getLayerOptionEnum("lunarg_image.debug_action", (uint32_t *) &debug_action);
+    getLayerOptionEnumList("lunarg_image.disabled_checks", imageCheckNames,
+                           sizeof(imageCheckNames) / sizeof(imageCheckNames[0]), disabledChecks);
     if(debug_action & VK_DBG_LAYER_ACTION_LOG_MSG)
     {
-        FILE *log_output = NULL;
-        const char* option_str = getLayerOption("lunarg_image.log_filename");
-        log_output = getLayerLogOutput(option_str, "lunarg_image");
+        FILE *log_output;
+        layer_log_ring *log_ring;
+        getLayerLogSink("lunarg_image", &log_output, &log_ring);
         VkDebugReportCallbackCreateInfoEXT dbgInfo;
         memset(&dbgInfo, 0, sizeof(dbgInfo));
         dbgInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
-        dbgInfo.pfnCallback = log_callback;
-        dbgInfo.pUserData = log_output;
+        dbgInfo.pfnCallback = log_ring ? log_ring_callback : log_callback;
+        dbgInfo.pUserData = log_ring ? (void *) log_ring : (void *) log_output;
         dbgInfo.flags = report_flags;
         layer_create_msg_callback(data->report_data, &dbgInfo, pAllocator, &callback);
         data->logging_callback.push_back(callback);
@@ -345,7 +357,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(VkDevice device, co
     VkPhysicalDevice  physicalDevice = device_data->physicalDevice;
     layer_data       *phy_dev_data   = get_my_data_ptr(get_dispatch_key(physicalDevice), layer_data_map);
 
-    if (pCreateInfo->format != VK_FORMAT_UNDEFINED)
+    if (pCreateInfo->format != VK_FORMAT_UNDEFINED && !disabledChecks[IMAGE_FORMAT_UNSUPPORTED])
     {
         VkFormatProperties properties;
         phy_dev_data->instance_dispatch_table->GetPhysicalDeviceFormatProperties(
@@ -359,62 +371,64 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(VkDevice device, co
         }
     }
 
-    // Internal call to get format info.  Still goes through layers, could potentially go directly to ICD.
-    phy_dev_data->instance_dispatch_table->GetPhysicalDeviceImageFormatProperties(
-                       physicalDevice, pCreateInfo->format, pCreateInfo->imageType, pCreateInfo->tiling,
-                       pCreateInfo->usage, pCreateInfo->flags, &ImageFormatProperties);
-
-    VkDeviceSize imageGranularity = device_data->physicalDeviceProperties.limits.bufferImageGranularity;
-    imageGranularity = imageGranularity == 1 ? 0 : imageGranularity;
-
-    if ((pCreateInfo->extent.depth  > ImageFormatProperties.maxExtent.depth)  ||
-        (pCreateInfo->extent.width  > ImageFormatProperties.maxExtent.width)  ||
-        (pCreateInfo->extent.height > ImageFormatProperties.maxExtent.height)) {
-        skipCall |= log_msg(phy_dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, (uint64_t)pImage, __LINE__,
-                        IMAGE_INVALID_FORMAT_LIMITS_VIOLATION, "Image",
-                        "CreateImage extents exceed allowable limits for format: "
-                        "Width = %d Height = %d Depth = %d:  Limits for Width = %d Height = %d Depth = %d for format %s.",
-                        pCreateInfo->extent.width, pCreateInfo->extent.height, pCreateInfo->extent.depth,
-                        ImageFormatProperties.maxExtent.width, ImageFormatProperties.maxExtent.height, ImageFormatProperties.maxExtent.depth,
-                        string_VkFormat(pCreateInfo->format));
+    if (!disabledChecks[IMAGE_INVALID_FORMAT_LIMITS_VIOLATION]) {
+        // Internal call to get format info.  Still goes through layers, could potentially go directly to ICD.
+        phy_dev_data->instance_dispatch_table->GetPhysicalDeviceImageFormatProperties(
+                           physicalDevice, pCreateInfo->format, pCreateInfo->imageType, pCreateInfo->tiling,
+                           pCreateInfo->usage, pCreateInfo->flags, &ImageFormatProperties);
+
+        VkDeviceSize imageGranularity = device_data->physicalDeviceProperties.limits.bufferImageGranularity;
+        imageGranularity = imageGranularity == 1 ? 0 : imageGranularity;
+
+        if ((pCreateInfo->extent.depth  > ImageFormatProperties.maxExtent.depth)  ||
+            (pCreateInfo->extent.width  > ImageFormatProperties.maxExtent.width)  ||
+            (pCreateInfo->extent.height > ImageFormatProperties.maxExtent.height)) {
+            skipCall |= log_msg(phy_dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, (uint64_t)pImage, __LINE__,
+                            IMAGE_INVALID_FORMAT_LIMITS_VIOLATION, "Image",
+                            "CreateImage extents exceed allowable limits for format: "
+                            "Width = %d Height = %d Depth = %d:  Limits for Width = %d Height = %d Depth = %d for format %s.",
+                            pCreateInfo->extent.width, pCreateInfo->extent.height, pCreateInfo->extent.depth,
+                            ImageFormatProperties.maxExtent.width, ImageFormatProperties.maxExtent.height, ImageFormatProperties.maxExtent.depth,
+                            string_VkFormat(pCreateInfo->format));
 
-    }
+        }
 
-    uint64_t totalSize = ((uint64_t)pCreateInfo->extent.width               *
-                          (uint64_t)pCreateInfo->extent.height              *
-                          (uint64_t)pCreateInfo->extent.depth               *
-                          (uint64_t)pCreateInfo->arrayLayers                *
-                          (uint64_t)pCreateInfo->samples                    *
-                          (uint64_t)vk_format_get_size(pCreateInfo->format) +
-                          (uint64_t)imageGranularity ) & ~(uint64_t)imageGranularity;
-
-    if (totalSize > ImageFormatProperties.maxResourceSize) {
-        skipCall |= log_msg(phy_dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, (uint64_t)pImage, __LINE__,
-                        IMAGE_INVALID_FORMAT_LIMITS_VIOLATION, "Image",
-                        "CreateImage resource size exceeds allowable maximum "
-                        "Image resource size = %#" PRIxLEAST64 ", maximum resource size = %#" PRIxLEAST64 " ",
-                        totalSize, ImageFormatProperties.maxResourceSize);
-    }
+        uint64_t totalSize = ((uint64_t)pCreateInfo->extent.width               *
+                              (uint64_t)pCreateInfo->extent.height              *
+                              (uint64_t)pCreateInfo->extent.depth               *
+                              (uint64_t)pCreateInfo->arrayLayers                *
+                              (uint64_t)pCreateInfo->samples                    *
+                              (uint64_t)vk_format_get_size(pCreateInfo->format) +
+                              (uint64_t)imageGranularity ) & ~(uint64_t)imageGranularity;
+
+        if (totalSize > ImageFormatProperties.maxResourceSize) {
+            skipCall |= log_msg(phy_dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, (uint64_t)pImage, __LINE__,
+                            IMAGE_INVALID_FORMAT_LIMITS_VIOLATION, "Image",
+                            "CreateImage resource size exceeds allowable maximum "
+                            "Image resource size = %#" PRIxLEAST64 ", maximum resource size = %#" PRIxLEAST64 " ",
+                            totalSize, ImageFormatProperties.maxResourceSize);
+        }
 
-    if (pCreateInfo->mipLevels > ImageFormatProperties.maxMipLevels) {
-        skipCall |= log_msg(phy_dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, (uint64_t)pImage, __LINE__,
-                        IMAGE_INVALID_FORMAT_LIMITS_VIOLATION, "Image",
-                        "CreateImage mipLevels=%d exceeds allowable maximum supported by format of %d",
-                        pCreateInfo->mipLevels, ImageFormatProperties.maxMipLevels);
-    }
+        if (pCreateInfo->mipLevels > ImageFormatProperties.maxMipLevels) {
+            skipCall |= log_msg(phy_dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, (uint64_t)pImage, __LINE__,
+                            IMAGE_INVALID_FORMAT_LIMITS_VIOLATION, "Image",
+                            "CreateImage mipLevels=%d exceeds allowable maximum supported by format of %d",
+                            pCreateInfo->mipLevels, ImageFormatProperties.maxMipLevels);
+        }
 
-    if (pCreateInfo->arrayLayers > ImageFormatProperties.maxArrayLayers) {
-        skipCall |= log_msg(phy_dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, (uint64_t)pImage, __LINE__,
-                        IMAGE_INVALID_FORMAT_LIMITS_VIOLATION, "Image",
-                        "CreateImage arrayLayers=%d exceeds allowable maximum supported by format of %d",
-                        pCreateInfo->arrayLayers, ImageFormatProperties.maxArrayLayers);
-    }
+        if (pCreateInfo->arrayLayers > ImageFormatProperties.maxArrayLayers) {
+            skipCall |= log_msg(phy_dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, (uint64_t)pImage, __LINE__,
+                            IMAGE_INVALID_FORMAT_LIMITS_VIOLATION, "Image",
+                            "CreateImage arrayLayers=%d exceeds allowable maximum supported by format of %d",
+                            pCreateInfo->arrayLayers, ImageFormatProperties.maxArrayLayers);
+        }
 
-    if ((pCreateInfo->samples & ImageFormatProperties.sampleCounts) == 0) {
-        skipCall |= log_msg(phy_dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, (uint64_t)pImage, __LINE__,
-                        IMAGE_INVALID_FORMAT_LIMITS_VIOLATION, "Image",
-                        "CreateImage samples %s is not supported by format 0x%.8X",
-                        string_VkSampleCountFlagBits(pCreateInfo->samples), ImageFormatProperties.sampleCounts);
+        if ((pCreateInfo->samples & ImageFormatProperties.sampleCounts) == 0) {
+            skipCall |= log_msg(phy_dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, (uint64_t)pImage, __LINE__,
+                            IMAGE_INVALID_FORMAT_LIMITS_VIOLATION, "Image",
+                            "CreateImage samples %s is not supported by format 0x%.8X",
+                            string_VkSampleCountFlagBits(pCreateInfo->samples), ImageFormatProperties.sampleCounts);
+        }
     }
 
     if (VK_FALSE == skipCall) {
@@ -439,7 +453,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateRenderPass(VkDevice devic
     VkBool32 skipCall = VK_FALSE;
     for(uint32_t i = 0; i < pCreateInfo->attachmentCount; ++i)
     {
-        if(pCreateInfo->pAttachments[i].format != VK_FORMAT_UNDEFINED)
+        if(pCreateInfo->pAttachments[i].format != VK_FORMAT_UNDEFINED && !disabledChecks[IMAGE_FORMAT_UNSUPPORTED])
         {
             VkFormatProperties properties;
             get_my_data_ptr(get_dispatch_key(my_data->physicalDevice), layer_data_map)->instance_dispatch_table->GetPhysicalDeviceFormatProperties(
@@ -33,19 +33,31 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <deque>
 #include <functional>
 #include <list>
 #include <map>
+#include <mutex>
+#include <signal.h>
 #include <vector>
+#if defined(__linux__)
+#include <atomic>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 #include "vk_loader_platform.h"
+#include "vk_layer_rwlock.h"
 #include "vk_dispatch_table_helper.h"
 #include "vk_struct_string_helper_cpp.h"
 #include "mem_tracker.h"
 #include "vk_layer_config.h"
 #include "vk_layer_extension_utils.h"
+#include "vulkan/vk_debug_marker_layer.h"
+#include "vulkan/vk_lunarg_memory_usage.h"
 #include "vk_layer_table.h"
+#include "vk_layer_debug_marker_table.h"
 #include "vk_layer_data.h"
 #include "vk_layer_logging.h"
 
@@ -59,9 +71,15 @@ struct layer_data {
     VkLayerDispatchTable              *device_dispatch_table;
     VkLayerInstanceDispatchTable      *instance_dispatch_table;
     VkBool32                           wsi_enabled;
+    VkBool32                           debug_marker_enabled;
+    VkBool32                           memory_usage_enabled;
+    uint32_t                           submitsSinceStateDump;
+    uint32_t                           submitsSinceMemoryReport;
     uint64_t                           currentFenceId;
+    uint64_t                           currentMemAllocSerial;
     VkPhysicalDeviceProperties         properties;
-    unordered_map<VkDeviceMemory, vector<MEMORY_RANGE>>          bufferRanges, imageRanges;
+    VkMemoryUsageLUNARG                memoryUsage; // Running totals, completed by get_memory_usage()
+    unordered_map<VkDeviceMemory, memory_range_tree>             bufferRanges, imageRanges;
     // Maps for tracking key structs related to mem_tracker state
     unordered_map<VkCommandBuffer,     MT_CB_INFO>               cbMap;
     unordered_map<VkCommandPool,       MT_CMD_POOL_INFO>         commandPoolMap;
@@ -83,7 +101,13 @@ struct layer_data {
         device_dispatch_table(nullptr),
         instance_dispatch_table(nullptr),
         wsi_enabled(VK_FALSE),
-        currentFenceId(1)
+        debug_marker_enabled(VK_FALSE),
+        memory_usage_enabled(VK_FALSE),
+        submitsSinceStateDump(0),
+        submitsSinceMemoryReport(0),
+        currentFenceId(1),
+        currentMemAllocSerial(1),
+        memoryUsage()
     {};
 };
 
@@ -93,9 +117,31 @@ static VkPhysicalDeviceMemoryProperties memProps;
 
 static VkBool32 clear_cmd_buf_and_mem_references(layer_data* my_data, const VkCommandBuffer cb);
 
-// TODO : This can be much smarter, using separate locks for separate global data
+// globalLock guards all layer state. Calls that create, destroy, bind or submit objects
+//  take it exclusively, and calls that only look objects up take it shared. Command
+//  recording calls only change their own MT_CB_INFO, so they take it shared and
+//  serialize on that CB's recordLock instead, letting command buffers record in
+//  parallel. Lock order is globalLock, then recordLock, then any memObjLocks shard.
+//  bufferMap, imageMap and memObjMap share globalLock rather than having a lock each:
+//  recording only reads them, under the shared lock, and the calls that write them
+//  (binding memory, create, destroy, free) update several of them together.
 static int globalLockInitialized = 0;
-static loader_platform_thread_mutex globalLock;
+static loader_platform_thread_rwlock globalLock;
+// Sharded by mem handle, guards MT_MEM_OBJ_INFO::pCommandBufferBindings and refCount
+//  against recording calls that reference the same memory from different CBs
+#define MEM_OBJ_LOCK_BITS 4
+static std::mutex memObjLocks[1 << MEM_OBJ_LOCK_BITS];
+
+// Checks turned off with lunarg_mem_tracker.disabled_checks, indexed by MEM_TRACK_ERROR.
+//  A disabled check also skips the tracking work that only it needs.
+static bool disabledChecks[MEMTRACK_INVALID_MAP + 1];
+
+// From lunarg_mem_tracker.guard_page_map_shadows. Shadows of non-coherent mappings use
+//  guard pages and dirty-page tracking instead of guard bytes and whole-range copies.
+static bool guardPageMapShadows = false;
+#if defined(__linux__)
+static void destroyGuardedShadow(MT_GUARDED_SHADOW *shadow);
+#endif
 
 #define MAX_BINDING 0xFFFFFFFF
 
@@ -204,12 +250,37 @@ get_cmd_buf_info(
     }
 }
 
+// Lock for a vkCmd* recording call: globalLock shared, then the CB's recordLock.
+//  Recording calls may only read device-level maps, write their own MT_CB_INFO, and
+//  touch memory objects under their memObjLocks shard.
+static MT_CB_INFO*
+lockCBForRecording(
+    layer_data            *my_data,
+    const VkCommandBuffer  cb)
+{
+    loader_platform_thread_read_lock_rwlock(&globalLock);
+    MT_CB_INFO* pCBInfo = get_cmd_buf_info(my_data, cb);
+    if (pCBInfo)
+        pCBInfo->recordLock.lock();
+    return pCBInfo;
+}
+
+static void
+unlockCBForRecording(
+    MT_CB_INFO *pCBInfo)
+{
+    if (pCBInfo)
+        pCBInfo->recordLock.unlock();
+    loader_platform_thread_read_unlock_rwlock(&globalLock);
+}
+
 static void
 add_object_binding_info(
     layer_data            *my_data,
     const uint64_t         handle,
     const VkDebugReportObjectTypeEXT  type,
-    const VkDeviceMemory   mem)
+    const VkDeviceMemory   mem,
+    const VkDeviceSize     memOffset)
 {
     switch (type)
     {
@@ -218,12 +289,14 @@ add_object_binding_info(
         {
             auto pCI = &my_data->bufferMap[handle];
             pCI->mem = mem;
+            pCI->memOffset = memOffset;
             break;
         }
         case VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT:
         {
             auto pCI = &my_data->imageMap[handle];
             pCI->mem = mem;
+            pCI->memOffset = memOffset;
             break;
         }
         default:
@@ -312,6 +385,24 @@ delete_fence_info(
     my_data->fenceMap.erase(fence);
 }
 
+// Pop the queue's submissions up to lastRetiredId and drop their in-flight mem references
+static void
+retire_queue_submissions(
+    layer_data    *my_data,
+    MT_QUEUE_INFO *pQueueInfo)
+{
+    auto &pending = pQueueInfo->pendingSubmissions;
+    while (!pending.empty() && pending.front().fenceId <= pQueueInfo->lastRetiredId) {
+        for (auto &ref : pending.front().memRefs) {
+            auto mem_item = my_data->memObjMap.find(ref.first);
+            if (mem_item != my_data->memObjMap.end() && mem_item->second.allocSerial == ref.second) {
+                mem_item->second.inFlightCount--;
+            }
+        }
+        pending.pop_front();
+    }
+}
+
 // Record information when a fence is known to be signalled
 static void
 update_fence_tracking(
@@ -327,6 +418,7 @@ update_fence_tracking(
             MT_QUEUE_INFO *pQueueInfo = &(*queue_item).second;
             if (pQueueInfo->lastRetiredId < pCurFenceInfo->fenceId) {
                 pQueueInfo->lastRetiredId = pCurFenceInfo->fenceId;
+                retire_queue_submissions(my_data, pQueueInfo);
             }
         }
     }
@@ -345,6 +437,7 @@ retire_queue_fences(
     MT_QUEUE_INFO *pQueueInfo = &my_data->queueMap[queue];
     // Set queue's lastRetired to lastSubmitted indicating all fences completed
     pQueueInfo->lastRetiredId = pQueueInfo->lastSubmittedId;
+    retire_queue_submissions(my_data, pQueueInfo);
 }
 
 // Helper routine that updates all queues to all-retired
@@ -359,6 +452,7 @@ retire_device_fences(
         // Set queue's lastRetired to lastSubmitted indicating all fences completed
         MT_QUEUE_INFO *pQueueInfo = &(*ii).second;
         pQueueInfo->lastRetiredId = pQueueInfo->lastSubmittedId;
+        retire_queue_submissions(my_data, pQueueInfo);
     }
 }
 
@@ -407,6 +501,8 @@ validate_image_usage_flags(
     char const *usage_string)
 {
     VkBool32 skipCall = VK_FALSE;
+    if (disabledChecks[MEMTRACK_INVALID_USAGE_FLAG])
+        return skipCall;
     MT_OBJ_BINDING_INFO* pBindInfo = get_object_binding_info(my_data, (uint64_t)image, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT);
     if (pBindInfo) {
         skipCall = validate_usage_flags(my_data, disp_obj, pBindInfo->create_info.image.usage, desired, strict,
@@ -429,6 +525,8 @@ validate_buffer_usage_flags(
      char const *usage_string)
 {
     VkBool32 skipCall = VK_FALSE;
+    if (disabledChecks[MEMTRACK_INVALID_USAGE_FLAG])
+        return skipCall;
     MT_OBJ_BINDING_INFO* pBindInfo = get_object_binding_info(my_data, (uint64_t) buffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT);
     if (pBindInfo) {
         skipCall = validate_usage_flags(my_data, disp_obj, pBindInfo->create_info.buffer.usage, desired, strict,
@@ -471,7 +569,11 @@ add_mem_obj_info(
     my_data->memObjMap[mem].memRange.size   = 0;
     my_data->memObjMap[mem].pData           = 0;
     my_data->memObjMap[mem].pDriverData     = 0;
+    my_data->memObjMap[mem].pGuardedShadow  = NULL;
     my_data->memObjMap[mem].valid           = false;
+    my_data->memObjMap[mem].allocSerial     = my_data->currentMemAllocSerial++;
+    my_data->memObjMap[mem].inFlightCount   = 0;
+    my_data->memObjMap[mem].boundBytes      = 0;
 }
 
 static VkBool32 validate_memory_is_valid(layer_data *my_data, VkDeviceMemory mem, const char* functionName, VkImage image = VK_NULL_HANDLE) {
@@ -508,6 +610,46 @@ static void set_memory_valid(layer_data *my_data, VkDeviceMemory mem, bool valid
     }
 }
 
+// Queue a memory validity check or update to run when the CB is submitted
+static void
+add_mem_validation_record(
+    MT_CB_INFO           *pCBInfo,
+    MT_MEM_VALIDATION_OP  op,
+    VkDeviceMemory        mem,
+    VkImage               image = VK_NULL_HANDLE,
+    const char           *apiName = NULL)
+{
+    MT_MEM_VALIDATION_RECORD record;
+    record.op = op;
+    record.mem = mem;
+    record.image = image;
+    record.apiName = apiName;
+    pCBInfo->memValidationRecords.push_back(record);
+}
+
+// Run a CB's queued memory validity records in recording order
+static VkBool32
+replay_mem_validation_records(
+    layer_data *my_data,
+    MT_CB_INFO *pCBInfo)
+{
+    VkBool32 skipCall = VK_FALSE;
+    for (auto &record : pCBInfo->memValidationRecords) {
+        switch (record.op) {
+            case MT_MEM_VALIDATE:
+                skipCall |= validate_memory_is_valid(my_data, record.mem, record.apiName, record.image);
+                break;
+            case MT_MEM_SET_VALID:
+                set_memory_valid(my_data, record.mem, true, record.image);
+                break;
+            case MT_MEM_SET_INVALID:
+                set_memory_valid(my_data, record.mem, false, record.image);
+                break;
+        }
+    }
+    return skipCall;
+}
+
 // Find CB Info and add mem reference to list container
 // Find Mem Obj Info and add CB reference to list container
 static VkBool32
@@ -525,39 +667,16 @@ update_cmd_buf_and_mem_references(
         // First update CB binding in MemObj mini CB list
         MT_MEM_OBJ_INFO* pMemInfo = get_mem_obj_info(my_data, mem);
         if (pMemInfo) {
-            // Search for cmd buffer object in memory object's binding list
-            VkBool32 found  = VK_FALSE;
-            if (pMemInfo->pCommandBufferBindings.size() > 0) {
-                for (list<VkCommandBuffer>::iterator it = pMemInfo->pCommandBufferBindings.begin(); it != pMemInfo->pCommandBufferBindings.end(); ++it) {
-                    if ((*it) == cb) {
-                        found = VK_TRUE;
-                        break;
-                    }
-                }
-            }
-            // If not present, add to list
-            if (found == VK_FALSE) {
-                pMemInfo->pCommandBufferBindings.push_front(cb);
+            // Add cmd buffer to memory object's binding set if not already present
+            std::lock_guard<std::mutex> lock(memObjLocks[layer_lock_shard((uint64_t)mem, MEM_OBJ_LOCK_BITS)]);
+            if (pMemInfo->pCommandBufferBindings.insert(cb)) {
                 pMemInfo->refCount++;
             }
-            // Now update CBInfo's Mem reference list
+            // Now update CBInfo's Mem reference set
             MT_CB_INFO* pCBInfo = get_cmd_buf_info(my_data, cb);
             // TODO: keep track of all destroyed CBs so we know if this is a stale or simply invalid object
             if (pCBInfo) {
-                // Search for memory object in cmd buffer's reference list
-                VkBool32 found  = VK_FALSE;
-                if (pCBInfo->pMemObjList.size() > 0) {
-                    for (auto it = pCBInfo->pMemObjList.begin(); it != pCBInfo->pMemObjList.end(); ++it) {
-                        if ((*it) == mem) {
-                            found = VK_TRUE;
-                            break;
-                        }
-                    }
-                }
-                // If not present, add to list
-                if (found == VK_FALSE) {
-                    pCBInfo->pMemObjList.push_front(mem);
-                }
+                pCBInfo->pMemObjList.insert(mem);
             }
         }
     }
@@ -574,19 +693,15 @@ clear_cmd_buf_and_mem_references(
     MT_CB_INFO* pCBInfo = get_cmd_buf_info(my_data, cb);
 
     if (pCBInfo) {
-        if (pCBInfo->pMemObjList.size() > 0) {
-            list<VkDeviceMemory> mem_obj_list = pCBInfo->pMemObjList;
-            for (list<VkDeviceMemory>::iterator it=mem_obj_list.begin(); it!=mem_obj_list.end(); ++it) {
-                MT_MEM_OBJ_INFO* pInfo = get_mem_obj_info(my_data, *it);
-                if (pInfo) {
-                    pInfo->pCommandBufferBindings.remove(cb);
-                    pInfo->refCount--;
-                }
+        for (auto mem : pCBInfo->pMemObjList) {
+            MT_MEM_OBJ_INFO* pInfo = get_mem_obj_info(my_data, mem);
+            if (pInfo && pInfo->pCommandBufferBindings.erase(cb)) {
+                pInfo->refCount--;
             }
-            pCBInfo->pMemObjList.clear();
         }
+        pCBInfo->pMemObjList.clear();
         pCBInfo->activeDescriptorSets.clear();
-        pCBInfo->validate_functions.clear();
+        pCBInfo->memValidationRecords.clear();
     }
     return skipCall;
 }
@@ -621,7 +736,7 @@ reportMemReferencesAndCleanUp(
     }
 
     if (cmdBufRefCount > 0 && pMemObjInfo->pCommandBufferBindings.size() > 0) {
-        for (list<VkCommandBuffer>::const_iterator it = pMemObjInfo->pCommandBufferBindings.begin(); it != pMemObjInfo->pCommandBufferBindings.end(); ++it) {
+        for (auto it = pMemObjInfo->pCommandBufferBindings.begin(); it != pMemObjInfo->pCommandBufferBindings.end(); ++it) {
             // TODO : CommandBuffer should be source Obj here
             log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, (uint64_t)(*it), __LINE__, MEMTRACK_FREED_MEM_REF, "MEM",
                     "Command Buffer %p still has a reference to mem obj %#" PRIxLEAST64, (*it), (uint64_t) pMemObjInfo->mem);
@@ -706,24 +821,33 @@ freeMemObjInfo(
 
             VkBool32 commandBufferComplete = VK_FALSE;
             assert(pInfo->object != VK_NULL_HANDLE);
-            list<VkCommandBuffer>::iterator it = pInfo->pCommandBufferBindings.begin();
-            list<VkCommandBuffer>::iterator temp;
-            while (pInfo->pCommandBufferBindings.size() > 0 && it != pInfo->pCommandBufferBindings.end()) {
-                skipCall |= checkCBCompleted(my_data, *it, &commandBufferComplete);
-                if (VK_TRUE == commandBufferComplete) {
-                    temp = it;
-                    ++temp;
-                    skipCall |= clear_cmd_buf_and_mem_references(my_data, *it);
-                    it = temp;
-                } else {
-                    ++it;
+            // Clearing a CB's references erases it from pCommandBufferBindings, so collect them first
+            vector<VkCommandBuffer> completedCBs;
+            if (0 == pInfo->inFlightCount) {
+                // No unretired submission references this mem obj, so every CB bound to it has completed
+                completedCBs.assign(pInfo->pCommandBufferBindings.begin(), pInfo->pCommandBufferBindings.end());
+            } else {
+                for (auto cb : pInfo->pCommandBufferBindings) {
+                    skipCall |= checkCBCompleted(my_data, cb, &commandBufferComplete);
+                    if (VK_TRUE == commandBufferComplete) {
+                        completedCBs.push_back(cb);
+                    }
                 }
             }
+            for (auto cb : completedCBs) {
+                skipCall |= clear_cmd_buf_and_mem_references(my_data, cb);
+            }
 
             // Now verify that no references to this mem obj remain and remove bindings
             if (0 != pInfo->refCount) {
                 skipCall |= reportMemReferencesAndCleanUp(my_data, pInfo);
             }
+            VkMemoryUsageLUNARG *pUsage = &my_data->memoryUsage;
+            pUsage->allocationCount--;
+            if (pInfo->allocInfo.memoryTypeIndex < VK_MAX_MEMORY_TYPES) {
+                pUsage->typeBytes[pInfo->allocInfo.memoryTypeIndex] -= pInfo->allocInfo.allocationSize;
+                pUsage->typeAllocationCount[pInfo->allocInfo.memoryTypeIndex]--;
+            }
             // Delete mem obj info
             skipCall |= deleteMemObjInfo(my_data, object, mem);
         }
@@ -773,16 +897,12 @@ clear_object_binding(
         if (pMemObjInfo) {
             // This obj is bound to a memory object. Remove the reference to this object in that memory object's list, decrement the memObj's refcount
             // and set the objects memory binding pointer to NULL.
-            VkBool32 clearSucceeded = VK_FALSE;
-            for (auto it = pMemObjInfo->pObjBindings.begin(); it != pMemObjInfo->pObjBindings.end(); ++it) {
-                if ((it->handle == handle) && (it->type == type)) {
-                    pMemObjInfo->refCount--;
-                    pMemObjInfo->pObjBindings.erase(it);
-                    clearSucceeded = VK_TRUE;
-                    break;
-                }
-            }
-            if (VK_FALSE == clearSucceeded ) {
+            MT_OBJ_HANDLE_TYPE oht;
+            oht.handle = handle;
+            oht.type = type;
+            if (pMemObjInfo->pObjBindings.erase(oht)) {
+                pMemObjInfo->refCount--;
+            } else {
                 skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, type, handle, __LINE__, MEMTRACK_INVALID_OBJECT, "MEM",
                                 "While trying to clear mem binding for %s obj %#" PRIxLEAST64 ", unable to find that object referenced by mem obj %#" PRIxLEAST64,
                                  object_type_to_string(type), handle, (uint64_t) pMemObjInfo->mem);
@@ -835,8 +955,9 @@ set_mem_binding(
                     MT_OBJ_HANDLE_TYPE oht;
                     oht.handle = handle;
                     oht.type = type;
-                    pMemInfo->pObjBindings.push_front(oht);
-                    pMemInfo->refCount++;
+                    if (pMemInfo->pObjBindings.insert(oht)) {
+                        pMemInfo->refCount++;
+                    }
                     // For image objects, make sure default memory state is correctly set
                     // TODO : What's the best/correct way to handle this?
                     if (VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT == type) {
@@ -882,22 +1003,11 @@ set_sparse_mem_binding(
         // non-null case so should have real mem obj
         MT_MEM_OBJ_INFO* pInfo = get_mem_obj_info(my_data, mem);
         if (pInfo) {
-            // Search for object in memory object's binding list
-            VkBool32 found  = VK_FALSE;
-            if (pInfo->pObjBindings.size() > 0) {
-                for (auto it = pInfo->pObjBindings.begin(); it != pInfo->pObjBindings.end(); ++it) {
-                    if (((*it).handle == handle) && ((*it).type == type)) {
-                        found = VK_TRUE;
-                        break;
-                    }
-                }
-            }
-            // If not present, add to list
-            if (found == VK_FALSE) {
-                MT_OBJ_HANDLE_TYPE oht;
-                oht.handle = handle;
-                oht.type   = type;
-                pInfo->pObjBindings.push_front(oht);
+            // Add object to memory object's binding set if not already present
+            MT_OBJ_HANDLE_TYPE oht;
+            oht.handle = handle;
+            oht.type   = type;
+            if (pInfo->pObjBindings.insert(oht)) {
                 pInfo->refCount++;
             }
             // Need to set mem binding for this object
@@ -948,104 +1058,159 @@ get_mem_binding_from_object(
     return skipCall;
 }
 
-// Print details of MemObjInfo list
+// On-demand state dumps, enabled by lunarg_mem_tracker.state_dump_filename. Each dump
+//  appends one JSON object per line describing every memory object and command buffer.
+//  They are taken when the app records vkCmdDbgMarkerBegin() with state_dump_marker,
+//  every state_dump_submit_interval vkQueueSubmit() calls, on SIGUSR1 and at
+//  vkDestroyDevice(), so the API hot paths never walk the object maps.
+static FILE *stateDumpFile = NULL;
+static const char *stateDumpMarker = NULL;
+static uint32_t stateDumpSubmitInterval = 0;
+static uint64_t stateDumpSequence = 0;
+// Set by the SIGUSR1 handler, serviced by the next vkQueueSubmit()
+static volatile sig_atomic_t stateDumpRequested = 0;
+
+#if !defined(_WIN32)
+// SIGUSR1 disposition from before the handler was installed, put back with the last instance
+static struct sigaction previousUsr1Action;
+static bool stateDumpSignalInstalled = false;
+
 static void
-print_mem_list(
-    layer_data *my_data,
-    void       *dispObj)
+request_state_dump(
+    int sig)
 {
-    MT_MEM_OBJ_INFO* pInfo = NULL;
+    stateDumpRequested = 1;
+}
+#endif
 
-    // Early out if info is not requested
-    if (!(my_data->report_data->active_flags & VK_DEBUG_REPORT_INFORMATION_BIT_EXT)) {
+// Caller must hold globalLock
+static void
+dump_mem_tracker_state(
+    layer_data *my_data,
+    const char *reason)
+{
+    if (!stateDumpFile) {
         return;
     }
-
-    // Just printing each msg individually for now, may want to package these into single large print
-    log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-            "Details of Memory Object list (of size " PRINTF_SIZE_T_SPECIFIER " elements)", my_data->memObjMap.size());
-    log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-            "=============================");
-
-    if (my_data->memObjMap.size() <= 0)
-        return;
-
-    for (auto ii=my_data->memObjMap.begin(); ii!=my_data->memObjMap.end(); ++ii) {
-        pInfo = &(*ii).second;
-
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-            "    ===MemObjInfo at %p===", (void*)pInfo);
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-                "    Mem object: %#" PRIxLEAST64, (uint64_t)(pInfo->mem));
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-                "    Ref Count: %u", pInfo->refCount);
-        if (0 != pInfo->allocInfo.allocationSize) {
-            string pAllocInfoMsg = vk_print_vkmemoryallocateinfo(&pInfo->allocInfo, "MEM(INFO):         ");
-            log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-                    "    Mem Alloc info:\n%s", pAllocInfoMsg.c_str());
-        } else {
-            log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-                    "    Mem Alloc info is NULL (alloc done by vkCreateSwapchainKHR())");
+    fprintf(stateDumpFile, "{\"sequence\": %" PRIu64 ", \"reason\": \"%s\", \"memory\": [", ++stateDumpSequence, reason);
+    const char *separator = "";
+    for (auto ii = my_data->memObjMap.begin(); ii != my_data->memObjMap.end(); ++ii) {
+        const MT_MEM_OBJ_INFO &info = ii->second;
+        fprintf(stateDumpFile, "%s{\"handle\": \"0x%" PRIx64 "\", \"size\": %" PRIu64 ", \"boundBytes\": %" PRIu64 ", \"memoryTypeIndex\": %u, \"refCount\": %u, \"valid\": %s",
+                separator, (uint64_t)info.mem, (uint64_t)info.allocInfo.allocationSize, (uint64_t)info.boundBytes, info.allocInfo.memoryTypeIndex,
+                info.refCount, info.valid ? "true" : "false");
+        if (info.memRange.size) {
+            fprintf(stateDumpFile, ", \"mapped\": {\"offset\": %" PRIu64 ", \"size\": %" PRIu64 "}",
+                    (uint64_t)info.memRange.offset, (uint64_t)info.memRange.size);
         }
-
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-                "    VK OBJECT Binding list of size " PRINTF_SIZE_T_SPECIFIER " elements:", pInfo->pObjBindings.size());
-        if (pInfo->pObjBindings.size() > 0) {
-            for (list<MT_OBJ_HANDLE_TYPE>::iterator it = pInfo->pObjBindings.begin(); it != pInfo->pObjBindings.end(); ++it) {
-                log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-                        "       VK OBJECT %" PRIu64, it->handle);
-            }
+        fprintf(stateDumpFile, ", \"objects\": [");
+        const char *objSeparator = "";
+        for (auto it = info.pObjBindings.begin(); it != info.pObjBindings.end(); ++it) {
+            fprintf(stateDumpFile, "%s{\"handle\": \"0x%" PRIx64 "\", \"type\": \"%s\"}", objSeparator, it->handle, object_type_to_string(it->type));
+            objSeparator = ", ";
         }
-
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-                "    VK Command Buffer (CB) binding list of size " PRINTF_SIZE_T_SPECIFIER " elements", pInfo->pCommandBufferBindings.size());
-        if (pInfo->pCommandBufferBindings.size() > 0)
-        {
-            for (list<VkCommandBuffer>::iterator it = pInfo->pCommandBufferBindings.begin(); it != pInfo->pCommandBufferBindings.end(); ++it) {
-                log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-                        "      VK CB %p", (*it));
-            }
+        fprintf(stateDumpFile, "], \"commandBuffers\": [");
+        objSeparator = "";
+        for (auto it = info.pCommandBufferBindings.begin(); it != info.pCommandBufferBindings.end(); ++it) {
+            fprintf(stateDumpFile, "%s\"%p\"", objSeparator, (void*)(*it));
+            objSeparator = ", ";
         }
+        fprintf(stateDumpFile, "]}");
+        separator = ", ";
+    }
+    fprintf(stateDumpFile, "], \"commandBuffers\": [");
+    separator = "";
+    for (auto ii = my_data->cbMap.begin(); ii != my_data->cbMap.end(); ++ii) {
+        const MT_CB_INFO &info = ii->second;
+        fprintf(stateDumpFile, "%s{\"handle\": \"%p\", \"fenceId\": %" PRIu64 ", \"fence\": \"0x%" PRIx64 "\", \"memory\": [",
+                separator, (void*)ii->first, info.fenceId, (uint64_t)info.lastSubmittedFence);
+        const char *memSeparator = "";
+        for (auto it = info.pMemObjList.begin(); it != info.pMemObjList.end(); ++it) {
+            fprintf(stateDumpFile, "%s\"0x%" PRIx64 "\"", memSeparator, (uint64_t)(*it));
+            memSeparator = ", ";
+        }
+        fprintf(stateDumpFile, "]}");
+        separator = ", ";
     }
+    fprintf(stateDumpFile, "]}\n");
+    fflush(stateDumpFile);
 }
 
-static void
-printCBList(
-    layer_data *my_data,
-    void       *dispObj)
-{
-    MT_CB_INFO* pCBInfo = NULL;
+// Memory usage reports are logged every memory_report_submit_interval vkQueueSubmit()
+//  calls, and whenever vkAllocateMemory() runs out of device memory
+static uint32_t memoryReportSubmitInterval = 0;
 
-    // Early out if info is not requested
-    if (!(my_data->report_data->active_flags & VK_DEBUG_REPORT_INFORMATION_BIT_EXT)) {
-        return;
+// Caller must hold globalLock
+static void
+get_memory_usage(
+    layer_data          *my_data,
+    VkMemoryUsageLUNARG *pUsage)
+{
+    *pUsage = my_data->memoryUsage;
+    pUsage->maxMemoryAllocationCount = my_data->properties.limits.maxMemoryAllocationCount;
+    pUsage->memoryTypeCount = memProps.memoryTypeCount;
+    pUsage->memoryHeapCount = memProps.memoryHeapCount;
+    for (uint32_t i = 0; i < memProps.memoryHeapCount; i++) {
+        pUsage->heapSize[i] = memProps.memoryHeaps[i].size;
+    }
+    for (uint32_t i = 0; i < memProps.memoryTypeCount; i++) {
+        pUsage->heapBytes[memProps.memoryTypes[i].heapIndex] += pUsage->typeBytes[i];
+    }
+    for (auto ii = my_data->memObjMap.begin(); ii != my_data->memObjMap.end(); ++ii) {
+        const MT_MEM_OBJ_INFO &info = ii->second;
+        // Aliased bindings can add up to more than the allocation
+        VkDeviceSize unbound = (info.boundBytes < info.allocInfo.allocationSize) ? info.allocInfo.allocationSize - info.boundBytes : 0;
+        pUsage->unboundBytes += unbound;
+        if (unbound > pUsage->mostUnboundBytes) {
+            pUsage->mostUnboundBytes  = unbound;
+            pUsage->mostUnboundMemory = info.mem;
+        }
     }
+}
 
-    log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-        "Details of CB list (of size " PRINTF_SIZE_T_SPECIFIER " elements)", my_data->cbMap.size());
-    log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-        "==================");
-
-    if (my_data->cbMap.size() <= 0)
-        return;
-
-    for (auto ii=my_data->cbMap.begin(); ii!=my_data->cbMap.end(); ++ii) {
-        pCBInfo = &(*ii).second;
-
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-                "    CB Info (%p) has CB %p, fenceId %" PRIx64", and fence %#" PRIxLEAST64,
-                (void*)pCBInfo, (void*)pCBInfo->commandBuffer, pCBInfo->fenceId,
-                (uint64_t) pCBInfo->lastSubmittedFence);
-
-        if (pCBInfo->pMemObjList.size() <= 0)
-            continue;
-        for (list<VkDeviceMemory>::iterator it = pCBInfo->pMemObjList.begin(); it != pCBInfo->pMemObjList.end(); ++it) {
-            log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, 0, __LINE__, MEMTRACK_NONE, "MEM",
-                    "      Mem obj %" PRIu64, (uint64_t)(*it));
+// Caller must hold globalLock
+static VkBool32
+log_memory_usage(
+    layer_data      *my_data,
+    VkFlags          msgFlags,
+    MEM_TRACK_ERROR  msgCode,
+    uint64_t         srcObject,
+    const char      *reason)
+{
+    VkMemoryUsageLUNARG usage;
+    get_memory_usage(my_data, &usage);
+    char line[256];
+    string report = reason;
+    snprintf(line, sizeof(line), ": %u of %u allocations; buffers: %u using %" PRIu64 " bytes; images: %u using %" PRIu64 " bytes; "
+             "unbound: %" PRIu64 " bytes", usage.allocationCount, usage.maxMemoryAllocationCount, usage.bufferCount,
+             (uint64_t)usage.bufferBytes, usage.imageCount, (uint64_t)usage.imageBytes, (uint64_t)usage.unboundBytes);
+    report += line;
+    if (usage.mostUnboundBytes) {
+        snprintf(line, sizeof(line), ", %" PRIu64 " of them in mem obj %#" PRIxLEAST64, (uint64_t)usage.mostUnboundBytes,
+                 (uint64_t)usage.mostUnboundMemory);
+        report += line;
+    }
+    for (uint32_t i = 0; i < usage.memoryHeapCount; i++) {
+        snprintf(line, sizeof(line), "; heap %u: %" PRIu64 " of %" PRIu64 " bytes", i, (uint64_t)usage.heapBytes[i], (uint64_t)usage.heapSize[i]);
+        report += line;
+    }
+    for (uint32_t i = 0; i < usage.memoryTypeCount; i++) {
+        if (usage.typeAllocationCount[i]) {
+            snprintf(line, sizeof(line), "; type %u: %u allocations, %" PRIu64 " bytes", i, usage.typeAllocationCount[i], (uint64_t)usage.typeBytes[i]);
+            report += line;
         }
     }
+    return log_msg(my_data->report_data, msgFlags, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, srcObject, __LINE__, msgCode, "MEM",
+                   "%s", report.c_str());
 }
 
+// Names accepted by lunarg_mem_tracker.disabled_checks
+static const layer_option_enum memTrackerCheckNames[] = {
+    {"MEMTRACK_INVALID_ALIASING", MEMTRACK_INVALID_ALIASING},
+    {"MEMTRACK_INVALID_USAGE_FLAG", MEMTRACK_INVALID_USAGE_FLAG},
+    {"MEMTRACK_INVALID_MAP", MEMTRACK_INVALID_MAP},
+};
+
 static void
 init_mem_tracker(
     layer_data *my_data,
@@ -1059,16 +1224,48 @@ init_mem_tracker(
     // initialize mem_tracker options
     report_flags = getLayerOptionFlags("lunarg_mem_tracker.report_flags", 0);
     getLayerOptionEnum("lunarg_mem_tracker.debug_action", (uint32_t *) &debug_action);
+    getLayerOptionEnumList("lunarg_mem_tracker.disabled_checks", memTrackerCheckNames,
+                           sizeof(memTrackerCheckNames) / sizeof(memTrackerCheckNames[0]), disabledChecks);
+    option_str = getLayerOption("lunarg_mem_tracker.guard_page_map_shadows");
+    if (option_str) {
+        guardPageMapShadows = strtoul(option_str, NULL, 0) != 0;
+    }
+    option_str = getLayerOption("lunarg_mem_tracker.state_dump_filename");
+    if (option_str && !stateDumpFile) {
+        stateDumpFile = getLayerLogOutput(option_str, "lunarg_mem_tracker");
+        stateDumpMarker = getLayerOption("lunarg_mem_tracker.state_dump_marker");
+        option_str = getLayerOption("lunarg_mem_tracker.state_dump_submit_interval");
+        if (option_str) {
+            stateDumpSubmitInterval = (uint32_t) strtoul(option_str, NULL, 0);
+        }
+    }
+#if !defined(_WIN32)
+    // Only with state dumps enabled, and leave SIGUSR1 alone if the app already handles it
+    if (stateDumpFile && !stateDumpSignalInstalled &&
+        sigaction(SIGUSR1, NULL, &previousUsr1Action) == 0 &&
+        !(previousUsr1Action.sa_flags & SA_SIGINFO) && previousUsr1Action.sa_handler == SIG_DFL) {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = request_state_dump;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        stateDumpSignalInstalled = sigaction(SIGUSR1, &action, NULL) == 0;
+    }
+#endif
+    option_str = getLayerOption("lunarg_mem_tracker.memory_report_submit_interval");
+    if (option_str) {
+        memoryReportSubmitInterval = (uint32_t) strtoul(option_str, NULL, 0);
+    }
 
     if (debug_action & VK_DBG_LAYER_ACTION_LOG_MSG)
     {
-        option_str = getLayerOption("lunarg_mem_tracker.log_filename");
-        log_output = getLayerLogOutput(option_str, "lunarg_mem_tracker");
+        layer_log_ring *log_ring;
+        getLayerLogSink("lunarg_mem_tracker", &log_output, &log_ring);
         VkDebugReportCallbackCreateInfoEXT dbgInfo;
         memset(&dbgInfo, 0, sizeof(dbgInfo));
         dbgInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
-        dbgInfo.pfnCallback = log_callback;
-        dbgInfo.pUserData = log_output;
+        dbgInfo.pfnCallback = log_ring ? log_ring_callback : log_callback;
+        dbgInfo.pUserData = log_ring ? (void *) log_ring : (void *) log_output;
         dbgInfo.flags = report_flags;
         layer_create_msg_callback(my_data->report_data, &dbgInfo, pAllocator, &callback);
         my_data->logging_callback.push_back(callback);
@@ -1087,7 +1284,7 @@ init_mem_tracker(
 
     if (!globalLockInitialized)
     {
-        loader_platform_thread_create_mutex(&globalLock);
+        loader_platform_thread_create_rwlock(&globalLock);
         globalLockInitialized = 1;
     }
 
@@ -1106,7 +1303,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     pTable->DestroyInstance(instance, pAllocator);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     // Clean up logging callback, if any
     while (my_data->logging_callback.size() > 0) {
         VkDebugReportCallbackEXT callback = my_data->logging_callback.back();
@@ -1117,10 +1314,16 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(
     layer_debug_report_destroy_instance(my_data->report_data);
     delete my_data->instance_dispatch_table;
     layer_data_map.erase(key);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (layer_data_map.empty()) {
+#if !defined(_WIN32)
+        if (stateDumpSignalInstalled) {
+            sigaction(SIGUSR1, &previousUsr1Action, NULL);
+            stateDumpSignalInstalled = false;
+        }
+#endif
         // Release mutex when destroying last instance
-        loader_platform_thread_delete_mutex(&globalLock);
+        loader_platform_thread_delete_rwlock(&globalLock);
         globalLockInitialized = 0;
     }
 }
@@ -1176,9 +1379,18 @@ createDeviceRegisterExtensions(
     pDisp->AcquireNextImageKHR = (PFN_vkAcquireNextImageKHR) gpa(device, "vkAcquireNextImageKHR");
     pDisp->QueuePresentKHR = (PFN_vkQueuePresentKHR) gpa(device, "vkQueuePresentKHR");
     my_device_data->wsi_enabled = VK_FALSE;
+    my_device_data->debug_marker_enabled = VK_FALSE;
+    my_device_data->memory_usage_enabled = VK_FALSE;
     for (uint32_t i = 0; i < pCreateInfo->enabledExtensionCount; i++) {
         if (strcmp(pCreateInfo->ppEnabledExtensionNames[i], VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0)
             my_device_data->wsi_enabled = true;
+        if (strcmp(pCreateInfo->ppEnabledExtensionNames[i], DEBUG_MARKER_EXTENSION_NAME) == 0) {
+            // Only intercepted to take state dumps, see state_dump_marker
+            my_device_data->debug_marker_enabled = true;
+            initDebugMarkerTable(device);
+        }
+        if (strcmp(pCreateInfo->ppEnabledExtensionNames[i], VK_LUNARG_MEMORY_USAGE_EXTENSION_NAME) == 0)
+            my_device_data->memory_usage_enabled = true;
     }
 }
 
@@ -1227,13 +1439,8 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(
     dispatch_key key = get_dispatch_key(device);
     layer_data *my_device_data = get_my_data_ptr(key, layer_data_map);
     VkBool32 skipCall = VK_FALSE;
-    loader_platform_thread_lock_mutex(&globalLock);
-    log_msg(my_device_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT, (uint64_t)device, __LINE__, MEMTRACK_NONE, "MEM",
-        "Printing List details prior to vkDestroyDevice()");
-    log_msg(my_device_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT, (uint64_t)device, __LINE__, MEMTRACK_NONE, "MEM",
-        "================================================");
-    print_mem_list(my_device_data, device);
-    printCBList(my_device_data, device);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    dump_mem_tracker_state(my_device_data, "vkDestroyDevice");
     skipCall = delete_cmd_buf_info_list(my_device_data);
     // Report any memory leaks
     MT_MEM_OBJ_INFO* pInfo = NULL;
@@ -1246,12 +1453,19 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(
                                  "Mem Object %" PRIu64 " has not been freed. You should clean up this memory by calling "
                                  "vkFreeMemory(%" PRIu64 ") prior to vkDestroyDevice().", (uint64_t)(pInfo->mem), (uint64_t)(pInfo->mem));
             }
+#if defined(__linux__)
+            // Drop shadows of mappings left open, restoring SIGSEGV with the last one
+            if (pInfo->pGuardedShadow) {
+                destroyGuardedShadow(pInfo->pGuardedShadow);
+                pInfo->pGuardedShadow = NULL;
+            }
+#endif
         }
     }
     // Queues persist until device is destroyed
     delete_queue_info_list(my_device_data);
     layer_debug_report_destroy_device(device);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
 #if DISPATCH_MAP_DEBUG
     fprintf(stderr, "Device: %p, key: %p\n", device, key);
@@ -1260,6 +1474,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(
     if (VK_FALSE == skipCall) {
         pDisp->DestroyDevice(device, pAllocator);
     }
+    tableDebugMarkerMap.erase(key);
     delete my_device_data->device_dispatch_table;
     layer_data_map.erase(key);
 }
@@ -1307,20 +1522,28 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceLayerPropertie
                                    pCount, pProperties);
 }
 
+static const VkExtensionProperties mt_device_extensions[] = {
+    {
+        VK_LUNARG_MEMORY_USAGE_EXTENSION_NAME,
+        VK_LUNARG_MEMORY_USAGE_SPEC_VERSION
+    }
+};
+
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateDeviceExtensionProperties(
         VkPhysicalDevice                            physicalDevice,
         const char                                 *pLayerName,
         uint32_t                                   *pCount,
         VkExtensionProperties                      *pProperties)
 {
-    /* Mem tracker does not have any physical device extensions */
     if (pLayerName == NULL) {
         layer_data *my_data = get_my_data_ptr(get_dispatch_key(physicalDevice), layer_data_map);
         VkLayerInstanceDispatchTable *pInstanceTable = my_data->instance_dispatch_table;
         return pInstanceTable->EnumerateDeviceExtensionProperties(
             physicalDevice, NULL, pCount, pProperties);
     } else {
-        return util_GetExtensionProperties(0, NULL, pCount, pProperties);
+        return util_GetExtensionProperties(ARRAY_SIZE(mt_device_extensions),
+                                           mt_device_extensions,
+                                           pCount, pProperties);
     }
 }
 
@@ -1342,9 +1565,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkGetDeviceQueue(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     my_data->device_dispatch_table->GetDeviceQueue(device, queueNodeIndex, queueIndex, pQueue);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     add_queue_info(my_data, *pQueue);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(
@@ -1356,14 +1579,27 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
 
-    loader_platform_thread_lock_mutex(&globalLock);
-    // TODO : Need to track fence and clear mem references when fence clears
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     MT_CB_INFO* pCBInfo = NULL;
     uint64_t    fenceId = 0;
     VkBool32 skipCall = add_fence_info(my_data, fence, queue, &fenceId);
+    MT_SUBMISSION_INFO submission;
+    submission.fenceId = fenceId;
 
-    print_mem_list(my_data, queue);
-    printCBList(my_data, queue);
+    if (stateDumpFile) {
+        if (stateDumpRequested) {
+            stateDumpRequested = 0;
+            dump_mem_tracker_state(my_data, "SIGUSR1");
+        }
+        if (stateDumpSubmitInterval && ++my_data->submitsSinceStateDump >= stateDumpSubmitInterval) {
+            my_data->submitsSinceStateDump = 0;
+            dump_mem_tracker_state(my_data, "state_dump_submit_interval");
+        }
+    }
+    if (memoryReportSubmitInterval && ++my_data->submitsSinceMemoryReport >= memoryReportSubmitInterval) {
+        my_data->submitsSinceMemoryReport = 0;
+        log_memory_usage(my_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, MEMTRACK_NONE, 0, "Memory usage");
+    }
     for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
         const VkSubmitInfo *submit = &pSubmits[submit_idx];
         for (uint32_t i = 0; i < submit->commandBufferCount; i++) {
@@ -1372,8 +1608,13 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(
                 pCBInfo->fenceId = fenceId;
                 pCBInfo->lastSubmittedFence = fence;
                 pCBInfo->lastSubmittedQueue = queue;
-                for (auto& function : pCBInfo->validate_functions) {
-                    skipCall |= function();
+                skipCall |= replay_mem_validation_records(my_data, pCBInfo);
+                for (auto mem : pCBInfo->pMemObjList) {
+                    MT_MEM_OBJ_INFO *pMemInfo = get_mem_obj_info(my_data, mem);
+                    if (pMemInfo) {
+                        pMemInfo->inFlightCount++;
+                        submission.memRefs.push_back(std::make_pair(mem, pMemInfo->allocSerial));
+                    }
                 }
             }
         }
@@ -1403,14 +1644,17 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(
             }
         }
     }
+    if (!submission.memRefs.empty()) {
+        my_data->queueMap[queue].pendingSubmissions.push_back(std::move(submission));
+    }
 
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->QueueSubmit(
             queue, submitCount, pSubmits, fence);
     }
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
         const VkSubmitInfo *submit = &pSubmits[submit_idx];
         for (uint32_t i = 0; i < submit->waitSemaphoreCount; i++) {
@@ -1421,7 +1665,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(
             }
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     return result;
 }
@@ -1434,11 +1678,28 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->AllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
-    // TODO : Track allocations and overall size here
-    loader_platform_thread_lock_mutex(&globalLock);
-    add_mem_obj_info(my_data, device, *pMemory, pAllocateInfo);
-    print_mem_list(my_data, device);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
+    if (VK_SUCCESS == result) {
+        add_mem_obj_info(my_data, device, *pMemory, pAllocateInfo);
+        VkMemoryUsageLUNARG *pUsage = &my_data->memoryUsage;
+        pUsage->allocationCount++;
+        if (pAllocateInfo->memoryTypeIndex < VK_MAX_MEMORY_TYPES) {
+            pUsage->typeBytes[pAllocateInfo->memoryTypeIndex] += pAllocateInfo->allocationSize;
+            pUsage->typeAllocationCount[pAllocateInfo->memoryTypeIndex]++;
+        }
+        uint32_t maxAllocations = my_data->properties.limits.maxMemoryAllocationCount;
+        if (maxAllocations && pUsage->allocationCount > maxAllocations) {
+            log_msg(my_data->report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, (uint64_t) *pMemory, __LINE__,
+                    MEMTRACK_ALLOCATION_COUNT_EXCEEDED, "MEM", "vkAllocateMemory: %u live allocations exceed maxMemoryAllocationCount of %u",
+                    pUsage->allocationCount, maxAllocations);
+        }
+    } else if (VK_ERROR_OUT_OF_DEVICE_MEMORY == result) {
+        char reason[128];
+        snprintf(reason, sizeof(reason), "vkAllocateMemory of %" PRIu64 " bytes from memory type %u ran out of device memory",
+                 (uint64_t)pAllocateInfo->allocationSize, pAllocateInfo->memoryTypeIndex);
+        log_memory_usage(my_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, MEMTRACK_OUT_OF_DEVICE_MEMORY, 0, reason);
+    }
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     return result;
 }
 
@@ -1458,11 +1719,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkFreeMemory(
     // buffers (on host or device) for anything other than destroying those objects will result in
     // undefined behavior.
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     freeMemObjInfo(my_data, device, mem, VK_FALSE);
-    print_mem_list(my_data, device);
-    printCBList(my_data, device);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     my_data->device_dispatch_table->FreeMemory(device, mem, pAllocator);
 }
 
@@ -1523,6 +1782,202 @@ storeMemRanges(
     }
 }
 
+static char NoncoherentMemoryFillValue = 0xb;
+
+// Returns true if any of the size bytes at p no longer holds NoncoherentMemoryFillValue.
+//  Compares a word at a time, since guard bands are as large as the mapping itself.
+static bool
+guardBytesChanged(
+    const char *p,
+    size_t      size)
+{
+    uint64_t pattern;
+    memset(&pattern, NoncoherentMemoryFillValue, sizeof(pattern));
+    size_t i = 0;
+    for (; i < size && ((uintptr_t)(p + i) % sizeof(uint64_t)); ++i) {
+        if (p[i] != NoncoherentMemoryFillValue)
+            return true;
+    }
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        if (*reinterpret_cast<const uint64_t*>(p + i) != pattern)
+            return true;
+    }
+    for (; i < size; ++i) {
+        if (p[i] != NoncoherentMemoryFillValue)
+            return true;
+    }
+    return false;
+}
+
+#if defined(__linux__)
+// Shadow of a non-coherent mapping when guard_page_map_shadows is set. One mmap'd region
+//  holds a PROT_NONE guard page, the data pages and a second guard page. The data ends
+//  exactly at the trailing guard page; the slack in front of it is filled with
+//  NoncoherentMemoryFillValue and checked on flush. Data pages stay read-only until the
+//  app writes them, so the fault handler can record which pages a flush has to copy.
+//  The kernel does not raise SIGSEGV for its own writes, so a syscall that writes into
+//  a clean page of the mapping (read(2), recv(2), ...) fails with EFAULT instead.
+struct MT_GUARDED_SHADOW {
+    char                  *base;       // Start of the region, the leading guard page
+    size_t                 regionSize; // Including both guard pages
+    char                  *pages;      // First data page
+    size_t                 pageCount;
+    size_t                 slack;      // Fill bytes in front of the data
+    volatile sig_atomic_t *dirty;      // Per data page, set by the fault handler
+    volatile sig_atomic_t  overflowed; // Set by the fault handler when a guard page is touched
+};
+
+static const uint32_t MAX_GUARDED_SHADOWS = 256;
+static size_t guardedShadowPageSize = 0;
+// Searched by the SIGSEGV handler, so entries are published and retired atomically
+static std::atomic<MT_GUARDED_SHADOW*> guardedShadows[MAX_GUARDED_SHADOWS];
+static struct sigaction previousSegvAction;
+// Live guarded shadows. The SIGSEGV handler is only installed while this is non-zero.
+//  Caller must hold globalLock.
+static uint32_t guardedShadowCount = 0;
+
+static void
+guardedShadowFault(
+    int        sig,
+    siginfo_t *info,
+    void      *context)
+{
+    char *addr = static_cast<char*>(info->si_addr);
+    for (uint32_t i = 0; i < MAX_GUARDED_SHADOWS; ++i) {
+        MT_GUARDED_SHADOW *shadow = guardedShadows[i].load(std::memory_order_acquire);
+        if (!shadow || addr < shadow->base || addr >= shadow->base + shadow->regionSize)
+            continue;
+        char *page = shadow->base + ((addr - shadow->base) / guardedShadowPageSize) * guardedShadowPageSize;
+        if (page >= shadow->pages && page < shadow->pages + shadow->pageCount * guardedShadowPageSize) {
+            shadow->dirty[(page - shadow->pages) / guardedShadowPageSize] = 1;
+        } else {
+            // Let the access through so the app keeps running; the next flush reports it
+            shadow->overflowed = 1;
+        }
+        mprotect(page, guardedShadowPageSize, PROT_READ | PROT_WRITE);
+        return;
+    }
+    // Not a shadow page, hand the fault to whoever had it before us
+    if (previousSegvAction.sa_flags & SA_SIGINFO) {
+        previousSegvAction.sa_sigaction(sig, info, context);
+    } else if (previousSegvAction.sa_handler != SIG_DFL && previousSegvAction.sa_handler != SIG_IGN) {
+        previousSegvAction.sa_handler(sig);
+    } else {
+        // Returning re-executes the faulting access with the default action in place
+        signal(SIGSEGV, SIG_DFL);
+    }
+}
+
+// Returns NULL if no guarded shadow can be made, the caller then falls back to a plain one
+static MT_GUARDED_SHADOW*
+createGuardedShadow(
+    size_t size)
+{
+    if (!guardedShadowPageSize) {
+        guardedShadowPageSize = (size_t) sysconf(_SC_PAGESIZE);
+    }
+    if (!guardedShadowCount) {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = guardedShadowFault;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGSEGV, &action, &previousSegvAction) != 0)
+            return NULL;
+    }
+    MT_GUARDED_SHADOW *shadow = new MT_GUARDED_SHADOW;
+    shadow->pageCount = (size + guardedShadowPageSize - 1) / guardedShadowPageSize;
+    shadow->slack = shadow->pageCount * guardedShadowPageSize - size;
+    shadow->regionSize = (shadow->pageCount + 2) * guardedShadowPageSize;
+    void *region = mmap(NULL, shadow->regionSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        delete shadow;
+        if (!guardedShadowCount)
+            sigaction(SIGSEGV, &previousSegvAction, NULL);
+        return NULL;
+    }
+    shadow->base = static_cast<char*>(region);
+    shadow->pages = shadow->base + guardedShadowPageSize;
+    shadow->dirty = new sig_atomic_t[shadow->pageCount]();
+    shadow->overflowed = 0;
+    if (shadow->slack) {
+        mprotect(shadow->pages, guardedShadowPageSize, PROT_READ | PROT_WRITE);
+        memset(shadow->pages, NoncoherentMemoryFillValue, shadow->slack);
+    }
+    mprotect(shadow->pages, shadow->pageCount * guardedShadowPageSize, PROT_READ);
+    for (uint32_t i = 0; i < MAX_GUARDED_SHADOWS; ++i) {
+        MT_GUARDED_SHADOW *expected = NULL;
+        if (guardedShadows[i].compare_exchange_strong(expected, shadow)) {
+            guardedShadowCount++;
+            return shadow;
+        }
+    }
+    munmap(region, shadow->regionSize);
+    delete[] shadow->dirty;
+    delete shadow;
+    if (!guardedShadowCount)
+        sigaction(SIGSEGV, &previousSegvAction, NULL);
+    return NULL;
+}
+
+static void
+destroyGuardedShadow(
+    MT_GUARDED_SHADOW *shadow)
+{
+    for (uint32_t i = 0; i < MAX_GUARDED_SHADOWS; ++i) {
+        MT_GUARDED_SHADOW *expected = shadow;
+        if (guardedShadows[i].compare_exchange_strong(expected, NULL))
+            break;
+    }
+    munmap(shadow->base, shadow->regionSize);
+    delete[] shadow->dirty;
+    delete shadow;
+    // Hand SIGSEGV back once the last shadow is gone
+    if (--guardedShadowCount == 0)
+        sigaction(SIGSEGV, &previousSegvAction, NULL);
+}
+
+// Check the guards and copy the dirty pages within one flushed range to the driver
+static VkBool32
+flushGuardedShadow(
+    layer_data                *my_data,
+    MT_MEM_OBJ_INFO           *pMemObj,
+    const VkMappedMemoryRange &range)
+{
+    VkBool32 skipCall = VK_FALSE;
+    MT_GUARDED_SHADOW *shadow = pMemObj->pGuardedShadow;
+    if (shadow->overflowed || guardBytesChanged(shadow->pages, shadow->slack)) {
+        skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, (uint64_t)range.memory,
+                            __LINE__, MEMTRACK_INVALID_MAP, "MEM", "Memory overflow was detected on mem obj %" PRIxLEAST64, (uint64_t)range.memory);
+    }
+    // Flushed range in bytes from the start of the mapping
+    size_t dataSize = shadow->pageCount * guardedShadowPageSize - shadow->slack;
+    size_t begin = (range.offset > pMemObj->memRange.offset) ? (size_t)(range.offset - pMemObj->memRange.offset) : 0;
+    size_t end = (range.size == VK_WHOLE_SIZE) ? dataSize : begin + (size_t)range.size;
+    if (end > dataSize)
+        end = dataSize;
+    if (begin >= end)
+        return skipCall;
+    char *data = shadow->pages + shadow->slack;
+    char *driverData = static_cast<char*>(pMemObj->pDriverData);
+    for (size_t page = (begin + shadow->slack) / guardedShadowPageSize; page <= (end - 1 + shadow->slack) / guardedShadowPageSize; ++page) {
+        if (!shadow->dirty[page])
+            continue;
+        size_t pageBegin = (page == 0) ? 0 : page * guardedShadowPageSize - shadow->slack;
+        size_t pageEnd = (page + 1) * guardedShadowPageSize - shadow->slack;
+        size_t copyBegin = (begin > pageBegin) ? begin : pageBegin;
+        size_t copyEnd = (end < pageEnd) ? end : pageEnd;
+        memcpy(driverData + copyBegin, data + copyBegin, copyEnd - copyBegin);
+        // A page only partly flushed stays dirty for the flush that covers the rest
+        if (copyBegin == pageBegin && copyEnd == pageEnd) {
+            shadow->dirty[page] = 0;
+            mprotect(shadow->pages + page * guardedShadowPageSize, guardedShadowPageSize, PROT_READ);
+        }
+    }
+    return skipCall;
+}
+#endif
+
 VkBool32 deleteMemRanges(
     layer_data     *my_data,
     VkDeviceMemory  mem)
@@ -1540,12 +1995,16 @@ VkBool32 deleteMemRanges(
             free(mem_element->second.pData);
             mem_element->second.pData = 0;
         }
+#if defined(__linux__)
+        if (mem_element->second.pGuardedShadow) {
+            destroyGuardedShadow(mem_element->second.pGuardedShadow);
+            mem_element->second.pGuardedShadow = NULL;
+        }
+#endif
     }
     return skipCall;
 }
 
-static char NoncoherentMemoryFillValue = 0xb;
-
 void
 initializeAndTrackMemory(
     layer_data      *my_data,
@@ -1557,13 +2016,25 @@ initializeAndTrackMemory(
     if (mem_element != my_data->memObjMap.end()) {
         mem_element->second.pDriverData = *ppData;
         uint32_t index = mem_element->second.allocInfo.memoryTypeIndex;
-        if (memProps.memoryTypes[index].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+        if ((memProps.memoryTypes[index].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) ||
+            disabledChecks[MEMTRACK_INVALID_MAP]) {
+            // No shadow copy, so flushes have no guard bytes to check and nothing to copy
             mem_element->second.pData = 0;
         } else {
             if (size == VK_WHOLE_SIZE) {
                 size = mem_element->second.allocInfo.allocationSize;
             }
             size_t convSize = (size_t)(size);
+#if defined(__linux__)
+            if (guardPageMapShadows) {
+                MT_GUARDED_SHADOW *shadow = createGuardedShadow(convSize);
+                if (shadow) {
+                    mem_element->second.pGuardedShadow = shadow;
+                    *ppData = shadow->pages + shadow->slack;
+                    return;
+                }
+            }
+#endif
             mem_element->second.pData = malloc(2 * convSize);
             memset(mem_element->second.pData, NoncoherentMemoryFillValue, 2 * convSize);
             *ppData = static_cast<char*>(mem_element->second.pData) + (convSize / 2);
@@ -1582,7 +2053,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkBool32 skipCall   = VK_FALSE;
     VkResult result     = VK_ERROR_VALIDATION_FAILED_EXT;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     MT_MEM_OBJ_INFO *pMemObj = get_mem_obj_info(my_data, mem);
     if (pMemObj) {
         pMemObj->valid = true;
@@ -1595,10 +2066,12 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory(
     }
     skipCall |= validateMemRange(my_data, mem, offset, size);
     storeMemRanges(my_data, mem, offset, size);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->MapMemory(device, mem, offset, size, flags, ppData);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         initializeAndTrackMemory(my_data, mem, size, ppData);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -1610,9 +2083,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkUnmapMemory(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkBool32 skipCall   = VK_FALSE;
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     skipCall |= deleteMemRanges(my_data, mem);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->UnmapMemory(device, mem);
     }
@@ -1648,21 +2121,23 @@ validateAndCopyNoncoherentMemoryToDriver(
     for (uint32_t i = 0; i < memRangeCount; ++i) {
         auto mem_element = my_data->memObjMap.find(pMemRanges[i].memory);
         if (mem_element != my_data->memObjMap.end()) {
+#if defined(__linux__)
+            if (mem_element->second.pGuardedShadow) {
+                skipCall |= flushGuardedShadow(my_data, &mem_element->second, pMemRanges[i]);
+                continue;
+            }
+#endif
             if (mem_element->second.pData) {
                 VkDeviceSize size      = mem_element->second.memRange.size;
+                if (size == VK_WHOLE_SIZE) {
+                    size = mem_element->second.allocInfo.allocationSize;
+                }
                 VkDeviceSize half_size = (size / 2);
                 char* data = static_cast<char*>(mem_element->second.pData);
-                for (auto j = 0; j < half_size; ++j) {
-                    if (data[j] != NoncoherentMemoryFillValue) {
-                        skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, (uint64_t)pMemRanges[i].memory,
-                                            __LINE__, MEMTRACK_INVALID_MAP, "MEM", "Memory overflow was detected on mem obj %" PRIxLEAST64, (uint64_t)pMemRanges[i].memory);
-                    }
-                }
-                for (auto j = size + half_size; j < 2 * size; ++j) {
-                    if (data[j] != NoncoherentMemoryFillValue) {
-                        skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, (uint64_t)pMemRanges[i].memory,
-                                            __LINE__, MEMTRACK_INVALID_MAP, "MEM", "Memory overflow was detected on mem obj %" PRIxLEAST64, (uint64_t)pMemRanges[i].memory);
-                    }
+                if (guardBytesChanged(data, (size_t)half_size) ||
+                    guardBytesChanged(data + (size_t)(size + half_size), (size_t)(size - half_size))) {
+                    skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, (uint64_t)pMemRanges[i].memory,
+                                        __LINE__, MEMTRACK_INVALID_MAP, "MEM", "Memory overflow was detected on mem obj %" PRIxLEAST64, (uint64_t)pMemRanges[i].memory);
                 }
                 memcpy(mem_element->second.pDriverData, static_cast<void*>(data + (size_t)(half_size)), (size_t)(size));
             }
@@ -1680,10 +2155,10 @@ VK_LAYER_EXPORT VkResult VKAPI_CALL vkFlushMappedMemoryRanges(
     VkBool32    skipCall  = VK_FALSE;
     layer_data *my_data   = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     skipCall  |= validateAndCopyNoncoherentMemoryToDriver(my_data, memRangeCount, pMemRanges);
     skipCall  |= validateMemoryIsMapped(my_data, memRangeCount, pMemRanges);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall ) {
         result = my_data->device_dispatch_table->FlushMappedMemoryRanges(device, memRangeCount, pMemRanges);
     }
@@ -1699,9 +2174,9 @@ VK_LAYER_EXPORT VkResult VKAPI_CALL vkInvalidateMappedMemoryRanges(
     VkBool32    skipCall = VK_FALSE;
     layer_data *my_data   = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     skipCall |= validateMemoryIsMapped(my_data, memRangeCount, pMemRanges);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->InvalidateMappedMemoryRanges(device, memRangeCount, pMemRanges);
     }
@@ -1714,16 +2189,81 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyFence(
     const VkAllocationCallbacks *pAllocator)
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     delete_fence_info(my_data, fence);
     auto item = my_data->fenceMap.find(fence);
     if (item != my_data->fenceMap.end()) {
         my_data->fenceMap.erase(item);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     my_data->device_dispatch_table->DestroyFence(device, fence, pAllocator);
 }
 
+// Drop the range a buffer or image was bound to once it is destroyed
+static void remove_memory_range(
+    unordered_map<VkDeviceMemory, memory_range_tree>& ranges,
+    uint64_t handle,
+    const MT_OBJ_BINDING_INFO& bindInfo)
+{
+    auto it = ranges.find(bindInfo.mem);
+    if (it != ranges.end())
+        it->second.erase(bindInfo.memOffset, handle);
+}
+
+// Charge a newly bound buffer or image to its memory object and the per-type usage totals
+static void
+account_bound_memory(
+    layer_data                 *my_data,
+    uint64_t                    handle,
+    VkDebugReportObjectTypeEXT  type,
+    VkDeviceMemory              mem,
+    VkDeviceSize                size)
+{
+    MT_OBJ_BINDING_INFO *pBindInfo = get_object_binding_info(my_data, handle, type);
+    MT_MEM_OBJ_INFO *pMemInfo = get_mem_obj_info(my_data, mem);
+    // set_mem_binding reports rebinds, the first binding keeps the charge
+    if (!pBindInfo || !pMemInfo || pBindInfo->memSize != 0) {
+        return;
+    }
+    pBindInfo->memSize = size;
+    pMemInfo->boundBytes += size;
+    if (VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT == type) {
+        my_data->memoryUsage.bufferCount++;
+        my_data->memoryUsage.bufferBytes += size;
+    } else {
+        my_data->memoryUsage.imageCount++;
+        my_data->memoryUsage.imageBytes += size;
+    }
+}
+
+// Undo account_bound_memory, called before clear_object_binding drops the object from its mem obj
+static void
+release_bound_memory(
+    layer_data                 *my_data,
+    uint64_t                    handle,
+    VkDebugReportObjectTypeEXT  type,
+    const MT_OBJ_BINDING_INFO  &bindInfo)
+{
+    if (bindInfo.memSize == 0) {
+        return;
+    }
+    MT_MEM_OBJ_INFO *pMemInfo = get_mem_obj_info(my_data, bindInfo.mem);
+    MT_OBJ_HANDLE_TYPE oht;
+    oht.handle = handle;
+    oht.type = type;
+    // Once its memory is freed, a reused handle no longer lists this object
+    if (pMemInfo && pMemInfo->pObjBindings.count(oht)) {
+        pMemInfo->boundBytes -= bindInfo.memSize;
+    }
+    if (VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT == type) {
+        my_data->memoryUsage.bufferCount--;
+        my_data->memoryUsage.bufferBytes -= bindInfo.memSize;
+    } else {
+        my_data->memoryUsage.imageCount--;
+        my_data->memoryUsage.imageBytes -= bindInfo.memSize;
+    }
+}
+
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer(
     VkDevice                     device,
     VkBuffer                     buffer,
@@ -1731,13 +2271,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkBool32 skipCall = VK_FALSE;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     auto item = my_data->bufferMap.find((uint64_t)buffer);
     if (item != my_data->bufferMap.end()) {
+        remove_memory_range(my_data->bufferRanges, (uint64_t)buffer, item->second);
+        release_bound_memory(my_data, (uint64_t)buffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, item->second);
         skipCall = clear_object_binding(my_data, device, (uint64_t)buffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT);
         my_data->bufferMap.erase(item);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->DestroyBuffer(device, buffer, pAllocator);
     }
@@ -1750,13 +2292,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyImage(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkBool32 skipCall = VK_FALSE;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     auto item = my_data->imageMap.find((uint64_t)image);
     if (item != my_data->imageMap.end()) {
+        remove_memory_range(my_data->imageRanges, (uint64_t)image, item->second);
+        release_bound_memory(my_data, (uint64_t)image, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, item->second);
         skipCall = clear_object_binding(my_data, device, (uint64_t)image, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT);
         my_data->imageMap.erase(item);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->DestroyImage(device, image, pAllocator);
     }
@@ -1772,17 +2316,17 @@ VkBool32 print_memory_range_error(layer_data *my_data, const uint64_t object_han
     }
 }
 
-VkBool32 validate_memory_range(layer_data *my_data, const unordered_map<VkDeviceMemory, vector<MEMORY_RANGE>>& memory, const MEMORY_RANGE& new_range, VkDebugReportObjectTypeEXT object_type) {
+VkBool32 validate_memory_range(layer_data *my_data, const unordered_map<VkDeviceMemory, memory_range_tree>& memory, const MEMORY_RANGE& new_range, VkDebugReportObjectTypeEXT object_type) {
     VkBool32 skip_call = false;
-    if (!memory.count(new_range.memory)) return false;
-    const vector<MEMORY_RANGE>& ranges = memory.at(new_range.memory);
-    for (auto range : ranges) {
-        if ((range.end & ~(my_data->properties.limits.bufferImageGranularity - 1)) <
-            (new_range.start & ~(my_data->properties.limits.bufferImageGranularity - 1))) continue;
-        if ((range.start & ~(my_data->properties.limits.bufferImageGranularity - 1)) >
-            (new_range.end & ~(my_data->properties.limits.bufferImageGranularity - 1))) continue;
+    auto ranges = memory.find(new_range.memory);
+    if (ranges == memory.end()) return false;
+    // Ranges alias if they share a bufferImageGranularity-sized page, so widen the query to whole pages
+    VkDeviceSize page_mask = ~(my_data->properties.limits.bufferImageGranularity - 1);
+    VkDeviceSize first = new_range.start & page_mask;
+    VkDeviceSize last = (new_range.end & page_mask) + ~page_mask;
+    ranges->second.for_each_overlap(first, last, [&](const MEMORY_RANGE& range) {
         skip_call |= print_memory_range_error(my_data, new_range.handle, range.handle, object_type);
-    }
+    });
     return skip_call;
 }
 
@@ -1792,8 +2336,8 @@ VkBool32 validate_buffer_image_aliasing(
     VkDeviceMemory mem,
     VkDeviceSize memoryOffset,
     VkMemoryRequirements memRequirements,
-    unordered_map<VkDeviceMemory, vector<MEMORY_RANGE>>& ranges,
-    const unordered_map<VkDeviceMemory, vector<MEMORY_RANGE>>& other_ranges,
+    unordered_map<VkDeviceMemory, memory_range_tree>& ranges,
+    const unordered_map<VkDeviceMemory, memory_range_tree>& other_ranges,
     VkDebugReportObjectTypeEXT object_type)
 {
     MEMORY_RANGE range;
@@ -1801,7 +2345,7 @@ VkBool32 validate_buffer_image_aliasing(
     range.memory = mem;
     range.start = memoryOffset;
     range.end = memoryOffset + memRequirements.size - 1;
-    ranges[mem].push_back(range);
+    ranges[mem].insert(range);
     return validate_memory_range(my_data, other_ranges, range, object_type);
 }
 
@@ -1813,18 +2357,18 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkBindBufferMemory(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     // Track objects tied to memory
     uint64_t buffer_handle = (uint64_t)(buffer);
     VkBool32 skipCall = set_mem_binding(my_data, device, mem, buffer_handle, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, "vkBindBufferMemory");
-    add_object_binding_info(my_data, buffer_handle, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, mem);
-    {
-        VkMemoryRequirements memRequirements;
-        vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+    add_object_binding_info(my_data, buffer_handle, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, mem, memoryOffset);
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+    account_bound_memory(my_data, buffer_handle, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, mem, memRequirements.size);
+    if (!disabledChecks[MEMTRACK_INVALID_ALIASING]) {
         skipCall |= validate_buffer_image_aliasing(my_data, buffer_handle, mem, memoryOffset, memRequirements, my_data->bufferRanges, my_data->imageRanges, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT);
     }
-    print_mem_list(my_data, device);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->BindBufferMemory(device, buffer, mem, memoryOffset);
     }
@@ -1839,18 +2383,18 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkBindImageMemory(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     // Track objects tied to memory
     uint64_t image_handle = (uint64_t)(image);
     VkBool32 skipCall = set_mem_binding(my_data, device, mem, image_handle, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, "vkBindImageMemory");
-    add_object_binding_info(my_data, image_handle, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, mem);
-    {
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(device, image, &memRequirements);
+    add_object_binding_info(my_data, image_handle, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, mem, memoryOffset);
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device, image, &memRequirements);
+    account_bound_memory(my_data, image_handle, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, mem, memRequirements.size);
+    if (!disabledChecks[MEMTRACK_INVALID_ALIASING]) {
         skipCall |= validate_buffer_image_aliasing(my_data, image_handle, mem, memoryOffset, memRequirements, my_data->imageRanges, my_data->bufferRanges, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT);
     }
-    print_mem_list(my_data, device);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->BindImageMemory(device, image, mem, memoryOffset);
     }
@@ -1889,7 +2433,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueBindSparse(
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     VkBool32 skipCall = VK_FALSE;
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
 
     for (uint32_t i = 0; i < bindInfoCount; i++) {
         // Track objects tied to memory
@@ -1922,8 +2466,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueBindSparse(
         }
     }
 
-    print_mem_list(my_data, queue);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->QueueBindSparse(queue, bindInfoCount, pBindInfo, fence);
     }
@@ -1939,14 +2482,14 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateFence(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->CreateFence(device, pCreateInfo, pAllocator, pFence);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         MT_FENCE_INFO* pFI = &my_data->fenceMap[*pFence];
         memset(pFI, 0, sizeof(MT_FENCE_INFO));
         memcpy(&(pFI->createInfo), pCreateInfo, sizeof(VkFenceCreateInfo));
         if (pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT) {
             pFI->firstTimeFlag = VK_TRUE;
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -1960,7 +2503,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetFences(
     VkResult result   = VK_ERROR_VALIDATION_FAILED_EXT;
     VkBool32 skipCall = VK_FALSE;
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     // Reset fence state in fenceCreateInfo structure
     for (uint32_t i = 0; i < fenceCount; i++) {
         auto fence_item = my_data->fenceMap.find(pFences[i]);
@@ -1977,7 +2520,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetFences(
             }
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->ResetFences(device, fenceCount, pFences);
     }
@@ -2024,16 +2567,16 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(
     VkFence  fence)
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     VkBool32 skipCall = verifyFenceStatus(device, fence, "vkGetFenceStatus");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (skipCall)
         return VK_ERROR_VALIDATION_FAILED_EXT;
     VkResult result = my_data->device_dispatch_table->GetFenceStatus(device, fence);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         update_fence_tracking(my_data, fence);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -2048,23 +2591,23 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkWaitForFences(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkBool32 skipCall = VK_FALSE;
     // Verify fence status of submitted fences
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for(uint32_t i = 0; i < fenceCount; i++) {
         skipCall |= verifyFenceStatus(device, pFences[i], "vkWaitForFences");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (skipCall)
         return VK_ERROR_VALIDATION_FAILED_EXT;
     VkResult result = my_data->device_dispatch_table->WaitForFences(device, fenceCount, pFences, waitAll, timeout);
 
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         if (waitAll || fenceCount == 1) { // Clear all the fences
             for(uint32_t i = 0; i < fenceCount; i++) {
                 update_fence_tracking(my_data, pFences[i]);
             }
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -2075,9 +2618,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueWaitIdle(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkResult result = my_data->device_dispatch_table->QueueWaitIdle(queue);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         retire_queue_fences(my_data, queue);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -2088,9 +2631,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkDeviceWaitIdle(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->DeviceWaitIdle(device);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         retire_device_fences(my_data, device);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -2104,9 +2647,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->CreateBuffer(device, pCreateInfo, pAllocator, pBuffer);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         add_object_create_info(my_data, (uint64_t)*pBuffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, pCreateInfo);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -2120,9 +2663,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->CreateImage(device, pCreateInfo, pAllocator, pImage);
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         add_object_create_info(my_data, (uint64_t)*pImage, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, pCreateInfo);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -2136,13 +2679,13 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateImageView(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->CreateImageView(device, pCreateInfo, pAllocator, pView);
     if (result == VK_SUCCESS) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         my_data->imageViewMap[*pView].image = pCreateInfo->image;
         // Validate that img has correct usage flags set
         validate_image_usage_flags(my_data, device, pCreateInfo->image,
                     VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
                     VK_FALSE, "vkCreateImageView()", "VK_IMAGE_USAGE_[SAMPLED|STORAGE|COLOR_ATTACHMENT]_BIT");
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -2156,13 +2699,13 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateBufferView(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->CreateBufferView(device, pCreateInfo, pAllocator, pView);
     if (result == VK_SUCCESS) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_read_lock_rwlock(&globalLock);
         // In order to create a valid buffer view, the buffer must have been created with at least one of the
         // following flags:  UNIFORM_TEXEL_BUFFER_BIT or STORAGE_TEXEL_BUFFER_BIT
         validate_buffer_usage_flags(my_data, device, pCreateInfo->buffer,
                     VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT,
                     VK_FALSE, "vkCreateBufferView()", "VK_BUFFER_USAGE_[STORAGE|UNIFORM]_TEXEL_BUFFER_BIT");
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_read_unlock_rwlock(&globalLock);
     }
     return result;
 }
@@ -2175,14 +2718,13 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAllocateCommandBuffers(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult    result  = my_data->device_dispatch_table->AllocateCommandBuffers(device, pCreateInfo, pCommandBuffer);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     if (VK_SUCCESS == result) {
         for (uint32_t i = 0; i < pCreateInfo->commandBufferCount; i++) {
             add_cmd_buf_info(my_data, pCreateInfo->commandPool, pCommandBuffer[i]);
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
-    printCBList(my_data, device);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     return result;
 }
 
@@ -2195,12 +2737,11 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkFreeCommandBuffers(
     VkBool32 skipCall = VK_FALSE;
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t i = 0; i < commandBufferCount; i++) {
         skipCall |= delete_cmd_buf_info(my_data, commandPool, pCommandBuffers[i]);
     }
-    printCBList(my_data, device);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->FreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
@@ -2216,11 +2757,11 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateCommandPool(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->CreateCommandPool(device, pCreateInfo, pAllocator, pCommandPool);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
 
     // Add cmd pool to map
     my_data->commandPoolMap[*pCommandPool].createFlags = pCreateInfo->flags;
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     return result;
 }
@@ -2234,7 +2775,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyCommandPool(
     VkBool32 skipCall              = VK_FALSE;
     // Verify that command buffers in pool are complete (not in-flight)
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (auto it = my_data->commandPoolMap[commandPool].pCommandBuffers.begin();
               it != my_data->commandPoolMap[commandPool].pCommandBuffers.end(); it++) {
         commandBufferComplete = VK_FALSE;
@@ -2246,13 +2787,13 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyCommandPool(
                                 reinterpret_cast<uint64_t>(*it));
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->DestroyCommandPool(device, commandPool, pAllocator);
     }
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     auto item = my_data->commandPoolMap[commandPool].pCommandBuffers.begin();
     // Remove command buffers from command buffer map
     while (item != my_data->commandPoolMap[commandPool].pCommandBuffers.end()) {
@@ -2260,7 +2801,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyCommandPool(
         delete_cmd_buf_info(my_data, commandPool, *del_item);
     }
     my_data->commandPoolMap.erase(commandPool);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandPool(
@@ -2273,7 +2814,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandPool(
     VkBool32    skipCall              = VK_FALSE;
     VkResult    result                = VK_ERROR_VALIDATION_FAILED_EXT;
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     auto it = my_data->commandPoolMap[commandPool].pCommandBuffers.begin();
     // Verify that CB's in pool are complete (not in-flight)
     while (it != my_data->commandPoolMap[commandPool].pCommandBuffers.end()) {
@@ -2288,7 +2829,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandPool(
         }
         ++it;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->ResetCommandPool(device, commandPool, flags);
@@ -2305,7 +2846,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkBeginCommandBuffer(
     VkResult result            = VK_ERROR_VALIDATION_FAILED_EXT;
     VkBool32 skipCall          = VK_FALSE;
     VkBool32 commandBufferComplete = VK_FALSE;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
 
     // This implicitly resets the Cmd Buffer so make sure any fence is done and then clear memory references
     skipCall = checkCBCompleted(my_data, commandBuffer, &commandBufferComplete);
@@ -2315,13 +2856,13 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkBeginCommandBuffer(
                         MEMTRACK_RESET_CB_WHILE_IN_FLIGHT, "MEM", "Calling vkBeginCommandBuffer() on active CB %p before it has completed. "
                         "You must check CB flag before this call.", commandBuffer);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->BeginCommandBuffer(commandBuffer, pBeginInfo);
     }
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     clear_cmd_buf_and_mem_references(my_data, commandBuffer);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     return result;
 }
 
@@ -2342,7 +2883,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandBuffer(
     VkResult result            = VK_ERROR_VALIDATION_FAILED_EXT;
     VkBool32 skipCall          = VK_FALSE;
     VkBool32 commandBufferComplete = VK_FALSE;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
 
     // Verify that CB is complete (not in-flight)
     skipCall = checkCBCompleted(my_data, commandBuffer, &commandBufferComplete);
@@ -2353,7 +2894,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandBuffer(
     }
     // Clear memory references as this point.
     skipCall |= clear_cmd_buf_and_mem_references(my_data, commandBuffer);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->ResetCommandBuffer(commandBuffer, flags);
     }
@@ -2395,9 +2936,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(
     const uint32_t        *pDynamicOffsets)
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    if (cb_data != my_data->cbMap.end()) {
-        std::vector<VkDescriptorSet>& activeDescriptorSets = cb_data->second.activeDescriptorSets;
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
+    if (pCBInfo) {
+        std::vector<VkDescriptorSet>& activeDescriptorSets = pCBInfo->activeDescriptorSets;
         if (activeDescriptorSets.size() < (setCount + firstSet)) {
             activeDescriptorSets.resize(setCount + firstSet);
         }
@@ -2405,6 +2946,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(
             activeDescriptorSets[i + firstSet] = pDescriptorSets[i];
         }
     }
+    unlockCBForRecording(pCBInfo);
     // TODO : Somewhere need to verify that all textures referenced by shaders in DS are in some type of *SHADER_READ* state
     my_data->device_dispatch_table->CmdBindDescriptorSets(
         commandBuffer, pipelineBindPoint, layout, firstSet, setCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
@@ -2419,18 +2961,16 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindVertexBuffers(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkBool32 skip_call = false;
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     for (uint32_t i = 0; i < bindingCount; ++i) {
         VkDeviceMemory mem;
         skip_call |= get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)(pBuffers[i]),
             VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
-        auto cb_data = my_data->cbMap.find(commandBuffer);
-        if (cb_data != my_data->cbMap.end()) {
-            std::function<VkBool32()> function = [=]() { return validate_memory_is_valid(my_data, mem, "vkCmdBindVertexBuffers()"); };
-            cb_data->second.validate_functions.push_back(function);
+        if (pCBInfo) {
+            add_mem_validation_record(pCBInfo, MT_MEM_VALIDATE, mem, VK_NULL_HANDLE, "vkCmdBindVertexBuffers()");
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     // TODO : Somewhere need to verify that VBs have correct usage state flagged
     if (!skip_call)
         my_data->device_dispatch_table->CmdBindVertexBuffers(commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets);
@@ -2444,14 +2984,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindIndexBuffer(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     VkBool32 skip_call = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)(buffer), VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { return validate_memory_is_valid(my_data, mem, "vkCmdBindIndexBuffer()"); };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_VALIDATE, mem, VK_NULL_HANDLE, "vkCmdBindIndexBuffer()");
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     // TODO : Somewhere need to verify that IBs have correct usage state flagged
     if (!skip_call)
         my_data->device_dispatch_table->CmdBindIndexBuffer(commandBuffer, buffer, offset, indexType);
@@ -2465,6 +3003,8 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkUpdateDescriptorSets(
     const VkCopyDescriptorSet*                  pDescriptorCopies)
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    // Recording calls read descriptorSetMap under the shared lock
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t i = 0; i < descriptorWriteCount; ++i) {
         if (pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE) {
             my_data->descriptorSetMap[pDescriptorWrites[i].dstSet].images.push_back(pDescriptorWrites[i].pImageInfo->imageView);
@@ -2475,40 +3015,39 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkUpdateDescriptorSets(
             my_data->descriptorSetMap[pDescriptorWrites[i].dstSet].buffers.push_back(pDescriptorWrites[i].pBufferInfo->buffer);
         }
     }
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     my_data->device_dispatch_table->UpdateDescriptorSets(device, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount, pDescriptorCopies);
 }
 
-bool markStoreImagesAndBuffersAsWritten(
-    VkCommandBuffer commandBuffer)
+// Caller must hold the CB's recording lock, see lockCBForRecording()
+static bool
+markStoreImagesAndBuffersAsWritten(
+    layer_data      *my_data,
+    VkCommandBuffer  commandBuffer,
+    MT_CB_INFO      *pCBInfo)
 {
     bool skip_call = false;
-    loader_platform_thread_lock_mutex(&globalLock);
-    layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    if (cb_data == my_data->cbMap.end()) return skip_call;
-    std::vector<VkDescriptorSet>& activeDescriptorSets = cb_data->second.activeDescriptorSets;
+    if (!pCBInfo) return skip_call;
+    std::vector<VkDescriptorSet>& activeDescriptorSets = pCBInfo->activeDescriptorSets;
     for (auto descriptorSet : activeDescriptorSets) {
         auto ds_data = my_data->descriptorSetMap.find(descriptorSet);
         if (ds_data == my_data->descriptorSetMap.end()) continue;
-        std::vector<VkImageView> images = ds_data->second.images;
-        std::vector<VkBuffer> buffers = ds_data->second.buffers;
+        const std::vector<VkImageView>& images = ds_data->second.images;
+        const std::vector<VkBuffer>& buffers = ds_data->second.buffers;
         for (auto imageView : images) {
             auto iv_data = my_data->imageViewMap.find(imageView);
             if (iv_data == my_data->imageViewMap.end()) continue;
             VkImage image = iv_data->second.image;
             VkDeviceMemory mem;
             skip_call |= get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)image, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
-            std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true, image); return VK_FALSE; };
-            cb_data->second.validate_functions.push_back(function);
+            add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem, image);
         }
         for (auto buffer : buffers) {
             VkDeviceMemory mem;
             skip_call |= get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)buffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
-            std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true); return VK_FALSE; };
-            cb_data->second.validate_functions.push_back(function);
+            add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem);
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
     return skip_call;
 }
 
@@ -2520,7 +3059,9 @@ VKAPI_ATTR void VKAPI_CALL vkCmdDraw(
     uint32_t                                    firstInstance)
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    bool skip_call = markStoreImagesAndBuffersAsWritten(commandBuffer);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
+    bool skip_call = markStoreImagesAndBuffersAsWritten(my_data, commandBuffer, pCBInfo);
+    unlockCBForRecording(pCBInfo);
     if (!skip_call)
         my_data->device_dispatch_table->CmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
 }
@@ -2534,7 +3075,9 @@ VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(
     uint32_t                                    firstInstance)
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    bool skip_call = markStoreImagesAndBuffersAsWritten(commandBuffer);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
+    bool skip_call = markStoreImagesAndBuffersAsWritten(my_data, commandBuffer, pCBInfo);
+    unlockCBForRecording(pCBInfo);
     if (!skip_call)
         my_data->device_dispatch_table->CmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
@@ -2548,11 +3091,11 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndirect(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     VkBool32 skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)buffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
     skipCall          |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdDrawIndirect");
-    skipCall |= markStoreImagesAndBuffersAsWritten(commandBuffer);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    skipCall |= markStoreImagesAndBuffersAsWritten(my_data, commandBuffer, pCBInfo);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdDrawIndirect(commandBuffer, buffer, offset, count, stride);
     }
@@ -2567,11 +3110,11 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexedIndirect(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     VkBool32 skipCall = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)buffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
     skipCall         |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdDrawIndexedIndirect");
-    skipCall |= markStoreImagesAndBuffersAsWritten(commandBuffer);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    skipCall |= markStoreImagesAndBuffersAsWritten(my_data, commandBuffer, pCBInfo);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdDrawIndexedIndirect(commandBuffer, buffer, offset, count, stride);
     }
@@ -2585,7 +3128,9 @@ VKAPI_ATTR void VKAPI_CALL vkCmdDispatch(
     uint32_t                                    z)
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    bool skip_call = markStoreImagesAndBuffersAsWritten(commandBuffer);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
+    bool skip_call = markStoreImagesAndBuffersAsWritten(my_data, commandBuffer, pCBInfo);
+    unlockCBForRecording(pCBInfo);
     if (!skip_call)
         my_data->device_dispatch_table->CmdDispatch(commandBuffer, x, y, z);
 }
@@ -2597,11 +3142,11 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDispatchIndirect(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     VkBool32 skipCall = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)buffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
     skipCall         |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdDispatchIndirect");
-    skipCall |= markStoreImagesAndBuffersAsWritten(commandBuffer);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    skipCall |= markStoreImagesAndBuffersAsWritten(my_data, commandBuffer, pCBInfo);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdDispatchIndirect(commandBuffer, buffer, offset);
     }
@@ -2617,24 +3162,21 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyBuffer(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
     VkBool32       skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)srcBuffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { return validate_memory_is_valid(my_data, mem, "vkCmdCopyBuffer()"); };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_VALIDATE, mem, VK_NULL_HANDLE, "vkCmdCopyBuffer()");
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdCopyBuffer");
     skipCall |= get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)dstBuffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdCopyBuffer");
     // Validate that SRC & DST buffers have correct usage flags set
     skipCall |= validate_buffer_usage_flags(my_data, commandBuffer, srcBuffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true, "vkCmdCopyBuffer()", "VK_BUFFER_USAGE_TRANSFER_SRC_BIT");
     skipCall |= validate_buffer_usage_flags(my_data, commandBuffer, dstBuffer, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, "vkCmdCopyBuffer()", "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, regionCount, pRegions);
     }
@@ -2653,17 +3195,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyQueryPoolResults(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
     VkBool32       skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     skipCall |= get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)dstBuffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdCopyQueryPoolResults");
     // Validate that DST buffer has correct usage flags set
     skipCall |= validate_buffer_usage_flags(my_data, commandBuffer, dstBuffer, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, "vkCmdCopyQueryPoolResults()", "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdCopyQueryPoolResults(commandBuffer, queryPool, firstQuery, queryCount, dstBuffer, dstOffset, destStride, flags);
     }
@@ -2681,24 +3221,21 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyImage(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
     VkBool32       skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     // Validate that src & dst images have correct usage flags set
     skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)srcImage, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { return validate_memory_is_valid(my_data, mem, "vkCmdCopyImage()", srcImage); };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_VALIDATE, mem, srcImage, "vkCmdCopyImage()");
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdCopyImage");
     skipCall |= get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)dstImage, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true, dstImage); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem, dstImage);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdCopyImage");
     skipCall |= validate_image_usage_flags(my_data, commandBuffer, srcImage, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, true, "vkCmdCopyImage()", "VK_IMAGE_USAGE_TRANSFER_SRC_BIT");
     skipCall |= validate_image_usage_flags(my_data, commandBuffer, dstImage, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true, "vkCmdCopyImage()", "VK_IMAGE_USAGE_TRANSFER_DST_BIT");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdCopyImage(
             commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions);
@@ -2718,24 +3255,21 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBlitImage(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
     VkBool32       skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     // Validate that src & dst images have correct usage flags set
     skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)srcImage, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { return validate_memory_is_valid(my_data, mem, "vkCmdBlitImage()", srcImage); };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_VALIDATE, mem, srcImage, "vkCmdBlitImage()");
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdBlitImage");
     skipCall |= get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)dstImage, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);\
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true, dstImage); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem, dstImage);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdBlitImage");
     skipCall |= validate_image_usage_flags(my_data, commandBuffer, srcImage, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, true, "vkCmdBlitImage()", "VK_IMAGE_USAGE_TRANSFER_SRC_BIT");
     skipCall |= validate_image_usage_flags(my_data, commandBuffer, dstImage, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true, "vkCmdBlitImage()", "VK_IMAGE_USAGE_TRANSFER_DST_BIT");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdBlitImage(
             commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions, filter);
@@ -2753,24 +3287,21 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyBufferToImage(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
     VkBool32       skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)dstImage, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true, dstImage); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem, dstImage);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdCopyBufferToImage");
     skipCall |= get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)srcBuffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { return validate_memory_is_valid(my_data, mem, "vkCmdCopyBufferToImage()"); };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_VALIDATE, mem, VK_NULL_HANDLE, "vkCmdCopyBufferToImage()");
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdCopyBufferToImage");
     // Validate that src buff & dst image have correct usage flags set
     skipCall |= validate_buffer_usage_flags(my_data, commandBuffer, srcBuffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true, "vkCmdCopyBufferToImage()", "VK_BUFFER_USAGE_TRANSFER_SRC_BIT");
     skipCall |= validate_image_usage_flags(my_data, commandBuffer, dstImage, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true, "vkCmdCopyBufferToImage()", "VK_IMAGE_USAGE_TRANSFER_DST_BIT");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdCopyBufferToImage(
         commandBuffer, srcBuffer, dstImage, dstImageLayout, regionCount, pRegions);
@@ -2788,24 +3319,21 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyImageToBuffer(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
     VkBool32       skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)srcImage, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { return validate_memory_is_valid(my_data, mem, "vkCmdCopyImageToBuffer()", srcImage); };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_VALIDATE, mem, srcImage, "vkCmdCopyImageToBuffer()");
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdCopyImageToBuffer");
     skipCall |= get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)dstBuffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdCopyImageToBuffer");
     // Validate that dst buff & src image have correct usage flags set
     skipCall |= validate_image_usage_flags(my_data, commandBuffer, srcImage, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, true, "vkCmdCopyImageToBuffer()", "VK_IMAGE_USAGE_TRANSFER_SRC_BIT");
     skipCall |= validate_buffer_usage_flags(my_data, commandBuffer, dstBuffer, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, "vkCmdCopyImageToBuffer()", "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdCopyImageToBuffer(
             commandBuffer, srcImage, srcImageLayout, dstBuffer, regionCount, pRegions);
@@ -2822,17 +3350,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdUpdateBuffer(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
     VkBool32       skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)dstBuffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdUpdateBuffer");
     // Validate that dst buff has correct usage flags set
     skipCall |= validate_buffer_usage_flags(my_data, commandBuffer, dstBuffer, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, "vkCmdUpdateBuffer()", "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdUpdateBuffer(commandBuffer, dstBuffer, dstOffset, dataSize, pData);
     }
@@ -2848,17 +3374,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdFillBuffer(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkDeviceMemory mem;
     VkBool32       skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)dstBuffer, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdFillBuffer");
     // Validate that dst buff has correct usage flags set
     skipCall |= validate_buffer_usage_flags(my_data, commandBuffer, dstBuffer, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, "vkCmdFillBuffer()", "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdFillBuffer(commandBuffer, dstBuffer, dstOffset, size, data);
     }
@@ -2876,15 +3400,13 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdClearColorImage(
     // TODO : Verify memory is in VK_IMAGE_STATE_CLEAR state
     VkDeviceMemory mem;
     VkBool32       skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)image, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true, image); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem, image);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdClearColorImage");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdClearColorImage(commandBuffer, image, imageLayout, pColor, rangeCount, pRanges);
     }
@@ -2902,15 +3424,13 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdClearDepthStencilImage(
     // TODO : Verify memory is in VK_IMAGE_STATE_CLEAR state
     VkDeviceMemory mem;
     VkBool32       skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)image, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true, image); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem, image);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdClearDepthStencilImage");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdClearDepthStencilImage(
             commandBuffer, image, imageLayout, pDepthStencil, rangeCount, pRanges);
@@ -2928,22 +3448,19 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdResolveImage(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     VkBool32 skipCall = VK_FALSE;
-    auto cb_data = my_data->cbMap.find(commandBuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    MT_CB_INFO *pCBInfo = lockCBForRecording(my_data, commandBuffer);
     VkDeviceMemory mem;
     skipCall  = get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)srcImage, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { return validate_memory_is_valid(my_data, mem, "vkCmdResolveImage()", srcImage); };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_VALIDATE, mem, srcImage, "vkCmdResolveImage()");
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdResolveImage");
     skipCall |= get_mem_binding_from_object(my_data, commandBuffer, (uint64_t)dstImage, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
-    if (cb_data != my_data->cbMap.end()) {
-        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, mem, true, dstImage); return VK_FALSE; };
-        cb_data->second.validate_functions.push_back(function);
+    if (pCBInfo) {
+        add_mem_validation_record(pCBInfo, MT_MEM_SET_VALID, mem, dstImage);
     }
     skipCall |= update_cmd_buf_and_mem_references(my_data, commandBuffer, mem, "vkCmdResolveImage");
-    loader_platform_thread_unlock_mutex(&globalLock);
+    unlockCBForRecording(pCBInfo);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->CmdResolveImage(
             commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions);
@@ -2989,9 +3506,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDebugReportCallbackEXT(
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     VkResult res = pTable->CreateDebugReportCallbackEXT(instance, pCreateInfo, pAllocator, pMsgCallback);
     if (res == VK_SUCCESS) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         res = layer_create_msg_callback(my_data->report_data, pCreateInfo, pAllocator, pMsgCallback);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     return res;
 }
@@ -3004,9 +3521,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDebugReportCallbackEXT(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(instance), layer_data_map);
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     pTable->DestroyDebugReportCallbackEXT(instance, msgCallback, pAllocator);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     layer_destroy_msg_callback(my_data->report_data, msgCallback, pAllocator);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDebugReportMessageEXT(
@@ -3033,9 +3550,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateSwapchainKHR(
     VkResult result = my_data->device_dispatch_table->CreateSwapchainKHR(device, pCreateInfo, pAllocator, pSwapchain);
 
     if (VK_SUCCESS == result) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         add_swap_chain_info(my_data, *pSwapchain, pCreateInfo);
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
 
     return result;
@@ -3048,7 +3565,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroySwapchainKHR(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkBool32 skipCall = VK_FALSE;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     if (my_data->swapchainMap.find(swapchain) != my_data->swapchainMap.end()) {
         MT_SWAP_CHAIN_INFO* pInfo = my_data->swapchainMap[swapchain];
 
@@ -3063,7 +3580,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroySwapchainKHR(
         delete pInfo;
         my_data->swapchainMap.erase(swapchain);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         my_data->device_dispatch_table->DestroySwapchainKHR(device, swapchain, pAllocator);
     }
@@ -3078,7 +3595,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetSwapchainImagesKHR(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->GetSwapchainImagesKHR(device, swapchain, pCount, pSwapchainImages);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     if (result == VK_SUCCESS && pSwapchainImages != NULL) {
         const size_t count = *pCount;
         MT_SWAP_CHAIN_INFO *pInfo = my_data->swapchainMap[swapchain];
@@ -3107,7 +3624,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetSwapchainImagesKHR(
             }
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     return result;
 }
 
@@ -3123,7 +3640,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(
     VkResult result   = VK_ERROR_VALIDATION_FAILED_EXT;
     VkBool32 skipCall = VK_FALSE;
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     if (my_data->semaphoreMap.find(semaphore) != my_data->semaphoreMap.end()) {
         if (my_data->semaphoreMap[semaphore] != MEMTRACK_SEMAPHORE_STATE_UNSET) {
             skipCall = log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_SEMAPHORE_EXT, (uint64_t)semaphore,
@@ -3136,7 +3653,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(
     if (fence_data != my_data->fenceMap.end()) {
         fence_data->second.swapchain = swapchain;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (VK_FALSE == skipCall) {
         result = my_data->device_dispatch_table->AcquireNextImageKHR(device,
                                     swapchain, timeout, semaphore, fence, pImageIndex);
@@ -3152,26 +3669,26 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkBool32 skip_call = false;
     VkDeviceMemory mem;
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t i = 0; i < pPresentInfo->swapchainCount; ++i) {
         MT_SWAP_CHAIN_INFO *pInfo = my_data->swapchainMap[pPresentInfo->pSwapchains[i]];
         VkImage image = pInfo->images[pPresentInfo->pImageIndices[i]];
         skip_call |= get_mem_binding_from_object(my_data, queue, (uint64_t)(image), VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, &mem);
         skip_call |= validate_memory_is_valid(my_data, mem, "vkQueuePresentKHR()", image);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     if (!skip_call) {
         result = my_data->device_dispatch_table->QueuePresentKHR(queue, pPresentInfo);
     }
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t i = 0; i < pPresentInfo->waitSemaphoreCount; i++) {
         VkSemaphore sem = pPresentInfo->pWaitSemaphores[i];
         if (my_data->semaphoreMap.find(sem) != my_data->semaphoreMap.end()) {
             my_data->semaphoreMap[sem] = MEMTRACK_SEMAPHORE_STATE_UNSET;
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     return result;
 }
@@ -3184,11 +3701,11 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateSemaphore(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->CreateSemaphore(device, pCreateInfo, pAllocator, pSemaphore);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     if (*pSemaphore != VK_NULL_HANDLE) {
         my_data->semaphoreMap[*pSemaphore] = MEMTRACK_SEMAPHORE_STATE_UNSET;
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     return result;
 }
 
@@ -3198,12 +3715,12 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroySemaphore(
     const VkAllocationCallbacks *pAllocator)
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     auto item = my_data->semaphoreMap.find(semaphore);
     if (item != my_data->semaphoreMap.end()) {
         my_data->semaphoreMap.erase(item);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     my_data->device_dispatch_table->DestroySemaphore(device, semaphore, pAllocator);
 }
 
@@ -3215,7 +3732,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateFramebuffer(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->CreateFramebuffer(device, pCreateInfo, pAllocator, pFramebuffer);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t i = 0; i < pCreateInfo->attachmentCount; ++i) {
         VkImageView view = pCreateInfo->pAttachments[i];
         auto view_data = my_data->imageViewMap.find(view);
@@ -3227,7 +3744,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateFramebuffer(
         fb_info.image = view_data->second.image;
         my_data->fbMap[*pFramebuffer].attachments.push_back(fb_info);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     return result;
 }
 
@@ -3238,12 +3755,12 @@ VKAPI_ATTR void VKAPI_CALL vkDestroyFramebuffer(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     auto item = my_data->fbMap.find(framebuffer);
     if (item != my_data->fbMap.end()) {
         my_data->fbMap.erase(framebuffer);
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     my_data->device_dispatch_table->DestroyFramebuffer(device, framebuffer, pAllocator);
 }
@@ -3256,7 +3773,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateRenderPass(
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->CreateRenderPass(device, pCreateInfo, pAllocator, pRenderPass);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     for (uint32_t i = 0; i < pCreateInfo->attachmentCount; ++i) {
         VkAttachmentDescription desc = pCreateInfo->pAttachments[i];
         MT_PASS_ATTACHMENT_INFO pass_info;
@@ -3289,7 +3806,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateRenderPass(
             attachment_first_layout.insert(std::make_pair(attachment, subpass.pDepthStencilAttachment->layout));
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 
     return result;
 }
@@ -3302,9 +3819,9 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyRenderPass(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     my_data->device_dispatch_table->DestroyRenderPass(device, renderPass, pAllocator);
 
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     my_data->passMap.erase(renderPass);
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(
@@ -3315,7 +3832,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     VkBool32 skip_call = false;
     if (pRenderPassBegin) {
-        loader_platform_thread_lock_mutex(&globalLock);
+        loader_platform_thread_write_lock_rwlock(&globalLock);
         auto pass_data = my_data->passMap.find(pRenderPassBegin->renderPass);
         if (pass_data != my_data->passMap.end()) {
             MT_PASS_INFO& pass_info = pass_data->second;
@@ -3325,8 +3842,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(
                 MT_FB_ATTACHMENT_INFO& fb_info = my_data->fbMap[pass_info.fb].attachments[i];
                 if (pass_info.attachments[i].load_op == VK_ATTACHMENT_LOAD_OP_CLEAR) {
                     if (cb_data != my_data->cbMap.end()) {
-                        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, fb_info.mem, true, fb_info.image); return VK_FALSE; };
-                        cb_data->second.validate_functions.push_back(function);
+                        add_mem_validation_record(&cb_data->second, MT_MEM_SET_VALID, fb_info.mem, fb_info.image);
                     }
                     VkImageLayout& attachment_layout = pass_info.attachment_first_layout[pass_info.attachments[i].attachment];
                     if (attachment_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL ||
@@ -3337,19 +3853,16 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(
                     }
                 } else if (pass_info.attachments[i].load_op == VK_ATTACHMENT_LOAD_OP_DONT_CARE) {
                     if (cb_data != my_data->cbMap.end()) {
-                        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, fb_info.mem, false, fb_info.image); return VK_FALSE; };
-                        cb_data->second.validate_functions.push_back(function);
+                        add_mem_validation_record(&cb_data->second, MT_MEM_SET_INVALID, fb_info.mem, fb_info.image);
                     }
                 } else if (pass_info.attachments[i].load_op == VK_ATTACHMENT_LOAD_OP_LOAD) {
                     if (cb_data != my_data->cbMap.end()) {
-                        std::function<VkBool32()> function = [=]() { return validate_memory_is_valid(my_data, fb_info.mem, "vkCmdBeginRenderPass()", fb_info.image); };
-                        cb_data->second.validate_functions.push_back(function);
+                        add_mem_validation_record(&cb_data->second, MT_MEM_VALIDATE, fb_info.mem, fb_info.image, "vkCmdBeginRenderPass()");
                     }
                 }
                 if (pass_info.attachment_first_read[pass_info.attachments[i].attachment]) {
                     if (cb_data != my_data->cbMap.end()) {
-                        std::function<VkBool32()> function = [=]() { return validate_memory_is_valid(my_data, fb_info.mem, "vkCmdBeginRenderPass()", fb_info.image); };
-                        cb_data->second.validate_functions.push_back(function);
+                        add_mem_validation_record(&cb_data->second, MT_MEM_VALIDATE, fb_info.mem, fb_info.image, "vkCmdBeginRenderPass()");
                     }
                 }
             }
@@ -3357,7 +3870,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(
                 cb_data->second.pass = pRenderPassBegin->renderPass;
             }
         }
-        loader_platform_thread_unlock_mutex(&globalLock);
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
     }
     if (!skip_call)
         return my_data->device_dispatch_table->CmdBeginRenderPass(cmdBuffer, pRenderPassBegin, contents);
@@ -3367,7 +3880,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdEndRenderPass(
     VkCommandBuffer cmdBuffer)
 {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
-    loader_platform_thread_lock_mutex(&globalLock);
+    loader_platform_thread_write_lock_rwlock(&globalLock);
     auto cb_data = my_data->cbMap.find(cmdBuffer);
     if (cb_data != my_data->cbMap.end()) {
         auto pass_data = my_data->passMap.find(cb_data->second.pass);
@@ -3377,22 +3890,43 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdEndRenderPass(
                 MT_FB_ATTACHMENT_INFO& fb_info = my_data->fbMap[pass_info.fb].attachments[i];
                 if (pass_info.attachments[i].store_op == VK_ATTACHMENT_STORE_OP_STORE) {
                     if (cb_data != my_data->cbMap.end()) {
-                        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, fb_info.mem, true, fb_info.image); return VK_FALSE; };
-                        cb_data->second.validate_functions.push_back(function);
+                        add_mem_validation_record(&cb_data->second, MT_MEM_SET_VALID, fb_info.mem, fb_info.image);
                     }
                 } else if (pass_info.attachments[i].store_op == VK_ATTACHMENT_STORE_OP_DONT_CARE) {
                     if (cb_data != my_data->cbMap.end()) {
-                        std::function<VkBool32()> function = [=]() { set_memory_valid(my_data, fb_info.mem, false, fb_info.image); return VK_FALSE; };
-                        cb_data->second.validate_functions.push_back(function);
+                        add_mem_validation_record(&cb_data->second, MT_MEM_SET_INVALID, fb_info.mem, fb_info.image);
                     }
                 }
             }
         }
     }
-    loader_platform_thread_unlock_mutex(&globalLock);
+    loader_platform_thread_write_unlock_rwlock(&globalLock);
     my_data->device_dispatch_table->CmdEndRenderPass(cmdBuffer);
 }
 
+VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDbgMarkerBegin(
+    VkCommandBuffer  commandBuffer,
+    const char      *pMarker)
+{
+    layer_data *my_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
+    if (stateDumpMarker && pMarker && !strcmp(pMarker, stateDumpMarker)) {
+        loader_platform_thread_write_lock_rwlock(&globalLock);
+        dump_mem_tracker_state(my_data, "vkCmdDbgMarkerBegin");
+        loader_platform_thread_write_unlock_rwlock(&globalLock);
+    }
+    debug_marker_dispatch_table(commandBuffer)->CmdDbgMarkerBegin(commandBuffer, pMarker);
+}
+
+VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkGetMemoryUsageLUNARG(
+    VkDevice             device,
+    VkMemoryUsageLUNARG *pUsage)
+{
+    layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    loader_platform_thread_read_lock_rwlock(&globalLock);
+    get_memory_usage(my_data, pUsage);
+    loader_platform_thread_read_unlock_rwlock(&globalLock);
+}
+
 VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(
     VkDevice    dev,
     const char *funcName)
@@ -3554,6 +4088,18 @@ VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(
             return (PFN_vkVoidFunction)vkQueuePresentKHR;
     }
 
+    if (my_data->debug_marker_enabled)
+    {
+        if (!strcmp(funcName, "vkCmdDbgMarkerBegin"))
+            return (PFN_vkVoidFunction) vkCmdDbgMarkerBegin;
+    }
+
+    if (my_data->memory_usage_enabled)
+    {
+        if (!strcmp(funcName, VK_LUNARG_MEMORY_USAGE_QUERY_NAME))
+            return (PFN_vkVoidFunction) vkGetMemoryUsageLUNARG;
+    }
+
     VkLayerDispatchTable *pDisp = my_data->device_dispatch_table;
     if (pDisp->GetDeviceProcAddr == NULL)
         return NULL;
@@ -27,10 +27,53 @@
  */
 
 #pragma once
+#include <mutex>
 #include <vector>
 #include <unordered_map>
 #include "vulkan/vk_layer.h"
 
+// Deduplicated set of references, kept as a dense vector plus an index into it so
+//  insert, erase and lookup are O(1). erase() moves the last element into the hole,
+//  so elements must not be erased while the set is being iterated.
+template <typename T, typename Hash = std::hash<T> >
+class ref_set {
+  public:
+    typedef typename std::vector<T>::const_iterator const_iterator;
+    const_iterator begin() const { return elements.begin(); }
+    const_iterator end() const { return elements.end(); }
+    size_t size() const { return elements.size(); }
+    bool empty() const { return elements.empty(); }
+    size_t count(const T& value) const { return index.count(value); }
+    // Returns false if value was already present
+    bool insert(const T& value) {
+        if (!index.insert(std::make_pair(value, elements.size())).second)
+            return false;
+        elements.push_back(value);
+        return true;
+    }
+    // Returns false if value was not present
+    bool erase(const T& value) {
+        auto it = index.find(value);
+        if (it == index.end())
+            return false;
+        size_t pos = it->second;
+        index.erase(it);
+        if (pos != elements.size() - 1) {
+            elements[pos] = elements.back();
+            index[elements[pos]] = pos;
+        }
+        elements.pop_back();
+        return true;
+    }
+    void clear() {
+        elements.clear();
+        index.clear();
+    }
+  private:
+    std::vector<T> elements;
+    std::unordered_map<T, size_t, Hash> index;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -56,6 +99,8 @@ typedef enum _MEM_TRACK_ERROR
     MEMTRACK_REBIND_OBJECT,                 // Non-sparse object bindings are immutable
     MEMTRACK_INVALID_USAGE_FLAG,            // Usage flags specified at image/buffer create conflict w/ use of object
     MEMTRACK_INVALID_MAP,                   // Size flag specified at alloc is too small for mapping range
+    MEMTRACK_ALLOCATION_COUNT_EXCEEDED,     // More live allocations than maxMemoryAllocationCount
+    MEMTRACK_OUT_OF_DEVICE_MEMORY,          // vkAllocateMemory failed, reported with the current memory usage
 } MEM_TRACK_ERROR;
 
 // MemTracker Semaphore states
@@ -105,8 +150,15 @@ struct MemRange {
 struct MT_OBJ_HANDLE_TYPE {
     uint64_t        handle;
     VkDebugReportObjectTypeEXT type;
+    bool operator==(const MT_OBJ_HANDLE_TYPE& other) const { return handle == other.handle && type == other.type; }
 };
 
+struct MT_OBJ_HANDLE_TYPE_HASH {
+    size_t operator()(const MT_OBJ_HANDLE_TYPE& obj) const { return std::hash<uint64_t>()(obj.handle) ^ obj.type; }
+};
+
+struct MT_GUARDED_SHADOW;
+
 // Data struct for tracking memory object
 struct MT_MEM_OBJ_INFO {
     void*                       object;                 // Dispatchable object used to create this memory (device of swapchain)
@@ -114,15 +166,21 @@ struct MT_MEM_OBJ_INFO {
     bool                        valid;                  // Stores if the memory has valid data or not
     VkDeviceMemory              mem;
     VkMemoryAllocateInfo        allocInfo;
-    list<MT_OBJ_HANDLE_TYPE>    pObjBindings;           // list container of objects bound to this memory
-    list<VkCommandBuffer>       pCommandBufferBindings; // list container of cmd buffers that reference this mem object
+    ref_set<MT_OBJ_HANDLE_TYPE, MT_OBJ_HANDLE_TYPE_HASH> pObjBindings; // objects bound to this memory
+    ref_set<VkCommandBuffer>    pCommandBufferBindings; // cmd buffers that reference this mem object
     MemRange                    memRange;
     void                       *pData, *pDriverData;
+    MT_GUARDED_SHADOW          *pGuardedShadow;         // Replaces pData with guard_page_map_shadows set
+    uint64_t                    allocSerial;            // Tells a reused handle apart in MT_SUBMISSION_INFO::memRefs
+    uint32_t                    inFlightCount;          // Unretired submissions whose CBs reference this mem object
+    VkDeviceSize                boundBytes;             // Requirements size of the buffers and images bound to it
 };
 
 // This only applies to Buffers and Images, which can have memory bound to them
 struct MT_OBJ_BINDING_INFO {
     VkDeviceMemory mem;
+    VkDeviceSize memOffset; // Offset it was bound at, locates its MEMORY_RANGE for removal
+    VkDeviceSize memSize; // Requirements size charged to the memory usage totals, 0 until bound
     bool valid; //If this is a swapchain image backing memory is not a MT_MEM_OBJ_INFO so store it here.
     union create_info {
         VkImageCreateInfo  image;
@@ -130,6 +188,21 @@ struct MT_OBJ_BINDING_INFO {
     } create_info;
 };
 
+// Memory validity operations a CB performs, checked and applied in order at submit time
+typedef enum _MT_MEM_VALIDATION_OP
+{
+    MT_MEM_VALIDATE,                        // Command reads the memory, report if it holds no valid data
+    MT_MEM_SET_VALID,                       // Command writes the memory
+    MT_MEM_SET_INVALID,                     // Command leaves the memory contents undefined
+} MT_MEM_VALIDATION_OP;
+
+struct MT_MEM_VALIDATION_RECORD {
+    MT_MEM_VALIDATION_OP op;
+    VkDeviceMemory       mem;
+    VkImage              image;   // Identifies swapchain images, whose mem is MEMTRACKER_SWAP_CHAIN_IMAGE_KEY
+    const char          *apiName; // Reported by MT_MEM_VALIDATE
+};
+
 // Track all command buffers
 typedef struct _MT_CB_INFO {
     VkCommandBufferAllocateInfo createInfo;
@@ -141,9 +214,10 @@ typedef struct _MT_CB_INFO {
     VkQueue                     lastSubmittedQueue;
     VkRenderPass                pass;
     vector<VkDescriptorSet>     activeDescriptorSets;
-    vector<std::function<VkBool32()> > validate_functions;
+    vector<MT_MEM_VALIDATION_RECORD> memValidationRecords; // Cleared on reset but keeps its storage
     // Order dependent, stl containers must be at end of struct
-    list<VkDeviceMemory>        pMemObjList; // List container of Mem objs referenced by this CB
+    ref_set<VkDeviceMemory>     pMemObjList; // Mem objs referenced by this CB
+    std::mutex                  recordLock;  // held with globalLock shared while a vkCmd* call records into this CB
     // Constructor
     _MT_CB_INFO():createInfo{},pipelines{},attachmentCount(0),fenceId(0),lastSubmittedFence{},lastSubmittedQueue{} {};
 } MT_CB_INFO;
@@ -190,12 +264,17 @@ struct MT_FENCE_INFO {
     VkFenceCreateInfo createInfo;
 };
 
+// Memory referenced by one vkQueueSubmit, released when its fenceId retires
+struct MT_SUBMISSION_INFO {
+    uint64_t                    fenceId;
+    vector<std::pair<VkDeviceMemory, uint64_t>> memRefs; // mem and its allocSerial, once per referencing CB
+};
+
 // Track Queue information
 struct MT_QUEUE_INFO {
     uint64_t                    lastRetiredId;
     uint64_t                    lastSubmittedId;
-    list<VkCommandBuffer>       pQueueCommandBuffers;
-    list<VkDeviceMemory>        pMemRefList;
+    deque<MT_SUBMISSION_INFO>   pendingSubmissions; // Ordered by fenceId, oldest first
 };
 
 struct MT_DESCRIPTOR_SET_INFO {
@@ -219,3 +298,121 @@ struct MEMORY_RANGE {
 #ifdef __cplusplus
 }
 #endif
+
+// Buffer or image ranges bound to one memory object, for aliasing checks. A treap ordered
+//  by start and augmented with the largest end in each subtree, so inserts, removals and
+//  overlap queries stay O(log n + k) however many objects are packed into one allocation.
+class memory_range_tree {
+  public:
+    memory_range_tree() : root(nullptr) {}
+    ~memory_range_tree() { destroy(root); }
+    void insert(const MEMORY_RANGE& range) {
+        node* n = new node;
+        n->range = range;
+        n->maxEnd = range.end;
+        n->priority = scramble(range.handle ^ range.start);
+        n->left = n->right = nullptr;
+        root = insert(root, n);
+    }
+    // Remove the range bound at start for handle, if present
+    void erase(VkDeviceSize start, uint64_t handle) { root = erase(root, start, handle); }
+    // Call fn for each range intersecting [start, end], bounds inclusive
+    template <typename Fn> void for_each_overlap(VkDeviceSize start, VkDeviceSize end, Fn fn) const { visit(root, start, end, fn); }
+
+  private:
+    struct node {
+        MEMORY_RANGE range;
+        VkDeviceSize maxEnd; // Largest range.end in this subtree
+        uint64_t priority;
+        node *left, *right;
+    };
+    node* root;
+
+    memory_range_tree(const memory_range_tree&);
+    memory_range_tree& operator=(const memory_range_tree&);
+
+    static uint64_t scramble(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return x;
+    }
+    static bool precedes(const MEMORY_RANGE& range, VkDeviceSize start, uint64_t handle) {
+        return (range.start < start) || (range.start == start && range.handle < handle);
+    }
+    static node* update(node* n) {
+        n->maxEnd = n->range.end;
+        if (n->left && n->left->maxEnd > n->maxEnd)
+            n->maxEnd = n->left->maxEnd;
+        if (n->right && n->right->maxEnd > n->maxEnd)
+            n->maxEnd = n->right->maxEnd;
+        return n;
+    }
+    // Split t into the nodes ordered before (start, handle) and the rest
+    static void split(node* t, VkDeviceSize start, uint64_t handle, node*& before, node*& rest) {
+        if (!t) {
+            before = rest = nullptr;
+        } else if (precedes(t->range, start, handle)) {
+            split(t->right, start, handle, t->right, rest);
+            before = update(t);
+        } else {
+            split(t->left, start, handle, before, t->left);
+            rest = update(t);
+        }
+    }
+    // Join two treaps where every node of a precedes every node of b
+    static node* merge(node* a, node* b) {
+        if (!a || !b)
+            return a ? a : b;
+        if (a->priority > b->priority) {
+            a->right = merge(a->right, b);
+            return update(a);
+        }
+        b->left = merge(a, b->left);
+        return update(b);
+    }
+    static node* insert(node* t, node* n) {
+        if (!t)
+            return n;
+        if (n->priority > t->priority) {
+            split(t, n->range.start, n->range.handle, n->left, n->right);
+            return update(n);
+        }
+        if (precedes(n->range, t->range.start, t->range.handle))
+            t->left = insert(t->left, n);
+        else
+            t->right = insert(t->right, n);
+        return update(t);
+    }
+    static node* erase(node* t, VkDeviceSize start, uint64_t handle) {
+        if (!t)
+            return nullptr;
+        if (t->range.start == start && t->range.handle == handle) {
+            node* joined = merge(t->left, t->right);
+            delete t;
+            return joined;
+        }
+        if (precedes(t->range, start, handle))
+            t->right = erase(t->right, start, handle);
+        else
+            t->left = erase(t->left, start, handle);
+        return update(t);
+    }
+    template <typename Fn> static void visit(const node* t, VkDeviceSize start, VkDeviceSize end, Fn& fn) {
+        if (!t || t->maxEnd < start)
+            return;
+        visit(t->left, start, end, fn);
+        if (t->range.start > end)
+            return;
+        if (t->range.end >= start)
+            fn(t->range);
+        visit(t->right, start, end, fn);
+    }
+    static void destroy(node* t) {
+        if (t) {
+            destroy(t->left);
+            destroy(t->right);
+            delete t;
+        }
+    }
+};
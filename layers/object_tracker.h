@@ -31,6 +31,9 @@
 #include "vk_layer_extension_utils.h"
 #include "vk_enum_string_helper.h"
 #include "vk_layer_table.h"
+#include "object_tracker_table.h"
+
+#include <vector>
 
 // Object Tracker ERROR codes
 typedef enum _OBJECT_TRACK_ERROR
@@ -47,7 +50,6 @@ typedef enum _OBJECT_TRACK_ERROR
 } OBJECT_TRACK_ERROR;
 
 // Object Status -- used to track state of individual objects
-typedef VkFlags ObjectStatusFlags;
 typedef enum _ObjectStatusFlagBits
 {
     OBJSTATUS_NONE                              = 0x00000000, // No status is set
@@ -60,13 +62,6 @@ typedef enum _ObjectStatusFlagBits
     OBJSTATUS_COMMAND_BUFFER_SECONDARY          = 0x00000040, // Command Buffer is of type SECONDARY
 } ObjectStatusFlagBits;
 
-typedef struct _OBJTRACK_NODE {
-    uint64_t                   vkObj;           // Object handle
-    VkDebugReportObjectTypeEXT objType;         // Object type identifier
-    ObjectStatusFlags          status;          // Object state
-    uint64_t                   parentObj;       // Parent object
-} OBJTRACK_NODE;
-
 // prototype for extension functions
 uint64_t objTrackGetObjectCount(VkDevice device);
 uint64_t objTrackGetObjectsOfTypeCount(VkDevice, VkDebugReportObjectTypeEXT type);
@@ -101,15 +96,12 @@ static instance_table_map                      object_tracker_instance_table_map
 
 // We need additionally validate image usage using a separate map
 // of swapchain-created images
-static unordered_map<uint64_t, OBJTRACK_NODE*> swapchainImageMap;
+static objtrack_table swapchainImageMap;
 
 static long long unsigned int object_track_index = 0;
 static int objLockInitialized = 0;
 static loader_platform_thread_mutex objLock;
 
-// Objects stored in a global map w/ struct containing basic info
-// unordered_map<const void*, OBJTRACK_NODE*> objMap;
-
 #define NUM_OBJECT_TYPES (VK_DEBUG_REPORT_OBJECT_TYPE_DEBUG_REPORT_EXT+1)
 
 static uint64_t                         numObjs[NUM_OBJECT_TYPES]     = {0};
@@ -352,20 +344,19 @@ initObjectTracker(
     uint32_t report_flags = 0;
     uint32_t debug_action = 0;
     FILE *log_output = NULL;
-    const char *option_str;
     // initialize object_tracker options
     report_flags = getLayerOptionFlags("lunarg_object_tracker.report_flags", 0);
     getLayerOptionEnum("lunarg_object_tracker.debug_action", (uint32_t *) &debug_action);
 
     if (debug_action & VK_DBG_LAYER_ACTION_LOG_MSG)
     {
-        option_str = getLayerOption("lunarg_object_tracker.log_filename");
-        log_output = getLayerLogOutput(option_str, "lunarg_object_tracker");
+        layer_log_ring *log_ring;
+        getLayerLogSink("lunarg_object_tracker", &log_output, &log_ring);
         VkDebugReportCallbackCreateInfoEXT dbgInfo;
         memset(&dbgInfo, 0, sizeof(dbgInfo));
         dbgInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
-        dbgInfo.pfnCallback = log_callback;
-        dbgInfo.pUserData = log_output;
+        dbgInfo.pfnCallback = log_ring ? log_ring_callback : log_callback;
+        dbgInfo.pUserData = log_ring ? (void *) log_ring : (void *) log_output;
         dbgInfo.flags = report_flags;
         layer_create_msg_callback(my_data->report_data, &dbgInfo, pAllocator, &my_data->logging_callback);
     }
@@ -416,17 +407,18 @@ static VkBool32 validate_status(VkDevice dispatchable_object, VkFence object, Vk
     ObjectStatusFlags status_mask, ObjectStatusFlags status_flag, VkFlags msg_flags, OBJECT_TRACK_ERROR  error_code,
     const char         *fail_msg);
 #endif
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkPhysicalDeviceMap;
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkImageMap;
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkQueueMap;
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkDescriptorSetMap;
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkBufferMap;
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkFenceMap;
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkSemaphoreMap;
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkCommandPoolMap;
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkCommandBufferMap;
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkSwapchainKHRMap;
-extern unordered_map<uint64_t, OBJTRACK_NODE*> VkSurfaceKHRMap;
+extern objtrack_table VkPhysicalDeviceMap;
+extern objtrack_table VkImageMap;
+extern objtrack_table VkQueueMap;
+extern objtrack_table VkDescriptorSetMap;
+extern objtrack_table VkBufferMap;
+extern objtrack_table VkFenceMap;
+extern objtrack_table VkSemaphoreMap;
+extern objtrack_table VkCommandPoolMap;
+extern objtrack_table VkDescriptorPoolMap;
+extern objtrack_table VkCommandBufferMap;
+extern objtrack_table VkSwapchainKHRMap;
+extern objtrack_table VkSurfaceKHRMap;
 
 static void create_physical_device(VkInstance dispatchable_object, VkPhysicalDevice vkObj, VkDebugReportObjectTypeEXT objType)
 {
@@ -434,11 +426,9 @@ static void create_physical_device(VkInstance dispatchable_object, VkPhysicalDev
         "OBJ[%llu] : CREATE %s object 0x%" PRIxLEAST64 , object_track_index++, string_VkDebugReportObjectTypeEXT(objType),
         reinterpret_cast<uint64_t>(vkObj));
 
-    OBJTRACK_NODE* pNewObjNode = new OBJTRACK_NODE;
+    OBJTRACK_NODE* pNewObjNode = VkPhysicalDeviceMap.insert(reinterpret_cast<uint64_t>(vkObj));
     pNewObjNode->objType = objType;
     pNewObjNode->status  = OBJSTATUS_NONE;
-    pNewObjNode->vkObj  = reinterpret_cast<uint64_t>(vkObj);
-    VkPhysicalDeviceMap[reinterpret_cast<uint64_t>(vkObj)] = pNewObjNode;
     uint32_t objIndex = objTypeToIndex(objType);
     numObjs[objIndex]++;
     numTotalObjs++;
@@ -451,11 +441,9 @@ static void create_surface_khr(VkInstance dispatchable_object, VkSurfaceKHR vkOb
         "OBJ[%llu] : CREATE %s object 0x%" PRIxLEAST64 , object_track_index++, string_VkDebugReportObjectTypeEXT(objType),
         (uint64_t)(vkObj));
 
-    OBJTRACK_NODE* pNewObjNode = new OBJTRACK_NODE;
+    OBJTRACK_NODE* pNewObjNode = VkSurfaceKHRMap.insert((uint64_t)(vkObj));
     pNewObjNode->objType = objType;
     pNewObjNode->status  = OBJSTATUS_NONE;
-    pNewObjNode->vkObj   = (uint64_t)(vkObj);
-    VkSurfaceKHRMap[(uint64_t)vkObj] = pNewObjNode;
     uint32_t objIndex = objTypeToIndex(objType);
     numObjs[objIndex]++;
     numTotalObjs++;
@@ -464,8 +452,8 @@ static void create_surface_khr(VkInstance dispatchable_object, VkSurfaceKHR vkOb
 static void destroy_surface_khr(VkInstance dispatchable_object, VkSurfaceKHR object)
 {
     uint64_t object_handle = (uint64_t)(object);
-    if (VkSurfaceKHRMap.find(object_handle) != VkSurfaceKHRMap.end()) {
-        OBJTRACK_NODE* pNode = VkSurfaceKHRMap[(uint64_t)object];
+    OBJTRACK_NODE* pNode = VkSurfaceKHRMap.find(object_handle);
+    if (pNode) {
         uint32_t objIndex = objTypeToIndex(pNode->objType);
         assert(numTotalObjs > 0);
         numTotalObjs--;
@@ -475,8 +463,7 @@ static void destroy_surface_khr(VkInstance dispatchable_object, VkSurfaceKHR obj
            "OBJ_STAT Destroy %s obj 0x%" PRIxLEAST64 " (%" PRIu64 " total objs remain & %" PRIu64 " %s objs).",
             string_VkDebugReportObjectTypeEXT(pNode->objType), (uint64_t)(object), numTotalObjs, numObjs[objIndex],
             string_VkDebugReportObjectTypeEXT(pNode->objType));
-        delete pNode;
-        VkSurfaceKHRMap.erase(object_handle);
+        VkSurfaceKHRMap.erase(pNode);
     } else {
         log_msg(mdd(dispatchable_object), VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT ) 0, object_handle, __LINE__, OBJTRACK_NONE, "OBJTRACK",
             "Unable to remove obj 0x%" PRIxLEAST64 ". Was it created? Has it already been destroyed?",
@@ -490,16 +477,15 @@ static void alloc_command_buffer(VkDevice device, VkCommandPool commandPool, VkC
         "OBJ[%llu] : CREATE %s object 0x%" PRIxLEAST64 , object_track_index++, string_VkDebugReportObjectTypeEXT(objType),
         reinterpret_cast<uint64_t>(vkObj));
 
-    OBJTRACK_NODE* pNewObjNode = new OBJTRACK_NODE;
+    OBJTRACK_NODE* pNewObjNode = VkCommandBufferMap.insert(reinterpret_cast<uint64_t>(vkObj));
+    unlinkChildNode(VkCommandPoolMap, VkCommandBufferMap, pNewObjNode);
+    linkChildNode(VkCommandPoolMap, VkCommandBufferMap, pNewObjNode, (uint64_t) commandPool);
     pNewObjNode->objType   = objType;
-    pNewObjNode->vkObj     = reinterpret_cast<uint64_t>(vkObj);
-    pNewObjNode->parentObj = (uint64_t) commandPool;
     if (level == VK_COMMAND_BUFFER_LEVEL_SECONDARY) {
         pNewObjNode->status = OBJSTATUS_COMMAND_BUFFER_SECONDARY;
     } else {
         pNewObjNode->status = OBJSTATUS_NONE;
     }
-    VkCommandBufferMap[reinterpret_cast<uint64_t>(vkObj)] = pNewObjNode;
     uint32_t objIndex = objTypeToIndex(objType);
     numObjs[objIndex]++;
     numTotalObjs++;
@@ -508,8 +494,8 @@ static void alloc_command_buffer(VkDevice device, VkCommandPool commandPool, VkC
 static void free_command_buffer(VkDevice device, VkCommandPool commandPool, VkCommandBuffer commandBuffer)
 {
     uint64_t object_handle = reinterpret_cast<uint64_t>(commandBuffer);
-    if (VkCommandBufferMap.find(object_handle) != VkCommandBufferMap.end()) {
-        OBJTRACK_NODE* pNode = VkCommandBufferMap[(uint64_t)commandBuffer];
+    OBJTRACK_NODE* pNode = VkCommandBufferMap.find(object_handle);
+    if (pNode) {
 
        if (pNode->parentObj != (uint64_t)(commandPool)) {
            log_msg(mdd(device), VK_DEBUG_REPORT_ERROR_BIT_EXT, pNode->objType, object_handle, __LINE__, OBJTRACK_COMMAND_POOL_MISMATCH, "OBJTRACK",
@@ -526,8 +512,8 @@ static void free_command_buffer(VkDevice device, VkCommandPool commandPool, VkCo
                "OBJ_STAT Destroy %s obj 0x%" PRIxLEAST64 " (%" PRIu64 " total objs remain & %" PRIu64 " %s objs).",
                 string_VkDebugReportObjectTypeEXT(pNode->objType), reinterpret_cast<uint64_t>(commandBuffer), numTotalObjs, numObjs[objIndex],
                 string_VkDebugReportObjectTypeEXT(pNode->objType));
-            delete pNode;
-            VkCommandBufferMap.erase(object_handle);
+            unlinkChildNode(VkCommandPoolMap, VkCommandBufferMap, pNode);
+            VkCommandBufferMap.erase(pNode);
         }
     } else {
         log_msg(mdd(device), VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, object_handle, __LINE__, OBJTRACK_NONE, "OBJTRACK",
@@ -542,12 +528,11 @@ static void alloc_descriptor_set(VkDevice device, VkDescriptorPool descriptorPoo
         "OBJ[%llu] : CREATE %s object 0x%" PRIxLEAST64 , object_track_index++, string_VkDebugReportObjectTypeEXT(objType),
         (uint64_t)(vkObj));
 
-    OBJTRACK_NODE* pNewObjNode = new OBJTRACK_NODE;
+    OBJTRACK_NODE* pNewObjNode = VkDescriptorSetMap.insert((uint64_t)(vkObj));
+    unlinkChildNode(VkDescriptorPoolMap, VkDescriptorSetMap, pNewObjNode);
+    linkChildNode(VkDescriptorPoolMap, VkDescriptorSetMap, pNewObjNode, (uint64_t) descriptorPool);
     pNewObjNode->objType   = objType;
     pNewObjNode->status    = OBJSTATUS_NONE;
-    pNewObjNode->vkObj     = (uint64_t)(vkObj);
-    pNewObjNode->parentObj = (uint64_t) descriptorPool;
-    VkDescriptorSetMap[(uint64_t)vkObj] = pNewObjNode;
     uint32_t objIndex = objTypeToIndex(objType);
     numObjs[objIndex]++;
     numTotalObjs++;
@@ -556,8 +541,8 @@ static void alloc_descriptor_set(VkDevice device, VkDescriptorPool descriptorPoo
 static void free_descriptor_set(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorSet descriptorSet)
 {
     uint64_t object_handle = (uint64_t)(descriptorSet);
-    if (VkDescriptorSetMap.find(object_handle) != VkDescriptorSetMap.end()) {
-        OBJTRACK_NODE* pNode = VkDescriptorSetMap[(uint64_t)descriptorSet];
+    OBJTRACK_NODE* pNode = VkDescriptorSetMap.find(object_handle);
+    if (pNode) {
 
         if (pNode->parentObj != (uint64_t)(descriptorPool)) {
             log_msg(mdd(device), VK_DEBUG_REPORT_ERROR_BIT_EXT, pNode->objType, object_handle, __LINE__, OBJTRACK_DESCRIPTOR_POOL_MISMATCH, "OBJTRACK",
@@ -573,8 +558,8 @@ static void free_descriptor_set(VkDevice device, VkDescriptorPool descriptorPool
                "OBJ_STAT Destroy %s obj 0x%" PRIxLEAST64 " (%" PRIu64 " total objs remain & %" PRIu64 " %s objs).",
                 string_VkDebugReportObjectTypeEXT(pNode->objType), (uint64_t)(descriptorSet), numTotalObjs, numObjs[objIndex],
                 string_VkDebugReportObjectTypeEXT(pNode->objType));
-            delete pNode;
-            VkDescriptorSetMap.erase(object_handle);
+            unlinkChildNode(VkDescriptorPoolMap, VkDescriptorSetMap, pNode);
+            VkDescriptorSetMap.erase(pNode);
         }
     } else {
         log_msg(mdd(device), VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT) 0, object_handle, __LINE__, OBJTRACK_NONE, "OBJTRACK",
@@ -589,11 +574,9 @@ static void create_queue(VkDevice dispatchable_object, VkQueue vkObj, VkDebugRep
         "OBJ[%llu] : CREATE %s object 0x%" PRIxLEAST64 , object_track_index++, string_VkDebugReportObjectTypeEXT(objType),
         reinterpret_cast<uint64_t>(vkObj));
 
-    OBJTRACK_NODE* pNewObjNode = new OBJTRACK_NODE;
+    OBJTRACK_NODE* pNewObjNode = VkQueueMap.insert(reinterpret_cast<uint64_t>(vkObj));
     pNewObjNode->objType = objType;
     pNewObjNode->status  = OBJSTATUS_NONE;
-    pNewObjNode->vkObj  = reinterpret_cast<uint64_t>(vkObj);
-    VkQueueMap[reinterpret_cast<uint64_t>(vkObj)] = pNewObjNode;
     uint32_t objIndex = objTypeToIndex(objType);
     numObjs[objIndex]++;
     numTotalObjs++;
@@ -604,12 +587,11 @@ static void create_swapchain_image_obj(VkDevice dispatchable_object, VkImage vkO
         "OBJ[%llu] : CREATE %s object 0x%" PRIxLEAST64 , object_track_index++, "SwapchainImage",
         (uint64_t)(vkObj));
 
-    OBJTRACK_NODE* pNewObjNode             = new OBJTRACK_NODE;
+    OBJTRACK_NODE* pNewObjNode             = swapchainImageMap.insert((uint64_t) vkObj);
+    unlinkChildNode(VkSwapchainKHRMap, swapchainImageMap, pNewObjNode);
+    linkChildNode(VkSwapchainKHRMap, swapchainImageMap, pNewObjNode, (uint64_t) swapchain);
     pNewObjNode->objType                   = VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT;
     pNewObjNode->status                    = OBJSTATUS_NONE;
-    pNewObjNode->vkObj                     = (uint64_t) vkObj;
-    pNewObjNode->parentObj                 = (uint64_t) swapchain;
-    swapchainImageMap[(uint64_t)(vkObj)] = pNewObjNode;
 }
 
 //
@@ -907,14 +889,13 @@ explicit_DestroySwapchainKHR(
     loader_platform_thread_lock_mutex(&objLock);
     // A swapchain's images are implicitly deleted when the swapchain is deleted.
     // Remove this swapchain's images from our map of such images.
-    unordered_map<uint64_t, OBJTRACK_NODE*>::iterator itr = swapchainImageMap.begin();
-    while (itr != swapchainImageMap.end()) {
-        OBJTRACK_NODE* pNode = (*itr).second;
-        if (pNode->parentObj == (uint64_t)(swapchain)) {
-           swapchainImageMap.erase(itr++);
-        } else {
-           ++itr;
-        }
+    OBJTRACK_NODE* pSwapchainNode = VkSwapchainKHRMap.find((uint64_t)(swapchain));
+    while (pSwapchainNode && pSwapchainNode->firstChild) {
+        OBJTRACK_NODE* pNode = swapchainImageMap.find(pSwapchainNode->firstChild);
+        if (!pNode)
+            break;
+        unlinkChildNode(VkSwapchainKHRMap, swapchainImageMap, pNode);
+        swapchainImageMap.erase(pNode);
     }
     destroy_swapchain_khr(device, swapchain);
     loader_platform_thread_unlock_mutex(&objLock);
@@ -978,13 +959,13 @@ explicit_DestroyDescriptorPool(
     // A DescriptorPool's descriptor sets are implicitly deleted when the pool is deleted.
     // Remove this pool's descriptor sets from our descriptorSet map.
     loader_platform_thread_lock_mutex(&objLock);
-    unordered_map<uint64_t, OBJTRACK_NODE*>::iterator itr = VkDescriptorSetMap.begin();
-    while (itr != VkDescriptorSetMap.end()) {
-        OBJTRACK_NODE* pNode = (*itr).second;
-        auto del_itr = itr++;
-        if (pNode->parentObj == (uint64_t)(descriptorPool)) {
-            destroy_descriptor_set(device, (VkDescriptorSet)((*del_itr).first));
-        }
+    // Each destroy unlinks the pool's newest set, so this only visits the pool's own sets.
+    OBJTRACK_NODE* pPoolNode = VkDescriptorPoolMap.find((uint64_t)(descriptorPool));
+    while (pPoolNode && pPoolNode->firstChild) {
+        uint64_t firstChild = pPoolNode->firstChild;
+        destroy_descriptor_set(device, (VkDescriptorSet)(firstChild));
+        if (pPoolNode->firstChild == firstChild)
+            break;
     }
     destroy_descriptor_pool(device, descriptorPool);
     loader_platform_thread_unlock_mutex(&objLock);
@@ -1008,15 +989,14 @@ explicit_DestroyCommandPool(
     loader_platform_thread_lock_mutex(&objLock);
     // A CommandPool's command buffers are implicitly deleted when the pool is deleted.
     // Remove this pool's cmdBuffers from our cmd buffer map.
-    unordered_map<uint64_t, OBJTRACK_NODE*>::iterator itr = VkCommandBufferMap.begin();
-    unordered_map<uint64_t, OBJTRACK_NODE*>::iterator del_itr;
-    while (itr != VkCommandBufferMap.end()) {
-        OBJTRACK_NODE* pNode = (*itr).second;
-        del_itr = itr++;
-        if (pNode->parentObj == (uint64_t)(commandPool)) {
-            destroy_command_buffer(reinterpret_cast<VkCommandBuffer>((*del_itr).first),
-                                   reinterpret_cast<VkCommandBuffer>((*del_itr).first));
-        }
+    // Each destroy unlinks the pool's newest command buffer, so this only visits the pool's own.
+    OBJTRACK_NODE* pPoolNode = VkCommandPoolMap.find((uint64_t)(commandPool));
+    while (pPoolNode && pPoolNode->firstChild) {
+        uint64_t firstChild = pPoolNode->firstChild;
+        destroy_command_buffer(reinterpret_cast<VkCommandBuffer>(firstChild),
+                               reinterpret_cast<VkCommandBuffer>(firstChild));
+        if (pPoolNode->firstChild == firstChild)
+            break;
     }
     destroy_command_pool(device, commandPool);
     loader_platform_thread_unlock_mutex(&objLock);
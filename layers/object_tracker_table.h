@@ -0,0 +1,188 @@
+/* Copyright (c) 2015-2016 The Khronos Group Inc.
+ * Copyright (c) 2015-2016 Valve Corporation
+ * Copyright (c) 2015-2016 LunarG, Inc.
+ * Copyright (C) 2015-2016 Google Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and/or associated documentation files (the "Materials"), to
+ * deal in the Materials without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Materials, and to permit persons to whom the Materials
+ * are furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice(s) and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+ * USE OR OTHER DEALINGS IN THE MATERIALS
+ *
+ * Author: Mark Lobodzinski <mark@lunarg.com>
+ */
+
+#pragma once
+
+#include <string.h>
+#include <assert.h>
+#include <vector>
+#include "vulkan/vulkan.h"
+
+// Object Status -- used to track state of individual objects
+typedef VkFlags ObjectStatusFlags;
+
+typedef struct _OBJTRACK_NODE {
+    uint64_t                   vkObj;           // Object handle
+    VkDebugReportObjectTypeEXT objType;         // Object type identifier
+    ObjectStatusFlags          status;          // Object state
+    uint64_t                   parentObj;       // Parent object
+    uint64_t                   firstChild;      // Newest child, for objects whose children are freed with them
+    uint64_t                   prevSibling;     // Neighbours in the parent's list of children
+    uint64_t                   nextSibling;
+} OBJTRACK_NODE;
+
+// The tracked objects of one type. Nodes are kept inline in an open-addressing table
+//  with linear probing, so creating an object does not hit the heap and lookups touch
+//  one or two cache lines. Nodes move when the table grows or an entry is erased, so
+//  node pointers are only good until the next insert or erase and nodes refer to each
+//  other by handle.
+class objtrack_table {
+  public:
+    objtrack_table() :
+        count(0)
+    {};
+
+    size_t size() const { return count; }
+
+    OBJTRACK_NODE *find(uint64_t handle)
+    {
+        if (!handle || nodes.empty())
+            return NULL;
+        size_t mask = nodes.size() - 1;
+        for (size_t i = hash(handle) & mask;; i = (i + 1) & mask) {
+            if (nodes[i].vkObj == handle)
+                return &nodes[i];
+            if (!nodes[i].vkObj)
+                return NULL;
+        }
+    }
+
+    // Returns the node for handle, adding a zeroed one if it is not tracked yet
+    OBJTRACK_NODE *insert(uint64_t handle)
+    {
+        assert(handle);
+        if ((count + 1) * 2 > nodes.size())
+            grow();
+        size_t mask = nodes.size() - 1;
+        size_t i = hash(handle) & mask;
+        while (nodes[i].vkObj && (nodes[i].vkObj != handle))
+            i = (i + 1) & mask;
+        if (!nodes[i].vkObj) {
+            memset(&nodes[i], 0, sizeof(OBJTRACK_NODE));
+            nodes[i].vkObj = handle;
+            count++;
+        }
+        return &nodes[i];
+    }
+
+    void erase(OBJTRACK_NODE *pNode)
+    {
+        // Shift later entries of the probe run back so lookups need no tombstones
+        size_t mask = nodes.size() - 1;
+        size_t hole = pNode - &nodes[0];
+        for (size_t i = (hole + 1) & mask; nodes[i].vkObj; i = (i + 1) & mask) {
+            size_t home = hash(nodes[i].vkObj) & mask;
+            bool stays = (hole <= i) ? ((hole < home) && (home <= i)) : ((hole < home) || (home <= i));
+            if (!stays) {
+                nodes[hole] = nodes[i];
+                hole = i;
+            }
+        }
+        nodes[hole].vkObj = 0;
+        count--;
+    }
+
+    // Walk the tracked objects with first() and next(); do not insert or erase meanwhile
+    OBJTRACK_NODE *first() { return scan(0); }
+    OBJTRACK_NODE *next(OBJTRACK_NODE *pNode) { return scan(pNode - &nodes[0] + 1); }
+
+    void clear()
+    {
+        std::vector<OBJTRACK_NODE>().swap(nodes);
+        count = 0;
+    }
+
+  private:
+    static size_t hash(uint64_t handle)
+    {
+        return (size_t)((handle * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+
+    OBJTRACK_NODE *scan(size_t i)
+    {
+        for (; i < nodes.size(); i++) {
+            if (nodes[i].vkObj)
+                return &nodes[i];
+        }
+        return NULL;
+    }
+
+    void grow()
+    {
+        std::vector<OBJTRACK_NODE> old;
+        old.swap(nodes);
+        nodes.resize(old.empty() ? 16 : old.size() * 2);
+        memset(&nodes[0], 0, nodes.size() * sizeof(OBJTRACK_NODE));
+        size_t mask = nodes.size() - 1;
+        for (size_t j = 0; j < old.size(); j++) {
+            if (!old[j].vkObj)
+                continue;
+            size_t i = hash(old[j].vkObj) & mask;
+            while (nodes[i].vkObj)
+                i = (i + 1) & mask;
+            nodes[i] = old[j];
+        }
+    }
+
+    std::vector<OBJTRACK_NODE> nodes;   // size is zero or a power of two
+    size_t                     count;
+};
+
+// Command buffers, descriptor sets and swapchain images are linked into a list on their
+//  pool's or swapchain's node, so that destroying the parent only visits its own children
+static void linkChildNode(objtrack_table &parentMap, objtrack_table &childMap, OBJTRACK_NODE *pNode, uint64_t parentObj)
+{
+    pNode->parentObj   = parentObj;
+    pNode->prevSibling = 0;
+    pNode->nextSibling = 0;
+    OBJTRACK_NODE *pParent = parentMap.find(parentObj);
+    if (!pParent)
+        return;
+    OBJTRACK_NODE *pFirst = childMap.find(pParent->firstChild);
+    if (pFirst) {
+        pFirst->prevSibling = pNode->vkObj;
+        pNode->nextSibling  = pFirst->vkObj;
+    }
+    pParent->firstChild = pNode->vkObj;
+}
+
+static void unlinkChildNode(objtrack_table &parentMap, objtrack_table &childMap, OBJTRACK_NODE *pNode)
+{
+    OBJTRACK_NODE *pPrev = childMap.find(pNode->prevSibling);
+    OBJTRACK_NODE *pNext = childMap.find(pNode->nextSibling);
+    if (pPrev) {
+        pPrev->nextSibling = pNode->nextSibling;
+    } else {
+        OBJTRACK_NODE *pParent = parentMap.find(pNode->parentObj);
+        if (pParent && (pParent->firstChild == pNode->vkObj))
+            pParent->firstChild = pNode->nextSibling;
+    }
+    if (pNext)
+        pNext->prevSibling = pNode->prevSibling;
+    pNode->prevSibling = 0;
+    pNode->nextSibling = 0;
+}
@@ -105,15 +105,15 @@ static void InitParamChecker(layer_data *data, const VkAllocationCallbacks *pAll
     getLayerOptionEnum("lunarg_param_checker.debug_action", (uint32_t *) &debug_action);
     if(debug_action & VK_DBG_LAYER_ACTION_LOG_MSG)
     {
-        FILE *log_output = NULL;
-        const char* option_str = getLayerOption("lunarg_param_checker.log_filename");
-        log_output = getLayerLogOutput(option_str, "lunarg_param_checker");
+        FILE *log_output;
+        layer_log_ring *log_ring;
+        getLayerLogSink("lunarg_param_checker", &log_output, &log_ring);
         VkDebugReportCallbackCreateInfoEXT dbgCreateInfo;
         memset(&dbgCreateInfo, 0, sizeof(dbgCreateInfo));
         dbgCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
         dbgCreateInfo.flags = report_flags;
-        dbgCreateInfo.pfnCallback = log_callback;
-        dbgCreateInfo.pUserData = log_output;
+        dbgCreateInfo.pfnCallback = log_ring ? log_ring_callback : log_callback;
+        dbgCreateInfo.pUserData = log_ring ? (void *) log_ring : (void *) log_output;
 
         layer_create_msg_callback(data->report_data, &dbgCreateInfo, pAllocator, &callback);
         data->logging_callback.push_back(callback);
@@ -250,7 +250,6 @@ static void initSwapchain(layer_data *my_data, const VkAllocationCallbacks *pAll
     uint32_t report_flags = 0;
     uint32_t debug_action = 0;
     FILE *log_output = NULL;
-    const char *option_str;
     VkDebugReportCallbackEXT callback;
 
     // Initialize swapchain options:
@@ -260,13 +259,13 @@ static void initSwapchain(layer_data *my_data, const VkAllocationCallbacks *pAll
     if (debug_action & VK_DBG_LAYER_ACTION_LOG_MSG)
     {
         // Turn on logging, since it was requested:
-        option_str = getLayerOption("lunarg_swapchain.log_filename");
-        log_output = getLayerLogOutput(option_str, "lunarg_swapchain");
+        layer_log_ring *log_ring;
+        getLayerLogSink("lunarg_swapchain", &log_output, &log_ring);
         VkDebugReportCallbackCreateInfoEXT dbgInfo;
         memset(&dbgInfo, 0, sizeof(dbgInfo));
         dbgInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
-        dbgInfo.pfnCallback = log_callback;
-        dbgInfo.pUserData = log_output;
+        dbgInfo.pfnCallback = log_ring ? log_ring_callback : log_callback;
+        dbgInfo.pUserData = log_ring ? (void *) log_ring : (void *) log_output;
         dbgInfo.flags = report_flags;
         layer_create_msg_callback(my_data->report_data,
                                   &dbgInfo,
@@ -45,6 +45,9 @@
 
 #include "thread_check.h"
 
+// google_threading.sample_percent, applied to every instance and device
+static uint32_t threadingSamplePercent = 100;
+
 static void initThreading(layer_data *my_data, const VkAllocationCallbacks *pAllocator)
 {
 
@@ -59,14 +62,14 @@ static void initThreading(layer_data *my_data, const VkAllocationCallbacks *pAll
 
     if (debug_action & VK_DBG_LAYER_ACTION_LOG_MSG)
     {
-        strOpt = getLayerOption("google_threading.log_filename");
-        log_output = getLayerLogOutput(strOpt, "google_threading");
+        layer_log_ring *log_ring;
+        getLayerLogSink("google_threading", &log_output, &log_ring);
         VkDebugReportCallbackCreateInfoEXT dbgCreateInfo;
         memset(&dbgCreateInfo, 0, sizeof(dbgCreateInfo));
         dbgCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
         dbgCreateInfo.flags = report_flags;
-        dbgCreateInfo.pfnCallback = log_callback;
-        dbgCreateInfo.pUserData = (void *) log_output;
+        dbgCreateInfo.pfnCallback = log_ring ? log_ring_callback : log_callback;
+        dbgCreateInfo.pUserData = log_ring ? (void *) log_ring : (void *) log_output;
         layer_create_msg_callback(my_data->report_data, &dbgCreateInfo, pAllocator, &callback);
         my_data->logging_callback.push_back(callback);
     }
@@ -82,10 +85,18 @@ static void initThreading(layer_data *my_data, const VkAllocationCallbacks *pAll
         my_data->logging_callback.push_back(callback);
     }
 
+    strOpt = getLayerOption("google_threading.sample_percent");
+    if (strOpt) {
+        threadingSamplePercent = (uint32_t) strtoul(strOpt, NULL, 0);
+        if (threadingSamplePercent > 100)
+            threadingSamplePercent = 100;
+    }
+    setThreadingSamplePercent(my_data, threadingSamplePercent);
+
     if (!threadingLockInitialized)
     {
         loader_platform_thread_create_mutex(&threadingLock);
-        loader_platform_thread_init_cond(&threadingCond);
+        loader_platform_thread_create_rwlock(&commandPoolLock);
         threadingLockInitialized = 1;
     }
 }
@@ -146,6 +157,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(VkInstance instance
     if (layer_data_map.empty()) {
         // Release mutex when destroying last instance.
         loader_platform_thread_delete_mutex(&threadingLock);
+        loader_platform_thread_delete_rwlock(&commandPoolLock);
         threadingLockInitialized = 0;
     }
 }
@@ -179,6 +191,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice g
     layer_init_device_dispatch_table(*pDevice, my_device_data->device_dispatch_table, fpGetDeviceProcAddr);
 
     my_device_data->report_data = layer_debug_report_create_device(my_instance_data->report_data, *pDevice);
+    setThreadingSamplePercent(my_device_data, threadingSamplePercent);
     return result;
 }
 
@@ -387,9 +400,9 @@ VkResult VKAPI_CALL vkAllocateCommandBuffers(
     // Record mapping from command buffer to command pool
     if (VK_SUCCESS == result) {
         for (int index=0;index<pAllocateInfo->commandBufferCount;index++) {
-            loader_platform_thread_lock_mutex(&threadingLock);
+            loader_platform_thread_write_lock_rwlock(&commandPoolLock);
             command_pool_map[pCommandBuffers[index]] = pAllocateInfo->commandPool;
-            loader_platform_thread_unlock_mutex(&threadingLock);
+            loader_platform_thread_write_unlock_rwlock(&commandPoolLock);
         }
     }
 
@@ -417,9 +430,9 @@ void VKAPI_CALL vkFreeCommandBuffers(
     finishWriteObject(my_data, commandPool);
     for (int index=0;index<commandBufferCount;index++) {
         finishWriteObject(my_data, pCommandBuffers[index], lockCommandPool);
-        loader_platform_thread_lock_mutex(&threadingLock);
+        loader_platform_thread_write_lock_rwlock(&commandPoolLock);
         command_pool_map.erase(pCommandBuffers[index]);
-        loader_platform_thread_unlock_mutex(&threadingLock);
+        loader_platform_thread_write_unlock_rwlock(&commandPoolLock);
     }
 }
 
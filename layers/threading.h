@@ -27,9 +27,12 @@
 
 #ifndef THREADING_H
 #define THREADING_H
+#include <atomic>
+#include <thread>
 #include <vector>
 #include "vk_layer_config.h"
 #include "vk_layer_logging.h"
+#include "vk_layer_rwlock.h"
 
 #if defined(__LP64__) || defined(_WIN64) || defined(__x86_64__) || defined(_M_X64) || defined(__ia64) || defined (_M_IA64) || defined(__aarch64__) || defined(__powerpc64__)
 // If pointers are 64-bit, then there can be separate counters for each
@@ -51,151 +54,267 @@ struct object_use_data {
     int writer_count;
 };
 
+// Each counter<T> tracks the uses of its objects in a direct-mapped table of slots, so
+//  that starting or finishing a use nobody else is making is one atomic operation on
+//  the slot's state word:
+//   bits  0-11  readers     in-flight read uses of the slot's object
+//   bits 12-23  writers     in-flight write uses of the slot's object
+//   bits 24-35  overflow    in-flight uses of other objects that hashed to the slot while
+//                           it was taken, tracked in counter::overflowUses instead
+//   bit  36     rekeying    the slot is being handed to a new object
+//   bits 37-43  generation  bumped each time the slot is handed to a new object
+//   bits 44-63  thread      tag of the thread that started the current use
+// A slot is only handed to a new object when all three counts are zero, so an object is
+//  tracked either in its slot or in overflowUses, never both. threadingLock is only taken
+//  for overflowUses, and threads that must wait for an object poll instead of sleeping.
+#define USE_COUNT_MASK          0xFFFULL
+#define USE_READERS_SHIFT       0
+#define USE_WRITERS_SHIFT       12
+#define USE_OVERFLOW_SHIFT      24
+#define USE_REKEYING_BIT        (1ULL << 36)
+#define USE_GENERATION_SHIFT    37
+#define USE_GENERATION_MASK     0x7FULL
+#define USE_THREAD_SHIFT        44
+#define USE_THREAD_MASK         0xFFFFFULL
+#define USE_SLOT_BITS           8
+#define USE_SLOT_COUNT          (1 << USE_SLOT_BITS)
+
+static inline uint64_t useField(uint64_t state, int shift, uint64_t mask)
+{
+    return (state >> shift) & mask;
+}
+
+static inline uint64_t setUseField(uint64_t state, int shift, uint64_t mask, uint64_t value)
+{
+    return (state & ~(mask << shift)) | ((value & mask) << shift);
+}
+
+static inline bool useSlotTaken(uint64_t state)
+{
+    return (useField(state, USE_READERS_SHIFT, USE_COUNT_MASK) | useField(state, USE_WRITERS_SHIFT, USE_COUNT_MASK)) != 0;
+}
+
+struct object_use_slot {
+    std::atomic<uint64_t> object;
+    std::atomic<uint64_t> state;
+    // Thread that started the current use, only read to report collisions
+    std::atomic<loader_platform_thread_id> thread;
+};
+
+// Small per-thread tags fit in the state word, unlike loader_platform_thread_id
+static std::atomic<uint32_t> nextThreadTag(1);
+static THREAD_LOCAL_DECL uint32_t threadTag = 0;
+
+static inline uint64_t getThreadTag()
+{
+    while (threadTag == 0) {
+        threadTag = nextThreadTag++ & USE_THREAD_MASK;
+    }
+    return threadTag;
+}
+
 struct layer_data;
 
 static int threadingLockInitialized = 0;
+// Guards each counter's overflowUses
 static loader_platform_thread_mutex threadingLock;
-static loader_platform_thread_cond threadingCond;
+// Guards command_pool_map, which every command buffer call reads
+static loader_platform_thread_rwlock commandPoolLock;
 
 template <typename T> class counter {
     public:
     const char *typeName;
     VkDebugReportObjectTypeEXT objectType;
-    std::unordered_map<T, object_use_data> uses;
+    // Percentage of objects whose uses are tracked, set by setThreadingSamplePercent() in
+    //  thread_check.h. The choice is made per handle, so an object is always or never tracked.
+    uint32_t samplePercent;
+    object_use_slot slots[USE_SLOT_COUNT];
+    std::unordered_map<T, object_use_data> overflowUses;
     void startWrite(debug_report_data *report_data, T object)
     {
-        VkBool32 skipCall = VK_FALSE;
-        loader_platform_thread_id tid = loader_platform_get_thread_id();
-        loader_platform_thread_lock_mutex(&threadingLock);
-        if (uses.find(object) == uses.end()) {
-            // There is no current use of the object.  Record writer thread.
-            struct object_use_data *use_data = &uses[object];
-            use_data->reader_count = 0;
-            use_data->writer_count = 1;
-            use_data->thread = tid;
-        } else {
-            struct object_use_data *use_data = &uses[object];
-            if (use_data->reader_count == 0) {
-                // There are no readers.  Two writers just collided.
-                if (use_data->thread != tid) {
-                    skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                        /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                        "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
-                        typeName, use_data->thread, tid);
-                    if (skipCall) {
-                        // Wait for thread-safe access to object instead of skipping call.
-                        while (uses.find(object) != uses.end()) {
-                            loader_platform_thread_cond_wait(&threadingCond, &threadingLock);
-                        }
-                        // There is now no current use of the object.  Record writer thread.
-                        struct object_use_data *use_data = &uses[object];
-                        use_data->thread = tid ;
-                        use_data->reader_count = 0;
-                        use_data->writer_count = 1;
-                    } else {
-                        // Continue with an unsafe use of the object.
-                        use_data->thread = tid ;
-                        use_data->writer_count += 1;
-                    }
-                } else {
-                    // This is either safe multiple use in one call, or recursive use.
-                    // There is no way to make recursion safe.  Just forge ahead.
-                    use_data->writer_count += 1;
+        startUse(report_data, object, true);
+    }
+
+    void finishWrite(T object)
+    {
+        finishUse(object, true);
+    }
+
+    void startRead(debug_report_data *report_data, T object) {
+        startUse(report_data, object, false);
+    }
+    void finishRead(T object) {
+        finishUse(object, false);
+    }
+    counter(const char *name = "",
+            VkDebugReportObjectTypeEXT type=VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT) {
+        typeName = name;
+        objectType=type;
+        samplePercent = 100;
+        for (int i = 0; i < USE_SLOT_COUNT; i++) {
+            slots[i].object.store(0);
+            slots[i].state.store(0);
+            slots[i].thread.store(loader_platform_thread_id());
+        }
+    }
+
+    private:
+    bool isSampled(uint64_t key)
+    {
+        return samplePercent >= 100 || ((key * 0xC2B2AE3D27D4EB4FULL) >> 32) % 100 < samplePercent;
+    }
+
+    object_use_slot &slotFor(uint64_t key)
+    {
+        return slots[(key * 0x9E3779B97F4A7C15ULL) >> (64 - USE_SLOT_BITS)];
+    }
+
+    // Returns true if the callback asked to skip the call. The layer waits for the
+    //  object to be free instead of skipping.
+    bool reportCollision(debug_report_data *report_data, T object, loader_platform_thread_id owner, loader_platform_thread_id tid)
+    {
+        return VK_FALSE != log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
+            /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
+            "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
+            typeName, owner, tid);
+    }
+
+    void startUse(debug_report_data *report_data, T object, bool write)
+    {
+        const uint64_t key = (uint64_t)(object);
+        if (!isSampled(key)) {
+            return;
+        }
+        const uint64_t tag = getThreadTag();
+        const loader_platform_thread_id tid = loader_platform_get_thread_id();
+        const int shift = write ? USE_WRITERS_SHIFT : USE_READERS_SHIFT;
+        object_use_slot &slot = slotFor(key);
+        bool reported = false;
+        bool wait = false;
+        for (;;) {
+            uint64_t state = slot.state.load();
+            if (state & USE_REKEYING_BIT) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (!useSlotTaken(state) && useField(state, USE_OVERFLOW_SHIFT, USE_COUNT_MASK) == 0) {
+                // There is no current use of the slot.  Hand it to this object.
+                uint64_t generation = useField(state, USE_GENERATION_SHIFT, USE_GENERATION_MASK) + 1;
+                if (!slot.state.compare_exchange_weak(state, USE_REKEYING_BIT)) {
+                    continue;
                 }
-            } else {
-                // There are readers.  This writer collided with them.
-                if (use_data->thread != tid) {
-                    skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                        /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                        "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
-                        typeName, use_data->thread, tid);
-                    if (skipCall) {
-                        // Wait for thread-safe access to object instead of skipping call.
-                        while (uses.find(object) != uses.end()) {
-                            loader_platform_thread_cond_wait(&threadingCond, &threadingLock);
-                        }
-                        // There is now no current use of the object.  Record writer thread.
-                        struct object_use_data *use_data = &uses[object];
-                        use_data->thread = tid ;
-                        use_data->reader_count = 0;
-                        use_data->writer_count = 1;
-                    } else {
-                        // Continue with an unsafe use of the object.
-                        use_data->thread = tid ;
-                        use_data->writer_count += 1;
+                slot.object.store(key);
+                slot.thread.store(tid);
+                slot.state.store(setUseField(setUseField(1ULL << shift, USE_GENERATION_SHIFT, USE_GENERATION_MASK, generation),
+                                             USE_THREAD_SHIFT, USE_THREAD_MASK, tag));
+                return;
+            }
+            // The state compare-and-swaps below fail if the slot was rekeyed after this load
+            if (useSlotTaken(state) && slot.object.load() == key) {
+                uint64_t owner = useField(state, USE_THREAD_SHIFT, USE_THREAD_MASK);
+                bool collision = (owner != tag) && (write || useField(state, USE_WRITERS_SHIFT, USE_COUNT_MASK) > 0);
+                if (collision && !reported) {
+                    reported = true;
+                    wait = reportCollision(report_data, object, slot.thread.load(), tid);
+                }
+                if (wait || useField(state, shift, USE_COUNT_MASK) == USE_COUNT_MASK) {
+                    // Wait for thread-safe access to the object, or for a free count
+                    std::this_thread::yield();
+                    continue;
+                }
+                uint64_t newState = state + (1ULL << shift);
+                if (write) {
+                    // A writer becomes the owner, even when continuing with an unsafe use
+                    newState = setUseField(newState, USE_THREAD_SHIFT, USE_THREAD_MASK, tag);
+                }
+                if (slot.state.compare_exchange_weak(state, newState)) {
+                    if (write && owner != tag) {
+                        slot.thread.store(tid);
                     }
-                } else {
-                    // This is either safe multiple use in one call, or recursive use.
-                    // There is no way to make recursion safe.  Just forge ahead.
-                    use_data->writer_count += 1;
+                    return;
                 }
+                continue;
+            }
+            // Another object has the slot
+            if (useField(state, USE_OVERFLOW_SHIFT, USE_COUNT_MASK) == USE_COUNT_MASK) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (!slot.state.compare_exchange_weak(state, state + (1ULL << USE_OVERFLOW_SHIFT))) {
+                continue;
             }
+            if (startOverflowUse(report_data, object, write, tid, reported, wait)) {
+                return;
+            }
+            slot.state.fetch_sub(1ULL << USE_OVERFLOW_SHIFT);
+            std::this_thread::yield();
         }
-        loader_platform_thread_unlock_mutex(&threadingLock);
     }
 
-    void finishWrite(T object)
+    // Slow path for an object whose slot is taken, the caller has counted this use in the
+    //  slot's overflow field. Returns false if the caller must wait for the object.
+    bool startOverflowUse(debug_report_data *report_data, T object, bool write, loader_platform_thread_id tid,
+                          bool &reported, bool &wait)
     {
-        // Object is no longer in use
+        bool started = true;
         loader_platform_thread_lock_mutex(&threadingLock);
-        uses[object].writer_count -= 1;
-        if ((uses[object].reader_count == 0) && (uses[object].writer_count == 0)) {
-            uses.erase(object);
-        }
-        // Notify any waiting threads that this object may be safe to use
-        loader_platform_thread_cond_broadcast(&threadingCond);
-        loader_platform_thread_unlock_mutex(&threadingLock);
-    }
-
-    void startRead(debug_report_data *report_data, T object) {
-        VkBool32 skipCall = VK_FALSE;
-        loader_platform_thread_id tid = loader_platform_get_thread_id();
-        loader_platform_thread_lock_mutex(&threadingLock);
-        if (uses.find(object) == uses.end()) {
-            // There is no current use of the object.  Record reader count
-            struct object_use_data *use_data = &uses[object];
-            use_data->reader_count = 1;
-            use_data->writer_count = 0;
+        auto use = overflowUses.find(object);
+        if (use == overflowUses.end()) {
+            // There is no current use of the object.  Record the thread.
+            struct object_use_data *use_data = &overflowUses[object];
             use_data->thread = tid;
-        } else if (uses[object].writer_count > 0 && uses[object].thread != tid) {
-            // There is a writer of the object.
-            skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
-                typeName, uses[object].thread, tid);
-            if (skipCall) {
+            use_data->reader_count = write ? 0 : 1;
+            use_data->writer_count = write ? 1 : 0;
+        } else {
+            struct object_use_data *use_data = &use->second;
+            bool collision = (use_data->thread != tid) && (write || use_data->writer_count > 0);
+            if (collision && !reported) {
+                reported = true;
+                wait = reportCollision(report_data, object, use_data->thread, tid);
+            }
+            if (wait) {
                 // Wait for thread-safe access to object instead of skipping call.
-                while (uses.find(object) != uses.end()) {
-                    loader_platform_thread_cond_wait(&threadingCond, &threadingLock);
-                }
-                // There is no current use of the object.  Record reader count
-                struct object_use_data *use_data = &uses[object];
-                use_data->reader_count = 1;
-                use_data->writer_count = 0;
+                started = false;
+            } else if (write) {
+                // Either safe use by this thread, or continue with an unsafe use of the object.
                 use_data->thread = tid;
+                use_data->writer_count += 1;
             } else {
-                uses[object].reader_count += 1;
+                use_data->reader_count += 1;
             }
-        } else {
-            // There are other readers of the object.  Increase reader count
-            uses[object].reader_count += 1;
         }
         loader_platform_thread_unlock_mutex(&threadingLock);
+        return started;
     }
-    void finishRead(T object) {
+
+    void finishUse(T object, bool write)
+    {
+        const uint64_t key = (uint64_t)(object);
+        if (!isSampled(key)) {
+            return;
+        }
+        const int shift = write ? USE_WRITERS_SHIFT : USE_READERS_SHIFT;
+        object_use_slot &slot = slotFor(key);
+        // The use being finished keeps the slot from being rekeyed, and keeps the object
+        //  in whichever of the slot and overflowUses it started in
+        if (useSlotTaken(slot.state.load()) && slot.object.load() == key) {
+            slot.state.fetch_sub(1ULL << shift);
+            return;
+        }
         loader_platform_thread_lock_mutex(&threadingLock);
-        uses[object].reader_count -= 1;
-        if ((uses[object].reader_count == 0) && (uses[object].writer_count == 0)) {
-            uses.erase(object);
+        auto use = overflowUses.find(object);
+        if (use != overflowUses.end()) {
+            if (write) {
+                use->second.writer_count -= 1;
+            } else {
+                use->second.reader_count -= 1;
+            }
+            if ((use->second.reader_count == 0) && (use->second.writer_count == 0)) {
+                overflowUses.erase(use);
+            }
         }
-        // Notify and waiting threads that this object may be safe to use
-        loader_platform_thread_cond_broadcast(&threadingCond);
         loader_platform_thread_unlock_mutex(&threadingLock);
-    }
-    counter(const char *name = "",
-            VkDebugReportObjectTypeEXT type=VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT) {
-        typeName = name;
-        objectType=type;
+        slot.state.fetch_sub(1ULL << USE_OVERFLOW_SHIFT);
     }
 };
 
@@ -306,13 +425,21 @@ static std::unordered_map<void*, layer_data *> layer_data_map;
 static std::unordered_map<VkCommandBuffer, VkCommandPool> command_pool_map;
 
 // VkCommandBuffer needs check for implicit use of command pool
+static VkCommandPool getCommandPool(VkCommandBuffer object)
+{
+    VkCommandPool pool = VK_NULL_HANDLE;
+    loader_platform_thread_read_lock_rwlock(&commandPoolLock);
+    auto item = command_pool_map.find(object);
+    if (item != command_pool_map.end()) {
+        pool = item->second;
+    }
+    loader_platform_thread_read_unlock_rwlock(&commandPoolLock);
+    return pool;
+}
 static void startWriteObject(struct layer_data *my_data, VkCommandBuffer object, bool lockPool=true)
 {
     if (lockPool) {
-        loader_platform_thread_lock_mutex(&threadingLock);
-        VkCommandPool pool = command_pool_map[object];
-        loader_platform_thread_unlock_mutex(&threadingLock);
-        startWriteObject(my_data, pool);
+        startWriteObject(my_data, getCommandPool(object));
     }
     my_data->c_VkCommandBuffer.startWrite(my_data->report_data, object);
 }
@@ -320,26 +447,17 @@ static void finishWriteObject(struct layer_data *my_data, VkCommandBuffer object
 {
     my_data->c_VkCommandBuffer.finishWrite(object);
     if (lockPool) {
-        loader_platform_thread_lock_mutex(&threadingLock);
-        VkCommandPool pool = command_pool_map[object];
-        loader_platform_thread_unlock_mutex(&threadingLock);
-        finishWriteObject(my_data, pool);
+        finishWriteObject(my_data, getCommandPool(object));
     }
 }
 static void startReadObject(struct layer_data *my_data, VkCommandBuffer object)
 {
-    loader_platform_thread_lock_mutex(&threadingLock);
-    VkCommandPool pool = command_pool_map[object];
-    loader_platform_thread_unlock_mutex(&threadingLock);
-    startReadObject(my_data, pool);
+    startReadObject(my_data, getCommandPool(object));
     my_data->c_VkCommandBuffer.startRead(my_data->report_data, object);
 }
 static void finishReadObject(struct layer_data *my_data, VkCommandBuffer object)
 {
     my_data->c_VkCommandBuffer.finishRead(object);
-    loader_platform_thread_lock_mutex(&threadingLock);
-    VkCommandPool pool = command_pool_map[object];
-    loader_platform_thread_unlock_mutex(&threadingLock);
-    finishReadObject(my_data, pool);
+    finishReadObject(my_data, getCommandPool(object));
 }
 #endif // THREADING_H
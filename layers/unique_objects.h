@@ -33,8 +33,10 @@
 #include "vulkan/vulkan.h"
 #include "vk_loader_platform.h"
 
+#include <mutex>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "vulkan/vk_layer.h"
 #include "vk_layer_config.h"
@@ -42,12 +44,39 @@
 #include "vk_layer_data.h"
 #include "vk_layer_logging.h"
 #include "vk_layer_extension_utils.h"
-#include "vk_safe_struct.h"
+
+// Structure to wrap returned non-dispatchable objects to guarantee they have unique handles
+//  address of struct will be used as the unique handle
+struct VkUniqueObject
+{
+    uint64_t actualObject;  // next free entry while the entry is on its pool's free list
+    uint64_t generation;    // bumped each time the entry is freed
+};
+
+// Wrappers are carved out of 64-byte aligned slabs kept per instance and device, so
+//  that unwrapping touches densely packed memory and creating or destroying a handle
+//  does not hit the heap. A device's slabs are released by vkDestroyDevice().
+#define UNIQUE_OBJECT_SLAB_SIZE 256
+struct unique_object_pool {
+    std::mutex                   lock;
+    VkUniqueObject              *freeList;
+    std::vector<void *>          slabs;   // as returned by malloc, before alignment
+
+    unique_object_pool() :
+        freeList(NULL)
+    {};
+};
 
 struct layer_data {
+    debug_report_data *report_data;
     bool wsi_enabled;
+    unique_object_pool objectPool;
+    // Wrapped descriptor sets of each wrapped pool, released when the pool is reset or
+    //  destroyed. Guarded by objectPool.lock.
+    std::unordered_map<uint64_t, std::unordered_set<uint64_t>> descriptorSetsByPool;
 
     layer_data() :
+        report_data(nullptr),
         wsi_enabled(false)
     {};
 };
@@ -66,13 +95,232 @@ static std::unordered_map<void*, struct instExts> instanceExtMap;
 static std::unordered_map<void*, layer_data *>    layer_data_map;
 static device_table_map                           unique_objects_device_table_map;
 static instance_table_map                         unique_objects_instance_table_map;
-// Structure to wrap returned non-dispatchable objects to guarantee they have unique handles
-//  address of struct will be used as the unique handle
-struct VkUniqueObject
+
+// Building with UNIQUE_OBJECTS_HANDLE_GENERATIONS puts the low 16 bits of the entry's
+//  generation in the top bits of each handle, so that using a handle after it was
+//  destroyed, even once its entry has been reused, is caught. This assumes user space
+//  addresses fit in 48 bits. Such a handle is reported through the debug report
+//  callbacks of the instance or device owning the entry, and unwraps to VK_NULL_HANDLE.
+//  To find that owner, slabs are aligned to their size and their first entry holds it.
+#ifdef UNIQUE_OBJECTS_HANDLE_GENERATIONS
+#define UNIQUE_OBJECT_GENERATION_SHIFT 48
+#define UNIQUE_OBJECT_GENERATION_MASK  0xFFFFULL
+#define UNIQUE_OBJECT_SLAB_ALIGN       (UNIQUE_OBJECT_SLAB_SIZE * sizeof(VkUniqueObject))
+#define UNIQUE_OBJECT_SLAB_FIRST_ENTRY 1
+
+static inline uint64_t makeUniqueHandle(VkUniqueObject *pUO)
+{
+    return (uint64_t)(uintptr_t)pUO | ((pUO->generation & UNIQUE_OBJECT_GENERATION_MASK) << UNIQUE_OBJECT_GENERATION_SHIFT);
+}
+
+static inline VkUniqueObject *getUniqueObject(uint64_t handle)
+{
+    VkUniqueObject *pUO = (VkUniqueObject *)(uintptr_t)(handle & ((1ULL << UNIQUE_OBJECT_GENERATION_SHIFT) - 1));
+    if ((pUO->generation & UNIQUE_OBJECT_GENERATION_MASK) != (handle >> UNIQUE_OBJECT_GENERATION_SHIFT)) {
+        VkUniqueObject *pSlab = (VkUniqueObject *)((uintptr_t)pUO & ~(uintptr_t)(UNIQUE_OBJECT_SLAB_ALIGN - 1));
+        layer_data *my_data = (layer_data *)(uintptr_t)pSlab->actualObject;
+        log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, handle, __LINE__, 0, "UNIQUE_OBJECTS",
+                "Handle 0x%" PRIx64 " is used after being destroyed.", handle);
+        return NULL;
+    }
+    return pUO;
+}
+#else // UNIQUE_OBJECTS_HANDLE_GENERATIONS
+#define UNIQUE_OBJECT_SLAB_ALIGN       64
+#define UNIQUE_OBJECT_SLAB_FIRST_ENTRY 0
+
+static inline uint64_t makeUniqueHandle(VkUniqueObject *pUO)
+{
+    return (uint64_t)(uintptr_t)pUO;
+}
+
+static inline VkUniqueObject *getUniqueObject(uint64_t handle)
+{
+    return (VkUniqueObject *)(uintptr_t)handle;
+}
+#endif // UNIQUE_OBJECTS_HANDLE_GENERATIONS
+
+// Returns the handle the next layer or driver gave for a handle this layer returned
+static inline uint64_t unwrapUniqueObject(uint64_t handle)
+{
+    VkUniqueObject *pUO = getUniqueObject(handle);
+    return pUO ? pUO->actualObject : 0;
+}
+
+// Caller must hold my_data->objectPool.lock
+static VkUniqueObject *allocUniqueObjectLocked(layer_data *my_data)
+{
+    unique_object_pool *pool = &my_data->objectPool;
+    if (!pool->freeList) {
+        void *slab = malloc(UNIQUE_OBJECT_SLAB_SIZE * sizeof(VkUniqueObject) + UNIQUE_OBJECT_SLAB_ALIGN - 1);
+        pool->slabs.push_back(slab);
+        VkUniqueObject *entries = (VkUniqueObject *)(((uintptr_t)slab + UNIQUE_OBJECT_SLAB_ALIGN - 1) & ~(uintptr_t)(UNIQUE_OBJECT_SLAB_ALIGN - 1));
+        // Any reserved first entry records the owner instead of being handed out
+        entries[0].actualObject = (uint64_t)(uintptr_t)my_data;
+        for (uint32_t i = UNIQUE_OBJECT_SLAB_FIRST_ENTRY; i < UNIQUE_OBJECT_SLAB_SIZE; i++) {
+            entries[i].actualObject = (i + 1 < UNIQUE_OBJECT_SLAB_SIZE) ? (uint64_t)(uintptr_t)&entries[i + 1] : 0;
+            entries[i].generation = 0;
+        }
+        pool->freeList = &entries[UNIQUE_OBJECT_SLAB_FIRST_ENTRY];
+    }
+    VkUniqueObject *pUO = pool->freeList;
+    pool->freeList = (VkUniqueObject *)(uintptr_t)pUO->actualObject;
+    return pUO;
+}
+
+// Caller must hold pool->lock
+static void freeUniqueObjectLocked(unique_object_pool *pool, uint64_t handle)
+{
+    if (!handle)
+        return;
+    VkUniqueObject *pUO = getUniqueObject(handle);
+    if (!pUO)
+        return;
+    pUO->generation++;
+    pUO->actualObject = (uint64_t)(uintptr_t)pool->freeList;
+    pool->freeList = pUO;
+}
+
+// Wrap one new object and return the handle to give the application
+static uint64_t wrapUniqueObject(layer_data *my_data, uint64_t actualObject)
+{
+    std::lock_guard<std::mutex> lock(my_data->objectPool.lock);
+    VkUniqueObject *pUO = allocUniqueObjectLocked(my_data);
+    pUO->actualObject = actualObject;
+    return makeUniqueHandle(pUO);
+}
+
+// Wrap an array of new objects in place, taking the pool lock once
+template <typename T>
+static void wrapUniqueObjects(layer_data *my_data, uint32_t count, T *pObjects)
+{
+    std::lock_guard<std::mutex> lock(my_data->objectPool.lock);
+    for (uint32_t i = 0; i < count; i++) {
+        VkUniqueObject *pUO = allocUniqueObjectLocked(my_data);
+        pUO->actualObject = (uint64_t)pObjects[i];
+        pObjects[i] = (T)makeUniqueHandle(pUO);
+    }
+}
+
+static void freeUniqueObject(layer_data *my_data, uint64_t handle)
+{
+    std::lock_guard<std::mutex> lock(my_data->objectPool.lock);
+    freeUniqueObjectLocked(&my_data->objectPool, handle);
+}
+
+template <typename T>
+static void freeUniqueObjects(layer_data *my_data, uint32_t count, const T *pHandles)
+{
+    std::lock_guard<std::mutex> lock(my_data->objectPool.lock);
+    for (uint32_t i = 0; i < count; i++) {
+        freeUniqueObjectLocked(&my_data->objectPool, (uint64_t)pHandles[i]);
+    }
+}
+
+// Releases every wrapper of an instance or device at once
+static void destroyUniqueObjectPool(layer_data *my_data)
 {
-    uint64_t actualObject;
+    std::lock_guard<std::mutex> lock(my_data->objectPool.lock);
+    for (auto slab : my_data->objectPool.slabs) {
+        free(slab);
+    }
+    my_data->objectPool.slabs.clear();
+    my_data->objectPool.freeList = NULL;
+    my_data->descriptorSetsByPool.clear();
+}
+
+// Calls taking structs that hold non-dispatchable handles pass the next layer shallow
+//  copies of those structs and arrays with the handles unwrapped. The copies are made in
+//  per-thread scratch memory that is kept between calls: generated code first adds up
+//  scratchBytes() for every copy, then makes them with unique_objects_scratch::copy(),
+//  so a call only touches the heap when it needs more scratch than any before it.
+#define UNIQUE_OBJECTS_SCRATCH_ALIGN 16
+// Larger requests get memory of their own which is freed at the end of the call. The
+//  kept buffer is never freed, so this also bounds what each exited thread leaves behind.
+#define UNIQUE_OBJECTS_SCRATCH_RETAIN_SIZE (16 * 1024)
+
+struct unique_objects_scratch_buffer {
+    char   *base;
+    size_t  size;
+    bool    inUse;
+};
+static THREAD_LOCAL_DECL unique_objects_scratch_buffer threadScratch;
+
+template <typename T>
+static inline size_t scratchBytes(const T *, uint32_t count)
+{
+    return (sizeof(T) * count + UNIQUE_OBJECTS_SCRATCH_ALIGN - 1) & ~(size_t)(UNIQUE_OBJECTS_SCRATCH_ALIGN - 1);
+}
+
+class unique_objects_scratch {
+  public:
+    unique_objects_scratch(size_t size) :
+        base(NULL), next(NULL), owned(false)
+    {
+        if (0 == size)
+            return;
+        if (!threadScratch.inUse && size <= UNIQUE_OBJECTS_SCRATCH_RETAIN_SIZE) {
+            if (threadScratch.size < size) {
+                free(threadScratch.base);
+                threadScratch.base = (char *)malloc(size);
+                threadScratch.size = size;
+            }
+            threadScratch.inUse = true;
+            base = threadScratch.base;
+        } else {
+            // Too large to keep, or the thread's buffer is taken by a call further up the stack
+            base = (char *)malloc(size);
+            owned = true;
+        }
+        next = base;
+    }
+
+    ~unique_objects_scratch()
+    {
+        if (owned)
+            free(base);
+        else if (base)
+            threadScratch.inUse = false;
+    }
+
+    // Copy count elements of src into scratch, which must have been sized for them
+    template <typename T>
+    T *copy(const T *src, uint32_t count)
+    {
+        T *dst = (T *)next;
+        if (count) {
+            memcpy(dst, src, sizeof(T) * count);
+            next += scratchBytes(src, count);
+        }
+        return dst;
+    }
+
+  private:
+    char *base;
+    char *next;
+    bool  owned;
 };
 
+// Which of VkWriteDescriptorSet's info arrays are read for a descriptor type. The
+//  others may be left dangling by the app, so they must not be copied.
+static inline bool descriptorTypeUsesImageInfo(VkDescriptorType type)
+{
+    return (VK_DESCRIPTOR_TYPE_SAMPLER == type) || (VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER == type) ||
+           (VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE == type) || (VK_DESCRIPTOR_TYPE_STORAGE_IMAGE == type) ||
+           (VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT == type);
+}
+
+static inline bool descriptorTypeUsesBufferInfo(VkDescriptorType type)
+{
+    return (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER == type) || (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER == type) ||
+           (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == type) || (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == type);
+}
+
+static inline bool descriptorTypeUsesTexelBufferView(VkDescriptorType type)
+{
+    return (VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER == type) || (VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER == type);
+}
+
 // Handle CreateInstance
 static void createInstanceRegisterExtensions(const VkInstanceCreateInfo* pCreateInfo, VkInstance instance)
 {
@@ -161,13 +409,34 @@ explicit_CreateInstance(
         return result;
     }
 
-    initInstanceTable(*pInstance, fpGetInstanceProcAddr, unique_objects_instance_table_map);
+    VkLayerInstanceDispatchTable *pTable = initInstanceTable(*pInstance, fpGetInstanceProcAddr, unique_objects_instance_table_map);
+
+    layer_data *my_data = get_my_data_ptr(get_dispatch_key(*pInstance), layer_data_map);
+    my_data->report_data = debug_report_create_instance(pTable, *pInstance, pCreateInfo->enabledExtensionCount, pCreateInfo->ppEnabledExtensionNames);
 
     createInstanceRegisterExtensions(pCreateInfo, *pInstance);
 
     return result;
 }
 
+void
+explicit_DestroyInstance(
+    VkInstance                   instance,
+    const VkAllocationCallbacks *pAllocator)
+{
+    dispatch_key key = get_dispatch_key(instance);
+    VkLayerInstanceDispatchTable *pTable = get_dispatch_table(unique_objects_instance_table_map, instance);
+    pTable->DestroyInstance(instance, pAllocator);
+    instanceExtMap.erase(pTable);
+    unique_objects_instance_table_map.erase(key);
+
+    layer_data *my_data = get_my_data_ptr(key, layer_data_map);
+    layer_debug_report_destroy_instance(my_data->report_data);
+    destroyUniqueObjectPool(my_data);
+    delete my_data;
+    layer_data_map.erase(key);
+}
+
 // Handle CreateDevice
 static void createDeviceRegisterExtensions(const VkDeviceCreateInfo* pCreateInfo, VkDevice device)
 {
@@ -214,17 +483,154 @@ explicit_CreateDevice(
     // Setup layer's device dispatch table
     initDeviceTable(*pDevice, fpGetDeviceProcAddr, unique_objects_device_table_map);
 
+    layer_data *my_instance_data = get_my_data_ptr(get_dispatch_key(gpu), layer_data_map);
+    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(*pDevice), layer_data_map);
+    my_device_data->report_data = layer_debug_report_create_device(my_instance_data->report_data, *pDevice);
+
     createDeviceRegisterExtensions(pCreateInfo, *pDevice);
 
     return result;
 }
 
+void
+explicit_DestroyDevice(
+    VkDevice                     device,
+    const VkAllocationCallbacks *pAllocator)
+{
+    dispatch_key key = get_dispatch_key(device);
+    get_dispatch_table(unique_objects_device_table_map, device)->DestroyDevice(device, pAllocator);
+    unique_objects_device_table_map.erase(key);
+
+    layer_data *my_device_data = get_my_data_ptr(key, layer_data_map);
+    layer_debug_report_destroy_device(device);
+    destroyUniqueObjectPool(my_device_data);
+    delete my_device_data;
+    layer_data_map.erase(key);
+}
+
+// Descriptor sets go away with their pool, so their wrappers are kept per pool and
+//  released by vkResetDescriptorPool() and vkDestroyDescriptorPool() as well
+VkResult explicit_AllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo* pAllocateInfo, VkDescriptorSet* pDescriptorSets)
+{
+    VkDescriptorSetAllocateInfo* local_pAllocateInfo = NULL;
+    size_t scratch_size = 0;
+    if (pAllocateInfo) {
+        scratch_size += scratchBytes(pAllocateInfo, 1);
+        if (pAllocateInfo->pSetLayouts) {
+            scratch_size += scratchBytes(pAllocateInfo->pSetLayouts, pAllocateInfo->descriptorSetCount);
+        }
+    }
+    unique_objects_scratch scratch(scratch_size);
+    if (pAllocateInfo) {
+        local_pAllocateInfo = scratch.copy(pAllocateInfo, 1);
+        if (pAllocateInfo->descriptorPool) {
+            local_pAllocateInfo->descriptorPool = (VkDescriptorPool)unwrapUniqueObject((uint64_t)pAllocateInfo->descriptorPool);
+        }
+        if (pAllocateInfo->pSetLayouts) {
+            VkDescriptorSetLayout* local_pSetLayouts = scratch.copy(pAllocateInfo->pSetLayouts, pAllocateInfo->descriptorSetCount);
+            local_pAllocateInfo->pSetLayouts = local_pSetLayouts;
+            for (uint32_t idx0=0; idx0<pAllocateInfo->descriptorSetCount; ++idx0) {
+                local_pSetLayouts[idx0] = (VkDescriptorSetLayout)unwrapUniqueObject((uint64_t)pAllocateInfo->pSetLayouts[idx0]);
+            }
+        }
+    }
+    VkResult result = get_dispatch_table(unique_objects_device_table_map, device)->AllocateDescriptorSets(device, (const VkDescriptorSetAllocateInfo*)local_pAllocateInfo, pDescriptorSets);
+    if (VK_SUCCESS == result) {
+        layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+        std::lock_guard<std::mutex> lock(my_data->objectPool.lock);
+        std::unordered_set<uint64_t> &poolSets = my_data->descriptorSetsByPool[(uint64_t)pAllocateInfo->descriptorPool];
+        for (uint32_t i = 0; i < pAllocateInfo->descriptorSetCount; i++) {
+            VkUniqueObject *pUO = allocUniqueObjectLocked(my_data);
+            pUO->actualObject = (uint64_t)pDescriptorSets[i];
+            pDescriptorSets[i] = (VkDescriptorSet)makeUniqueHandle(pUO);
+            poolSets.insert((uint64_t)pDescriptorSets[i]);
+        }
+    }
+    return result;
+}
+
+VkResult explicit_FreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets)
+{
+    VkDescriptorSet* local_pDescriptorSets = NULL;
+    size_t scratch_size = 0;
+    if (pDescriptorSets) {
+        scratch_size += scratchBytes(pDescriptorSets, descriptorSetCount);
+    }
+    unique_objects_scratch scratch(scratch_size);
+    VkDescriptorPool local_descriptorPool = descriptorPool;
+    if (descriptorPool) {
+        descriptorPool = (VkDescriptorPool)unwrapUniqueObject((uint64_t)descriptorPool);
+    }
+    if (pDescriptorSets) {
+        local_pDescriptorSets = scratch.copy(pDescriptorSets, descriptorSetCount);
+        for (uint32_t idx0=0; idx0<descriptorSetCount; ++idx0) {
+            local_pDescriptorSets[idx0] = (VkDescriptorSet)unwrapUniqueObject((uint64_t)pDescriptorSets[idx0]);
+        }
+    }
+    VkResult result = get_dispatch_table(unique_objects_device_table_map, device)->FreeDescriptorSets(device, descriptorPool, descriptorSetCount, (const VkDescriptorSet*)local_pDescriptorSets);
+    // The sets stay valid if the free fails, so only then are their wrappers released
+    if (VK_SUCCESS == result) {
+        layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+        std::lock_guard<std::mutex> lock(my_data->objectPool.lock);
+        auto poolSets = my_data->descriptorSetsByPool.find((uint64_t)local_descriptorPool);
+        for (uint32_t i = 0; i < descriptorSetCount; i++) {
+            if (poolSets != my_data->descriptorSetsByPool.end())
+                poolSets->second.erase((uint64_t)pDescriptorSets[i]);
+            freeUniqueObjectLocked(&my_data->objectPool, (uint64_t)pDescriptorSets[i]);
+        }
+    }
+    return result;
+}
+
+// Caller must hold my_data->objectPool.lock
+static void freePoolDescriptorSetsLocked(layer_data *my_data, uint64_t descriptorPool, bool erasePool)
+{
+    auto poolSets = my_data->descriptorSetsByPool.find(descriptorPool);
+    if (poolSets == my_data->descriptorSetsByPool.end())
+        return;
+    for (auto handle : poolSets->second) {
+        freeUniqueObjectLocked(&my_data->objectPool, handle);
+    }
+    if (erasePool)
+        my_data->descriptorSetsByPool.erase(poolSets);
+    else
+        poolSets->second.clear();
+}
+
+VkResult explicit_ResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags)
+{
+    VkDescriptorPool local_descriptorPool = descriptorPool;
+    if (descriptorPool) {
+        descriptorPool = (VkDescriptorPool)unwrapUniqueObject((uint64_t)descriptorPool);
+    }
+    VkResult result = get_dispatch_table(unique_objects_device_table_map, device)->ResetDescriptorPool(device, descriptorPool, flags);
+    if (VK_SUCCESS == result) {
+        layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+        std::lock_guard<std::mutex> lock(my_data->objectPool.lock);
+        freePoolDescriptorSetsLocked(my_data, (uint64_t)local_descriptorPool, false);
+    }
+    return result;
+}
+
+void explicit_DestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks* pAllocator)
+{
+    VkDescriptorPool local_descriptorPool = descriptorPool;
+    if (descriptorPool) {
+        descriptorPool = (VkDescriptorPool)unwrapUniqueObject((uint64_t)descriptorPool);
+    }
+    get_dispatch_table(unique_objects_device_table_map, device)->DestroyDescriptorPool(device, descriptorPool, pAllocator);
+    layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    std::lock_guard<std::mutex> lock(my_data->objectPool.lock);
+    freePoolDescriptorSetsLocked(my_data, (uint64_t)local_descriptorPool, true);
+    freeUniqueObjectLocked(&my_data->objectPool, (uint64_t)local_descriptorPool);
+}
+
 VkResult explicit_QueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
 {
 // UNWRAP USES:
 //  0 : fence,VkFence
     if (VK_NULL_HANDLE != fence) {
-        fence = (VkFence)((VkUniqueObject*)fence)->actualObject;
+        fence = (VkFence)unwrapUniqueObject((uint64_t)fence);
     }
 //  waitSemaphoreCount : pSubmits[submitCount]->pWaitSemaphores,VkSemaphore
     std::vector<VkSemaphore> original_pWaitSemaphores = {};
@@ -236,14 +642,14 @@ VkResult explicit_QueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmi
                 for (uint32_t index1=0; index1<pSubmits[index0].waitSemaphoreCount; ++index1) {
                     VkSemaphore** ppSemaphore = (VkSemaphore**)&(pSubmits[index0].pWaitSemaphores);
                     original_pWaitSemaphores.push_back(pSubmits[index0].pWaitSemaphores[index1]);
-                    *(ppSemaphore[index1]) = (VkSemaphore)((VkUniqueObject*)pSubmits[index0].pWaitSemaphores[index1])->actualObject;
+                    *(ppSemaphore[index1]) = (VkSemaphore)unwrapUniqueObject((uint64_t)pSubmits[index0].pWaitSemaphores[index1]);
                 }
             }
             if (pSubmits[index0].pSignalSemaphores) {
                 for (uint32_t index1=0; index1<pSubmits[index0].signalSemaphoreCount; ++index1) {
                     VkSemaphore** ppSemaphore = (VkSemaphore**)&(pSubmits[index0].pSignalSemaphores);
                     original_pSignalSemaphores.push_back(pSubmits[index0].pSignalSemaphores[index1]);
-                    *(ppSemaphore[index1]) = (VkSemaphore)((VkUniqueObject*)pSubmits[index0].pSignalSemaphores[index1])->actualObject;
+                    *(ppSemaphore[index1]) = (VkSemaphore)unwrapUniqueObject((uint64_t)pSubmits[index0].pSignalSemaphores[index1]);
                 }
             }
         }
@@ -287,14 +693,14 @@ VkResult explicit_QueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const V
                     if (pBindInfo[index0].pBufferBinds[index1].buffer) {
                         VkBuffer* pBuffer = (VkBuffer*)&(pBindInfo[index0].pBufferBinds[index1].buffer);
                         original_buffer.push_back(pBindInfo[index0].pBufferBinds[index1].buffer);
-                        *(pBuffer) = (VkBuffer)((VkUniqueObject*)pBindInfo[index0].pBufferBinds[index1].buffer)->actualObject;
+                        *(pBuffer) = (VkBuffer)unwrapUniqueObject((uint64_t)pBindInfo[index0].pBufferBinds[index1].buffer);
                     }
                     if (pBindInfo[index0].pBufferBinds[index1].pBinds) {
                         for (uint32_t index2=0; index2<pBindInfo[index0].pBufferBinds[index1].bindCount; ++index2) {
                             if (pBindInfo[index0].pBufferBinds[index1].pBinds[index2].memory) {
                                 VkDeviceMemory* pDeviceMemory = (VkDeviceMemory*)&(pBindInfo[index0].pBufferBinds[index1].pBinds[index2].memory);
                                 original_memory1.push_back(pBindInfo[index0].pBufferBinds[index1].pBinds[index2].memory);
-                                *(pDeviceMemory) = (VkDeviceMemory)((VkUniqueObject*)pBindInfo[index0].pBufferBinds[index1].pBinds[index2].memory)->actualObject;
+                                *(pDeviceMemory) = (VkDeviceMemory)unwrapUniqueObject((uint64_t)pBindInfo[index0].pBufferBinds[index1].pBinds[index2].memory);
                             }
                         }
                     }
@@ -305,14 +711,14 @@ VkResult explicit_QueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const V
                     if (pBindInfo[index0].pImageOpaqueBinds[index1].image) {
                         VkImage* pImage = (VkImage*)&(pBindInfo[index0].pImageOpaqueBinds[index1].image);
                         original_image1.push_back(pBindInfo[index0].pImageOpaqueBinds[index1].image);
-                        *(pImage) = (VkImage)((VkUniqueObject*)pBindInfo[index0].pImageOpaqueBinds[index1].image)->actualObject;
+                        *(pImage) = (VkImage)unwrapUniqueObject((uint64_t)pBindInfo[index0].pImageOpaqueBinds[index1].image);
                     }
                     if (pBindInfo[index0].pImageOpaqueBinds[index1].pBinds) {
                         for (uint32_t index2=0; index2<pBindInfo[index0].pImageOpaqueBinds[index1].bindCount; ++index2) {
                             if (pBindInfo[index0].pImageOpaqueBinds[index1].pBinds[index2].memory) {
                                 VkDeviceMemory* pDeviceMemory = (VkDeviceMemory*)&(pBindInfo[index0].pImageOpaqueBinds[index1].pBinds[index2].memory);
                                 original_memory2.push_back(pBindInfo[index0].pImageOpaqueBinds[index1].pBinds[index2].memory);
-                                *(pDeviceMemory) = (VkDeviceMemory)((VkUniqueObject*)pBindInfo[index0].pImageOpaqueBinds[index1].pBinds[index2].memory)->actualObject;
+                                *(pDeviceMemory) = (VkDeviceMemory)unwrapUniqueObject((uint64_t)pBindInfo[index0].pImageOpaqueBinds[index1].pBinds[index2].memory);
                             }
                         }
                     }
@@ -323,14 +729,14 @@ VkResult explicit_QueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const V
                     if (pBindInfo[index0].pImageBinds[index1].image) {
                         VkImage* pImage = (VkImage*)&(pBindInfo[index0].pImageBinds[index1].image);
                         original_image2.push_back(pBindInfo[index0].pImageBinds[index1].image);
-                        *(pImage) = (VkImage)((VkUniqueObject*)pBindInfo[index0].pImageBinds[index1].image)->actualObject;
+                        *(pImage) = (VkImage)unwrapUniqueObject((uint64_t)pBindInfo[index0].pImageBinds[index1].image);
                     }
                     if (pBindInfo[index0].pImageBinds[index1].pBinds) {
                         for (uint32_t index2=0; index2<pBindInfo[index0].pImageBinds[index1].bindCount; ++index2) {
                             if (pBindInfo[index0].pImageBinds[index1].pBinds[index2].memory) {
                                 VkDeviceMemory* pDeviceMemory = (VkDeviceMemory*)&(pBindInfo[index0].pImageBinds[index1].pBinds[index2].memory);
                                 original_memory3.push_back(pBindInfo[index0].pImageBinds[index1].pBinds[index2].memory);
-                                *(pDeviceMemory) = (VkDeviceMemory)((VkUniqueObject*)pBindInfo[index0].pImageBinds[index1].pBinds[index2].memory)->actualObject;
+                                *(pDeviceMemory) = (VkDeviceMemory)unwrapUniqueObject((uint64_t)pBindInfo[index0].pImageBinds[index1].pBinds[index2].memory);
                             }
                         }
                     }
@@ -340,20 +746,20 @@ VkResult explicit_QueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const V
                 for (uint32_t index1=0; index1<pBindInfo[index0].waitSemaphoreCount; ++index1) {
                     VkSemaphore** ppSemaphore = (VkSemaphore**)&(pBindInfo[index0].pWaitSemaphores);
                     original_pWaitSemaphores.push_back(pBindInfo[index0].pWaitSemaphores[index1]);
-                    *(ppSemaphore[index1]) = (VkSemaphore)((VkUniqueObject*)pBindInfo[index0].pWaitSemaphores[index1])->actualObject;
+                    *(ppSemaphore[index1]) = (VkSemaphore)unwrapUniqueObject((uint64_t)pBindInfo[index0].pWaitSemaphores[index1]);
                 }
             }
             if (pBindInfo[index0].pSignalSemaphores) {
                 for (uint32_t index1=0; index1<pBindInfo[index0].signalSemaphoreCount; ++index1) {
                     VkSemaphore** ppSemaphore = (VkSemaphore**)&(pBindInfo[index0].pSignalSemaphores);
                     original_pSignalSemaphores.push_back(pBindInfo[index0].pSignalSemaphores[index1]);
-                    *(ppSemaphore[index1]) = (VkSemaphore)((VkUniqueObject*)pBindInfo[index0].pSignalSemaphores[index1])->actualObject;
+                    *(ppSemaphore[index1]) = (VkSemaphore)unwrapUniqueObject((uint64_t)pBindInfo[index0].pSignalSemaphores[index1]);
                 }
             }
         }
     }
     if (VK_NULL_HANDLE != fence) {
-        fence = (VkFence)((VkUniqueObject*)fence)->actualObject;
+        fence = (VkFence)unwrapUniqueObject((uint64_t)fence);
     }
     VkResult result = get_dispatch_table(unique_objects_device_table_map, queue)->QueueBindSparse(queue, bindInfoCount, pBindInfo, fence);
     if (pBindInfo) {
@@ -427,35 +833,34 @@ VkResult explicit_CreateComputePipelines(VkDevice device, VkPipelineCache pipeli
 {
 // STRUCT USES:{'pipelineCache': 'VkPipelineCache', 'pCreateInfos[createInfoCount]': {'stage': {'module': 'VkShaderModule'}, 'layout': 'VkPipelineLayout', 'basePipelineHandle': 'VkPipeline'}}
 //LOCAL DECLS:{'pCreateInfos': 'VkComputePipelineCreateInfo*'}
-    safe_VkComputePipelineCreateInfo* local_pCreateInfos = NULL;
+    VkComputePipelineCreateInfo* local_pCreateInfos = NULL;
+    size_t scratch_size = 0;
+    if (pCreateInfos) {
+        scratch_size += scratchBytes(pCreateInfos, createInfoCount);
+    }
+    unique_objects_scratch scratch(scratch_size);
     if (pCreateInfos) {
-        local_pCreateInfos = new safe_VkComputePipelineCreateInfo[createInfoCount];
+        local_pCreateInfos = scratch.copy(pCreateInfos, createInfoCount);
         for (uint32_t idx0=0; idx0<createInfoCount; ++idx0) {
-            local_pCreateInfos[idx0].initialize(&pCreateInfos[idx0]);
             if (pCreateInfos[idx0].basePipelineHandle) {
-                local_pCreateInfos[idx0].basePipelineHandle = (VkPipeline)((VkUniqueObject*)pCreateInfos[idx0].basePipelineHandle)->actualObject;
+                local_pCreateInfos[idx0].basePipelineHandle = (VkPipeline)unwrapUniqueObject((uint64_t)pCreateInfos[idx0].basePipelineHandle);
             }
             if (pCreateInfos[idx0].layout) {
-                local_pCreateInfos[idx0].layout = (VkPipelineLayout)((VkUniqueObject*)pCreateInfos[idx0].layout)->actualObject;
+                local_pCreateInfos[idx0].layout = (VkPipelineLayout)unwrapUniqueObject((uint64_t)pCreateInfos[idx0].layout);
             }
             if (pCreateInfos[idx0].stage.module) {
-                local_pCreateInfos[idx0].stage.module = (VkShaderModule)((VkUniqueObject*)pCreateInfos[idx0].stage.module)->actualObject;
+                local_pCreateInfos[idx0].stage.module = (VkShaderModule)unwrapUniqueObject((uint64_t)pCreateInfos[idx0].stage.module);
             }
         }
     }
     if (pipelineCache) {
-        pipelineCache = (VkPipelineCache)((VkUniqueObject*)pipelineCache)->actualObject;
+        pipelineCache = (VkPipelineCache)unwrapUniqueObject((uint64_t)pipelineCache);
     }
 // CODEGEN : file /usr/local/google/home/tobine/vulkan_work/LoaderAndTools/vk-layer-generate.py line #1671
     VkResult result = get_dispatch_table(unique_objects_device_table_map, device)->CreateComputePipelines(device, pipelineCache, createInfoCount, (const VkComputePipelineCreateInfo*)local_pCreateInfos, pAllocator, pPipelines);
-    delete[] local_pCreateInfos;
     if (VK_SUCCESS == result) {
-        VkUniqueObject* pUO = NULL;
-        for (uint32_t i=0; i<createInfoCount; ++i) {
-            pUO = new VkUniqueObject();
-            pUO->actualObject = (uint64_t)pPipelines[i];
-            pPipelines[i] = (VkPipeline)pUO;
-        }
+        layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+        wrapUniqueObjects(my_data, createInfoCount, pPipelines);
     }
     return result;
 }
@@ -464,42 +869,48 @@ VkResult explicit_CreateGraphicsPipelines(VkDevice device, VkPipelineCache pipel
 {
 // STRUCT USES:{'pipelineCache': 'VkPipelineCache', 'pCreateInfos[createInfoCount]': {'layout': 'VkPipelineLayout', 'pStages[stageCount]': {'module': 'VkShaderModule'}, 'renderPass': 'VkRenderPass', 'basePipelineHandle': 'VkPipeline'}}
 //LOCAL DECLS:{'pCreateInfos': 'VkGraphicsPipelineCreateInfo*'}
-    safe_VkGraphicsPipelineCreateInfo* local_pCreateInfos = NULL;
+    VkGraphicsPipelineCreateInfo* local_pCreateInfos = NULL;
+    size_t scratch_size = 0;
     if (pCreateInfos) {
-        local_pCreateInfos = new safe_VkGraphicsPipelineCreateInfo[createInfoCount];
+        scratch_size += scratchBytes(pCreateInfos, createInfoCount);
+        for (uint32_t idx0=0; idx0<createInfoCount; ++idx0) {
+            if (pCreateInfos[idx0].pStages) {
+                scratch_size += scratchBytes(pCreateInfos[idx0].pStages, pCreateInfos[idx0].stageCount);
+            }
+        }
+    }
+    unique_objects_scratch scratch(scratch_size);
+    if (pCreateInfos) {
+        local_pCreateInfos = scratch.copy(pCreateInfos, createInfoCount);
         for (uint32_t idx0=0; idx0<createInfoCount; ++idx0) {
-            local_pCreateInfos[idx0].initialize(&pCreateInfos[idx0]);
             if (pCreateInfos[idx0].basePipelineHandle) {
-                local_pCreateInfos[idx0].basePipelineHandle = (VkPipeline)((VkUniqueObject*)pCreateInfos[idx0].basePipelineHandle)->actualObject;
+                local_pCreateInfos[idx0].basePipelineHandle = (VkPipeline)unwrapUniqueObject((uint64_t)pCreateInfos[idx0].basePipelineHandle);
             }
             if (pCreateInfos[idx0].layout) {
-                local_pCreateInfos[idx0].layout = (VkPipelineLayout)((VkUniqueObject*)pCreateInfos[idx0].layout)->actualObject;
+                local_pCreateInfos[idx0].layout = (VkPipelineLayout)unwrapUniqueObject((uint64_t)pCreateInfos[idx0].layout);
             }
             if (pCreateInfos[idx0].pStages) {
+                VkPipelineShaderStageCreateInfo* local_pStages = scratch.copy(pCreateInfos[idx0].pStages, pCreateInfos[idx0].stageCount);
+                local_pCreateInfos[idx0].pStages = local_pStages;
                 for (uint32_t idx1=0; idx1<pCreateInfos[idx0].stageCount; ++idx1) {
                     if (pCreateInfos[idx0].pStages[idx1].module) {
-                        local_pCreateInfos[idx0].pStages[idx1].module = (VkShaderModule)((VkUniqueObject*)pCreateInfos[idx0].pStages[idx1].module)->actualObject;
+                        local_pStages[idx1].module = (VkShaderModule)unwrapUniqueObject((uint64_t)pCreateInfos[idx0].pStages[idx1].module);
                     }
                 }
             }
             if (pCreateInfos[idx0].renderPass) {
-                local_pCreateInfos[idx0].renderPass = (VkRenderPass)((VkUniqueObject*)pCreateInfos[idx0].renderPass)->actualObject;
+                local_pCreateInfos[idx0].renderPass = (VkRenderPass)unwrapUniqueObject((uint64_t)pCreateInfos[idx0].renderPass);
             }
         }
     }
     if (pipelineCache) {
-        pipelineCache = (VkPipelineCache)((VkUniqueObject*)pipelineCache)->actualObject;
+        pipelineCache = (VkPipelineCache)unwrapUniqueObject((uint64_t)pipelineCache);
     }
 // CODEGEN : file /usr/local/google/home/tobine/vulkan_work/LoaderAndTools/vk-layer-generate.py line #1671
     VkResult result = get_dispatch_table(unique_objects_device_table_map, device)->CreateGraphicsPipelines(device, pipelineCache, createInfoCount, (const VkGraphicsPipelineCreateInfo*)local_pCreateInfos, pAllocator, pPipelines);
-    delete[] local_pCreateInfos;
     if (VK_SUCCESS == result) {
-        VkUniqueObject* pUO = NULL;
-        for (uint32_t i=0; i<createInfoCount; ++i) {
-            pUO = new VkUniqueObject();
-            pUO->actualObject = (uint64_t)pPipelines[i];
-            pPipelines[i] = (VkPipeline)pUO;
-        }
+        layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+        wrapUniqueObjects(my_data, createInfoCount, pPipelines);
     }
     return result;
 }
@@ -509,18 +920,14 @@ VkResult explicit_GetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchai
 // UNWRAP USES:
 //  0 : swapchain,VkSwapchainKHR, pSwapchainImages,VkImage
     if (VK_NULL_HANDLE != swapchain) {
-        swapchain = (VkSwapchainKHR)((VkUniqueObject*)swapchain)->actualObject;
+        swapchain = (VkSwapchainKHR)unwrapUniqueObject((uint64_t)swapchain);
     }
     VkResult result = get_dispatch_table(unique_objects_device_table_map, device)->GetSwapchainImagesKHR(device, swapchain, pSwapchainImageCount, pSwapchainImages);
     // TODO : Need to add corresponding code to delete these images
     if (VK_SUCCESS == result) {
         if ((*pSwapchainImageCount > 0) && pSwapchainImages) {
-            std::vector<VkUniqueObject*> uniqueImages = {};
-            for (uint32_t i=0; i<*pSwapchainImageCount; ++i) {
-                uniqueImages.push_back(new VkUniqueObject());
-                uniqueImages[i]->actualObject = (uint64_t)pSwapchainImages[i];
-                pSwapchainImages[i] = (VkImage)uniqueImages[i];
-            }
+            layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+            wrapUniqueObjects(my_data, *pSwapchainImageCount, pSwapchainImages);
         }
     }
     return result;
@@ -29,14 +29,78 @@
 #include <fstream>
 #include <string>
 #include <map>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <algorithm>
 #include <string.h>
+#include <stdlib.h>
 #include <vulkan/vk_layer.h>
 #include <iostream>
 #include "vk_layer_config.h"
 #include "vulkan/vk_sdk_platform.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #define MAX_CHARS_PER_LINE 4096
 
+/*
+ * Binary log ring file layout, see getLayerLogRing(). vk_layer_log_decode.py
+ * must be kept in sync with these structures.
+ *
+ *   LogRingHeader
+ *   LogRingRecord[recordCapacity]
+ *   char strings[stringCapacity]
+ *
+ * Writers reserve a record slot and a span of the string area with one atomic
+ * add each, so logging never takes a lock or makes a syscall. Both heads only
+ * grow; the position in the file is the head modulo the capacity. A record's
+ * sequence is stored last and equals its index + 1, which lets the decoder drop
+ * slots that were torn or have been overwritten.
+ */
+#define LOG_RING_MAGIC "VKLOGRNG"
+#define LOG_RING_VERSION 1
+#define LOG_RING_DEFAULT_RECORDS 65536
+#define LOG_RING_STRING_BYTES_PER_RECORD 128
+#define LOG_RING_MAX_MESSAGE 1024
+
+struct LogRingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t recordCapacity;
+    uint64_t stringCapacity;
+    std::atomic<uint64_t> recordHead;
+    std::atomic<uint64_t> stringHead;
+    uint64_t reserved[2];
+};
+
+struct LogRingRecord {
+    std::atomic<uint64_t> sequence;
+    uint64_t timestamp; // steady clock, in nanoseconds
+    uint64_t threadId;
+    uint64_t object;
+    uint64_t location;
+    uint64_t msgOffset; // absolute offset of the message in the string area
+    uint32_t msgLength;
+    int32_t msgCode;
+    uint32_t msgFlags;
+    uint32_t objectType;
+    char layerPrefix[16]; // NUL-terminated, longer prefixes are truncated
+};
+
+struct _layer_log_ring {
+    LogRingHeader *header;
+    LogRingRecord *records;
+    char *strings;
+};
+
 class ConfigFile
 {
 public:
@@ -121,6 +185,130 @@ FILE* getLayerLogOutput(const char *_option, const char *layerName)
     return log_output;
 }
 
+static void *mapLogRingFile(const char *filename, size_t size)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32),
+                                        (DWORD)(size & 0xffffffff), NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+        return NULL;
+    void *base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    CloseHandle(mapping);
+    return base;
+#else
+    int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return NULL;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return NULL;
+    }
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return (base == MAP_FAILED) ? NULL : base;
+#endif
+}
+
+// Map _option as a binary log ring file. The file is sized once from the
+// <layerName>.log_ring_records setting and never grows; old records are
+// overwritten. Layers naming the same file share one ring. Returns NULL if
+// the file can't be mapped, so the caller can fall back to a text log.
+layer_log_ring *getLayerLogRing(const char *_option, const char *layerName)
+{
+    static std::mutex ringsLock;
+    static std::map<std::string, layer_log_ring *> rings;
+
+    std::lock_guard<std::mutex> lock(ringsLock);
+    auto it = rings.find(_option);
+    if (it != rings.end())
+        return it->second;
+
+    uint64_t recordCapacity = LOG_RING_DEFAULT_RECORDS;
+    const char *records_str = g_configFileObj.getOption(std::string(layerName) + ".log_ring_records");
+    if (records_str && strtoull(records_str, NULL, 0) > 0)
+        recordCapacity = strtoull(records_str, NULL, 0);
+    uint64_t stringCapacity = std::max<uint64_t>(recordCapacity * LOG_RING_STRING_BYTES_PER_RECORD, LOG_RING_MAX_MESSAGE);
+    size_t size = (size_t)(sizeof(LogRingHeader) + recordCapacity * sizeof(LogRingRecord) + stringCapacity);
+
+    char *base = (char *)mapLogRingFile(_option, size);
+    if (base == NULL) {
+        std::cout << std::endl << layerName << " ERROR: Unable to map log ring file: " << _option << ". Writing text log instead" << std::endl << std::endl;
+        return NULL;
+    }
+
+    layer_log_ring *ring = new layer_log_ring;
+    ring->header = (LogRingHeader *)base;
+    ring->records = (LogRingRecord *)(base + sizeof(LogRingHeader));
+    ring->strings = base + sizeof(LogRingHeader) + recordCapacity * sizeof(LogRingRecord);
+
+    memcpy(ring->header->magic, LOG_RING_MAGIC, sizeof(ring->header->magic));
+    ring->header->version = LOG_RING_VERSION;
+    ring->header->recordSize = sizeof(LogRingRecord);
+    ring->header->recordCapacity = recordCapacity;
+    ring->header->stringCapacity = stringCapacity;
+    ring->header->recordHead.store(0);
+    ring->header->stringHead.store(0);
+
+    rings[_option] = ring;
+    return ring;
+}
+
+// Open the log output configured for layerName: the binary ring named by
+//  <layerName>.log_ring_filename if that is set and can be mapped, else the
+//  text file named by <layerName>.log_filename. Exactly one of *log and *ring
+//  is non-NULL on return.
+void getLayerLogSink(const char *layerName, FILE **log, layer_log_ring **ring)
+{
+    std::string prefix(layerName);
+    const char *ringFilename = g_configFileObj.getOption(prefix + ".log_ring_filename");
+    *ring = ringFilename ? getLayerLogRing(ringFilename, layerName) : NULL;
+    *log = *ring ? NULL : getLayerLogOutput(g_configFileObj.getOption(prefix + ".log_filename"), layerName);
+}
+
+void layerLogRingWrite(layer_log_ring *ring, VkFlags msgFlags, VkDebugReportObjectTypeEXT objType, uint64_t srcObject,
+                       size_t location, int32_t msgCode, const char *pLayerPrefix, const char *pMsg)
+{
+    LogRingHeader *header = ring->header;
+    uint32_t length = 0;
+    while (length < LOG_RING_MAX_MESSAGE && pMsg[length])
+        length++;
+
+    uint64_t index = header->recordHead.fetch_add(1, std::memory_order_relaxed);
+    uint64_t offset = header->stringHead.fetch_add(length, std::memory_order_relaxed);
+    LogRingRecord *record = &ring->records[index % header->recordCapacity];
+
+    // Invalidate the slot while it is being rewritten
+    record->sequence.store(0, std::memory_order_relaxed);
+    record->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch()).count();
+#ifdef _WIN32
+    record->threadId = GetCurrentThreadId();
+#else
+    record->threadId = (uint64_t)pthread_self();
+#endif
+    record->object = srcObject;
+    record->location = location;
+    record->msgOffset = offset;
+    record->msgLength = length;
+    record->msgCode = msgCode;
+    record->msgFlags = msgFlags;
+    record->objectType = objType;
+    strncpy(record->layerPrefix, pLayerPrefix, sizeof(record->layerPrefix) - 1);
+    record->layerPrefix[sizeof(record->layerPrefix) - 1] = '\0';
+
+    uint64_t start = offset % header->stringCapacity;
+    uint64_t first = std::min<uint64_t>(length, header->stringCapacity - start);
+    memcpy(ring->strings + start, pMsg, (size_t)first);
+    memcpy(ring->strings, pMsg + first, (size_t)(length - first));
+
+    record->sequence.store(index + 1, std::memory_order_release);
+}
+
 VkDebugReportFlagsEXT getLayerOptionFlags(const char *_option, uint32_t optionDefault)
 {
     VkDebugReportFlagsEXT flags = optionDefault;
@@ -171,6 +359,40 @@ bool getLayerOptionEnum(const char *_option, uint32_t *optionDefault)
     return res;
 }
 
+// Parse a comma-separated list of enum names, such as message codes, and set
+// pFlags[value] for each name found in pEnums. pFlags must be large enough to
+// be indexed by every value in pEnums.
+void getLayerOptionEnumList(const char *_option, const layer_option_enum *pEnums, uint32_t enumCount, bool *pFlags)
+{
+    const char *option = (g_configFileObj.getOption(_option));
+
+    while (option) {
+        while (*option == ' ')
+            option++;
+        const char *p = strchr(option, ',');
+        size_t len = p ? (size_t)(p - option) : strlen(option);
+        while (len > 0 && option[len - 1] == ' ')
+            len--;
+
+        if (len > 0) {
+            uint32_t i;
+            for (i = 0; i < enumCount; i++) {
+                if (strlen(pEnums[i].name) == len && strncmp(option, pEnums[i].name, len) == 0) {
+                    pFlags[pEnums[i].value] = true;
+                    break;
+                }
+            }
+            if (i == enumCount)
+                std::cout << _option << " WARNING: Ignoring unknown or unsupported value: " << std::string(option, len) << std::endl;
+        }
+
+        if (!p)
+            break;
+
+        option = p + 1;
+    }
+}
+
 void setLayerOptionEnum(const char *_option, const char *_valEnum)
 {
     unsigned int val = convertStringEnumVal(_valEnum);
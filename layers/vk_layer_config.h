@@ -30,10 +30,24 @@
 extern "C" {
 #endif
 
+// Opaque handle to a memory-mapped binary log ring, see getLayerLogRing()
+typedef struct _layer_log_ring layer_log_ring;
+
+// Name of a layer error enum value, for settings that list message codes
+typedef struct _layer_option_enum {
+    const char *name;
+    uint32_t value;
+} layer_option_enum;
+
 const char *getLayerOption(const char *_option);
 FILE* getLayerLogOutput(const char *_option, const char *layerName);
+layer_log_ring *getLayerLogRing(const char *_option, const char *layerName);
+void getLayerLogSink(const char *layerName, FILE **log, layer_log_ring **ring);
+void layerLogRingWrite(layer_log_ring *ring, VkFlags msgFlags, VkDebugReportObjectTypeEXT objType, uint64_t srcObject,
+                       size_t location, int32_t msgCode, const char *pLayerPrefix, const char *pMsg);
 VkDebugReportFlagsEXT getLayerOptionFlags(const char *_option, uint32_t optionDefault);
 bool getLayerOptionEnum(const char *_option, uint32_t *optionDefault);
+void getLayerOptionEnumList(const char *_option, const layer_option_enum *pEnums, uint32_t enumCount, bool *pFlags);
 
 void setLayerOption(const char *_option, const char *_val);
 void setLayerOptionEnum(const char *_option, const char *_valEnum);
@@ -33,6 +33,8 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <unordered_map>
+#include <string>
+#include <vector>
 #include <inttypes.h>
 #include "vk_loader_platform.h"
 #include "vulkan/vk_layer.h"
@@ -49,6 +51,26 @@ template debug_report_data *get_my_data_ptr<debug_report_data>(
         void *data_key,
         std::unordered_map<void *, debug_report_data *> &data_map);
 
+// A message recorded instead of delivered, see debug_report_capture
+typedef struct _debug_report_msg {
+    VkFlags                     msgFlags;
+    VkDebugReportObjectTypeEXT  objectType;
+    uint64_t                    srcObject;
+    size_t                      location;
+    int32_t                     msgCode;
+    const char*                 pLayerPrefix;
+    std::string                 msg;
+} debug_report_msg;
+
+// When set, messages reported on this thread are appended here instead of going to the
+//  callbacks. A layer validating on worker threads uses this to deliver their messages
+//  afterwards, in a deterministic order, with debug_report_replay_msgs().
+static THREAD_LOCAL_DECL std::vector<debug_report_msg> *debug_report_capture = NULL;
+
+// Number of messages raised through log_msg() on this thread, whether or not a callback
+//  was listening. Compare it around a check to learn whether the check found anything.
+static THREAD_LOCAL_DECL uint32_t log_msg_count = 0;
+
 // Utility function to handle reporting
 static inline VkBool32 debug_report_log_msg(
     debug_report_data          *debug_data,
@@ -60,6 +82,12 @@ static inline VkBool32 debug_report_log_msg(
     const char*                 pLayerPrefix,
     const char*                 pMsg)
 {
+    if (debug_report_capture) {
+        debug_report_msg msg = { msgFlags, objectType, srcObject, location, msgCode, pLayerPrefix, pMsg };
+        debug_report_capture->push_back(msg);
+        return false;
+    }
+
     VkBool32 bail = false;
     VkLayerDbgFunctionNode *pTrav = debug_data->g_pDbgFunctionHead;
     while (pTrav) {
@@ -80,6 +108,21 @@ static inline VkBool32 debug_report_log_msg(
     return bail;
 }
 
+// Deliver messages captured through debug_report_capture
+static inline VkBool32 debug_report_replay_msgs(
+    debug_report_data                    *debug_data,
+    const std::vector<debug_report_msg>  &msgs)
+{
+    VkBool32 bail = false;
+    for (auto &msg : msgs) {
+        if (debug_report_log_msg(debug_data, msg.msgFlags, msg.objectType, msg.srcObject,
+                                 msg.location, msg.msgCode, msg.pLayerPrefix, msg.msg.c_str())) {
+            bail = true;
+        }
+    }
+    return bail;
+}
+
 static inline debug_report_data *debug_report_create_instance(
         VkLayerInstanceDispatchTable   *table,
         VkInstance                      inst,
@@ -284,6 +327,7 @@ static inline VkBool32 log_msg(
     const char*                 format,
     ...)
 {
+    log_msg_count++;
     if (!debug_data || !(debug_data->active_flags & msgFlags)) {
         /* message is not wanted */
         return false;
@@ -321,6 +365,26 @@ static inline VKAPI_ATTR VkBool32 VKAPI_CALL log_callback(
     return false;
 }
 
+/*
+ * Append a fixed-size record to the memory-mapped ring passed as pUserData.
+ * Unlike log_callback this does no formatting and no I/O, so it is cheap
+ * enough to leave on in production. Decode with vk_layer_log_decode.py.
+ */
+static inline VKAPI_ATTR VkBool32 VKAPI_CALL log_ring_callback(
+    VkFlags                             msgFlags,
+    VkDebugReportObjectTypeEXT          objType,
+    uint64_t                            srcObject,
+    size_t                              location,
+    int32_t                             msgCode,
+    const char*                         pLayerPrefix,
+    const char*                         pMsg,
+    void*                               pUserData)
+{
+    layerLogRingWrite((layer_log_ring *) pUserData, msgFlags, objType, srcObject, location, msgCode, pLayerPrefix, pMsg);
+
+    return false;
+}
+
 static inline VKAPI_ATTR VkBool32 VKAPI_CALL win32_debug_output_msg(
     VkFlags                             msgFlags,
     VkDebugReportObjectTypeEXT          objType,
@@ -0,0 +1,100 @@
+/* Copyright (c) 2015-2016 The Khronos Group Inc.
+ * Copyright (c) 2015-2016 Valve Corporation
+ * Copyright (c) 2015-2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and/or associated documentation files (the "Materials"), to
+ * deal in the Materials without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Materials, and to permit persons to whom the Materials
+ * are furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice(s) and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+ * USE OR OTHER DEALINGS IN THE MATERIALS
+ */
+
+#ifndef LAYER_RWLOCK_H
+#define LAYER_RWLOCK_H
+
+#include <stdint.h>
+#include "vk_loader_platform.h"
+
+// Reader/writer lock for layer state that is read far more often than it is written.
+//  The loader itself has no use for one, and pthread_rwlock_t is not declared for the
+//  loader's plain C99 build, so it lives here rather than in vk_loader_platform.h.
+#if defined(__linux__)
+typedef pthread_rwlock_t loader_platform_thread_rwlock;
+static inline void
+loader_platform_thread_create_rwlock(loader_platform_thread_rwlock *pLock) {
+    pthread_rwlock_init(pLock, NULL);
+}
+static inline void
+loader_platform_thread_read_lock_rwlock(loader_platform_thread_rwlock *pLock) {
+    pthread_rwlock_rdlock(pLock);
+}
+static inline void
+loader_platform_thread_read_unlock_rwlock(
+    loader_platform_thread_rwlock *pLock) {
+    pthread_rwlock_unlock(pLock);
+}
+static inline void
+loader_platform_thread_write_lock_rwlock(loader_platform_thread_rwlock *pLock) {
+    pthread_rwlock_wrlock(pLock);
+}
+static inline void
+loader_platform_thread_write_unlock_rwlock(
+    loader_platform_thread_rwlock *pLock) {
+    pthread_rwlock_unlock(pLock);
+}
+static inline void
+loader_platform_thread_delete_rwlock(loader_platform_thread_rwlock *pLock) {
+    pthread_rwlock_destroy(pLock);
+}
+#elif defined(_WIN32)
+typedef SRWLOCK loader_platform_thread_rwlock;
+static inline void
+loader_platform_thread_create_rwlock(loader_platform_thread_rwlock *pLock) {
+    InitializeSRWLock(pLock);
+}
+static inline void
+loader_platform_thread_read_lock_rwlock(loader_platform_thread_rwlock *pLock) {
+    AcquireSRWLockShared(pLock);
+}
+static inline void
+loader_platform_thread_read_unlock_rwlock(
+    loader_platform_thread_rwlock *pLock) {
+    ReleaseSRWLockShared(pLock);
+}
+static inline void
+loader_platform_thread_write_lock_rwlock(loader_platform_thread_rwlock *pLock) {
+    AcquireSRWLockExclusive(pLock);
+}
+static inline void
+loader_platform_thread_write_unlock_rwlock(
+    loader_platform_thread_rwlock *pLock) {
+    ReleaseSRWLockExclusive(pLock);
+}
+static inline void
+loader_platform_thread_delete_rwlock(loader_platform_thread_rwlock *pLock) {
+    // SRW locks hold no resources
+    (void)pLock;
+}
+#endif
+
+// Index of the lock shard, out of 1 << shardBits, that guards the object behind handle.
+//  Handles are usually aligned pointers whose low bits are all zero, so the handle is
+//  mixed with a Fibonacci hash and the shard taken from the top bits.
+static inline uint32_t layer_lock_shard(uint64_t handle, uint32_t shardBits) {
+    return (uint32_t)(((handle >> 4) * 0x9E3779B97F4A7C15ULL) >> (64 - shardBits));
+}
+
+#endif // LAYER_RWLOCK_H
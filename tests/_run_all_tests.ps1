@@ -12,5 +12,6 @@ Set-Item -path env:Path -value ($env:Path + ";..\loader\$dPath")
 Set-Item -path env:Path -value ($env:Path + ";gtest-1.7.0\$dPath")
 $env:VK_LAYER_PATH = "..\layers\$dPath"
 
+& $dPath\vk_layer_data_structure_tests
 & $dPath\vk_layer_validation_tests
 .\vkvalidatelayerdoc.ps1
@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2015-2016 The Khronos Group Inc.
+ * Copyright (c) 2015-2016 Valve Corporation
+ * Copyright (c) 2015-2016 LunarG, Inc.
+ * Copyright (c) 2015-2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and/or associated documentation files (the "Materials"), to
+ * deal in the Materials without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Materials, and to permit persons to whom the Materials are
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice(s) and this permission notice shall be included in
+ * all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+ * USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+// Tests of the containers the layers keep their state in. They use the layer headers
+//  directly and need no Vulkan driver.
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+#include "gtest/gtest.h"
+#include "draw_state.h"
+#include "mem_tracker.h"
+#include "object_tracker_table.h"
+
+// flat_set must stay strictly ordered under its comparator with no duplicates, whatever
+//  order the values arrive and leave in
+template <typename Compare>
+static void checkFlatSetOrdered(const flat_set<uint32_t, Compare> &set) {
+    auto outOfOrder = std::adjacent_find(set.begin(), set.end(),
+                                         [](uint32_t a, uint32_t b) { return !Compare()(a, b); });
+    ASSERT_TRUE(outOfOrder == set.end());
+}
+
+TEST(FlatSet, StaysSortedAndUniqueUnderRandomInsertErase) {
+    std::mt19937 rng(32);
+    flat_set<uint32_t> set;
+    std::set<uint32_t> model;
+    for (int i = 0; i < 50000; i++) {
+        uint32_t value = rng() % 128;
+        if (rng() % 200 == 0) {
+            set.clear();
+            model.clear();
+        } else if (rng() % 2) {
+            set.insert(value);
+            model.insert(value);
+        } else {
+            set.erase(value);
+            model.erase(value);
+        }
+        ASSERT_EQ(model.count(value), set.count(value));
+        ASSERT_EQ(model.size(), set.size());
+        checkFlatSetOrdered(set);
+        if (HasFatalFailure())
+            return;
+    }
+    ASSERT_TRUE(std::equal(set.begin(), set.end(), model.begin()));
+}
+
+TEST(FlatSet, HonorsComparator) {
+    flat_set<uint32_t, std::greater<uint32_t> > set;
+    const uint32_t values[] = {5, 1, 9, 5, 3, 9, 7};
+    for (auto value : values)
+        set.insert(value);
+    ASSERT_EQ(5u, set.size());
+    checkFlatSetOrdered(set);
+    ASSERT_EQ(9u, *set.begin());
+    set.erase(9);
+    set.erase(4);
+    ASSERT_EQ(4u, set.size());
+    ASSERT_EQ(7u, *set.begin());
+    ASSERT_EQ(0u, set.count(9));
+}
+
+// Expected layer values of each (aspectMask, mipLevel) of a subresource_range_map<int>;
+//  0 stands for a layer no run covers
+typedef std::map<std::pair<VkImageAspectFlags, uint32_t>, std::vector<int> > SubresourceLayers;
+
+// Runs of a level must be non-empty, sorted, disjoint and maximal (touching runs of equal
+//  value merged), and must cover exactly the layers the model says they do
+static void checkSubresourceRuns(const subresource_range_map<int> &map, SubresourceLayers &expected,
+                                 uint32_t layerCount) {
+    for (auto &level : map.levels) {
+        std::vector<int> &layers = expected[std::make_pair(level.aspectMask, level.mipLevel)];
+        layers.resize(layerCount);
+        std::vector<int> covered(layerCount, 0);
+        for (size_t i = 0; i < level.runs.size(); i++) {
+            auto &run = level.runs[i];
+            ASSERT_LT(run.begin, run.end);
+            ASSERT_LE(run.end, layerCount);
+            if (i + 1 < level.runs.size()) {
+                auto &next = level.runs[i + 1];
+                ASSERT_LE(run.end, next.begin);
+                ASSERT_FALSE(run.end == next.begin && run.value == next.value);
+            }
+            for (uint32_t layer = run.begin; layer < run.end; layer++)
+                covered[layer] = run.value;
+        }
+        ASSERT_EQ(layers, covered);
+    }
+}
+
+TEST(SubresourceRangeMap, RunsStayMaximalUnderRandomSetsAndUpdates) {
+    const uint32_t layerCount = 64;
+    const VkImageAspectFlags aspects[] = {VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_ASPECT_DEPTH_BIT};
+    std::mt19937 rng(34);
+    subresource_range_map<int> map;
+    SubresourceLayers expected;
+    for (int i = 0; i < 20000; i++) {
+        VkImageAspectFlags aspectMask = aspects[rng() % 2];
+        uint32_t mipLevel = rng() % 4;
+        uint32_t begin = rng() % layerCount;
+        uint32_t end = begin + 1 + rng() % std::min(layerCount - begin, 16u);
+        std::vector<int> &layers = expected[std::make_pair(aspectMask, mipLevel)];
+        layers.resize(layerCount);
+        if (rng() % 2) {
+            // Few distinct values, so neighbouring runs often need merging
+            int value = 1 + rng() % 3;
+            map.set(aspectMask, mipLevel, begin, end, value);
+            std::fill(layers.begin() + begin, layers.begin() + end, value);
+        } else {
+            bool store = (rng() % 4) != 0;
+            map.update(aspectMask, mipLevel, begin, end, [&](bool found, int &value) {
+                EXPECT_EQ(found, value != 0);
+                value = found ? (value % 5) + 1 : 7;
+                return store;
+            });
+            if (store) {
+                for (uint32_t layer = begin; layer < end; layer++)
+                    layers[layer] = layers[layer] ? (layers[layer] % 5) + 1 : 7;
+            }
+        }
+        checkSubresourceRuns(map, expected, layerCount);
+        if (HasFatalFailure())
+            return;
+    }
+}
+
+TEST(SubresourceRangeMap, UpdateSplitsAtRunBoundaries) {
+    subresource_range_map<int> map;
+    map.set(VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 4, 1);
+    map.set(VK_IMAGE_ASPECT_COLOR_BIT, 0, 8, 12, 2);
+    // [2, 10) is the tail of the first run, the gap between the runs, then the head of the second
+    std::vector<std::pair<bool, int> > pieces;
+    map.update(VK_IMAGE_ASPECT_COLOR_BIT, 0, 2, 10, [&](bool found, int &value) {
+        pieces.push_back(std::make_pair(found, value));
+        value = 1;
+        return true;
+    });
+    ASSERT_EQ(3u, pieces.size());
+    ASSERT_EQ(std::make_pair(true, 1), pieces[0]);
+    ASSERT_EQ(std::make_pair(false, 0), pieces[1]);
+    ASSERT_EQ(std::make_pair(true, 2), pieces[2]);
+    // Everything up to layer 10 now holds 1 and collapses into one run
+    auto &runs = map.levels[0].runs;
+    ASSERT_EQ(2u, runs.size());
+    ASSERT_EQ(0u, runs[0].begin);
+    ASSERT_EQ(10u, runs[0].end);
+    ASSERT_EQ(1, runs[0].value);
+    ASSERT_EQ(10u, runs[1].begin);
+    ASSERT_EQ(2, runs[1].value);
+}
+
+// A set's nodes as handed out by the arena, stamped so that another set handed the same
+//  memory would show up as a changed stamp
+struct ArenaAllocation {
+    DESCRIPTOR_NODE *pNodes;
+    uint32_t count;
+    uint32_t tag;
+};
+
+TEST(DescriptorArena, LiveAllocationsAreZeroedAndNeverOverlap) {
+    std::mt19937 rng(36);
+    descriptor_arena arena;
+    std::vector<ArenaAllocation> live;
+    uint32_t nextTag = 1;
+    for (int i = 0; i < 20000; i++) {
+        uint32_t op = rng() % 200;
+        if (op == 0) {
+            arena.reset();
+            live.clear();
+        } else if (op < 80 && !live.empty()) {
+            size_t victim = rng() % live.size();
+            arena.release(live[victim].pNodes, live[victim].count);
+            live[victim] = live.back();
+            live.pop_back();
+        } else {
+            // Mostly small sets, now and then one bigger than a whole chunk
+            uint32_t count = (op == 199) ? 1500 : 1 + rng() % 8;
+            ArenaAllocation allocation = {arena.allocate(count), count, nextTag++};
+            for (uint32_t j = 0; j < count; j++) {
+                ASSERT_EQ(VK_FALSE, allocation.pNodes[j].updated);
+                allocation.pNodes[j].updated = allocation.tag;
+                allocation.pNodes[j].type = (VkDescriptorType)j;
+            }
+            live.push_back(allocation);
+        }
+        if (i % 100 == 0) {
+            for (auto &allocation : live) {
+                for (uint32_t j = 0; j < allocation.count; j++) {
+                    ASSERT_EQ(allocation.tag, allocation.pNodes[j].updated);
+                    ASSERT_EQ((VkDescriptorType)j, allocation.pNodes[j].type);
+                }
+            }
+        }
+    }
+}
+
+TEST(DescriptorArena, ReusesReleasedAndResetStorage) {
+    descriptor_arena arena;
+    DESCRIPTOR_NODE *pFirst = arena.allocate(4);
+    DESCRIPTOR_NODE *pSecond = arena.allocate(4);
+    ASSERT_NE(pFirst, pSecond);
+    arena.release(pSecond, 4);
+    ASSERT_EQ(pSecond, arena.allocate(4));
+    arena.reset();
+    ASSERT_EQ(pFirst, arena.allocate(4));
+    ASSERT_EQ(pSecond, arena.allocate(4));
+}
+
+// memory_range_tree visits overlapping ranges in (start, handle) order, with both ends
+//  of a range and of the query inclusive
+TEST(MemoryRangeTree, OverlapQueriesMatchBruteForceInOrder) {
+    std::mt19937 rng(38);
+    memory_range_tree tree;
+    std::vector<MEMORY_RANGE> ranges;
+    uint64_t nextHandle = 1;
+    for (int i = 0; i < 20000; i++) {
+        uint32_t op = rng() % 10;
+        if (op < 4 || ranges.empty()) {
+            MEMORY_RANGE range = {};
+            range.handle = nextHandle++;
+            // Starts collide often, so ranges that only differ by handle are common
+            range.start = rng() % 1024;
+            range.end = range.start + rng() % 256;
+            tree.insert(range);
+            ranges.push_back(range);
+        } else if (op < 7) {
+            size_t victim = rng() % ranges.size();
+            tree.erase(ranges[victim].start, ranges[victim].handle);
+            ranges[victim] = ranges.back();
+            ranges.pop_back();
+        } else if (op < 8) {
+            // Neither the start nor the handle alone identifies a range, so these do nothing
+            tree.erase(ranges[0].start + 1, ranges[0].handle);
+            tree.erase(ranges[0].start, nextHandle);
+        } else {
+            VkDeviceSize start = rng() % 1400;
+            VkDeviceSize end = start + rng() % 300;
+            std::vector<std::pair<VkDeviceSize, uint64_t> > found;
+            tree.for_each_overlap(start, end, [&](const MEMORY_RANGE &range) {
+                found.push_back(std::make_pair(range.start, range.handle));
+            });
+            ASSERT_TRUE(std::is_sorted(found.begin(), found.end()));
+            std::vector<std::pair<VkDeviceSize, uint64_t> > expected;
+            for (auto &range : ranges) {
+                if (range.start <= end && range.end >= start)
+                    expected.push_back(std::make_pair(range.start, range.handle));
+            }
+            std::sort(expected.begin(), expected.end());
+            ASSERT_EQ(expected, found);
+        }
+    }
+}
+
+TEST(MemoryRangeTree, BoundsAreInclusive) {
+    memory_range_tree tree;
+    MEMORY_RANGE range = {};
+    range.handle = 1;
+    range.start = 10;
+    range.end = 20;
+    tree.insert(range);
+    size_t hits = 0;
+    auto count = [&](const MEMORY_RANGE &) { hits++; };
+    tree.for_each_overlap(20, 30, count);
+    tree.for_each_overlap(0, 10, count);
+    ASSERT_EQ(2u, hits);
+    tree.for_each_overlap(21, 30, count);
+    tree.for_each_overlap(0, 9, count);
+    ASSERT_EQ(2u, hits);
+    tree.erase(10, 1);
+    tree.for_each_overlap(0, 100, count);
+    ASSERT_EQ(2u, hits);
+}
+
+// ref_set erases by moving its last element into the hole, so after any sequence of
+//  operations each element must appear in the dense array exactly once
+TEST(RefSet, DenseArrayHoldsEachElementOnce) {
+    std::mt19937 rng(40);
+    ref_set<uint64_t> set;
+    std::set<uint64_t> model;
+    for (int i = 0; i < 50000; i++) {
+        uint64_t value = (rng() % 256) << 6;
+        if (rng() % 500 == 0) {
+            set.clear();
+            model.clear();
+        } else if (rng() % 2) {
+            ASSERT_EQ(model.insert(value).second, set.insert(value));
+        } else {
+            ASSERT_EQ(model.erase(value) != 0, set.erase(value));
+        }
+        ASSERT_EQ(model.count(value), set.count(value));
+        ASSERT_EQ(model.size(), set.size());
+        if (i % 500 == 0) {
+            std::vector<uint64_t> elements(set.begin(), set.end());
+            std::sort(elements.begin(), elements.end());
+            ASSERT_TRUE(std::adjacent_find(elements.begin(), elements.end()) == elements.end());
+            ASSERT_TRUE(std::equal(elements.begin(), elements.end(), model.begin()));
+        }
+    }
+}
+
+TEST(RefSet, EraseMovesLastElementIntoHole) {
+    ref_set<uint32_t> set;
+    ASSERT_TRUE(set.insert(1));
+    ASSERT_TRUE(set.insert(2));
+    ASSERT_TRUE(set.insert(3));
+    ASSERT_FALSE(set.insert(2));
+    ASSERT_TRUE(set.erase(1));
+    ASSERT_FALSE(set.erase(1));
+    std::vector<uint32_t> elements(set.begin(), set.end());
+    ASSERT_EQ((std::vector<uint32_t>{3, 2}), elements);
+    // The moved element's index entry must follow it, or this erase would hit the wrong slot
+    ASSERT_TRUE(set.erase(3));
+    ASSERT_EQ(1u, set.size());
+    ASSERT_EQ(2u, *set.begin());
+}
+
+// objtrack_table moves nodes when it grows or backward-shifts a probe run on erase, so
+//  each node carries a status derived from its handle to show it moved intact, and
+//  descriptor sets stay linked into their pool's child list throughout
+TEST(ObjtrackTable, NodesAndChildListsSurviveRandomChurn) {
+    const uint64_t pools[] = {0x1000, 0x2000, 0x3000};
+    std::mt19937 rng(50);
+    objtrack_table poolMap, setMap;
+    std::map<uint64_t, uint64_t> parentOf;
+    for (auto pool : pools)
+        poolMap.insert(pool);
+    for (int i = 0; i < 200000; i++) {
+        // Drivers hand out aligned addresses, so keep the low bits clear as they would be
+        uint64_t handle = (1 + rng() % 5000) * 64;
+        if (rng() % 3) {
+            if (!parentOf.count(handle)) {
+                OBJTRACK_NODE *pNode = setMap.insert(handle);
+                ASSERT_EQ(handle, pNode->vkObj);
+                ASSERT_EQ(0u, pNode->status);
+                pNode->status = (ObjectStatusFlags)(handle >> 6);
+                uint64_t pool = pools[rng() % 3];
+                linkChildNode(poolMap, setMap, pNode, pool);
+                parentOf[handle] = pool;
+            } else {
+                // Inserting a tracked handle hands back the existing node
+                ASSERT_EQ((ObjectStatusFlags)(handle >> 6), setMap.insert(handle)->status);
+            }
+        } else if (parentOf.count(handle)) {
+            OBJTRACK_NODE *pNode = setMap.find(handle);
+            ASSERT_TRUE(pNode != NULL);
+            ASSERT_EQ(parentOf[handle], pNode->parentObj);
+            unlinkChildNode(poolMap, setMap, pNode);
+            setMap.erase(pNode);
+            parentOf.erase(handle);
+        }
+        OBJTRACK_NODE *pNode = setMap.find(handle);
+        ASSERT_EQ(parentOf.count(handle) != 0, pNode != NULL);
+        if (pNode) {
+            ASSERT_EQ((ObjectStatusFlags)(handle >> 6), pNode->status);
+        }
+        ASSERT_EQ(parentOf.size(), setMap.size());
+    }
+    // Tear each pool down through its child list the way vkDestroyDescriptorPool does
+    for (auto pool : pools) {
+        size_t expected = 0;
+        for (auto &entry : parentOf)
+            expected += (entry.second == pool);
+        size_t freed = 0;
+        OBJTRACK_NODE *pPool = poolMap.find(pool);
+        while (pPool->firstChild) {
+            OBJTRACK_NODE *pNode = setMap.find(pPool->firstChild);
+            ASSERT_TRUE(pNode != NULL);
+            ASSERT_EQ(pool, pNode->parentObj);
+            unlinkChildNode(poolMap, setMap, pNode);
+            setMap.erase(pNode);
+            freed++;
+        }
+        ASSERT_EQ(expected, freed);
+    }
+    ASSERT_EQ(0u, setMap.size());
+    ASSERT_TRUE(setMap.first() == NULL);
+}
+
+TEST(ObjtrackTable, WalkVisitsEveryNodeOnceAcrossGrowth) {
+    objtrack_table table;
+    for (uint64_t handle = 64; handle <= 64 * 10000; handle += 64)
+        table.insert(handle);
+    ASSERT_EQ(10000u, table.size());
+    std::set<uint64_t> walked;
+    for (OBJTRACK_NODE *pNode = table.first(); pNode; pNode = table.next(pNode))
+        ASSERT_TRUE(walked.insert(pNode->vkObj).second);
+    ASSERT_EQ(10000u, walked.size());
+    ASSERT_TRUE(table.find(0) == NULL);
+    ASSERT_TRUE(table.find(64 * 10001) == NULL);
+    table.clear();
+    ASSERT_EQ(0u, table.size());
+    ASSERT_TRUE(table.find(64) == NULL);
+}
@@ -9,6 +9,10 @@ set -e
 # Verify that validation checks in source match documentation
 ./vkvalidatelayerdoc.sh
 
+# vk_layer_data_structure_tests check the layers' internal containers against
+# std containers; they do not need a Vulkan driver
+./vk_layer_data_structure_tests
+
 # vk_layer_validation_tests check to see that validation layers will
 # catch the errors that they are supposed to by intentionally doing things
 # that are wrong
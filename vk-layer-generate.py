@@ -347,7 +347,7 @@ class Subcommand(object):
         r_body.append('VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDebugReportMessageEXT(VkInstance instance, VkDebugReportFlagsEXT    flags, VkDebugReportObjectTypeEXT objType, uint64_t object, size_t location, int32_t msgCode, const char *pLayerPrefix, const char *pMsg)')
         r_body.append('{')
         # Switch to this code section for the new per-instance storage and debug callbacks
-        if self.layer_name == 'object_tracker' or self.layer_name == 'threading':
+        if self.layer_name in ['object_tracker', 'threading', 'unique_objects']:
             r_body.append('    VkLayerInstanceDispatchTable *pInstanceTable = get_dispatch_table(%s_instance_table_map, instance);' % self.layer_name )
         else:
             r_body.append('    VkLayerInstanceDispatchTable *pInstanceTable = instance_dispatch_table(instance);')
@@ -361,7 +361,7 @@ class Subcommand(object):
         ggep_body.append('%s' % self.lineinfo.get())
 
         ggep_body.append('')
-        if self.layer_name == 'object_tracker' or self.layer_name == 'threading':
+        if self.layer_name in ['object_tracker', 'threading', 'unique_objects']:
             ggep_body.append('static const VkExtensionProperties instance_extensions[] = {')
             ggep_body.append('    {')
             ggep_body.append('        VK_EXT_DEBUG_REPORT_EXTENSION_NAME,')
@@ -370,7 +370,7 @@ class Subcommand(object):
             ggep_body.append('};')
         ggep_body.append('VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceExtensionProperties(const char *pLayerName, uint32_t *pCount,  VkExtensionProperties* pProperties)')
         ggep_body.append('{')
-        if self.layer_name == 'object_tracker' or self.layer_name == 'threading':
+        if self.layer_name in ['object_tracker', 'threading', 'unique_objects']:
           ggep_body.append('    return util_GetExtensionProperties(1, instance_extensions, pCount, pProperties);')
         else:
           ggep_body.append('    return util_GetExtensionProperties(0, NULL, pCount, pProperties);')
@@ -780,6 +780,10 @@ class Subcommand(object):
         return "\n".join(func_body)
 
 class ObjectTrackerSubcommand(Subcommand):
+    # Objects freed along with their parent, which object_tracker.h links into the parent's node
+    child_parent_types = {'VkCommandBuffer' : 'VkCommandPool',
+                          'VkDescriptorSet' : 'VkDescriptorPool'}
+
     def generate_header(self):
         header_txt = []
         header_txt.append('%s' % self.lineinfo.get())
@@ -807,7 +811,7 @@ class ObjectTrackerSubcommand(Subcommand):
     def generate_maps(self):
         maps_txt = []
         for o in vulkan.object_type_list:
-            maps_txt.append('unordered_map<uint64_t, OBJTRACK_NODE*> %sMap;' % (o))
+            maps_txt.append('objtrack_table %sMap;' % (o))
         return "\n".join(maps_txt)
 
     def _gather_object_uses(self, obj_list, struct_type, obj_set):
@@ -853,11 +857,9 @@ class ObjectTrackerSubcommand(Subcommand):
             procs_txt.append('        "OBJ[%llu] : CREATE %s object 0x%" PRIxLEAST64 , object_track_index++, string_VkDebugReportObjectTypeEXT(objType),')
             procs_txt.append('        (uint64_t)(vkObj));')
             procs_txt.append('')
-            procs_txt.append('    OBJTRACK_NODE* pNewObjNode = new OBJTRACK_NODE;')
+            procs_txt.append('    OBJTRACK_NODE* pNewObjNode = %sMap.insert((uint64_t)(vkObj));' % (o))
             procs_txt.append('    pNewObjNode->objType = objType;')
             procs_txt.append('    pNewObjNode->status  = OBJSTATUS_NONE;')
-            procs_txt.append('    pNewObjNode->vkObj  = (uint64_t)(vkObj);')
-            procs_txt.append('    %sMap[(uint64_t)vkObj] = pNewObjNode;' % (o))
             procs_txt.append('    uint32_t objIndex = objTypeToIndex(objType);')
             procs_txt.append('    numObjs[objIndex]++;')
             procs_txt.append('    numTotalObjs++;')
@@ -870,8 +872,8 @@ class ObjectTrackerSubcommand(Subcommand):
                 procs_txt.append('static void destroy_%s(VkDevice dispatchable_object, %s object)' % (name, o))
             procs_txt.append('{')
             procs_txt.append('    uint64_t object_handle = (uint64_t)(object);')
-            procs_txt.append('    if (%sMap.find(object_handle) != %sMap.end()) {' % (o, o))
-            procs_txt.append('        OBJTRACK_NODE* pNode = %sMap[(uint64_t)object];' % (o))
+            procs_txt.append('    OBJTRACK_NODE* pNode = %sMap.find(object_handle);' % (o))
+            procs_txt.append('    if (pNode) {')
             procs_txt.append('        uint32_t objIndex = objTypeToIndex(pNode->objType);')
             procs_txt.append('        assert(numTotalObjs > 0);')
             procs_txt.append('        numTotalObjs--;')
@@ -881,8 +883,9 @@ class ObjectTrackerSubcommand(Subcommand):
             procs_txt.append('           "OBJ_STAT Destroy %s obj 0x%" PRIxLEAST64 " (%" PRIu64 " total objs remain & %" PRIu64 " %s objs).",')
             procs_txt.append('            string_VkDebugReportObjectTypeEXT(pNode->objType), (uint64_t)(object), numTotalObjs, numObjs[objIndex],')
             procs_txt.append('            string_VkDebugReportObjectTypeEXT(pNode->objType));')
-            procs_txt.append('        delete pNode;')
-            procs_txt.append('        %sMap.erase(object_handle);' % (o))
+            if o in self.child_parent_types:
+                procs_txt.append('        unlinkChildNode(%sMap, %sMap, pNode);' % (self.child_parent_types[o], o))
+            procs_txt.append('        %sMap.erase(pNode);' % (o))
             procs_txt.append('    } else {')
             procs_txt.append('        log_msg(mdd(dispatchable_object), VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT ) 0, object_handle, __LINE__, OBJTRACK_NONE, "OBJTRACK",')
             procs_txt.append('            "Unable to remove obj 0x%" PRIxLEAST64 ". Was it created? Has it already been destroyed?",')
@@ -898,8 +901,8 @@ class ObjectTrackerSubcommand(Subcommand):
             procs_txt.append('{')
             procs_txt.append('    if (object != VK_NULL_HANDLE) {')
             procs_txt.append('        uint64_t object_handle = (uint64_t)(object);')
-            procs_txt.append('        if (%sMap.find(object_handle) != %sMap.end()) {' % (o, o))
-            procs_txt.append('            OBJTRACK_NODE* pNode = %sMap[object_handle];' % (o))
+            procs_txt.append('        OBJTRACK_NODE* pNode = %sMap.find(object_handle);' % (o))
+            procs_txt.append('        if (pNode) {')
             procs_txt.append('            pNode->status |= status_flag;')
             procs_txt.append('        }')
             procs_txt.append('        else {')
@@ -926,8 +929,8 @@ class ObjectTrackerSubcommand(Subcommand):
             procs_txt.append('    const char         *fail_msg)')
             procs_txt.append('{')
             procs_txt.append('    uint64_t object_handle = (uint64_t)(object);')
-            procs_txt.append('    if (%sMap.find(object_handle) != %sMap.end()) {' % (o, o))
-            procs_txt.append('        OBJTRACK_NODE* pNode = %sMap[object_handle];' % (o))
+            procs_txt.append('    OBJTRACK_NODE* pNode = %sMap.find(object_handle);' % (o))
+            procs_txt.append('    if (pNode) {')
             procs_txt.append('        if ((pNode->status & status_mask) != status_flag) {')
             procs_txt.append('            log_msg(mdd(dispatchable_object), msg_flags, pNode->objType, object_handle, __LINE__, OBJTRACK_UNKNOWN_OBJECT, "OBJTRACK",')
             procs_txt.append('                "OBJECT VALIDATION WARNING: %s object 0x%" PRIxLEAST64 ": %s", string_VkDebugReportObjectTypeEXT(objType),')
@@ -952,8 +955,8 @@ class ObjectTrackerSubcommand(Subcommand):
                 procs_txt.append('static VkBool32 reset_%s_status(VkDevice dispatchable_object, %s object, VkDebugReportObjectTypeEXT objType, ObjectStatusFlags status_flag)' % (name, o))
             procs_txt.append('{')
             procs_txt.append('    uint64_t object_handle = (uint64_t)(object);')
-            procs_txt.append('    if (%sMap.find(object_handle) != %sMap.end()) {' % (o, o))
-            procs_txt.append('        OBJTRACK_NODE* pNode = %sMap[object_handle];' % (o))
+            procs_txt.append('    OBJTRACK_NODE* pNode = %sMap.find(object_handle);' % (o))
+            procs_txt.append('    if (pNode) {')
             procs_txt.append('        pNode->status &= ~status_flag;')
             procs_txt.append('    }')
             procs_txt.append('    else {')
@@ -980,7 +983,7 @@ class ObjectTrackerSubcommand(Subcommand):
             procs_txt.append('{')
             procs_txt.append('    if (null_allowed && (object == VK_NULL_HANDLE))')
             procs_txt.append('        return VK_FALSE;')
-            procs_txt.append('    if (%sMap.find((uint64_t)object) == %sMap.end()) {' % (do, do))
+            procs_txt.append('    if (!%sMap.find((uint64_t)object)) {' % (do))
             procs_txt.append('        return log_msg(mdd(dispatchable_object), VK_DEBUG_REPORT_ERROR_BIT_EXT, objType, (uint64_t)(object), __LINE__, OBJTRACK_INVALID_OBJECT, "OBJTRACK",')
             procs_txt.append('            "Invalid %s Object 0x%%" PRIx64 ,(uint64_t)(object));' % do)
             procs_txt.append('    }')
@@ -999,10 +1002,9 @@ class ObjectTrackerSubcommand(Subcommand):
                 procs_txt.append('        return VK_FALSE;')
                 if o == "VkImage":
                     procs_txt.append('    // We need to validate normal image objects and those from the swapchain')
-                    procs_txt.append('    if ((%sMap.find((uint64_t)object) == %sMap.end()) &&' % (o, o))
-                    procs_txt.append('        (swapchainImageMap.find((uint64_t)object) == swapchainImageMap.end())) {')
+                    procs_txt.append('    if (!%sMap.find((uint64_t)object) && !swapchainImageMap.find((uint64_t)object)) {' % (o))
                 else:
-                    procs_txt.append('    if (%sMap.find((uint64_t)object) == %sMap.end()) {' % (o, o))
+                    procs_txt.append('    if (!%sMap.find((uint64_t)object)) {' % (o))
                 procs_txt.append('        return log_msg(mdd(dispatchable_object), VK_DEBUG_REPORT_ERROR_BIT_EXT, objType, (uint64_t)(object), __LINE__, OBJTRACK_INVALID_OBJECT, "OBJTRACK",')
                 procs_txt.append('            "Invalid %s Object 0x%%" PRIx64, (uint64_t)(object));' % o)
                 procs_txt.append('    }')
@@ -1027,8 +1029,7 @@ class ObjectTrackerSubcommand(Subcommand):
         for o in vulkan.core.objects:
             if o in ['VkInstance', 'VkPhysicalDevice', 'VkQueue']:
                 continue
-            gedi_txt.append('    for (auto it = %sMap.begin(); it != %sMap.end(); ++it) {' % (o, o))
-            gedi_txt.append('        OBJTRACK_NODE* pNode = it->second;')
+            gedi_txt.append('    for (OBJTRACK_NODE* pNode = %sMap.first(); pNode; pNode = %sMap.next(pNode)) {' % (o, o))
             gedi_txt.append('        log_msg(mid(instance), VK_DEBUG_REPORT_ERROR_BIT_EXT, pNode->objType, pNode->vkObj, __LINE__, OBJTRACK_OBJECT_LEAK, "OBJTRACK",')
             gedi_txt.append('                "OBJ ERROR : %s object 0x%" PRIxLEAST64 " has not been destroyed.", string_VkDebugReportObjectTypeEXT(pNode->objType),')
             gedi_txt.append('                pNode->vkObj);')
@@ -1077,8 +1078,7 @@ class ObjectTrackerSubcommand(Subcommand):
             # DescriptorSets and Command Buffers are destroyed through their pools, not explicitly
             if o in ['VkInstance', 'VkPhysicalDevice', 'VkQueue', 'VkDevice', 'VkDescriptorSet', 'VkCommandBuffer']:
                 continue
-            gedd_txt.append('    for (auto it = %sMap.begin(); it != %sMap.end(); ++it) {' % (o, o))
-            gedd_txt.append('        OBJTRACK_NODE* pNode = it->second;')
+            gedd_txt.append('    for (OBJTRACK_NODE* pNode = %sMap.first(); pNode; pNode = %sMap.next(pNode)) {' % (o, o))
             gedd_txt.append('        log_msg(mdd(device), VK_DEBUG_REPORT_ERROR_BIT_EXT, pNode->objType, pNode->vkObj, __LINE__, OBJTRACK_OBJECT_LEAK, "OBJTRACK",')
             gedd_txt.append('                "OBJ ERROR : %s object 0x%" PRIxLEAST64 " has not been destroyed.", string_VkDebugReportObjectTypeEXT(pNode->objType),')
             gedd_txt.append('                pNode->vkObj);')
@@ -1118,8 +1118,8 @@ class ObjectTrackerSubcommand(Subcommand):
             s_code += '%sif ((%sdescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER) ||\n'      % (indent, prefix)
             s_code += '%s    (%sdescriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)   ) {\n'   % (indent, prefix)
         elif name == 'pBeginInfo->pInheritanceInfo':
-            s_code += '%sOBJTRACK_NODE* pNode = VkCommandBufferMap[(uint64_t)commandBuffer];\n'       % (indent)
-            s_code += '%sif ((%s) && (pNode->status & OBJSTATUS_COMMAND_BUFFER_SECONDARY)) {\n'       % (indent, name)
+            s_code += '%sOBJTRACK_NODE* pNode = VkCommandBufferMap.find((uint64_t)commandBuffer);\n' % (indent)
+            s_code += '%sif ((%s) && pNode && (pNode->status & OBJSTATUS_COMMAND_BUFFER_SECONDARY)) {\n' % (indent, name)
         else:
             s_code += '%sif (%s) {\n' % (indent, name)
         return s_code
@@ -1441,14 +1441,21 @@ class UniqueObjectsSubcommand(Subcommand):
         header_txt.append('#include "unique_objects.h"')
         return "\n".join(header_txt)
 
+    # VkWriteDescriptorSet only reads the info array matching its descriptorType and apps may
+    #  leave the others dangling, so only copy the one that is used
+    descriptor_type_members = {'pImageInfo' : 'descriptorTypeUsesImageInfo',
+                               'pBufferInfo' : 'descriptorTypeUsesBufferInfo',
+                               'pTexelBufferView' : 'descriptorTypeUsesTexelBufferView'}
+
     # Generate UniqueObjects code for given struct_uses dict of objects that need to be unwrapped
-    # vector_name_set is used to make sure we don't replicate vector names
+    # Structs and arrays holding ndos are shallow-copied into per-thread scratch memory and the
+    #  handles are unwrapped in the copies. Returns (size_code, pre_code): size_code adds the
+    #  scratch bytes needed to scratch_size and has to run before pre_code makes the copies.
+    # prefix leads to the app's copy of a member and local_prefix to the same member in our copy
     # first_level_param indicates if elements are passed directly into the function else they're below a ptr/struct
-    # TODO : Comment this code
-    def _gen_obj_code(self, struct_uses, param_type, indent, prefix, array_index, vector_name_set, first_level_param):
-        decls = ''
+    def _gen_obj_code(self, struct_uses, param_type, indent, prefix, local_prefix, array_index, first_level_param):
+        size_code = ''
         pre_code = ''
-        post_code = ''
         for obj in sorted(struct_uses):
             name = obj
             array = ''
@@ -1458,89 +1465,66 @@ class UniqueObjectsSubcommand(Subcommand):
             ptr_type = False
             if 'p' == obj[0] and obj[1] != obj[1].lower(): # TODO : Not idea way to determine ptr
                 ptr_type = True
-            if isinstance(struct_uses[obj], dict):
-                local_prefix = ''
-                name = '%s%s' % (prefix, name)
-                if ptr_type:
-                    if first_level_param and name in param_type:
-                        pre_code += '%sif (%s) {\n' % (indent, name)
-                    else: # shadow ptr will have been initialized at this point so check it vs. source ptr
-                        pre_code += '%sif (local_%s) {\n' % (indent, name)
-                    indent += '    '
+            is_struct = isinstance(struct_uses[obj], dict)
+            if array != '' or (is_struct and ptr_type):
+                # Copy the array or struct into scratch, then unwrap in the copy
+                count = '1'
+                if array != '':
+                    count = '%s%s' % (prefix, array)
+                cond = '%s%s' % (prefix, name)
+                if name in self.descriptor_type_members:
+                    cond += ' && %s(%sdescriptorType)' % (self.descriptor_type_members[name], prefix)
+                size_code += '%sif (%s) {\n' % (indent, cond)
+                pre_code += '%sif (%s) {\n' % (indent, cond)
+                indent += '    '
+                size_code += '%sscratch_size += scratchBytes(%s%s, %s);\n' % (indent, prefix, name, count)
+                if first_level_param and name in param_type:
+                    pre_code += '%slocal_%s = scratch.copy(%s%s, %s);\n' % (indent, name, prefix, name, count)
+                else: # point the enclosing copy at this one
+                    local_type = 'auto'
+                    if not is_struct:
+                        local_type = '%s*' % struct_uses[obj]
+                    pre_code += '%s%s local_%s = scratch.copy(%s%s, %s);\n' % (indent, local_type, name, prefix, name, count)
+                    pre_code += '%s%s%s = local_%s;\n' % (indent, local_prefix, name, name)
                 if array != '':
                     idx = 'idx%s' % str(array_index)
                     array_index += 1
-                    if first_level_param and name in param_type:
-                        pre_code += '%slocal_%s = new safe_%s[%s];\n' % (indent, name, param_type[name].strip('*'), array)
-                        post_code += '    if (local_%s)\n' % (name)
-                        post_code += '        delete[] local_%s;\n' % (name)
-                    pre_code += '%sfor (uint32_t %s=0; %s<%s%s; ++%s) {\n' % (indent, idx, idx, prefix, array, idx)
+                    loop_txt = '%sfor (uint32_t %s=0; %s<%s; ++%s) {\n' % (indent, idx, idx, count, idx)
                     indent += '    '
-                    if first_level_param:
-                        pre_code += '%slocal_%s[%s].initialize(&%s[%s]);\n' % (indent, name, idx, name, idx)
-                    local_prefix = '%s[%s].' % (name, idx)
-                elif ptr_type:
-                    if first_level_param and name in param_type:
-                        pre_code += '%slocal_%s = new safe_%s(%s);\n' % (indent, name, param_type[name].strip('*'), name)
-                        post_code += '    if (local_%s)\n' % (name)
-                        post_code += '        delete local_%s;\n' % (name)
-                    local_prefix = '%s->' % (name)
-                else:
-                    local_prefix = '%s.' % (name)
-                assert isinstance(decls, object)
-                (tmp_decl, tmp_pre, tmp_post) = self._gen_obj_code(struct_uses[obj], param_type, indent, local_prefix, array_index, vector_name_set, False)
-                decls += tmp_decl
-                pre_code += tmp_pre
-                post_code += tmp_post
-                if array != '':
-                    indent = indent[4:]
-                    pre_code += '%s}\n' % (indent)
-                if ptr_type:
-                    indent = indent[4:]
-                    pre_code += '%s}\n' % (indent)
-            else:
-                if (array_index > 0) or array != '': # TODO : This is not ideal, really want to know if we're anywhere under an array
-                    if first_level_param:
-                        pre_code += '%s%s* local_%s = NULL;\n' % (indent, struct_uses[obj], name)
-                    if array != '' and not first_level_param: # ptrs under structs will have been initialized so use local_*
-                        pre_code += '%sif (local_%s%s) {\n' %(indent, prefix, name)
+                    if is_struct:
+                        (tmp_size, tmp_pre) = self._gen_obj_code(struct_uses[obj], param_type, indent, '%s%s[%s].' % (prefix, name, idx), 'local_%s[%s].' % (name, idx), array_index, False)
                     else:
-                        pre_code += '%sif (%s%s) {\n' %(indent, prefix, name)
-                    indent += '    '
-                    if array != '':
-                        idx = 'idx%s' % str(array_index)
-                        array_index += 1
-                        if first_level_param:
-                            pre_code += '%slocal_%s = new %s[%s];\n' % (indent, name, struct_uses[obj], array)
-                            post_code += '    if (local_%s)\n' % (name)
-                            post_code += '        delete[] local_%s;\n' % (name)
-                        pre_code += '%sfor (uint32_t %s=0; %s<%s%s; ++%s) {\n' % (indent, idx, idx, prefix, array, idx)
-                        indent += '    '
-                        name = '%s[%s]' % (name, idx)
-                    pName = 'p%s' % (struct_uses[obj][2:])
-                    if name not in vector_name_set:
-                        vector_name_set.add(name)
-                    pre_code += '%slocal_%s%s = (%s)((VkUniqueObject*)%s%s)->actualObject;\n' % (indent, prefix, name, struct_uses[obj], prefix, name)
-                    if array != '':
-                        indent = indent[4:]
-                        pre_code += '%s}\n' % (indent)
+                        tmp_size = ''
+                        tmp_pre = '%slocal_%s[%s] = (%s)unwrapUniqueObject((uint64_t)%s%s[%s]);\n' % (indent, name, idx, struct_uses[obj], prefix, name, idx)
                     indent = indent[4:]
-                    pre_code += '%s}\n' % (indent)
+                    if tmp_size != '':
+                        size_code += '%s%s%s}\n' % (loop_txt, tmp_size, indent)
+                    pre_code += '%s%s%s}\n' % (loop_txt, tmp_pre, indent)
                 else:
-                    pre_code += '%s\n' % (self.lineinfo.get())
-                    pre_code += '%sif (%s%s) {\n' %(indent, prefix, name)
-                    indent += '    '
+                    (tmp_size, tmp_pre) = self._gen_obj_code(struct_uses[obj], param_type, indent, '%s%s->' % (prefix, name), 'local_%s->' % (name), array_index, False)
+                    size_code += tmp_size
+                    pre_code += tmp_pre
+                indent = indent[4:]
+                size_code += '%s}\n' % (indent)
+                pre_code += '%s}\n' % (indent)
+            elif is_struct: # struct held by value in the enclosing copy
+                (tmp_size, tmp_pre) = self._gen_obj_code(struct_uses[obj], param_type, indent, '%s%s.' % (prefix, name), '%s%s.' % (local_prefix, name), array_index, False)
+                size_code += tmp_size
+                pre_code += tmp_pre
+            else:
+                pre_code += '%sif (%s%s) {\n' %(indent, prefix, name)
+                indent += '    '
+                if first_level_param:
                     deref_txt = '&'
                     if ptr_type:
                         deref_txt = ''
-                    if '->' in prefix: # need to update local struct
-                        pre_code += '%slocal_%s%s = (%s)((VkUniqueObject*)%s%s)->actualObject;\n' % (indent, prefix, name, struct_uses[obj], prefix, name)
-                    else:
-                        pre_code += '%s%s* p%s = (%s*)%s%s%s;\n' % (indent, struct_uses[obj], name, struct_uses[obj], deref_txt, prefix, name)
-                        pre_code += '%s*p%s = (%s)((VkUniqueObject*)%s%s)->actualObject;\n' % (indent, name, struct_uses[obj], prefix, name)
-                    indent = indent[4:]
-                    pre_code += '%s}\n' % (indent)
-        return decls, pre_code, post_code
+                    pre_code += '%s%s* p%s = (%s*)%s%s%s;\n' % (indent, struct_uses[obj], name, struct_uses[obj], deref_txt, prefix, name)
+                    pre_code += '%s*p%s = (%s)unwrapUniqueObject((uint64_t)%s%s);\n' % (indent, name, struct_uses[obj], prefix, name)
+                else:
+                    pre_code += '%s%s%s = (%s)unwrapUniqueObject((uint64_t)%s%s);\n' % (indent, local_prefix, name, struct_uses[obj], prefix, name)
+                indent = indent[4:]
+                pre_code += '%s}\n' % (indent)
+        return size_code, pre_code
 
     def generate_intercept(self, proto, qual):
         create_func = False
@@ -1555,9 +1539,15 @@ class UniqueObjectsSubcommand(Subcommand):
         # TODO : Special case Create*Pipelines funcs to handle creating multiple unique objects
         explicit_object_tracker_functions = ['GetSwapchainImagesKHR',
                                              'CreateInstance',
+                                             'DestroyInstance',
                                              'CreateDevice',
+                                             'DestroyDevice',
                                              'CreateComputePipelines',
-                                             'CreateGraphicsPipelines'
+                                             'CreateGraphicsPipelines',
+                                             'AllocateDescriptorSets',
+                                             'FreeDescriptorSets',
+                                             'ResetDescriptorPool',
+                                             'DestroyDescriptorPool'
                                              ]
         # TODO : This is hacky, need to make this a more general-purpose solution for all layers
         ifdef_dict = {'CreateXcbSurfaceKHR': 'VK_USE_PLATFORM_XCB_KHR', 'CreateAndroidSurfaceKHR': 'VK_USE_PLATFORM_ANDROID_KHR'}
@@ -1578,6 +1568,9 @@ class UniqueObjectsSubcommand(Subcommand):
             destroy_obj_type = proto.params[-2].ty
             if destroy_obj_type in vulkan.object_non_dispatch_list:
                 destroy_func = True
+            # Batch frees such as FreeDescriptorSets pass a count and an array of handles
+            elif 'count' in proto.params[-2].name.lower() and proto.params[-1].ty.replace('const ', '').strip('*') in vulkan.object_non_dispatch_list:
+                destroy_func = True
 
         # First thing we need to do is gather uses of non-dispatchable-objects (ndos)
         (struct_uses, local_decls) = get_object_uses(vulkan.object_non_dispatch_list, proto.params[1:last_param_index])
@@ -1586,19 +1579,18 @@ class UniqueObjectsSubcommand(Subcommand):
             pre_call_txt += '// STRUCT USES:%s\n' % struct_uses
             if len(local_decls) > 0:
                 pre_call_txt += '//LOCAL DECLS:%s\n' % local_decls
-            if destroy_func: # only one object
+            if destroy_func and 'count' not in proto.params[-2].name.lower(): # only one object
                 for del_obj in struct_uses:
                     pre_call_txt += '%s%s local_%s = %s;\n' % (indent, struct_uses[del_obj], del_obj, del_obj)
-            (pre_decl, pre_code, post_code) = self._gen_obj_code(struct_uses, local_decls, '    ', '', 0, set(), True)
-            # This is a bit hacky but works for now. Need to decl local versions of top-level structs
+            (size_code, pre_code) = self._gen_obj_code(struct_uses, local_decls, indent, '', '', 0, True)
+            # Declare local versions of top-level structs and arrays, which point into scratch
             for ld in local_decls:
-                init_null_txt = 'NULL';
-                if '*' not in local_decls[ld]:
-                    init_null_txt = '{}';
-                if local_decls[ld].strip('*') not in vulkan.object_non_dispatch_list:
-                    pre_decl += '    safe_%s local_%s = %s;\n' % (local_decls[ld], ld, init_null_txt)
-            pre_call_txt += '%s%s' % (pre_decl, pre_code)
-            post_call_txt += '%s' % (post_code)
+                pre_call_txt += '%s%s local_%s = NULL;\n' % (indent, local_decls[ld], ld)
+            if size_code != '':
+                pre_call_txt += '%ssize_t scratch_size = 0;\n' % (indent)
+                pre_call_txt += size_code
+                pre_call_txt += '%sunique_objects_scratch scratch(scratch_size);\n' % (indent)
+            pre_call_txt += pre_code
         elif create_func:
             base_type = proto.params[-1].ty.replace('const ', '').strip('*')
             if base_type not in vulkan.object_non_dispatch_list:
@@ -1618,40 +1610,28 @@ class UniqueObjectsSubcommand(Subcommand):
             obj_type = proto.params[-1].ty.strip('*')
             obj_name = proto.params[-1].name
             if obj_type in vulkan.object_non_dispatch_list:
-                local_name = "unique%s" % obj_type[2:]
                 post_call_txt += '%sif (VK_SUCCESS == result) {\n' % (indent)
                 indent += '    '
+                post_call_txt += '%s\n' % (self.lineinfo.get())
+                post_call_txt += '%slayer_data *my_data = get_my_data_ptr(get_dispatch_key(%s), layer_data_map);\n' % (indent, dispatch_param)
                 if obj_name in custom_create_dict:
-                    post_call_txt += '%s\n' % (self.lineinfo.get())
-                    local_name = '%ss' % (local_name) # add 's' to end for vector of many
-                    post_call_txt += '%sstd::vector<VkUniqueObject*> %s = {};\n' % (indent, local_name)
-                    post_call_txt += '%sfor (uint32_t i=0; i<%s; ++i) {\n' % (indent, custom_create_dict[obj_name])
-                    indent += '    '
-                    post_call_txt += '%s%s.push_back(new VkUniqueObject());\n' % (indent, local_name)
-                    post_call_txt += '%s%s[i]->actualObject = (uint64_t)%s[i];\n' % (indent, local_name, obj_name)
-                    post_call_txt += '%s%s[i] = (%s)%s[i];\n' % (indent, obj_name, obj_type, local_name)
-                    indent = indent[4:]
-                    post_call_txt += '%s}\n' % (indent)
+                    post_call_txt += '%swrapUniqueObjects(my_data, %s, %s);\n' % (indent, custom_create_dict[obj_name], obj_name)
                 else:
-                    post_call_txt += '%s\n' % (self.lineinfo.get())
-                    post_call_txt += '%sVkUniqueObject* %s = new VkUniqueObject();\n' % (indent, local_name)
-                    post_call_txt += '%s%s->actualObject = (uint64_t)*%s;\n' % (indent, local_name, obj_name)
-                    post_call_txt += '%s*%s = (%s)%s;\n' % (indent, obj_name, obj_type, local_name)
+                    post_call_txt += '%s*%s = (%s)wrapUniqueObject(my_data, (uint64_t)*%s);\n' % (indent, obj_name, obj_type, obj_name)
                 indent = indent[4:]
                 post_call_txt += '%s}\n' % (indent)
         elif destroy_func:
             del_obj = proto.params[-2].name
+            post_call_txt += '%s\n' % (self.lineinfo.get())
+            post_call_txt += '%slayer_data *my_data = get_my_data_ptr(get_dispatch_key(%s), layer_data_map);\n' % (indent, dispatch_param)
             if 'count' in del_obj.lower():
-                post_call_txt += '%s\n' % (self.lineinfo.get())
-                post_call_txt += '%sfor (uint32_t i=0; i<%s; ++i) {\n' % (indent, del_obj)
-                del_obj = proto.params[-1].name
-                indent += '    '
-                post_call_txt += '%sdelete (VkUniqueObject*)%s[i];\n' % (indent, del_obj)
-                indent = indent[4:]
-                post_call_txt += '%s}\n' % (indent)
+                # Batch frees can fail, in which case the objects stay valid
+                if proto.ret != "void":
+                    post_call_txt += '%sif (VK_SUCCESS == result)\n' % (indent)
+                    post_call_txt += '    '
+                post_call_txt += '%sfreeUniqueObjects(my_data, %s, %s);\n' % (indent, del_obj, proto.params[-1].name)
             else:
-                post_call_txt += '%s\n' % (self.lineinfo.get())
-                post_call_txt = '%sdelete (VkUniqueObject*)local_%s;\n' % (indent, proto.params[-2].name)
+                post_call_txt += '%sfreeUniqueObject(my_data, (uint64_t)local_%s);\n' % (indent, del_obj)
 
         call_sig = proto.c_call()
         # Replace default params with any custom local params
@@ -1708,9 +1688,13 @@ class UniqueObjectsSubcommand(Subcommand):
                                    'vkGetPhysicalDeviceSurfaceCapabilitiesKHR',
                                    'vkGetPhysicalDeviceSurfaceFormatsKHR',
                                    'vkGetPhysicalDeviceSurfacePresentModesKHR'])]
+        instance_extensions.append(('msg_callback_get_proc_addr', []))
         body = [self._generate_dispatch_entrypoints("VK_LAYER_EXPORT"),
                 self._generate_layer_gpa_function(extensions,
-                                                  instance_extensions)]
+                                                  instance_extensions),
+                self._gen_create_msg_callback(),
+                self._gen_destroy_msg_callback(),
+                self._gen_debug_report_msg()]
         return "\n\n".join(body)
 
 class ThreadingSubcommand(Subcommand):
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+# Copyright (c) 2015-2016 The Khronos Group Inc.
+# Copyright (c) 2015-2016 Valve Corporation
+# Copyright (c) 2015-2016 LunarG, Inc.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and/or associated documentation files (the "Materials"), to
+# deal in the Materials without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Materials, and to permit persons to whom the Materials
+# are furnished to do so, subject to the following conditions:
+#
+# The above copyright notice(s) and this permission notice shall be included
+# in all copies or substantial portions of the Materials.
+#
+# THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+#
+# IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+# DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+# OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+# USE OR OTHER DEALINGS IN THE MATERIALS
+
+import argparse
+import struct
+import sys
+
+# vk_layer_log_decode.py overview
+# Decodes the binary log ring written by the validation layers when
+#  <LayerIdentifier>.log_ring_filename is set in vk_layer_settings.txt, and
+#  prints the surviving records oldest first in the same format as the text log.
+# The file layout must match LogRingHeader / LogRingRecord in vk_layer_config.cpp.
+
+LOG_RING_MAGIC = b'VKLOGRNG'
+LOG_RING_VERSION = 1
+HEADER = struct.Struct('<8sIIQQQQ16x')
+RECORD = struct.Struct('<QQQQQQIiII16s')
+
+FLAG_NAMES = [(0x10, 'DEBUG'), (0x1, 'INFO'), (0x2, 'WARN'), (0x4, 'PERF'), (0x8, 'ERROR')]
+FLAG_BITS = {'debug': 0x10, 'info': 0x1, 'warn': 0x2, 'perf': 0x4, 'error': 0x8}
+
+def flags_to_string(flags):
+    return ','.join(name for bit, name in FLAG_NAMES if flags & bit)
+
+def parse_int_list(value):
+    return set(int(v, 0) for v in value.split(',')) if value else None
+
+def decode(data):
+    magic, version, record_size, record_capacity, string_capacity, record_head, string_head = HEADER.unpack_from(data, 0)
+    if magic != LOG_RING_MAGIC or version != LOG_RING_VERSION or record_size != RECORD.size:
+        raise ValueError('not a version %d validation log ring' % LOG_RING_VERSION)
+    records_base = HEADER.size
+    strings_base = records_base + record_capacity * record_size
+    first = max(record_head - record_capacity, 0)
+    records = []
+    for slot in range(record_capacity):
+        (sequence, timestamp, thread_id, obj, location, msg_offset, msg_length,
+         msg_code, msg_flags, obj_type, layer) = RECORD.unpack_from(data, records_base + slot * record_size)
+        # Skip empty, torn and stale slots
+        if sequence == 0 or sequence <= first or (sequence - 1) % record_capacity != slot:
+            continue
+        if string_head - msg_offset > string_capacity:
+            message = '<message overwritten>'
+        else:
+            start = msg_offset % string_capacity
+            raw = data[strings_base + start:strings_base + min(start + msg_length, string_capacity)]
+            raw += data[strings_base:strings_base + msg_length - len(raw)]
+            message = raw.decode('utf-8', 'replace')
+        records.append({'sequence': sequence, 'timestamp': timestamp, 'thread': thread_id, 'object': obj,
+                        'location': location, 'msgCode': msg_code, 'flags': msg_flags, 'type': obj_type,
+                        'layer': layer.split(b'\0', 1)[0].decode('ascii', 'replace'), 'message': message})
+    records.sort(key=lambda r: r['sequence'])
+    return records, record_head - len(records)
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description='Decode and filter a validation layer binary log ring.')
+    parser.add_argument('logfile', help='file named by <LayerIdentifier>.log_ring_filename')
+    parser.add_argument('--layer', help='comma-separated layer prefixes to keep, e.g. DS,MEM')
+    parser.add_argument('--flags', help='comma-separated report flags to keep: info,warn,perf,error,debug')
+    parser.add_argument('--msg-code', help='comma-separated message codes to keep')
+    parser.add_argument('--object', help='comma-separated object handles to keep')
+    parser.add_argument('--thread', help='comma-separated thread ids to keep')
+    parser.add_argument('--grep', help='keep only messages containing this string')
+    parser.add_argument('--summary', action='store_true', help='print counts per layer and message code instead')
+    args = parser.parse_args(argv)
+
+    with open(args.logfile, 'rb') as f:
+        data = f.read()
+    try:
+        records, dropped = decode(data)
+    except (ValueError, struct.error) as e:
+        print('%s: %s' % (args.logfile, e), file=sys.stderr)
+        return 1
+
+    layers = set(args.layer.split(',')) if args.layer else None
+    flags = sum(FLAG_BITS[f] for f in args.flags.split(',')) if args.flags else None
+    codes = parse_int_list(args.msg_code)
+    objects = parse_int_list(args.object)
+    threads = parse_int_list(args.thread)
+
+    counts = {}
+    for r in records:
+        if layers is not None and r['layer'] not in layers:
+            continue
+        if flags is not None and not (r['flags'] & flags):
+            continue
+        if codes is not None and r['msgCode'] not in codes:
+            continue
+        if objects is not None and r['object'] not in objects:
+            continue
+        if threads is not None and r['thread'] not in threads:
+            continue
+        if args.grep and args.grep not in r['message']:
+            continue
+        if args.summary:
+            key = (r['layer'], r['msgCode'])
+            counts[key] = counts.get(key, 0) + 1
+            continue
+        print('[%d.%09d] thread: %#x %s(%s): object: %#x type: %d location: %d msgCode: %d: %s' %
+              (r['timestamp'] // 1000000000, r['timestamp'] % 1000000000, r['thread'], r['layer'],
+               flags_to_string(r['flags']), r['object'], r['type'], r['location'], r['msgCode'], r['message']))
+
+    if args.summary:
+        for (layer, code), count in sorted(counts.items()):
+            print('%-12s msgCode: %-6d count: %d' % (layer, code, count))
+    if dropped:
+        print('%d records were overwritten or torn' % dropped, file=sys.stderr)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())